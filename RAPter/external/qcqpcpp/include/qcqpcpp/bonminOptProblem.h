@@ -35,6 +35,7 @@ class BonminOpt : public qcqpcpp::OptProblem<_Scalar>
             : _algCode  ( Bonmin::Algorithm::B_BB )
             , _nodeLimit( 100 )
             , _maxSolutions( 0 )
+            , _cutoff   ( std::numeric_limits<_Scalar>::max() )
             , _printSol ( false )
             , _debug    ( false )
         {}
@@ -75,6 +76,9 @@ class BonminOpt : public qcqpcpp::OptProblem<_Scalar>
         inline void setAlgorithm                           ( Bonmin::Algorithm alg ) { _algCode = alg; }
         inline void setNodeLimit                           ( int nodeLimit )         { _nodeLimit = nodeLimit; }
         inline void setMaxSolutions                        ( int maxSolutions )         { _maxSolutions = maxSolutions; }
+        //! \brief Objective of a known feasible solution, Bonmin only looks for better ones. Unset by default.
+        inline void setCutoff                              ( _Scalar cutoff )        { _cutoff = cutoff; }
+        inline _Scalar getCutoff                           ()        const           { return _cutoff; }
 
 
     protected:
@@ -89,6 +93,7 @@ class BonminOpt : public qcqpcpp::OptProblem<_Scalar>
         Bonmin::Algorithm           _algCode;   //!< \brief Stores the chosen algorihtm code. 0 = B_Bb default.
         int                         _nodeLimit; //!< \brief How many nodes bonmin can explore.
         int                         _maxSolutions;
+        _Scalar                     _cutoff;    //!< \brief Incumbent objective value, max() if unknown.
 
         VectorX                     _grad_f; //!< \brief Caches eval_grad_f output.
     private:
@@ -254,8 +259,8 @@ template <typename _Scalar> int
 BonminOpt<_Scalar>::update( bool verbose /* = false */ )
 {
 //    _jacobian = this->estimateJacobianOfConstraints();
-    VectorX ones( this->getVarCount(), 1 ); ones.setConstant( _Scalar(1.) );
-    this->getJacobian( ones );
+    // sparsity patterns are computed once here, the Ipopt callbacks only fill values in place
+    this->precalcJacobianSparsity();
     if ( isDebug() )
     {
         std::cout<<"[" << __func__ << "]: " << "jacobian ok" << this->_jacobian << std::endl; fflush(stdout);
@@ -362,6 +367,8 @@ BonminOpt<_Scalar>::optimize( std::vector<_Scalar> *x_out /* = NULL */, typename
     bonmin2.setIntParameter( Bonmin::BabSetupBase::MaxNodes, _nodeLimit );
     if ( _maxSolutions )
         bonmin2.setIntParameter( Bonmin::BabSetupBase::MaxSolutions, _maxSolutions );
+    if ( _cutoff < std::numeric_limits<_Scalar>::max() )
+        bonmin2.setDoubleParameter( Bonmin::BabSetupBase::Cutoff, _cutoff );
 
     std::cout << "[" << __func__ << "]: " << "Bonmin::MaxNode = " << bonmin2.getIntParameter( Bonmin::BabSetupBase::MaxNodes ) << ", _nodeLimit: " << _nodeLimit << std::endl;
     std::cout << "[" << __func__ << "]: " << "Bonmin::MaxIterations = " << bonmin2.getIntParameter( Bonmin::BabSetupBase::MaxIterations ) << std::endl;
@@ -546,9 +553,8 @@ BonminTMINLP<_Scalar>::get_nlp_info( Ipopt::Index                & n
 
     n           = _delegate.getVarCount();            // number of variable
     m           = _delegate.getConstraintCount();     // number of constraints
-    nnz_jac_g   = _delegate.getJacobian( _ones ).nonZeros(); // number of non zeroes in Jacobian
-    VectorX ones( m, 1 ); ones.setConstant( _Scalar(1.) );
-    nnz_h_lag   = _delegate.getHessian( 1., ones ).nonZeros();  // number of non zeroes in Hessian of Lagrangean
+    nnz_jac_g   = _delegate.getJacobianNonZeros();       // number of non zeroes in Jacobian
+    nnz_h_lag   = _delegate.getHessianNonZeros();        // number of non zeroes in Hessian of Lagrangean
     index_style = Ipopt::TNLP::C_STYLE;               // zero-indexed
 
     if ( _delegate.isDebug() )
@@ -875,39 +881,19 @@ BonminTMINLP<_Scalar>::eval_jac_g( Ipopt::Index         n
         throw new BonminOptException( "[BonminOpt::eval_jac_g] n != getVarCount()" );
     }
 
-    MatrixMapT   x_eig( x, _delegate.getVarCount() );
-    SparseMatrix jacobian = x ? _delegate.getJacobian( x_eig )
-                              : _delegate.getJacobian( _ones );
-
-    if ( nnz_jac != jacobian.nonZeros() )
+    if ( nnz_jac != static_cast<Ipopt::Index>(_delegate.getJacobianNonZeros()) )
         throw new BonminOptException( "[BonminOpt::eval_jac_g] nnz_jac != _jacobian.nonZeros()" );
 
-    int entry_id = 0;
     if ( values == NULL )
     {
-        for ( int row = 0; row != jacobian.outerSize(); ++row )
-        {
-            for ( typename Eigen::SparseMatrix<_Scalar,Eigen::RowMajor>::InnerIterator it(jacobian,row);
-                  it; ++it, ++entry_id )
-            {
-                iRow[ entry_id ] = it.row();
-                jCol[ entry_id ] = it.col();
-            } // ...for col
-        } // ...for row
-
+        std::copy( _delegate.getJacobianRows().begin(), _delegate.getJacobianRows().end(), iRow );
+        std::copy( _delegate.getJacobianCols().begin(), _delegate.getJacobianCols().end(), jCol );
         ret_val = true;
     } // ... if values == NULL
     else
     {
-        for ( int row = 0; row != jacobian.outerSize(); ++row )
-        {
-            for ( typename Eigen::SparseMatrix<_Scalar,Eigen::RowMajor>::InnerIterator it(jacobian,row);
-                  it; ++it, ++entry_id )
-            {
-                values[ entry_id ] = it.value();
-            } // ...for col
-        } // ...for row
-
+        // linear part copied, quadratic part added from x, x == NULL evaluates at ones
+        _delegate.fillJacobian( values, x );
         ret_val = true;
     } // ... else values != NULL
 
@@ -956,37 +942,19 @@ BonminTMINLP<_Scalar>::eval_h( Ipopt::Index          n
         throw new BonminOptException( "[BonminOpt::eval_h] m != getConstraintCount()" );
 
 
-    SparseMatrix hessian = lambda ? _delegate.getHessian( obj_factor, MatrixMapT(lambda, m) )
-                                  : _delegate.getHessian( obj_factor, VectorX::Ones(m,1) );
-
-    if ( nele_hess != hessian.nonZeros() )
+    if ( nele_hess != static_cast<Ipopt::Index>(_delegate.getHessianNonZeros()) )
         throw new BonminOptException( "[BonminOpt::eval_h] nele_hess != _delegate.getHessian().nonZeros()" );
 
-    int entry_id = 0;
     if ( values == NULL )
     {
-        for ( int row = 0; row != hessian.outerSize(); ++row )
-        {
-            for ( typename Eigen::SparseMatrix<_Scalar,Eigen::RowMajor>::InnerIterator it(hessian,row);
-                  it; ++it, ++entry_id )
-            {
-                iRow[ entry_id ] = it.row();
-                jCol[ entry_id ] = it.col();
-            } // ...for col
-        } // ...for row
-
+        std::copy( _delegate.getHessianRows().begin(), _delegate.getHessianRows().end(), iRow );
+        std::copy( _delegate.getHessianCols().begin(), _delegate.getHessianCols().end(), jCol );
         ret_val = true;
     }
     else {
         // NOTE: lower triangular only please!
-        for ( int row = 0; row != hessian.outerSize(); ++row )
-        {
-            for ( typename Eigen::SparseMatrix<_Scalar,Eigen::RowMajor>::InnerIterator it(hessian,row);
-                  it; ++it, ++entry_id )
-            {
-                values[ entry_id ] = it.value() * obj_factor;
-            } // ...for col
-        } // ...for row
+        // obj_factor * H_0 + sum_j lambda_j * H_j, lambda == NULL evaluates at ones
+        _delegate.fillHessian( values, obj_factor, lambda );
         ret_val = true;
     }
 
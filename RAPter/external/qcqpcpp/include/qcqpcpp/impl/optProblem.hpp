@@ -2,6 +2,7 @@
 #define QCQPCPP_SGOPTPROBLEM_HPP
 
 #include <exception>
+#include <algorithm>  // lower_bound, fill, copy
 #include "qcqpcpp/io/io.h" // readSparseMatrix, writeSparseMatrix
 #include "sys/stat.h"      // mkdir
 
@@ -229,51 +230,74 @@ OptProblem<_Scalar>::getJacobian( VectorX const& x )
 template <typename _Scalar> int
 OptProblem<_Scalar>::precalcHessianCoeffs()
 {
-//    if ( _quadConstrList.size() )
-//    {
-//        std::cerr << "[" << __func__ << "]: " << "Hessian NOT implemented for quadratic constraints yet..." << std::endl;
-//        throw new std::runtime_error( "[OptProblem::estimateHessianOfLagrangian] Hessian NOT implemented for quadratic constraints yet..." );
-//    }
+    // only the constraints up to the last quadratic one get a Hessian, the rest would be empty
+    size_t max_j_nnz = 0;
+    for ( size_t j = 0; j != std::min(_quadConstrList.size(), this->getConstraintCount()); ++j )
+        if ( _quadConstrList[j].size() )
+            max_j_nnz = 1+j;
+    if ( max_j_nnz < this->getConstraintCount() )
+        std::cout << "resizing hessians to " << max_j_nnz+1 << std::endl;
 
-    _hessians.resize( /* obj */ 1 + /* constraints: */ this->getConstraintCount() );
+    _hessians.resize( /* obj */ 1 + /* quadratic constraints: */ max_j_nnz );
 
-    _hessians[0] = SparseMatrix( getVarCount(), getVarCount() );
-    _hessians[0].reserve( _quadObjList.size() );
+    // duplicates are summed by setFromTriplets
+    SparseEntries entries;
+    entries.reserve( _quadObjList.size() );
     for ( size_t i = 0; i != _quadObjList.size(); ++i )
     {
         // (c * x^2)'' == 2c. Second derivative has a 2 multiplier if it's a squared variable.
         if ( _quadObjList[i].row() != _quadObjList[i].col() )
-            _hessians[0].coeffRef( _quadObjList[i].row(), _quadObjList[i].col() ) += _quadObjList[i].value();
+            entries.push_back( _quadObjList[i] );
         else
-        {
-            //std::cout << "[" << __func__ << "]: " << "inserting _hessians[0]" << _quadObjList[i].row() << ", " << _quadObjList[i].col() << " = " << _quadObjList[i].value() << std::endl;
-            _hessians[0].coeffRef( _quadObjList[i].row(), _quadObjList[i].col() ) += _Scalar(2) * _quadObjList[i].value();
-        }
-    } // for linConstrList
+            entries.push_back( SparseEntry(_quadObjList[i].row(), _quadObjList[i].col(), _Scalar(2) * _quadObjList[i].value()) );
+    } // for quadObjList
+    _hessians[0] = SparseMatrix( getVarCount(), getVarCount() );
+    _hessians[0].setFromTriplets( entries.begin(), entries.end() );
 
-    size_t max_j_nnz = 0;
-    for ( size_t j = 0; j != this->getConstraintCount(); ++j )
+    for ( size_t j = 0; j != max_j_nnz; ++j )
     {
-        _hessians[1+j] = SparseMatrix( getVarCount(), getVarCount() );
-
-        if ( j < _quadConstrList.size() ) //if quadratic constraint exists
+        entries.clear();
+        for ( size_t c = 0; c != _quadConstrList[j].size(); ++c )
         {
-            for ( size_t c = 0; c != _quadConstrList[j].size(); ++c )
-            {
-                SparseEntry const& entry = _quadConstrList[j][c];
-                _hessians[1+j].coeffRef( entry.row(), entry.col() ) += entry.value();
-                _hessians[1+j].coeffRef( entry.col(), entry.row() ) += entry.value();
-            } //...for constraint entries
-        } //...if quadratic constraint exists
+            SparseEntry const& entry = _quadConstrList[j][c];
+            entries.push_back( SparseEntry(entry.row(), entry.col(), entry.value()) );
+            entries.push_back( SparseEntry(entry.col(), entry.row(), entry.value()) );
+        } //...for constraint entries
 
-        if ( _hessians[1+j].nonZeros() )
-            max_j_nnz = 1+j;
+        _hessians[1+j] = SparseMatrix( getVarCount(), getVarCount() );
+        _hessians[1+j].setFromTriplets( entries.begin(), entries.end() );
     } //...for constraints
 
-    if ( max_j_nnz < _hessians.size()-1 )
+    // union pattern, and each Hessian as a slice of values at positions in it
+    entries.clear();
+    for ( size_t k = 0; k != _hessians.size(); ++k )
+        for ( int row = 0; row != _hessians[k].outerSize(); ++row )
+            for ( typename SparseMatrix::InnerIterator it(_hessians[k],row); it; ++it )
+                entries.push_back( SparseEntry(it.row(), it.col(), _Scalar(0)) );
+    SparseMatrix pattern( getVarCount(), getVarCount() );
+    pattern.setFromTriplets( entries.begin(), entries.end() );
+
+    _hessianRows.clear(); _hessianRows.reserve( pattern.nonZeros() );
+    _hessianCols.clear(); _hessianCols.reserve( pattern.nonZeros() );
+    for ( int row = 0; row != pattern.outerSize(); ++row )
+        for ( typename SparseMatrix::InnerIterator it(pattern,row); it; ++it )
+        {
+            _hessianRows.push_back( it.row() );
+            _hessianCols.push_back( it.col() );
+        }
+
+    _hessianSlices.assign( 1, 0 );
+    _hessianSlicePos .clear(); _hessianSlicePos .reserve( entries.size() );
+    _hessianSliceVals.clear(); _hessianSliceVals.reserve( entries.size() );
+    for ( size_t k = 0; k != _hessians.size(); ++k )
     {
-        std::cout << "resizing hessians to " << max_j_nnz+1 << std::endl;
-        _hessians.resize( max_j_nnz + 1 );
+        for ( int row = 0; row != _hessians[k].outerSize(); ++row )
+            for ( typename SparseMatrix::InnerIterator it(_hessians[k],row); it; ++it )
+            {
+                _hessianSlicePos .push_back( _patternPosition(pattern, it.row(), it.col()) );
+                _hessianSliceVals.push_back( it.value() );
+            }
+        _hessianSlices.push_back( _hessianSlicePos.size() );
     }
 
     return EXIT_SUCCESS;
@@ -301,6 +325,104 @@ OptProblem<_Scalar>::getHessian( Scalar const obj_factor, VectorX const& lambdas
     }
 }
 
+template <typename _Scalar> template <typename _NumberT> void
+OptProblem<_Scalar>::fillHessian( _NumberT * values, Scalar const obj_factor, _NumberT const* lambdas ) const
+{
+    std::fill( values, values + _hessianRows.size(), _NumberT(0) );
+    for ( size_t k = 0; k + 1 < _hessianSlices.size(); ++k )
+    {
+        const _Scalar factor = k ? (lambdas ? _Scalar(lambdas[k-1]) : _Scalar(1)) : obj_factor;
+        if ( factor == _Scalar(0) )
+            continue;
+
+        for ( size_t i = _hessianSlices[k]; i != _hessianSlices[k+1]; ++i )
+            values[ _hessianSlicePos[i] ] += factor * _hessianSliceVals[i];
+    }
+} //...OptProblem::fillHessian()
+
+template <typename _Scalar> int
+OptProblem<_Scalar>::precalcJacobianSparsity()
+{
+    // init linear cache part
+    if ( !this->_jacobian.size() )
+    {
+        this->_jacobian = SparseMatrix( getConstraintCount(), getVarCount() );
+        this->_jacobian.setFromTriplets( _linConstrList.begin(), _linConstrList.end() );
+    }
+
+    // pattern: linear entries, and the columns the quadratic constraints derive to
+    SparseEntries entries( _linConstrList );
+    for ( size_t constr_id = 0; constr_id != this->_quadConstrList.size(); ++constr_id )
+        for ( size_t entry_id = 0; entry_id != this->_quadConstrList[constr_id].size(); ++entry_id )
+        {
+            SparseEntry const& entry = this->_quadConstrList[constr_id][entry_id];
+            if ( entry.row() < entry.col() ) // above diagonal
+            {
+                std::cerr << "[" << __func__ << "]: " << "non-lower-triangular constraint matrix..." << std::endl;
+                throw new OptProblemException("non-lower-triangular constraint matrix...");
+            }
+            entries.push_back( SparseEntry(constr_id, entry.row(), _Scalar(0)) );
+            if ( entry.row() != entry.col() )
+                entries.push_back( SparseEntry(constr_id, entry.col(), _Scalar(0)) );
+        }
+    SparseMatrix pattern( getConstraintCount(), getVarCount() );
+    pattern.setFromTriplets( entries.begin(), entries.end() );
+
+    _jacobianRows   .clear(); _jacobianRows   .reserve( pattern.nonZeros() );
+    _jacobianCols   .clear(); _jacobianCols   .reserve( pattern.nonZeros() );
+    _jacobianLinVals.clear(); _jacobianLinVals.reserve( pattern.nonZeros() );
+    for ( int row = 0; row != pattern.outerSize(); ++row )
+        for ( typename SparseMatrix::InnerIterator it(pattern,row); it; ++it )
+        {
+            _jacobianRows   .push_back( it.row()   );
+            _jacobianCols   .push_back( it.col()   );
+            _jacobianLinVals.push_back( it.value() ); // summed linear coefficients, as in _jacobian
+        }
+
+    // terms of the quadratic part, see getJacobian
+    _jacobianQuadPos.clear(); _jacobianQuadVars.clear(); _jacobianQuadCoeffs.clear();
+    for ( size_t constr_id = 0; constr_id != this->_quadConstrList.size(); ++constr_id )
+        for ( size_t entry_id = 0; entry_id != this->_quadConstrList[constr_id].size(); ++entry_id )
+        {
+            SparseEntry const& entry = this->_quadConstrList[constr_id][entry_id];
+            if ( entry.row() == entry.col() ) // on diagonal: J(i,j) = 2 * c_jj * x_j
+            {
+                _jacobianQuadPos   .push_back( _patternPosition(pattern, constr_id, entry.row()) );
+                _jacobianQuadVars  .push_back( entry.col() );
+                _jacobianQuadCoeffs.push_back( _Scalar(2.) * entry.value() );
+            }
+            else // below diagonal: d(c_21 * x_2 * x_1) / dx_2 = c_21 * x_1, and / dx_1 = c_21 * x_2
+            {
+                _jacobianQuadPos   .push_back( _patternPosition(pattern, constr_id, entry.row()) );
+                _jacobianQuadVars  .push_back( entry.col() );
+                _jacobianQuadCoeffs.push_back( entry.value() );
+
+                _jacobianQuadPos   .push_back( _patternPosition(pattern, constr_id, entry.col()) );
+                _jacobianQuadVars  .push_back( entry.row() );
+                _jacobianQuadCoeffs.push_back( entry.value() );
+            }
+        } //...entries
+
+    return EXIT_SUCCESS;
+} //...OptProblem::precalcJacobianSparsity()
+
+template <typename _Scalar> template <typename _NumberT> void
+OptProblem<_Scalar>::fillJacobian( _NumberT * values, _NumberT const* x ) const
+{
+    std::copy( _jacobianLinVals.begin(), _jacobianLinVals.end(), values );
+    for ( size_t t = 0; t != _jacobianQuadPos.size(); ++t )
+        values[ _jacobianQuadPos[t] ] += _jacobianQuadCoeffs[t] * (x ? _Scalar(x[_jacobianQuadVars[t]]) : _Scalar(1));
+} //...OptProblem::fillJacobian()
+
+template <typename _Scalar> int
+OptProblem<_Scalar>::_patternPosition( SparseMatrix const& pattern, int const row, int const col )
+{
+    auto const begin = pattern.innerIndexPtr() + pattern.outerIndexPtr()[row];
+    auto const end   = pattern.innerIndexPtr() + pattern.outerIndexPtr()[row+1];
+    auto const it    = std::lower_bound( begin, end, col );
+    return (it != end && *it == col) ? int(it - pattern.innerIndexPtr()) : -1;
+} //...OptProblem::_patternPosition()
+
 //______________________________________________________________________________
 
 template <typename _Scalar> int
@@ -822,6 +944,17 @@ OptProblem<_Scalar>::read( std::string proj_file_path )
     const int entry_limit = 5;
     int entries = 0;
 
+    // binary container, see writeBinary(), either given, or in place of problem.proj in the directory
+    if ( (proj_file_path.size() > 5) && (proj_file_path.rfind(".qcqp") == proj_file_path.size() - 5) )
+        return this->readBinary( proj_file_path );
+    else if ( proj_file_path.rfind(".proj") != proj_file_path.size() - 5 )
+    {
+        struct stat file_stat;
+        if (  (0 != stat((proj_file_path + "/problem.proj"        ).c_str(), &file_stat))
+           && (0 == stat((proj_file_path + "/" + getBinaryName()).c_str(), &file_stat)) )
+            return this->readBinary( proj_file_path + "/" + getBinaryName() );
+    }
+
     // Parse project path
     std::string proj_path = ".";
     if ( proj_file_path.rfind(".proj") != proj_file_path.size() - 5 )
@@ -0,0 +1,573 @@
+#ifndef QCQPCPP_OPTPROBLEMIO_HPP
+#define QCQPCPP_OPTPROBLEMIO_HPP
+
+#include <cmath>           // abs
+#include <cstring>         // memcpy, memcmp
+#include <sstream>         // ostringstream
+#include <fstream>
+#include <iomanip>         // setprecision
+#include "fcntl.h"         // open
+#include "unistd.h"        // close
+#include "sys/mman.h"      // mmap, munmap
+#include "sys/stat.h"      // fstat
+#include "qcqpcpp/io/io.h" // BinaryHeader, BinaryReader, writeBinaryArray
+
+namespace qcqpcpp
+{
+
+template <typename _Scalar> int
+OptProblem<_Scalar>::writeBinary( std::string const& path, bool const withNames ) const
+{
+    std::ofstream f( path, std::ios::binary );
+    if ( !f.is_open() )
+    {
+        std::cerr << "[" << __func__ << "]: " << "could not open " << path << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const size_t n = this->getVarCount(), m = this->getConstraintCount();
+    SparseMatrix Qo = this->getQuadraticObjectivesMatrix(); // duplicates summed
+    SparseMatrix A  = this->getLinConstraintsMatrix();
+    Qo.makeCompressed();
+    A .makeCompressed();
+
+    // names, only if there are any
+    std::vector<int64_t> nameOffsets( 1, 0 );
+    std::string          names;
+    if ( withNames )
+    {
+        for ( size_t j = 0; j != _names.size(); ++j )
+        {
+            names += _names[j];
+            nameOffsets.push_back( names.size() );
+        }
+    }
+
+    io::BinaryHeader header;
+    std::memset( &header, 0, sizeof(header) );
+    std::memcpy( header.magic, "QCQP", 4 );
+    header.version         = io::BinaryHeader::VERSION;
+    header.vars            = n;
+    header.constraints     = m;
+    header.qoNnz           = Qo.nonZeros();
+    header.aNnz            = A.nonZeros();
+    header.quadConstraints = _quadConstrList.size();
+    header.qiNnz           = 0;
+    for ( size_t i = 0; i != _quadConstrList.size(); ++i )
+        header.qiNnz += _quadConstrList[i].size();
+    header.namesBytes      = names.size();
+    header.hasX0           = (static_cast<size_t>(_x0.rows()) == n) && n;
+    header.bias            = this->getObjectiveBias();
+    io::writeBinaryArray( f, &header, 1 );
+
+    // variables
+    io::writeBinaryArrayAs<int32_t>( f, _bkx    );
+    io::writeBinaryArrayAs<int32_t>( f, _type_x );
+    io::writeBinaryArrayAs<int32_t>( f, _lin_x  );
+    io::writeBinaryArrayAs<double> ( f, _blx    );
+    io::writeBinaryArrayAs<double> ( f, _bux    );
+    io::writeBinaryArrayAs<double> ( f, _linObjs );
+
+    // constraints
+    io::writeBinaryArrayAs<int32_t>( f, _bkc   );
+    io::writeBinaryArrayAs<int32_t>( f, _lin_c );
+    io::writeBinaryArrayAs<double> ( f, _blc   );
+    io::writeBinaryArrayAs<double> ( f, _buc   );
+
+    // Qo and A, compressed rows
+    SparseMatrix const* csrs[2] = { &Qo, &A };
+    for ( int k = 0; k != 2; ++k )
+    {
+        SparseMatrix const& mx = *csrs[k];
+        io::writeBinaryArrayAs<int64_t>( f, std::vector<int64_t>(mx.outerIndexPtr(), mx.outerIndexPtr() + mx.outerSize() + 1) );
+        io::writeBinaryArrayAs<int32_t>( f, std::vector<int32_t>(mx.innerIndexPtr(), mx.innerIndexPtr() + mx.nonZeros()) );
+        io::writeBinaryArrayAs<double> ( f, std::vector<double> (mx.valuePtr()     , mx.valuePtr()      + mx.nonZeros()) );
+    }
+
+    // Qi, triplets
+    {
+        std::vector<int64_t> offsets( 1, 0 );
+        std::vector<int32_t> rows, cols;
+        std::vector<double>  vals;
+        rows.reserve( header.qiNnz ); cols.reserve( header.qiNnz ); vals.reserve( header.qiNnz );
+        for ( size_t i = 0; i != _quadConstrList.size(); ++i )
+        {
+            for ( size_t e = 0; e != _quadConstrList[i].size(); ++e )
+            {
+                rows.push_back( _quadConstrList[i][e].row()   );
+                cols.push_back( _quadConstrList[i][e].col()   );
+                vals.push_back( _quadConstrList[i][e].value() );
+            }
+            offsets.push_back( rows.size() );
+        }
+        io::writeBinaryArray( f, offsets.data(), offsets.size() );
+        io::writeBinaryArray( f, rows   .data(), rows   .size() );
+        io::writeBinaryArray( f, cols   .data(), cols   .size() );
+        io::writeBinaryArray( f, vals   .data(), vals   .size() );
+    }
+
+    // X0
+    if ( header.hasX0 )
+        io::writeBinaryArrayAs<double>( f, std::vector<_Scalar>(_x0.data(), _x0.data() + n) );
+
+    // names
+    if ( header.namesBytes )
+    {
+        io::writeBinaryArray( f, nameOffsets.data(), nameOffsets.size() );
+        io::writeBinaryArray( f, names.data()      , names.size()       );
+    }
+
+    f.close();
+    if ( !f )
+    {
+        std::cerr << "[" << __func__ << "]: " << "could not write " << path << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "[" << __func__ << "]: " << "wrote " << n << " vars, " << m << " constraints to " << path << std::endl;
+
+    return EXIT_SUCCESS;
+} // ...OptProblem::writeBinary()
+
+template <typename _Scalar> int
+OptProblem<_Scalar>::readBinary( std::string const& path )
+{
+    if ( this->getVarCount() || this->getConstraintCount() )
+    {
+        std::cerr << "[" << __func__ << "]: " << "problem not empty, refusing to read " << path << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    int fd = open( path.c_str(), O_RDONLY );
+    if ( fd < 0 )
+    {
+        std::cerr << "[" << __func__ << "]: " << "could not open " << path << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    struct stat file_stat;
+    if ( (0 != fstat(fd, &file_stat)) || (file_stat.st_size < static_cast<off_t>(sizeof(io::BinaryHeader))) )
+    {
+        std::cerr << "[" << __func__ << "]: " << path << " is too short to be a problem" << std::endl;
+        close( fd );
+        return EXIT_FAILURE;
+    }
+
+    void* data = mmap( NULL, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    if ( MAP_FAILED == data )
+    {
+        std::cerr << "[" << __func__ << "]: " << "could not map " << path << std::endl;
+        close( fd );
+        return EXIT_FAILURE;
+    }
+
+    int err = this->_parseBinary( static_cast<char const*>(data), file_stat.st_size );
+    munmap( data, file_stat.st_size );
+    close( fd );
+
+    if ( EXIT_SUCCESS != err )
+        std::cerr << "[" << __func__ << "]: " << "could not parse " << path << std::endl;
+    else
+        std::cout << "[" << __func__ << "]: " << "read " << this->getVarCount() << " vars, " << this->getConstraintCount() << " constraints from " << path << std::endl;
+
+    return err;
+} // ...OptProblem::readBinary()
+
+template <typename _Scalar> int
+OptProblem<_Scalar>::_parseBinary( char const* data, size_t size )
+{
+    io::BinaryReader reader( data, size );
+    io::BinaryHeader const* header = reader.take<io::BinaryHeader>( 1 );
+    if ( !header || std::memcmp(header->magic, "QCQP", 4) || (header->version != io::BinaryHeader::VERSION) )
+    {
+        std::cerr << "[" << __func__ << "]: " << "not a version " << io::BinaryHeader::VERSION << " problem file" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const size_t n = header->vars, m = header->constraints, k = header->quadConstraints;
+    int32_t const* bkx         = reader.take<int32_t>( n );
+    int32_t const* type_x      = reader.take<int32_t>( n );
+    int32_t const* lin_x       = reader.take<int32_t>( n );
+    double  const* blx         = reader.take<double> ( n );
+    double  const* bux         = reader.take<double> ( n );
+    double  const* linObjs     = reader.take<double> ( n );
+    int32_t const* bkc         = reader.take<int32_t>( m );
+    int32_t const* lin_c       = reader.take<int32_t>( m );
+    double  const* blc         = reader.take<double> ( m );
+    double  const* buc         = reader.take<double> ( m );
+    int64_t const* qoRows      = reader.take<int64_t>( n + 1 );
+    int32_t const* qoCols      = reader.take<int32_t>( header->qoNnz );
+    double  const* qoVals      = reader.take<double> ( header->qoNnz );
+    int64_t const* aRows       = reader.take<int64_t>( m + 1 );
+    int32_t const* aCols       = reader.take<int32_t>( header->aNnz );
+    double  const* aVals       = reader.take<double> ( header->aNnz );
+    int64_t const* qiOffsets   = reader.take<int64_t>( k + 1 );
+    int32_t const* qiRows      = reader.take<int32_t>( header->qiNnz );
+    int32_t const* qiCols      = reader.take<int32_t>( header->qiNnz );
+    double  const* qiVals      = reader.take<double> ( header->qiNnz );
+    double  const* x0          = header->hasX0      ? reader.take<double> ( n )                  : NULL;
+    int64_t const* nameOffsets = header->namesBytes ? reader.take<int64_t>( n + 1 )              : NULL;
+    char    const* names       = header->namesBytes ? reader.take<char>   ( header->namesBytes ) : NULL;
+    if ( !reader.good() )
+    {
+        std::cerr << "[" << __func__ << "]: " << "file is truncated" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // offsets have to ascend within their arrays, and indices to be in range
+    bool valid = (qoRows[0] == 0) && (qoRows[n] == static_cast<int64_t>(header->qoNnz))
+              && (aRows [0] == 0) && (aRows [m] == static_cast<int64_t>(header->aNnz ))
+              && (qiOffsets[0] == 0) && (qiOffsets[k] == static_cast<int64_t>(header->qiNnz))
+              && (k <= m);
+    for ( size_t j = 0; valid && (j != n); ++j ) valid &= qoRows   [j] <= qoRows   [j+1];
+    for ( size_t i = 0; valid && (i != m); ++i ) valid &= aRows    [i] <= aRows    [i+1];
+    for ( size_t i = 0; valid && (i != k); ++i ) valid &= qiOffsets[i] <= qiOffsets[i+1];
+    for ( size_t e = 0; valid && (e != header->qoNnz); ++e ) valid &= (qoCols[e] >= 0) && (static_cast<size_t>(qoCols[e]) < n);
+    for ( size_t e = 0; valid && (e != header->aNnz ); ++e ) valid &= (aCols [e] >= 0) && (static_cast<size_t>(aCols [e]) < n);
+    for ( size_t e = 0; valid && (e != header->qiNnz); ++e ) valid &= (qiRows[e] >= 0) && (static_cast<size_t>(qiRows[e]) < n) && (qiCols[e] >= 0) && (static_cast<size_t>(qiCols[e]) < n);
+    if ( names )
+    {
+        valid &= (nameOffsets[0] == 0) && (nameOffsets[n] == static_cast<int64_t>(header->namesBytes));
+        for ( size_t j = 0; valid && (j != n); ++j ) valid &= nameOffsets[j] <= nameOffsets[j+1];
+    }
+    if ( !valid )
+    {
+        std::cerr << "[" << __func__ << "]: " << "inconsistent offsets or indices" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // variables
+    _bkx.resize( n ); _type_x.resize( n ); _lin_x.resize( n ); _blx.resize( n ); _bux.resize( n ); _linObjs.resize( n ); _names.resize( n );
+    for ( size_t j = 0; j != n; ++j )
+    {
+        _bkx    [j] = static_cast<BOUND>    ( bkx[j]    );
+        _type_x [j] = static_cast<VAR_TYPE> ( type_x[j] );
+        _lin_x  [j] = static_cast<LINEARITY>( lin_x[j]  );
+        _blx    [j] = blx[j];
+        _bux    [j] = bux[j];
+        _linObjs[j] = linObjs[j];
+        if ( names )
+            _names[j].assign( names + nameOffsets[j], names + nameOffsets[j+1] );
+    }
+    _cfix = header->bias;
+
+    // constraints
+    _bkc.resize( m ); _lin_c.resize( m ); _blc.resize( m ); _buc.resize( m );
+    for ( size_t i = 0; i != m; ++i )
+    {
+        _bkc  [i] = static_cast<BOUND>    ( bkc[i]   );
+        _lin_c[i] = static_cast<LINEARITY>( lin_c[i] );
+        _blc  [i] = blc[i];
+        _buc  [i] = buc[i];
+    }
+
+    // Qo, A
+    _quadObjList.reserve( header->qoNnz );
+    for ( size_t j = 0; j != n; ++j )
+        for ( int64_t e = qoRows[j]; e != qoRows[j+1]; ++e )
+            _quadObjList.push_back( SparseEntry(j, qoCols[e], qoVals[e]) );
+    _linConstrList.reserve( header->aNnz );
+    for ( size_t i = 0; i != m; ++i )
+        for ( int64_t e = aRows[i]; e != aRows[i+1]; ++e )
+            _linConstrList.push_back( SparseEntry(i, aCols[e], aVals[e]) );
+
+    // Qi
+    _quadConstrList.resize( k );
+    for ( size_t i = 0; i != k; ++i )
+    {
+        _quadConstrList[i].reserve( qiOffsets[i+1] - qiOffsets[i] );
+        for ( int64_t e = qiOffsets[i]; e != qiOffsets[i+1]; ++e )
+            _quadConstrList[i].push_back( SparseEntry(qiRows[e], qiCols[e], qiVals[e]) );
+    }
+
+    // X0, as read() does, only if it has entries
+    if ( x0 )
+    {
+        VectorX x0_vector( n );
+        for ( size_t j = 0; j != n; ++j )
+            x0_vector( j ) = x0[j];
+        if ( (x0_vector.array() != _Scalar(0)).any() )
+            this->setStartingPointDense( x0_vector );
+    }
+
+    _updated = false;
+
+    return EXIT_SUCCESS;
+} // ...OptProblem::_parseBinary()
+
+//______________________________________________________________________________
+
+namespace io
+{
+    //! \brief Appends " + |coeff| name", or " - |coeff| name", the first term of an expression (\p termCount 0) without the " + ". Breaks the line every 8 terms, LP lines are limited.
+    inline void writeLpTerm( std::ostream & f, double const coeff, std::string const& name, int & termCount )
+    {
+        if ( termCount && !(termCount % 8) )
+            f << "\n   ";
+        if ( termCount )    f << (coeff < 0. ? " - " : " + ");
+        else if ( coeff < 0. ) f << "-";
+        f << std::abs( coeff ) << " " << name;
+        ++termCount;
+    } //...writeLpTerm()
+} //...ns io
+
+template <typename _Scalar> int
+OptProblem<_Scalar>::writeMps( std::string const& path ) const
+{
+    typedef Eigen::SparseMatrix<_Scalar,Eigen::ColMajor> ColMatrix;
+
+    std::ofstream f( path );
+    if ( !f.is_open() )
+    {
+        std::cerr << "[" << __func__ << "]: " << "could not open " << path << std::endl;
+        return EXIT_FAILURE;
+    }
+    f << std::setprecision( 17 );
+
+    const size_t n = this->getVarCount(), m = this->getConstraintCount();
+    const ColMatrix A( this->getLinConstraintsMatrix() );
+
+    // rows
+    f << "NAME qcqpcpp\n" << "ROWS\n" << " N obj\n";
+    for ( size_t i = 0; i != m; ++i )
+    {
+        char type = 'N';
+        switch ( _bkc[i] )
+        {
+            case GREATER_EQ: type = 'G'; break;
+            case LESS_EQ:    type = 'L'; break;
+            case EQUAL:      type = 'E'; break;
+            case RANGE:      type = (_blc[i] == _buc[i]) ? 'E' : 'G'; break;
+            default:         type = 'N'; break;
+        }
+        f << " " << type << " c" << i << "\n";
+    }
+
+    // columns, integers between markers
+    f << "COLUMNS\n";
+    bool integer = false;
+    for ( size_t j = 0; j != n; ++j )
+    {
+        if ( (_type_x[j] != CONTINUOUS) != integer )
+        {
+            integer = !integer;
+            f << " MARKER 'MARKER' " << (integer ? "'INTORG'" : "'INTEND'") << "\n";
+        }
+
+        // every column once, even if empty
+        if ( (_linObjs[j] != _Scalar(0)) || !A.col(j).nonZeros() )
+            f << " x" << j << " obj " << _linObjs[j] << "\n";
+        for ( typename ColMatrix::InnerIterator it(A, j); it; ++it )
+            f << " x" << j << " c" << it.row() << " " << it.value() << "\n";
+    }
+    if ( integer )
+        f << " MARKER 'MARKER' 'INTEND'\n";
+
+    // right hand sides, the objective constant is the negative of the objective's
+    f << "RHS\n";
+    if ( this->getObjectiveBias() != _Scalar(0) )
+        f << " rhs obj " << -this->getObjectiveBias() << "\n";
+    for ( size_t i = 0; i != m; ++i )
+    {
+        const _Scalar rhs = (_bkc[i] == LESS_EQ) ? _buc[i] : _blc[i];
+        if ( (_bkc[i] != FREE) && (rhs != _Scalar(0)) )
+            f << " rhs c" << i << " " << rhs << "\n";
+    }
+
+    // ranges of G rows reach up from the rhs
+    f << "RANGES\n";
+    for ( size_t i = 0; i != m; ++i )
+        if ( (_bkc[i] == RANGE) && (_blc[i] != _buc[i]) )
+            f << " rng c" << i << " " << _buc[i] - _blc[i] << "\n";
+
+    // bounds, all explicit, since MPS defaults to [0,inf)
+    f << "BOUNDS\n";
+    for ( size_t j = 0; j != n; ++j )
+    {
+        if ( _type_x[j] == BINARY )
+        {
+            f << " BV bnd x" << j << "\n";
+            continue;
+        }
+
+        switch ( _bkx[j] )
+        {
+            case FREE:       f << " FR bnd x" << j << "\n"; break;
+            case GREATER_EQ: f << " LO bnd x" << j << " " << _blx[j] << "\n" << " PL bnd x" << j << "\n"; break;
+            case LESS_EQ:    f << " MI bnd x" << j << "\n" << " UP bnd x" << j << " " << _bux[j] << "\n"; break;
+            case EQUAL:      f << " FX bnd x" << j << " " << _blx[j] << "\n"; break;
+            default:         f << " LO bnd x" << j << " " << _blx[j] << "\n" << " UP bnd x" << j << " " << _bux[j] << "\n"; break;
+        }
+    }
+
+    // objective 1/2 x'Qx, lower triangle of Q = Qo + Qo', as the Hessian
+    {
+        const SparseMatrix Qo  = this->getQuadraticObjectivesMatrix();
+        const SparseMatrix QoT = Qo.transpose();
+        const SparseMatrix H   = Qo + QoT;
+        if ( H.nonZeros() )
+        {
+            f << "QUADOBJ\n";
+            for ( int row = 0; row != H.outerSize(); ++row )
+                for ( typename SparseMatrix::InnerIterator it(H, row); it; ++it )
+                    if ( it.col() <= row )
+                        f << " x" << it.col() << " x" << row << " " << it.value() << "\n";
+        }
+    }
+
+    // constraints x'Sx, full symmetric S = (Qi + Qi') / 2
+    for ( size_t i = 0; i != _quadConstrList.size(); ++i )
+    {
+        const SparseMatrix Qi  = this->getQuadraticConstraintsMatrix( i );
+        const SparseMatrix QiT = Qi.transpose();
+        const SparseMatrix S   = (Qi + QiT) * _Scalar(.5);
+        if ( !S.nonZeros() )
+            continue;
+
+        f << "QCMATRIX c" << i << "\n";
+        for ( int row = 0; row != S.outerSize(); ++row )
+            for ( typename SparseMatrix::InnerIterator it(S, row); it; ++it )
+                f << " x" << row << " x" << it.col() << " " << it.value() << "\n";
+    }
+
+    f << "ENDATA\n";
+    f.close();
+    std::cout << "[" << __func__ << "]: " << "wrote " << path << std::endl;
+
+    return EXIT_SUCCESS;
+} // ...OptProblem::writeMps()
+
+template <typename _Scalar> int
+OptProblem<_Scalar>::writeLp( std::string const& path ) const
+{
+    std::ofstream f( path );
+    if ( !f.is_open() )
+    {
+        std::cerr << "[" << __func__ << "]: " << "could not open " << path << std::endl;
+        return EXIT_FAILURE;
+    }
+    f << std::setprecision( 17 );
+
+    const size_t n = this->getVarCount(), m = this->getConstraintCount();
+    std::vector<std::string> vars( n );
+    for ( size_t j = 0; j != n; ++j )
+    {
+        std::ostringstream name; name << "x" << j;
+        vars[j] = name.str();
+    }
+
+    // objective, quadratic part as [ x'Qx ] / 2, with x_i * x_j coefficients Q_ij + Q_ji
+    f << "\\ qcqpcpp problem, " << n << " vars, " << m << " constraints\n" << "Minimize\n" << " obj: ";
+    int termCount = 0;
+    for ( size_t j = 0; j != n; ++j )
+        if ( _linObjs[j] != _Scalar(0) )
+            io::writeLpTerm( f, _linObjs[j], vars[j], termCount );
+    {
+        const SparseMatrix Qo  = this->getQuadraticObjectivesMatrix();
+        const SparseMatrix QoT = Qo.transpose();
+        const SparseMatrix H   = Qo + QoT;
+        if ( H.nonZeros() )
+        {
+            f << (termCount ? " + [ " : "[ ");
+            int quadCount = 0;
+            for ( int row = 0; row != H.outerSize(); ++row )
+                for ( typename SparseMatrix::InnerIterator it(H, row); it; ++it )
+                    if ( it.col() == row )      io::writeLpTerm( f, it.value()     , vars[row] + " ^ 2"                 , quadCount );
+                    else if ( it.col() < row )  io::writeLpTerm( f, 2. * it.value(), vars[it.col()] + " * " + vars[row], quadCount );
+            f << " ] / 2";
+            termCount += quadCount;
+        }
+    }
+    if ( this->getObjectiveBias() != _Scalar(0) )
+        io::writeLpTerm( f, this->getObjectiveBias(), "", termCount );
+    if ( !termCount && n )
+        f << "0 " << vars[0];
+    f << "\n";
+
+    // constraints, lhs is A(i,:) x + [ x'Qi x ]
+    f << "Subject To\n";
+    const SparseMatrix A = this->getLinConstraintsMatrix();
+    for ( size_t i = 0; i != m; ++i )
+    {
+        std::ostringstream lhs;
+        lhs << std::setprecision( 17 );
+        int lhsCount = 0;
+        for ( typename SparseMatrix::InnerIterator it(A, i); it; ++it )
+            io::writeLpTerm( lhs, it.value(), vars[it.col()], lhsCount );
+        if ( i < _quadConstrList.size() )
+        {
+            const SparseMatrix Qi  = this->getQuadraticConstraintsMatrix( i );
+            const SparseMatrix QiT = Qi.transpose();
+            const SparseMatrix S   = Qi + QiT;
+            if ( S.nonZeros() )
+            {
+                lhs << (lhsCount ? " + [ " : "[ ");
+                int quadCount = 0;
+                for ( int row = 0; row != S.outerSize(); ++row )
+                    for ( typename SparseMatrix::InnerIterator it(S, row); it; ++it )
+                        if ( it.col() == row )      io::writeLpTerm( lhs, it.value() / 2., vars[row] + " ^ 2"                 , quadCount );
+                        else if ( it.col() < row )  io::writeLpTerm( lhs, it.value()     , vars[it.col()] + " * " + vars[row], quadCount );
+                lhs << " ]";
+                lhsCount += quadCount;
+            }
+        }
+        if ( !lhsCount && n )
+            lhs << "0 " << vars[0];
+
+        switch ( _bkc[i] )
+        {
+            case GREATER_EQ: f << " c" << i << ": " << lhs.str() << " >= " << _blc[i] << "\n"; break;
+            case LESS_EQ:    f << " c" << i << ": " << lhs.str() << " <= " << _buc[i] << "\n"; break;
+            case EQUAL:      f << " c" << i << ": " << lhs.str() << " = "  << _blc[i] << "\n"; break;
+            case RANGE:
+                if ( _blc[i] == _buc[i] )
+                    f << " c" << i << ": " << lhs.str() << " = " << _blc[i] << "\n";
+                else
+                    f << " c" << i << "_lo: " << lhs.str() << " >= " << _blc[i] << "\n"
+                      << " c" << i << "_up: " << lhs.str() << " <= " << _buc[i] << "\n";
+                break;
+            default:         f << "\\ c" << i << " is free\n"; break;
+        }
+    }
+
+    // bounds, LP defaults to [0,inf) as well
+    f << "Bounds\n";
+    for ( size_t j = 0; j != n; ++j )
+    {
+        if ( _type_x[j] == BINARY )
+            continue;
+        switch ( _bkx[j] )
+        {
+            case FREE:       f << " " << vars[j] << " free\n"; break;
+            case GREATER_EQ: f << " " << vars[j] << " >= " << _blx[j] << "\n"; break;
+            case LESS_EQ:    f << " -inf <= " << vars[j] << " <= " << _bux[j] << "\n"; break;
+            case EQUAL:      f << " " << vars[j] << " = " << _blx[j] << "\n"; break;
+            default:         f << " " << _blx[j] << " <= " << vars[j] << " <= " << _bux[j] << "\n"; break;
+        }
+    }
+
+    // integrality
+    for ( int type = BINARY; type >= INTEGER; --type )
+    {
+        int typeCount = 0;
+        for ( size_t j = 0; j != n; ++j )
+        {
+            if ( _type_x[j] != type )
+                continue;
+            if ( !typeCount )
+                f << (type == BINARY ? "Binaries\n" : "Generals\n");
+            f << " " << vars[j] << ((++typeCount % 8) ? "" : "\n");
+        }
+        if ( typeCount % 8 )
+            f << "\n";
+    }
+
+    f << "End\n";
+    f.close();
+    std::cout << "[" << __func__ << "]: " << "wrote " << path << std::endl;
+
+    return EXIT_SUCCESS;
+} // ...OptProblem::writeLp()
+
+} // ...namespace qcqpcpp
+
+#endif // QCQPCPP_OPTPROBLEMIO_HPP
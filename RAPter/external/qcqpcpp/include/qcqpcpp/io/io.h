@@ -3,6 +3,8 @@
 
 #include <fstream>
 #include <iomanip>
+#include <vector>
+#include <cstdint>   // int32_t, int64_t, uint64_t
 
 #include "Eigen/Sparse"
 
@@ -102,6 +104,71 @@ writeSparseMatrix( Eigen::SparseMatrix<Scalar,Eigen::RowMajor> const& mx, std::s
     return EXIT_SUCCESS;
 } //... writeSparseMatrix
 
+//! \brief Header of the binary problem container, see OptProblem::writeBinary(). Followed by 8 byte aligned arrays.
+struct BinaryHeader
+{
+    static const uint32_t VERSION = 1;
+
+    char     magic[4];          //!< \brief "QCQP".
+    uint32_t version;           //!< \brief #VERSION.
+    uint64_t vars;              //!< \brief Variable count, n.
+    uint64_t constraints;       //!< \brief Constraint count, m.
+    uint64_t qoNnz;             //!< \brief Entries of the quadratic objective, stored as compressed rows.
+    uint64_t aNnz;              //!< \brief Entries of the linear constraints, stored as compressed rows.
+    uint64_t quadConstraints;   //!< \brief Count of quadratic constraint matrices.
+    uint64_t qiNnz;             //!< \brief Entries of all quadratic constraint matrices, stored as triplets.
+    uint64_t namesBytes;        //!< \brief Length of the concatenated variable names, 0, if there are none.
+    uint64_t hasX0;             //!< \brief 1, if a starting point is stored.
+    double   bias;              //!< \brief Objective bias.
+}; //...struct BinaryHeader
+
+//! \brief Writes \p count elements of \p data to \p f, and zeros up to the next 8 byte boundary, as BinaryReader::take() expects.
+template <typename T> inline void
+writeBinaryArray( std::ofstream & f, T const* data, size_t count )
+{
+    static const char zeros[8] = { 0 };
+    f.write( reinterpret_cast<char const*>(data), count * sizeof(T) );
+    if ( (count * sizeof(T)) % 8 )
+        f.write( zeros, 8 - (count * sizeof(T)) % 8 );
+} //...writeBinaryArray
+
+//! \brief Converts \p values to \p _OutT, and writes them with writeBinaryArray().
+template <typename _OutT, typename _InT> inline void
+writeBinaryArrayAs( std::ofstream & f, std::vector<_InT> const& values )
+{
+    std::vector<_OutT> out( values.size() );
+    for ( size_t i = 0; i != values.size(); ++i )
+        out[i] = static_cast<_OutT>( values[i] );
+    writeBinaryArray( f, out.data(), out.size() );
+} //...writeBinaryArrayAs
+
+//! \brief Cursor over a memory mapped file written by writeBinaryArray(), hands out pointers into the mapping without copying.
+class BinaryReader
+{
+    public:
+        BinaryReader( char const* data, size_t size ) : _pos( data ), _end( data + size ) {}
+
+        //! \brief Returns the next \p count elements, and skips their padding. NULL from here on, if the file is too short.
+        template <typename T> inline T const* take( size_t count )
+        {
+            if ( !_pos || (count > size_t(_end - _pos) / sizeof(T)) || ((count * sizeof(T) + 7) / 8 * 8 > size_t(_end - _pos)) )
+            {
+                _pos = NULL;
+                return NULL;
+            }
+            T const* data = reinterpret_cast<T const*>( _pos );
+            _pos += (count * sizeof(T) + 7) / 8 * 8;
+            return data;
+        } //...take()
+
+        //! \brief False, if a take() ran over the end.
+        inline bool good() const { return _pos != NULL; }
+
+    protected:
+        char const* _pos;   //!< \brief Next array.
+        char const* _end;   //!< \brief End of the mapping.
+}; //...class BinaryReader
+
 } //...namespace io
 } //...namespace qcqpcpp
 
@@ -0,0 +1,472 @@
+#ifndef QCQPCPP_LOCALSEARCHOPT_H
+#define QCQPCPP_LOCALSEARCHOPT_H
+
+#include <algorithm> // sort, shuffle
+#include <chrono>
+#include <cmath>     // ceil, floor
+#include <limits>
+#include <random>
+#include <vector>
+#include "qcqpcpp/optProblem.h"
+
+namespace qcqpcpp
+{
+
+//! \brief Dependency-free heuristic for binary problems with a quadratic objective and linear or quadratic constraints.
+//!        Minimizes objective + penalty * constraint violation by greedy 1-flip descent, 2-flip local search and random perturbations.
+//!        Restarts are independent and run in parallel. There is no optimality proof, the output is the best feasible point found.
+template <typename _Scalar>
+class LocalSearchOpt : public qcqpcpp::OptProblem<_Scalar>
+{
+    public:
+        typedef typename qcqpcpp::OptProblem<_Scalar>               ParentType;
+        typedef typename ParentType::VectorX                        VectorX;
+        typedef typename ParentType::SparseEntries                  SparseEntries;
+
+        //! \brief LocalSearchOpt   Default constructor.
+        LocalSearchOpt()
+            : _restarts ( 8 )
+            , _threads  ( 1 )
+            , _maxRounds( 100 )
+            , _seed     ( 0 )
+            , _penalty  ( _Scalar(1) )
+            , _objective( std::numeric_limits<_Scalar>::max() )
+        {}
+
+        //! \brief ~LocalSearchOpt  virtual destructor.
+        virtual ~LocalSearchOpt() {}
+
+        /** \name Functions from OptProblem. */
+        //@{
+        //! \brief update               Builds the per-variable adjacency of the objective and the constraints.
+        //! \param verbose              Controls logging to console.
+        //! \return                     EXIT_SUCCESS, EXIT_FAILURE, if a variable is not binary.
+        virtual int update( bool verbose = false  );
+
+        //! \brief optimize             Runs the restarts until they converge or the time limit is hit. Please call update before.
+        //! \param x_out                Output values, only written, if a feasible point was found.
+        //! \param objective_sense      Minimization or Maximization.
+        //! \return                     getOkCode(), or EXIT_FAILURE, if no feasible point was found.
+        virtual int optimize( std::vector<_Scalar> *x_out /* = NULL */, typename ParentType::OBJ_SENSE objecitve_sense /* = OBJ_SENSE::MINIMIZE */ );
+
+        virtual _Scalar getINF   () const override { return std::numeric_limits<_Scalar>::max(); }
+        virtual int     getOkCode() const override { return 0; }
+        //@}
+
+        //! \brief Number of independent restarts, the first one starts from the starting point, if set.
+        inline void     setRestarts ( int restarts )       { _restarts = restarts; }
+        //! \brief Number of restarts run in parallel.
+        inline void     setThreads  ( int threads )        { _threads = threads; }
+        //! \brief Perturbations without improvement, after which a restart stops.
+        inline void     setMaxRounds( int maxRounds )      { _maxRounds = maxRounds; }
+        inline void     setSeed     ( unsigned seed )      { _seed = seed; }
+        //! \brief Objective of the last optimize() output, max(), if none was found.
+        inline _Scalar  getObjective()               const { return _objective; }
+
+    protected:
+        //! \brief Off-diagonal objective entry, symmetrized: weight of x_j * x_var.
+        struct Neighbour
+        {
+            int     var;
+            _Scalar coeff;
+        };
+
+        //! \brief Constraint entry of variable j. other < 0: linear coefficient, other == j: diagonal, else coeff * x_j * x_other.
+        struct ConstrTerm
+        {
+            int     constr;
+            int     other;
+            _Scalar coeff;
+        };
+
+        class State;
+
+        //! \brief Violation of constraint \p i at value \p c.
+        inline _Scalar violation( int const i, _Scalar const c ) const;
+
+        std::vector<_Scalar>                    _lin;         //!< \brief Linear objective plus the objective diagonal.
+        std::vector< std::vector<Neighbour> >   _neighs;      //!< \brief Off-diagonal objective entries, both directions.
+        std::vector< std::vector<ConstrTerm> >  _constrTerms; //!< \brief Constraint entries per variable, sorted by constraint.
+        std::vector< std::vector<int> >         _constrVars;  //!< \brief Variables per constraint, candidates for 2-swaps.
+        std::vector<signed char>                _fixed;       //!< \brief -1: free, 0 or 1: fixed by the bounds.
+
+        int                                     _restarts;
+        int                                     _threads;
+        int                                     _maxRounds;
+        unsigned                                _seed;
+        _Scalar                                 _penalty;     //!< \brief Exceeds the objective's range, so that any feasible point beats unit violations.
+        _Scalar                                 _objective;   //!< \brief Objective of the last output.
+}; //...class LocalSearchOpt
+
+//! \brief Assignment with incrementally maintained objective gradient and constraint values.
+template <typename _Scalar>
+class LocalSearchOpt<_Scalar>::State
+{
+    public:
+        State( LocalSearchOpt<_Scalar> const& owner, _Scalar const sense )
+            : _owner    ( &owner )
+            , _sense    ( sense )
+            , x         ( owner._lin.size(), 0 )
+            , field     ( owner._lin )
+            , c         ( owner.getConstraintCount(), _Scalar(0) )
+            , objective ( _Scalar(0) )
+            , violation ( _Scalar(0) )
+        {
+            for ( size_t i = 0; i != c.size(); ++i )
+                violation += _owner->violation( i, c[i] );
+        }
+
+        //! \brief Penalized energy change, if x_j was flipped.
+        inline _Scalar delta( int const j ) const
+        {
+            const _Scalar d  = x[j] ? _Scalar(-1) : _Scalar(1);
+            _Scalar       dv = _Scalar(0);
+            std::vector<ConstrTerm> const& terms = _owner->_constrTerms[j];
+            for ( size_t t = 0; t != terms.size(); )
+            {
+                const int i  = terms[t].constr;
+                _Scalar   dc = _Scalar(0);
+                for ( ; (t != terms.size()) && (terms[t].constr == i); ++t )
+                    dc += coeff( j, terms[t] );
+                dv += _owner->violation( i, c[i] + d * dc ) - _owner->violation( i, c[i] );
+            }
+
+            return _sense * d * field[j] + _owner->_penalty * dv;
+        }
+
+        //! \brief Flips x_j and updates the gradient and the constraint values.
+        inline void flip( int const j )
+        {
+            const _Scalar d = x[j] ? _Scalar(-1) : _Scalar(1);
+            objective += d * field[j];
+
+            std::vector<ConstrTerm> const& terms = _owner->_constrTerms[j];
+            for ( size_t t = 0; t != terms.size(); )
+            {
+                const int i  = terms[t].constr;
+                _Scalar   dc = _Scalar(0);
+                for ( ; (t != terms.size()) && (terms[t].constr == i); ++t )
+                    dc += coeff( j, terms[t] );
+                violation -= _owner->violation( i, c[i] );
+                c[i]      += d * dc;
+                violation += _owner->violation( i, c[i] );
+            }
+
+            std::vector<Neighbour> const& neighs = _owner->_neighs[j];
+            for ( size_t k = 0; k != neighs.size(); ++k )
+                field[ neighs[k].var ] += d * neighs[k].coeff;
+
+            x[j] = !x[j];
+        }
+
+        inline _Scalar energy()   const { return _sense * objective + _owner->_penalty * violation; }
+        inline bool    feasible() const { return violation <= _Scalar(1e-6); }
+
+    protected:
+        inline _Scalar coeff( int const j, ConstrTerm const& term ) const
+        {
+            return ((term.other < 0) || (term.other == j)) ? term.coeff : term.coeff * x[term.other];
+        }
+
+        LocalSearchOpt<_Scalar> const* _owner;
+        _Scalar                        _sense;     //!< \brief -1, if maximizing.
+
+    public:
+        std::vector<char>              x;
+        std::vector<_Scalar>           field;      //!< \brief Objective change per unit increase of x_j.
+        std::vector<_Scalar>           c;          //!< \brief Constraint values A x + x' Q_i x.
+        _Scalar                        objective;  //!< \brief x' Q_o x + q_o' x.
+        _Scalar                        violation;  //!< \brief Sum of constraint violations.
+}; //...class LocalSearchOpt::State
+
+template <typename _Scalar> _Scalar
+LocalSearchOpt<_Scalar>::violation( int const i, _Scalar const c ) const
+{
+    typedef typename ParentType::BOUND BOUND;
+    const BOUND bound = this->getConstraintBoundType( i );
+    if ( ((bound == BOUND::GREATER_EQ) || (bound == BOUND::RANGE) || (bound == BOUND::EQUAL)) && (c < this->getConstraintLowerBound(i)) )
+        return this->getConstraintLowerBound(i) - c;
+    if ( ((bound == BOUND::LESS_EQ   ) || (bound == BOUND::RANGE) || (bound == BOUND::EQUAL)) && (c > this->getConstraintUpperBound(i)) )
+        return c - this->getConstraintUpperBound(i);
+    return _Scalar(0);
+}
+
+template <typename _Scalar> int
+LocalSearchOpt<_Scalar>::update( bool verbose /* = false */ )
+{
+    typedef typename ParentType::BOUND    BOUND;
+    typedef typename ParentType::VAR_TYPE VAR_TYPE;
+
+    const int n = this->getVarCount();
+
+    // variables have to be binary, possibly fixed by their bounds
+    _fixed.assign( n, -1 );
+    for ( int j = 0; j != n; ++j )
+    {
+        const BOUND bound = this->getVarBoundType( j );
+        _Scalar lo = ((bound == BOUND::GREATER_EQ) || (bound == BOUND::RANGE) || (bound == BOUND::EQUAL)) ? std::ceil ( this->getVarLowerBound(j) ) : -this->getINF();
+        _Scalar hi = ((bound == BOUND::LESS_EQ   ) || (bound == BOUND::RANGE) || (bound == BOUND::EQUAL)) ? std::floor( this->getVarUpperBound(j) ) :  this->getINF();
+        if ( this->getVarType(j) == VAR_TYPE::BINARY )
+        {
+            lo = std::max( lo, _Scalar(0) );
+            hi = std::min( hi, _Scalar(1) );
+        }
+
+        if ( (this->getVarType(j) == VAR_TYPE::CONTINUOUS) || (lo < _Scalar(0)) || (hi > _Scalar(1)) || (lo > hi) )
+        {
+            std::cerr << "[" << __func__ << "]: " << "variable " << j << " is not binary, the local search can't handle it" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if ( lo == hi )
+            _fixed[j] = static_cast<signed char>( lo );
+    }
+
+    // objective: diagonal goes to the linear part, since x_j * x_j == x_j
+    _lin.assign( n, _Scalar(0) );
+    std::vector<_Scalar> const& qo = this->getLinObjectives();
+    for ( size_t j = 0; j != qo.size(); ++j )
+        _lin[j] = qo[j];
+
+    _penalty = _Scalar(1);
+    for ( size_t j = 0; j != qo.size(); ++j )
+        _penalty += std::abs( qo[j] );
+
+    _neighs.assign( n, std::vector<Neighbour>() );
+    SparseEntries const& Qo = this->getQuadraticObjectives();
+    for ( typename SparseEntries::const_iterator it = Qo.begin(); it != Qo.end(); ++it )
+    {
+        _penalty += std::abs( it->value() );
+        if ( it->row() == it->col() )
+            _lin[ it->row() ] += it->value();
+        else
+        {
+            _neighs[ it->row() ].push_back( Neighbour{it->col(), it->value()} );
+            _neighs[ it->col() ].push_back( Neighbour{it->row(), it->value()} );
+        }
+    }
+
+    // sum duplicates
+    for ( int j = 0; j != n; ++j )
+    {
+        std::vector<Neighbour> &neighs = _neighs[j];
+        std::sort( neighs.begin(), neighs.end(), [](Neighbour const& a, Neighbour const& b) { return a.var < b.var; } );
+        size_t out = 0;
+        for ( size_t k = 0; k != neighs.size(); ++k )
+        {
+            if ( out && (neighs[out-1].var == neighs[k].var) )
+                neighs[out-1].coeff += neighs[k].coeff;
+            else
+                neighs[out++] = neighs[k];
+        }
+        neighs.resize( out );
+    }
+
+    // constraints
+    const int m = this->getConstraintCount();
+    _constrTerms.assign( n, std::vector<ConstrTerm>() );
+    _constrVars .assign( m, std::vector<int>() );
+    SparseEntries const& A = this->getLinConstraints();
+    for ( typename SparseEntries::const_iterator it = A.begin(); it != A.end(); ++it )
+    {
+        _constrTerms[ it->col() ].push_back( ConstrTerm{it->row(), -1, it->value()} );
+        _constrVars [ it->row() ].push_back( it->col() );
+    }
+    for ( int i = 0; i < std::min(m, int(this->getQuadraticConstraints().size())); ++i )
+    {
+        SparseEntries const& Qi = this->getQuadraticConstraints( i );
+        for ( typename SparseEntries::const_iterator it = Qi.begin(); it != Qi.end(); ++it )
+        {
+            _constrTerms[ it->row() ].push_back( ConstrTerm{i, it->col(), it->value()} );
+            _constrVars [ i         ].push_back( it->row() );
+            if ( it->row() != it->col() )
+            {
+                _constrTerms[ it->col() ].push_back( ConstrTerm{i, it->row(), it->value()} );
+                _constrVars [ i         ].push_back( it->col() );
+            }
+        }
+    }
+
+    for ( int j = 0; j != n; ++j )
+        std::stable_sort( _constrTerms[j].begin(), _constrTerms[j].end(), [](ConstrTerm const& a, ConstrTerm const& b) { return a.constr < b.constr; } );
+    for ( int i = 0; i != m; ++i )
+    {
+        std::sort( _constrVars[i].begin(), _constrVars[i].end() );
+        _constrVars[i].erase( std::unique(_constrVars[i].begin(), _constrVars[i].end()), _constrVars[i].end() );
+    }
+
+    if ( verbose )
+        std::cout << "[" << __func__ << "]: " << n << " variables, " << m << " constraints, penalty " << _penalty << std::endl;
+
+    this->_updated = true;
+    return EXIT_SUCCESS;
+} //...LocalSearchOpt::update()
+
+template <typename _Scalar> int
+LocalSearchOpt<_Scalar>::optimize( std::vector<_Scalar> *x_out /* = NULL */, typename ParentType::OBJ_SENSE objective_sense /* = MINIMIZE */ )
+{
+    typedef std::chrono::system_clock Clock;
+
+    if ( !this->_updated )
+    {
+        std::cerr << "[" << __func__ << "]: " << "Please call update() first!" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const int          n        = _lin.size();
+    const _Scalar      sense    = (objective_sense == ParentType::OBJ_SENSE::MAXIMIZE) ? _Scalar(-1) : _Scalar(1);
+    const _Scalar      eps      = _Scalar(1e-12) * _penalty;
+    const bool         limited  = this->getTimeLimit() > _Scalar(0);
+    const Clock::time_point start    = Clock::now();
+    const Clock::time_point deadline = start + std::chrono::microseconds( static_cast<long long>(limited ? this->getTimeLimit() * 1e6 : 0.) );
+    auto timeout = [&]() { return limited && (Clock::now() > deadline); };
+
+    // 1-flip descent in the given order, until no flip improves
+    auto descend = [&]( State &state, std::vector<int> const& order )
+    {
+        bool improved = true;
+        while ( improved && !timeout() )
+        {
+            improved = false;
+            for ( size_t k = 0; k != order.size(); ++k )
+                if ( state.delta(order[k]) < -eps )
+                {
+                    state.flip( order[k] );
+                    improved = true;
+                }
+        }
+    };
+
+    // 2-flip pass: flips a variable together with one sharing a constraint or an objective term with it, if that improves.
+    // Covers swaps within a constraint, and switching a variable on together with what its constraints need.
+    auto pairs = [&]( State &state )
+    {
+        int flips = 0;
+        for ( int j = 0; (j != n) && !timeout(); ++j )
+        {
+            if ( _fixed[j] >= 0 )
+                continue;
+
+            const _Scalar d0 = state.delta( j );
+            state.flip( j );
+            int other = -1;
+            for ( size_t t = 0; (t != _constrTerms[j].size()) && (other < 0); ++t )
+            {
+                if ( t && (_constrTerms[j][t].constr == _constrTerms[j][t-1].constr) )
+                    continue;
+                std::vector<int> const& vars = _constrVars[ _constrTerms[j][t].constr ];
+                for ( size_t v = 0; (v != vars.size()) && (other < 0); ++v )
+                    if ( (vars[v] != j) && (_fixed[vars[v]] < 0) && (d0 + state.delta(vars[v]) < -eps) )
+                        other = vars[v];
+            }
+            for ( size_t k = 0; (k != _neighs[j].size()) && (other < 0); ++k )
+            {
+                const int var = _neighs[j][k].var;
+                if ( (_fixed[var] < 0) && (d0 + state.delta(var) < -eps) )
+                    other = var;
+            }
+
+            if ( other < 0 )
+                state.flip( j );
+            else
+            {
+                state.flip( other );
+                ++flips;
+            }
+        }
+        return flips;
+    };
+
+    // free variables, cheapest first for the greedy restart
+    std::vector<int> freeVars;
+    for ( int j = 0; j != n; ++j )
+        if ( _fixed[j] < 0 )
+            freeVars.push_back( j );
+    std::vector<int> greedy( freeVars );
+    std::stable_sort( greedy.begin(), greedy.end(), [&](int a, int b) { return sense * _lin[a] < sense * _lin[b]; } );
+
+    bool               found      = false;
+    _Scalar            bestEnergy = std::numeric_limits<_Scalar>::max();
+    std::vector<char>  best;
+    int                rounds     = 0;
+
+#   pragma omp parallel for num_threads(_threads) schedule(dynamic)
+    for ( int r = 0; r < _restarts; ++r )
+    {
+        std::mt19937 rng( _seed + r );
+
+        // start from the fixed values and the starting point for the first restart, all off otherwise
+        State state( *this, sense );
+        for ( int j = 0; j != n; ++j )
+            if (    (_fixed[j] == 1)
+                 || ((_fixed[j] < 0) && (r == 0) && this->isUseStartingPoint() && (this->getStartingPoint().rows() == n) && (this->getStartingPoint()(j) > _Scalar(0.5))) )
+                state.flip( j );
+
+        std::vector<int> order( greedy );
+        if ( r > 0 )
+            std::shuffle( order.begin(), order.end(), rng );
+
+        descend( state, order );
+        while ( pairs(state) && !timeout() )
+            descend( state, order );
+
+        // iterated local search: perturb the best point of this restart, keep improvements
+        State local( state );
+        const int kick = std::max( 2, int(freeVars.size()) / 50 );
+        int       round = 0;
+        for ( int stale = 0; (stale < _maxRounds) && !freeVars.empty() && !timeout(); ++stale, ++round )
+        {
+            state = local;
+            for ( int k = 0; k != kick; ++k )
+                state.flip( freeVars[ rng() % freeVars.size() ] );
+            std::shuffle( order.begin(), order.end(), rng );
+            descend( state, order );
+            while ( pairs(state) && !timeout() )
+                descend( state, order );
+
+            if ( state.energy() < local.energy() - eps )
+            {
+                local = state;
+                stale = -1;
+            }
+        }
+
+#       pragma omp critical (QCQPCPP_LOCALSEARCH_BEST)
+        {
+            rounds += round;
+            if ( local.feasible() && (!found || (local.energy() < bestEnergy)) )
+            {
+                found      = true;
+                bestEnergy = local.energy();
+                best       = local.x;
+            }
+        }
+    } //...for restarts
+
+    std::chrono::duration<double> elapsed = Clock::now() - start;
+    std::cout << "[" << __func__ << "]: " << _restarts << " restarts, " << rounds << " perturbations in " << elapsed.count() << " s"
+              << (limited && (Clock::now() > deadline) ? ", time limit hit" : "") << std::endl;
+
+    if ( !found )
+    {
+        _objective = std::numeric_limits<_Scalar>::max();
+        std::cerr << "[" << __func__ << "]: " << "no feasible point found" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    VectorX sol( n );
+    for ( int j = 0; j != n; ++j )
+        sol(j) = best[j] ? _Scalar(1) : _Scalar(0);
+    this->setSolution( sol );
+    _objective = sense * bestEnergy;
+    std::cout << "[" << __func__ << "]: " << "objective: " << _objective << std::endl;
+
+    if ( x_out )
+        x_out->assign( sol.data(), sol.data() + n );
+
+    return this->getOkCode();
+} //...LocalSearchOpt::optimize()
+
+} //...ns qcqpcpp
+
+#endif // QCQPCPP_LOCALSEARCHOPT_H
@@ -122,9 +122,18 @@ class OptProblem
         //! \brief  estimateHessianOfLagrangian  Estimates Hessian of Lagrangian from Quadratic objective matrix.
         //! \return SparseMatrix                 Lower triangle only, assumed to be symmetric. (TODO: add quadratic constraints).
         //inline SparseMatrix                      estimateHessianOfLagrangian    ()        const;
+        //! \brief  precalcHessianCoeffs         Assembles the Hessians of the objective and the quadratic constraints, and their union sparsity pattern, see #fillHessian().
         inline int                               precalcHessianCoeffs           ();
         inline std::vector<SparseMatrix>  const& getHessians                    ()        const { return _hessians; }
         inline SparseMatrix               const  getHessian                     ( Scalar const obj_factor, VectorX const& lambdas ) const;
+        inline size_t                            getHessianNonZeros             ()        const { return _hessianRows.size(); } //!< \brief Entry count of the union pattern of the Hessians, call #precalcHessianCoeffs() first.
+        inline std::vector<int>           const& getHessianRows                 ()        const { return _hessianRows; }        //!< \brief Row ids of the union pattern, in row-major order.
+        inline std::vector<int>           const& getHessianCols                 ()        const { return _hessianCols; }        //!< \brief Column ids of the union pattern, in row-major order.
+        //! \brief                      Writes the values of getHessian( obj_factor, lambdas ) in the order of #getHessianRows() to \p values, without allocating.
+        //! \param values               Output, #getHessianNonZeros() long.
+        //! \param lambdas              Constraint multipliers, all 1, if NULL.
+        template <typename _NumberT>
+        inline void                              fillHessian                    ( _NumberT * values, Scalar const obj_factor, _NumberT const* lambdas ) const;
 
         ///////////////////////////////////////////////////////////////////////////////////////////////////////////////
         //// Constraints //////////////////////////////////////////////////////////////////////////////////////////////
@@ -169,6 +178,17 @@ class OptProblem
         inline size_t                            getConstraintCount             ()        const { return _bkc.size(); }         //!< \brief Returns the number of linear constraint lines currently in the system.
         //inline SparseMatrix                      estimateJacobianOfConstraints  ()        const;
         inline SparseMatrix               const  getJacobian                    ( VectorX const& x );                           //!< \brief Calculated on the fly from input vector x and precalculated _jacobian.
+        //! \brief                      Caches the linear part of the Jacobian, and the sparsity pattern of the full Jacobian, the union of the linear entries
+        //!                             and the derivatives of the quadratic constraints. Call before #fillJacobian().
+        inline int                               precalcJacobianSparsity        ();
+        inline size_t                            getJacobianNonZeros            ()        const { return _jacobianRows.size(); } //!< \brief Entry count of the Jacobian's pattern, call #precalcJacobianSparsity() first.
+        inline std::vector<int>           const& getJacobianRows                ()        const { return _jacobianRows; }        //!< \brief Row (constraint) ids of the pattern, in row-major order.
+        inline std::vector<int>           const& getJacobianCols                ()        const { return _jacobianCols; }        //!< \brief Column (variable) ids of the pattern, in row-major order.
+        //! \brief                      Writes the values of getJacobian( x ) in the order of #getJacobianRows() to \p values, without allocating.
+        //! \param values               Output, #getJacobianNonZeros() long.
+        //! \param x                    Point to evaluate at, getVarCount() long, all 1, if NULL.
+        template <typename _NumberT>
+        inline void                              fillJacobian                   ( _NumberT * values, _NumberT const* x ) const;
 
         //! \brief addQConstraint       Append an entry to a quadratic constraint matrix. Duplicate entries are summed in a lazy fashion (when <i>update()</i>) is called.
         //! \brief                      The corresponding linear constraints and bounds are stored in A.row( constr_id ), and _b[k|l|u]c[constr_id].
@@ -203,7 +223,19 @@ class OptProblem
 
         // IO
         inline int                               write                          ( std::string const& path ) const;              //!< \brief Serialize to disk.
-        inline int                               read                           ( std::string        proj_path );               //!< \brief Read from disk.
+        inline int                               read                           ( std::string        proj_path );               //!< \brief Read from disk, a \ref getBinaryName() file, if \p proj_path is one, or a directory with that instead of problem.proj.
+        /*! \brief Serialize to a single binary file: header, bounds and types, compressed rows of Qo and A, triplets of the Qi, X0, and optionally the names.
+         *  \param withNames Store the variable names, if there are any.
+         */
+        inline int                               writeBinary                    ( std::string const& path, bool withNames = true ) const;
+        //! \brief Read a #writeBinary() file by mapping it to memory. Fails, if the problem already has variables or constraints.
+        inline int                               readBinary                     ( std::string const& path );
+        /*! \brief Export to free MPS, with QUADOBJ and QCMATRIX sections for the quadratic objective and constraints.
+         *         Variables and constraints are named x<j> and c<i>.
+         */
+        inline int                               writeMps                       ( std::string const& path ) const;
+        //! \brief Export to CPLEX LP. Variables and constraints are named x<j> and c<i>, ranged constraints are split into c<i>_lo and c<i>_up.
+        inline int                               writeLp                        ( std::string const& path ) const;
 
         // PARAMS
         //! \brief            Set time limit to allow the implementation to run for.
@@ -220,6 +252,9 @@ class OptProblem
         inline std::string                      getQoName()                               const { return "Qo.csv";  } //!< \brief File name constexpr to store quadratic objective matrix. Used by #write().
         inline std::string                      getAName()                                const { return "A.csv";   } //!< \brief File name constexpr to store linear constraints matrix. Used by #write().
         inline std::string                      getX0Name()                               const { return "X0.csv";  } //!< \brief File name constexpr to store starting point (initial solution) vector. Used by #write().
+        inline std::string                      getBinaryName()                           const { return "problem.qcqp"; } //!< \brief File name constexpr of the binary container, see #writeBinary().
+        inline std::string                      getMpsName()                              const { return "problem.mps";  } //!< \brief File name constexpr of the MPS export, see #writeMps().
+        inline std::string                      getLpName()                               const { return "problem.lp";   } //!< \brief File name constexpr of the LP export, see #writeLp().
         //! \brief File name constexpr to store qaudratic constraints matrices. Used by #write().
         inline std::string                      getQiName( int i )                        const { char id[255]; sprintf( id, "Q%d.csv", i ); return std::string( id ); }
 
@@ -247,6 +282,19 @@ class OptProblem
         std::vector<SparseMatrix>   _hessians;            //!< \brief [0] = Hessian of ObjectiveFunction, [1..constrCount] = Hessian of Constraints
         SparseMatrix                _jacobian;            //!< \brief Fixed part (linear) of jacobian of constraints.
 
+        // Sparsity patterns, built once by precalcHessianCoeffs() and precalcJacobianSparsity(), so that the solver callbacks only fill values.
+        std::vector<int>            _hessianRows;         //!< \brief Union pattern of _hessians, row ids.
+        std::vector<int>            _hessianCols;         //!< \brief Union pattern of _hessians, column ids.
+        std::vector<size_t>         _hessianSlices;       //!< \brief Entries of _hessians[k] are at [ _hessianSlices[k], _hessianSlices[k+1] ) in _hessianSlicePos and _hessianSliceVals.
+        std::vector<int>            _hessianSlicePos;     //!< \brief Position of an entry of a Hessian in the union pattern.
+        std::vector<Scalar>         _hessianSliceVals;    //!< \brief Value of an entry of a Hessian.
+        std::vector<int>            _jacobianRows;        //!< \brief Jacobian pattern, row ids.
+        std::vector<int>            _jacobianCols;        //!< \brief Jacobian pattern, column ids.
+        std::vector<Scalar>         _jacobianLinVals;     //!< \brief Linear constraint coefficients in the order of the pattern, 0, where only quadratic terms are.
+        std::vector<int>            _jacobianQuadPos;     //!< \brief Quadratic term t adds _jacobianQuadCoeffs[t] * x[ _jacobianQuadVars[t] ] to the pattern entry _jacobianQuadPos[t].
+        std::vector<int>            _jacobianQuadVars;    //!< \brief Variable of a quadratic term of the Jacobian.
+        std::vector<Scalar>         _jacobianQuadCoeffs;  //!< \brief Coefficient of a quadratic term of the Jacobian.
+
         bool                        _updated;             //!< \brief This has to be flipped to true by calling update() for optimize() to run.
         VectorX                     _x;                   //!< \brief Optimize() stores the solution here when finishing.
         VectorX                     _x0;                  //!< \brief Starting point for optimization. TODO: store sparse instead...
@@ -257,6 +305,9 @@ class OptProblem
         Scalar                      _tol_rel_gap;         //!< \brief Relative Gap tolerance.
 
         inline int                              _parseAuxFile( std::string const& aux_file_path );                    //!< \brief Method to read variables and constraints from file. Used by #read().
+        inline int                              _parseBinary( char const* data, size_t size );                        //!< \brief Method to read a mapped #writeBinary() file. Used by #readBinary().
+        //! \brief Position of entry ( \p row, \p col ) in the compressed, sorted \p pattern, -1, if not stored.
+        static inline int                       _patternPosition( SparseMatrix const& pattern, int const row, int const col );
 }; // ...class SGOpt
 
 } // ... namespace qcqpcpp
@@ -264,6 +315,7 @@ class OptProblem
 #ifndef QCQPCPP_INC_SGOPTPROBLEM_HPP
 #   define QCQPCPP_INC_SGOPTPROBLEM_HPP
 #   include "qcqpcpp/impl/optProblem.hpp"
+#   include "qcqpcpp/impl/optProblemIo.hpp"
 #endif // QCQPCPP_INC_SGOPTPROBLEM_HPP
 
 #endif // QCQPCPP_INC_SGOPTPROBLEM_H
@@ -24,6 +24,7 @@ namespace am
                         , data_max              ( std::numeric_limits<int>::max() / 2 ) // TODO: change back to 1e10, if breaks
                         , max_neighbourhood_size( 15 )
                         , max_pearl_iterations  ( 3 )
+                        , data_radius           ( 0.f )
                         , pottsweight           ( 1.f )
                         , debug                 ( true )
                     {
@@ -40,6 +41,7 @@ namespace am
 
                     int     max_neighbourhood_size;    //!< \brief Sync with \ref CandidateGeneratorParams::nn_K.
                     int     max_pearl_iterations;      //!< \brief How many iterations of pearl to do.
+                    float   data_radius;               //!< \brief Sparse data cost: a point only gets costs for the labels closer than this, instead of a dense num_points x num_labels table. Dense, if not positive.
 
                     float   pottsweight;               //!< \brief Unused.
                     bool    debug;
@@ -77,8 +79,29 @@ namespace am
                     , Scalar             const  gammasqr
                     , Scalar             const  beta
                     , Params             const& params
+                    , std::vector<std::vector<int  > > const* neighs    = NULL
+                    , std::vector<std::vector<float> > const* sqr_dists = NULL
                     );
 
+            /*! \brief Sparse data cost of \ref expand: for every label, the points closer than \p params.data_radius, by ascending point id,
+             *         as GCO's setDataCost( label, costs, count ) expects. A point without a label in reach gets its closest label only.
+             *  \tparam _SparseCostsT  Concept: std::vector< gco::GCoptimization::SparseDataCost >.
+             *  \param[out] costs      One list per label.
+             *  \param[out] cheapest   Cheapest label of every point, a feasible starting labeling.
+             *  \param[in]  extrema    Extrema of the labels, that have points, used by finite distances.
+             *  \param[in]  finite     Per label, 1, if it has \p extrema.
+             */
+            template <class _SparseCostsT, typename _PclPointT, class _PrimitiveT>
+            static inline int
+            sparseDataCosts( std::vector<_SparseCostsT>                          & costs
+                           , std::vector<int>                                    & cheapest
+                           , boost::shared_ptr<pcl::PointCloud<_PclPointT> >       cloud
+                           , std::vector<_PrimitiveT>                       const& lines
+                           , std::vector<typename _PrimitiveT::ExtremaT>    const& extrema
+                           , std::vector<char>                              const& finite
+                           , Params                                         const& params
+                           );
+
             template <class PointsT, class TLine>
             static inline int
             refit( std::vector<TLine>        &lines
@@ -2,6 +2,9 @@
 #define __RAPTER_PEARL_HPP__
 
 #include <limits>
+#include <vector>
+#include <numeric>                                        // partial_sum
+#include <algorithm>                                      // sort, min
 
 #include "omp.h"
 
@@ -18,6 +21,7 @@
 #include "rapter/util/containers.hpp"   // containers::add
 #include "rapter/util/impl/pclUtil.hpp" // smartgeometry::
 #include "rapter/processing/util.hpp"   // processing::getNeighbourhoodIndices
+#include "rapter/processing/distanceKernels.hpp" // PositionArrays
 
 namespace am
 {
@@ -52,6 +56,17 @@ namespace am
             std::cout << "[" << __func__ << "]: " << "received " << lines.size() << "input primitives, skipping propose step!" << std::endl;
         }
 
+        // pairwise neighbourhoods, once, the cloud does not change between iterations
+        std::vector<std::vector<int  > > neighs;
+        std::vector<std::vector<float> > sqr_dists;
+        rapter::processing::getNeighbourhoodIndices( neighs
+                                                   , cloud
+                                                   , indices
+                                                   , &sqr_dists
+                                                   , params.max_neighbourhood_size
+                                                   , params.scale
+                                                   );
+
         int iteration_id = 0;
         std::vector<int> prev_labels;
         do
@@ -67,7 +82,9 @@ namespace am
                                 , /* [in]      primitives: */ lines
                                 , /* [in]        gammasqr: */ params.gammasqr // 50*50
                                 , /* [in]            beta: */ params.beta     // params.scale*100
-                                , /* [in]      parameters: */ params );
+                                , /* [in]      parameters: */ params
+                                , /* [in]          neighs: */ &neighs
+                                , /* [in]       sqr_dists: */ &sqr_dists );
             if ( err != EXIT_SUCCESS ) return err;
 
             if ( label_history )
@@ -188,7 +205,9 @@ namespace am
             , std::vector<_PrimitiveT>  const& lines
             , Scalar                    const  gammasqr
             , Scalar                    const  beta
-            , Params                    const& params )
+            , Params                    const& params
+            , std::vector<std::vector<int  > > const* neighs_arg
+            , std::vector<std::vector<float> > const* sqr_dists_arg )
     {
         using rapter::PidT;
         using rapter::LidT;
@@ -219,67 +238,105 @@ namespace am
 
         labels.resize( num_pixels );
 
-        // first set up the array for data costs
-        typename _PrimitiveT::ExtremaT extrema;
+        // extents of the labels that have points, once per label
+        std::vector<typename _PrimitiveT::ExtremaT> extrema( num_labels );
+        std::vector<char>                           finite ( num_labels, 0 );
+        if ( !noAssignmentsYet )
+        {
+#           pragma omp parallel for schedule(dynamic)
+            for ( LidT line_id = 0; line_id < static_cast<LidT>(num_labels); ++line_id )
+            {
+                rapter::GidPidVectorMap::const_iterator it = populations.find( line_id );
+                if ( (it == populations.end()) || !it->second.size() )
+                    continue;
+                lines[line_id].template getExtent<PointPrimitiveT>( extrema[line_id], points, params.scale, &(it->second), /* force_axis_aligned: */ true );
+                finite[line_id] = 1;
+            }
+        }
 
+        // first set up the array for data costs, or the sparse lists of the labels in reach
         const float intMultSqr = params.int_mult * params.int_mult;
         std::cout << "intMult: " << params.int_mult << std::endl;
-        Scalar *data = new Scalar[ num_pixels * num_labels ];
-        int data_zero_cnt = 0, data_max_cnt = 0;
-        for ( size_t pid = 0; pid != num_pixels; ++pid )
-            for ( size_t line_id = 0; line_id != num_labels; ++line_id )
+        Scalar *data = NULL;
+        std::vector< std::vector<gco::GCoptimization::SparseDataCost> > sparse_data;
+        std::vector<int>                                                 sparse_labels;
+        if ( params.data_radius > 0.f )
+            Pearl::sparseDataCosts( sparse_data, sparse_labels, cloud, lines, extrema, finite, params );
+        else
+        {
+            data = new Scalar[ num_pixels * num_labels ];
+            int data_zero_cnt = 0, data_max_cnt = 0;
+#           pragma omp parallel for reduction(+:data_zero_cnt,data_max_cnt)
+            for ( LidT pid = 0; pid < static_cast<LidT>(num_pixels); ++pid )
             {
-                //float dist = std::abs( lines[line_id].getDistance( /*     point: */ cloud->at( indices ? (*indices)[pid] : pid ).getVector3fMap() ) ); // abs() added by Aron 18/1/2015
-                float dist = std::numeric_limits<Scalar>::max();
-                if ( noAssignmentsYet || populations.find(line_id) == populations.end() || populations[line_id].size() == 0 )
-                {
-                    dist = std::abs( lines[line_id].getDistance( /* point: */ cloud->at( indices ? (*indices)[pid] : pid ).getVector3fMap() ) ); // abs() added by Aron 18/1/2015
-                }
-                else
+                const Eigen::Vector3f pnt = cloud->at( indices ? (*indices)[pid] : pid ).getVector3fMap();
+                for ( size_t line_id = 0; line_id != num_labels; ++line_id )
                 {
-                    lines[line_id].template getExtent<PointPrimitiveT>( extrema, points, params.scale, &populations.at(line_id), /* force_axis_aligned: */ true );
-                    dist = std::abs( lines[line_id].getFiniteDistance( extrema,
-                                                                       cloud->at( indices ? (*indices)[pid] : pid ).getVector3fMap() ) ); // abs() added by Aron 18/1/2015
-                }
+                    float dist = std::abs( finite[line_id] ? lines[line_id].getFiniteDistance( extrema[line_id], pnt )
+                                                           : lines[line_id].getDistance( pnt ) ); // abs() added by Aron 18/1/2015
 
-                //std::cout << "dist: " << dist;
-                dist *= dist * intMultSqr;
-                // std::cout << ", data: " << dist << std::endl;
+                    dist *= dist * intMultSqr;
 
-                if ( (dist != dist) || (dist < 0) || (dist > params.data_max) )
-                {
-                    dist = params.data_max;
-                    ++data_max_cnt;
-                }
-                else if (dist == 0)
-                    ++data_zero_cnt;
+                    if ( (dist != dist) || (dist < 0) || (dist > params.data_max) )
+                    {
+                        dist = params.data_max;
+                        ++data_max_cnt;
+                    }
+                    else if (dist == 0)
+                        ++data_zero_cnt;
 
-                data[ pid * num_labels + line_id ] = dist;
+                    data[ pid * num_labels + line_id ] = dist;
+                }
             }
-        std::cout << "Zero datacosts: " << data_zero_cnt << "/" << num_pixels << "(" << Scalar(data_zero_cnt)/num_pixels*Scalar(100.) << "%)"
-                  << ", capped datacost: " << data_max_cnt << "/" << num_pixels << "(" << Scalar(data_max_cnt)/num_pixels*Scalar(100.) << "%)\n";
+            std::cout << "Zero datacosts: " << data_zero_cnt << "/" << num_pixels << "(" << Scalar(data_zero_cnt)/num_pixels*Scalar(100.) << "%)"
+                      << ", capped datacost: " << data_max_cnt << "/" << num_pixels << "(" << Scalar(data_max_cnt)/num_pixels*Scalar(100.) << "%)\n";
+        }
 
-        // next set up the array for smooth costs
+        // next set up the array for smooth costs, the sparse mode uses GCO's default, the same Potts model without the num_labels^2 table
         //const int smooth_2 = params.lambdas(2)/2;
-        Scalar *smooth = new Scalar[ num_labels * num_labels ];
-        for ( ULidT l1 = 0; l1 < num_labels; ++l1 )
-            for ( ULidT l2 = 0; l2 < num_labels; ++l2 )
-                smooth[l1+l2*num_labels] = /*smooth_2 * */ (l1 != l2); // dirac/potts
+        Scalar *smooth = NULL;
+        if ( data )
+        {
+            smooth = new Scalar[ num_labels * num_labels ];
+            for ( ULidT l1 = 0; l1 < num_labels; ++l1 )
+                for ( ULidT l2 = 0; l2 < num_labels; ++l2 )
+                    smooth[l1+l2*num_labels] = /*smooth_2 * */ (l1 != l2); // dirac/potts
+        }
 
-        std::vector<std::vector<int  > > neighs;
-        std::vector<std::vector<float> > sqr_dists;
-        rapter::processing::getNeighbourhoodIndices( neighs
-                                                   , cloud
-                                                   , indices
-                                                   , &sqr_dists
-                                                   , params.max_neighbourhood_size   // 10
-                                                   , params.scale // 0.01f
-                                                   );
+        std::vector<std::vector<int  > > local_neighs;
+        std::vector<std::vector<float> > local_sqr_dists;
+        if ( !neighs_arg || !sqr_dists_arg )
+        {
+            rapter::processing::getNeighbourhoodIndices( local_neighs
+                                                       , cloud
+                                                       , indices
+                                                       , &local_sqr_dists
+                                                       , params.max_neighbourhood_size   // 10
+                                                       , params.scale // 0.01f
+                                                       );
+            neighs_arg    = &local_neighs;
+            sqr_dists_arg = &local_sqr_dists;
+        }
+        std::vector<std::vector<int  > > const& neighs    = *neighs_arg;
+        std::vector<std::vector<float> > const& sqr_dists = *sqr_dists_arg;
         try
         {
             gco::GCoptimizationGeneralGraph *gc = new gco::GCoptimizationGeneralGraph(num_pixels,num_labels);
-            gc->setDataCost  ( data   ); // unary
-            gc->setSmoothCost( smooth ); // pairwise labelwise
+            if ( data )
+            {
+                gc->setDataCost  ( data   ); // unary
+                gc->setSmoothCost( smooth ); // pairwise labelwise
+            }
+            else
+            {
+                // GCO copies the lists, and treats missing (point,label) pairs as infeasible, so start from a feasible labeling
+                for ( size_t line_id = 0; line_id != num_labels; ++line_id )
+                    if ( sparse_data[line_id].size() )
+                        gc->setDataCost( line_id, sparse_data[line_id].data(), sparse_data[line_id].size() ); // unary
+                std::vector< std::vector<gco::GCoptimization::SparseDataCost> >().swap( sparse_data );
+                for ( size_t pid = 0; pid != num_pixels; ++pid )
+                    gc->setLabel( pid, sparse_labels[pid] );
+            }
             gc->setLabelCost ( beta   ); // complexity ( number of labels)
 
             // set neighbourhoods
@@ -357,6 +414,182 @@ namespace am
         return EXIT_SUCCESS;
     }
 
+    template <class _SparseCostsT, typename _PclPointT, class _PrimitiveT>
+    inline int
+    Pearl::sparseDataCosts( std::vector<_SparseCostsT>                          & costs
+                          , std::vector<int>                                    & cheapest
+                          , boost::shared_ptr<pcl::PointCloud<_PclPointT> >       cloud
+                          , std::vector<_PrimitiveT>                       const& lines
+                          , std::vector<typename _PrimitiveT::ExtremaT>    const& extrema
+                          , std::vector<char>                              const& finite
+                          , Params                                         const& params )
+    {
+        using rapter::LidT;
+        typedef rapter::processing::kernels::PositionArrays<float> PositionsT;
+        typedef typename _SparseCostsT::value_type                 SparseCostT;
+
+        const LidT  num_pixels = cloud->size();
+        const LidT  num_labels = lines.size();
+        const float radius     = params.data_radius;
+        const float intMultSqr = params.int_mult * params.int_mult;
+        const float maxCost    = std::min( float(params.data_max), float(GCO_MAX_ENERGYTERM) ); // GCO refuses larger terms
+        costs   .assign( num_labels, _SparseCostsT() );
+        cheapest.assign( num_pixels, 0 );
+        if ( !num_pixels || !num_labels )
+            return EXIT_SUCCESS;
+
+        // uniform grid, cells are radius wide, or wider, so that there are at most 2^18 cells
+        Eigen::Vector3f minPt = cloud->at(0).getVector3fMap(), maxPt = minPt;
+        for ( LidT pid = 1; pid < num_pixels; ++pid )
+        {
+            minPt = minPt.cwiseMin( cloud->at(pid).getVector3fMap() );
+            maxPt = maxPt.cwiseMax( cloud->at(pid).getVector3fMap() );
+        }
+        float          cellSize = radius;
+        Eigen::Vector3i dims;
+        do
+        {
+            for ( int d = 0; d != 3; ++d )
+                dims(d) = int( std::min( std::floor((maxPt(d) - minPt(d)) / cellSize), 1.e6f ) ) + 1;
+            cellSize *= 2.f;
+        } while ( double(dims(0)) * dims(1) * dims(2) > double(1 << 18) );
+        cellSize *= .5f;
+        const LidT  cellCount = LidT(dims(0)) * dims(1) * dims(2);
+        const float reach     = radius + .5f * std::sqrt(3.f) * cellSize; // a cell centre this far may still have a point in reach
+
+        // points sorted by cell, ascending ids within a cell
+        std::vector<LidT> cellOf( num_pixels ), cellStarts( cellCount + 1, 0 );
+        for ( LidT pid = 0; pid < num_pixels; ++pid )
+        {
+            const Eigen::Vector3f pnt = cloud->at(pid).getVector3fMap();
+            Eigen::Vector3i cell;
+            for ( int d = 0; d != 3; ++d )
+                cell(d) = std::min( int((pnt(d) - minPt(d)) / cellSize), dims(d) - 1 );
+            cellOf[pid] = cell(0) + LidT(dims(0)) * (cell(1) + LidT(dims(1)) * cell(2));
+            ++cellStarts[ cellOf[pid] + 1 ];
+        }
+        std::partial_sum( cellStarts.begin(), cellStarts.end(), cellStarts.begin() );
+
+        std::vector<int> order( num_pixels );
+        PositionsT       positions;
+        positions.resize( num_pixels );
+        {
+            std::vector<LidT> next( cellStarts.begin(), cellStarts.end() - 1 );
+            for ( LidT pid = 0; pid < num_pixels; ++pid )
+            {
+                const LidT at = next[ cellOf[pid] ]++;
+                const Eigen::Vector3f pnt = cloud->at(pid).getVector3fMap();
+                order[at] = pid;
+                positions.x[at] = pnt(0); positions.y[at] = pnt(1); positions.z[at] = pnt(2);
+            }
+        }
+
+        PositionsT centers;
+        centers.resize( cellCount );
+        for ( LidT cell = 0; cell < cellCount; ++cell )
+        {
+            centers.x[cell] = minPt(0) + (cell % dims(0)           + .5f) * cellSize;
+            centers.y[cell] = minPt(1) + (cell / dims(0) % dims(1) + .5f) * cellSize;
+            centers.z[cell] = minPt(2) + (cell / dims(0) / dims(1) + .5f) * cellSize;
+        }
+
+        // every label: cells in reach, then the points in them in reach
+#       pragma omp parallel
+        {
+            std::vector<float> centerDists, dists;
+            std::vector<int>   blockPids;
+            PositionsT         block;
+#           pragma omp for schedule(dynamic)
+            for ( LidT line_id = 0; line_id < num_labels; ++line_id )
+            {
+                if ( finite[line_id] ) lines[line_id].getFiniteDistances( centerDists, extrema[line_id], centers );
+                else                   lines[line_id].getDistances      ( centerDists, centers );
+
+                block.x.clear(); block.y.clear(); block.z.clear(); blockPids.clear();
+                for ( LidT cell = 0; cell < cellCount; ++cell )
+                {
+                    if ( !(std::abs(centerDists[cell]) <= reach) || (cellStarts[cell] == cellStarts[cell+1]) )
+                        continue;
+                    block.x  .insert( block.x  .end(), positions.x.begin() + cellStarts[cell], positions.x.begin() + cellStarts[cell+1] );
+                    block.y  .insert( block.y  .end(), positions.y.begin() + cellStarts[cell], positions.y.begin() + cellStarts[cell+1] );
+                    block.z  .insert( block.z  .end(), positions.z.begin() + cellStarts[cell], positions.z.begin() + cellStarts[cell+1] );
+                    blockPids.insert( blockPids.end(), order      .begin() + cellStarts[cell], order      .begin() + cellStarts[cell+1] );
+                }
+
+                if ( finite[line_id] ) lines[line_id].getFiniteDistances( dists, extrema[line_id], block );
+                else                   lines[line_id].getDistances      ( dists, block );
+
+                for ( size_t i = 0; i != dists.size(); ++i )
+                {
+                    const float dist = std::abs( dists[i] );
+                    if ( !(dist <= radius) )
+                        continue;
+                    SparseCostT entry;
+                    entry.site = blockPids[i];
+                    entry.cost = std::min( dist * dist * intMultSqr, maxCost );
+                    costs[line_id].push_back( entry );
+                }
+            } //...for labels
+        } //...omp parallel
+
+        // points without a label in reach get their closest one
+        std::vector<char> covered( num_pixels, 0 );
+        for ( LidT line_id = 0; line_id < num_labels; ++line_id )
+            for ( size_t i = 0; i != costs[line_id].size(); ++i )
+                covered[ costs[line_id][i].site ] = 1;
+        std::vector<int> uncovered;
+        for ( LidT pid = 0; pid < num_pixels; ++pid )
+            if ( !covered[pid] )
+                uncovered.push_back( pid );
+
+        std::vector<SparseCostT> closest( uncovered.size() );
+        std::vector<LidT>        closestLabels( uncovered.size(), 0 );
+#       pragma omp parallel for schedule(dynamic,64)
+        for ( LidT i = 0; i < static_cast<LidT>(uncovered.size()); ++i )
+        {
+            const Eigen::Vector3f pnt = cloud->at( uncovered[i] ).getVector3fMap();
+            float minDist = std::numeric_limits<float>::max();
+            for ( LidT line_id = 0; line_id < num_labels; ++line_id )
+            {
+                const float dist = std::abs( finite[line_id] ? lines[line_id].getFiniteDistance( extrema[line_id], pnt )
+                                                             : lines[line_id].getDistance( pnt ) );
+                if ( dist < minDist )
+                {
+                    minDist          = dist;
+                    closestLabels[i] = line_id;
+                }
+            }
+            closest[i].site = uncovered[i];
+            closest[i].cost = (minDist < std::sqrt(maxCost / intMultSqr)) ? minDist * minDist * intMultSqr : maxCost;
+        }
+        for ( size_t i = 0; i != uncovered.size(); ++i )
+            costs[ closestLabels[i] ].push_back( closest[i] );
+
+#       pragma omp parallel for schedule(dynamic)
+        for ( LidT line_id = 0; line_id < num_labels; ++line_id )
+            std::sort( costs[line_id].begin(), costs[line_id].end(), [](SparseCostT const& a, SparseCostT const& b) { return a.site < b.site; } );
+
+        // starting labels
+        size_t nnz = 0;
+        std::vector<float> cheapestCosts( num_pixels, std::numeric_limits<float>::max() );
+        for ( LidT line_id = 0; line_id < num_labels; ++line_id )
+        {
+            nnz += costs[line_id].size();
+            for ( size_t i = 0; i != costs[line_id].size(); ++i )
+                if ( costs[line_id][i].cost < cheapestCosts[costs[line_id][i].site] )
+                {
+                    cheapestCosts[ costs[line_id][i].site ] = costs[line_id][i].cost;
+                    cheapest     [ costs[line_id][i].site ] = line_id;
+                }
+        }
+
+        std::cout << "[" << __func__ << "]: " << "sparse datacosts: " << nnz << " (" << float(nnz) / num_pixels << " labels/point, "
+                  << float(nnz) / (float(num_pixels) * num_labels) * 100.f << "% of dense), " << uncovered.size() << " points without a label in "
+                  << radius << ", grid " << dims.transpose() << std::endl;
+
+        return EXIT_SUCCESS;
+    } //...sparseDataCosts()
+
     template <typename _PointContainerT, class _PrimitiveT> inline int
     Pearl::refit( std::vector<_PrimitiveT>        &lines
                   , std::vector<int> const& labels
@@ -386,7 +619,8 @@ namespace am
 
         if ( _PrimitiveT::EmbedSpaceDim == 2 )
         {
-            for ( size_t line_id = 0; line_id != lines.size(); ++line_id )
+            #pragma omp parallel for schedule(dynamic)
+            for ( long line_id = 0; line_id < static_cast<long>(lines.size()); ++line_id )
             {
                 if ( lines_points[line_id].size() > 1 )
                     smartgeometry::geometry::fitLinearPrimitive<_PointContainerT,Scalar,6>( /*           output: */ lines[line_id].coeffs()
@@ -406,8 +640,8 @@ namespace am
             vptr->setBackgroundColor( .7, .7, .7 );
             pcl::ModelCoefficients modelCoeffs; modelCoeffs.values.resize(4);
 #endif
-            #pragma omp parallel for
-            for ( size_t planeId = 0; planeId < lines.size(); ++planeId )
+            #pragma omp parallel for schedule(dynamic)
+            for ( long planeId = 0; planeId < static_cast<long>(lines.size()); ++planeId )
             {
 #if 0
                 vptr->removePointCloud( "colourCloud" );
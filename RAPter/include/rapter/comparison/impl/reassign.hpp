@@ -7,6 +7,7 @@
 #define GCO_ENERGYTYPE float
 #include "gco/GCoptimization.h"
 #include "rapter/simpleTypes.h"
+#include "rapter/processing/distanceKernels.hpp" // PositionArrays
 
 namespace rapter
 {
@@ -94,19 +95,20 @@ namespace rapter
             std::cout << "[" << __func__ << "]: " << "setting data labels..." << std::endl; fflush(stdout);
             Scalar *data = new Scalar[num_pixels*num_labels];
 
-            #pragma omp for schedule(dynamic,8)
-            for ( PidT pid = 0; pid < num_pixels; pid++ )
-            {
-                LidT label = 0;
-                LidT lid0 = 0;
-                for ( typename _PrimitiveContainerT::const_iterator it = primitives.begin(); it != primitives.end(); ++it, ++lid0 )
-                    for ( ULidT lid1 = 0; lid1 != it->size(); ++lid1, ++label )
-                    {
-                        Scalar dist = it->at(lid1).getDistance( points[pid].template pos() );
-                        data[ pid*num_labels + label] = Scalar(100.) * dist * dist;
-                        labelMap[ label ] = std::pair<int,int>( lid0, lid1 );
-                    }
-            }
+            // one batch of point distances per label
+            processing::kernels::PositionArrays<Scalar> positions;
+            processing::kernels::gatherPositions<Scalar, _PointContainerT, std::vector<PidT> >( positions, points, /* indices: */ NULL );
+            std::vector<Scalar> distances;
+            LidT label = 0;
+            LidT lid0 = 0;
+            for ( typename _PrimitiveContainerT::const_iterator it = primitives.begin(); it != primitives.end(); ++it, ++lid0 )
+                for ( ULidT lid1 = 0; lid1 != it->size(); ++lid1, ++label )
+                {
+                    it->at(lid1).getDistances( distances, positions );
+                    for ( PidT pid = 0; pid < num_pixels; pid++ )
+                        data[ pid*num_labels + label] = Scalar(100.) * distances[pid] * distances[pid];
+                    labelMap[ label ] = std::pair<int,int>( lid0, lid1 );
+                }
 
             std::cout << "[" << __func__ << "]: " << "setting pairwise labels..." << std::endl; fflush(stdout);
             // next set up the array for smooth costs
@@ -0,0 +1,430 @@
+#ifndef RAPTER_BINARYIO_HPP
+#define RAPTER_BINARYIO_HPP
+
+#include <map>
+#include <set>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <cstring>                              // memcmp
+#include <stdint.h>
+
+#include "boost/shared_ptr.hpp"
+#include "boost/filesystem.hpp"
+#include "boost/interprocess/file_mapping.hpp"
+#include "boost/interprocess/mapped_region.hpp"
+
+#include "rapter/simpleTypes.h"                 // GidT, DidT, PidT
+#include "rapter/util/containers.hpp"           // valueOf
+
+namespace rapter
+{
+    namespace io
+    {
+        /*! \brief Versioned little-endian columnar container for primitives, point-primitive associations and points.
+         *
+         *  Layout: \ref Header, nColumns x \ref ColumnDesc, then the columns, each 8 byte aligned.
+         *  Every column has "rows" x "width" fixed size entries, so readers can memory map the file and use the columns in place.
+         *  The readers in \ref io.h recognize the container by its magic bytes, whatever the file is called,
+         *  so a binary "patches.csv" can be passed to any step expecting the CSV.
+         */
+        class BinaryColumns
+        {
+            public:
+                //! \brief What the file contains. Decides, which columns are expected.
+                enum KIND        { PRIMITIVES = 1, ASSOCIATIONS = 2, POINTS = 3 };
+                //! \brief Column contents.
+                enum COLUMN      { COEFFS = 0, GID = 1, DIR_GID = 2, STATUS = 3, GEN_ANGLE = 4, PID = 5, POS = 6, NORMAL = 7 };
+                //! \brief Element types of columns.
+                enum TYPE        { INT8 = 0, INT32 = 1, FLOAT32 = 2 };
+
+                static const uint32_t Version = 1;
+                static inline char const* Magic() { return "RBIN"; }
+
+                //! \brief 24 bytes.
+                struct Header
+                {
+                    char     magic[4];
+                    uint32_t version;
+                    uint32_t kind;
+                    uint32_t nColumns;
+                    uint64_t rows;
+                };
+
+                //! \brief 24 bytes.
+                struct ColumnDesc
+                {
+                    uint32_t id;
+                    uint32_t type;
+                    uint32_t width;     //!< \brief Number of elements per row.
+                    uint32_t reserved;
+                    uint64_t offset;    //!< \brief Byte offset of the column from the beginning of the file.
+                };
+
+                //! \brief A column to write, \p data points to rows x width elements of \p type.
+                struct ColumnData
+                {
+                    ColumnData( uint32_t id, uint32_t type, uint32_t width, void const* data )
+                        : _id( id ), _type( type ), _width( width ), _data( data ) {}
+                    uint32_t    _id, _type, _width;
+                    void const* _data;
+                };
+
+                BinaryColumns() : _header( NULL ), _columns( NULL ) {}
+
+                static inline size_t typeSize( uint32_t const type ) { return type == INT8 ? 1 : 4; }
+
+                //! \brief The format is written in host byte order, which has to be little-endian.
+                static inline bool isLittleEndian() { const uint16_t probe = 1; return *reinterpret_cast<char const*>(&probe) == 1; }
+
+                //! \brief Checks the magic bytes at the beginning of \p path.
+                static inline bool isBinary( std::string const& path )
+                {
+                    std::ifstream f( path.c_str(), std::ios::binary );
+                    char magic[4];
+                    if ( !f.is_open() || !f.read(magic, 4) )
+                        return false;
+                    return !std::memcmp( magic, Magic(), 4 );
+                }
+
+                /*! \brief Writes \p columns of \p rows entries each to \p path.
+                 *  \return EXIT_SUCCESS, if could write.
+                 */
+                static inline int write( std::string const& path, KIND const kind, uint64_t const rows, std::vector<ColumnData> const& columns )
+                {
+                    if ( !isLittleEndian() ) { std::cerr << "[" << __func__ << "]: " << "binary format is little-endian only" << std::endl; return EXIT_FAILURE; }
+
+                    std::string parent_path = boost::filesystem::path(path).parent_path().string();
+                    if ( !parent_path.empty() && !boost::filesystem::exists(parent_path) )
+                        boost::filesystem::create_directory( boost::filesystem::path(parent_path) );
+
+                    std::ofstream f( path.c_str(), std::ios::binary | std::ios::trunc );
+                    if ( !f.is_open() ) { std::cerr << "[" << __func__ << "]: " << "could not open " << path << std::endl; return EXIT_FAILURE; }
+
+                    Header header;
+                    std::memcpy( header.magic, Magic(), 4 );
+                    header.version  = Version;
+                    header.kind     = kind;
+                    header.nColumns = columns.size();
+                    header.rows     = rows;
+
+                    // lay out columns
+                    std::vector<ColumnDesc> descs( columns.size() );
+                    uint64_t offset = sizeof(Header) + sizeof(ColumnDesc) * columns.size();
+                    for ( size_t c = 0; c != columns.size(); ++c )
+                    {
+                        descs[c].id       = columns[c]._id;
+                        descs[c].type     = columns[c]._type;
+                        descs[c].width    = columns[c]._width;
+                        descs[c].reserved = 0;
+                        descs[c].offset   = offset;
+                        offset += align( rows * columns[c]._width * typeSize(columns[c]._type) );
+                    }
+
+                    f.write( reinterpret_cast<char const*>(&header), sizeof(Header) );
+                    f.write( reinterpret_cast<char const*>(descs.data()), sizeof(ColumnDesc) * descs.size() );
+                    const char padding[8] = { 0 };
+                    for ( size_t c = 0; c != columns.size(); ++c )
+                    {
+                        const uint64_t bytes = rows * columns[c]._width * typeSize(columns[c]._type);
+                        if ( bytes ) f.write( static_cast<char const*>(columns[c]._data), bytes );
+                        f.write( padding, align(bytes) - bytes );
+                    }
+
+                    return f.good() ? EXIT_SUCCESS : EXIT_FAILURE;
+                } //...write()
+
+                /*! \brief Memory maps \p path and checks its header and columns.
+                 *  \return EXIT_SUCCESS, if \p path is a valid container.
+                 */
+                inline int map( std::string const& path )
+                {
+                    this->release();
+                    if ( !isLittleEndian() ) { std::cerr << "[" << __func__ << "]: " << "binary format is little-endian only" << std::endl; return EXIT_FAILURE; }
+
+                    try
+                    {
+                        boost::interprocess::file_mapping mapping( path.c_str(), boost::interprocess::read_only );
+                        _region.reset( new boost::interprocess::mapped_region(mapping, boost::interprocess::read_only) );
+                    }
+                    catch ( boost::interprocess::interprocess_exception const& e )
+                    {
+                        std::cerr << "[" << __func__ << "]: " << "could not map " << path << ": " << e.what() << std::endl;
+                        return EXIT_FAILURE;
+                    }
+
+                    char const* data = static_cast<char const*>( _region->get_address() );
+                    const size_t size = _region->get_size();
+                    _header = reinterpret_cast<Header const*>( data );
+                    if (    (size < sizeof(Header))
+                         || std::memcmp(_header->magic, Magic(), 4)
+                         || (_header->version != Version)
+                         || (size < sizeof(Header) + sizeof(ColumnDesc) * _header->nColumns) )
+                    {
+                        std::cerr << "[" << __func__ << "]: " << path << " is not a version " << Version << " binary container" << std::endl;
+                        this->release();
+                        return EXIT_FAILURE;
+                    }
+
+                    _columns = reinterpret_cast<ColumnDesc const*>( data + sizeof(Header) );
+                    for ( uint32_t c = 0; c != _header->nColumns; ++c )
+                        if ( _columns[c].offset + _header->rows * _columns[c].width * typeSize(_columns[c].type) > size )
+                        {
+                            std::cerr << "[" << __func__ << "]: " << path << " is truncated" << std::endl;
+                            this->release();
+                            return EXIT_FAILURE;
+                        }
+
+                    return EXIT_SUCCESS;
+                } //...map()
+
+                inline uint32_t kind() const { return _header ? _header->kind : 0; }
+                inline uint64_t rows() const { return _header ? _header->rows : 0; }
+
+                /*! \brief Points into the mapped file at column \p id, or NULL, if the column is missing or its type or width do not match.
+                 *  \tparam T      int8_t, int32_t or float.
+                 *  \param[in] width Expected number of elements per row, 0 for any.
+                 */
+                template <typename T>
+                inline T const* column( uint32_t const id, uint32_t const width = 1 ) const
+                {
+                    if ( !_header )
+                        return NULL;
+                    for ( uint32_t c = 0; c != _header->nColumns; ++c )
+                    {
+                        if ( _columns[c].id != id )
+                            continue;
+                        if ( (typeSize(_columns[c].type) != sizeof(T)) || (width && (_columns[c].width != width)) )
+                        {
+                            std::cerr << "[" << __func__ << "]: " << "column " << id << " has unexpected type or width" << std::endl;
+                            return NULL;
+                        }
+                        return reinterpret_cast<T const*>( static_cast<char const*>(_region->get_address()) + _columns[c].offset );
+                    }
+                    return NULL;
+                } //...column()
+
+                inline uint32_t width( uint32_t const id ) const
+                {
+                    for ( uint32_t c = 0; _header && (c != _header->nColumns); ++c )
+                        if ( _columns[c].id == id ) return _columns[c].width;
+                    return 0;
+                }
+
+                inline void release() { _region.reset(); _header = NULL; _columns = NULL; }
+
+            protected:
+                static inline uint64_t align( uint64_t const bytes ) { return (bytes + 7) & ~uint64_t(7); }
+
+                Header     const* _header;
+                ColumnDesc const* _columns;
+                boost::shared_ptr<boost::interprocess::mapped_region> _region;
+        }; //...class BinaryColumns
+
+        //! \brief When set, \ref savePrimitives and \ref writeAssociations write \ref BinaryColumns instead of CSV. Set by "--binary" in main.
+        inline bool& binaryOutput() { static bool binary = false; return binary; }
+
+        //! \brief Decides, if \p path should be written in binary: either requested globally, or ends in ".rbin".
+        inline bool useBinary( std::string const& path, bool const points = false )
+        {
+            return (!points && binaryOutput()) || (boost::filesystem::path(path).extension().string() == ".rbin");
+        }
+
+        //! \brief Writes primitives as \ref BinaryColumns::PRIMITIVES. The coefficients column holds the same <x0,n> as \ref savePrimitives.
+        //! \tparam PrimitiveContainerT Concept: vector< vector< rapter::LinePrimitive2 > >.
+        template <class PrimitiveT, class _inner_const_iterator, class PrimitiveContainerT> inline int
+        savePrimitivesBinary( PrimitiveContainerT const& primitives, std::string const& path, bool const verbose = false )
+        {
+            typedef typename PrimitiveContainerT::const_iterator outer_const_iterator;
+            const int entryLength = PrimitiveT::getFileEntryLength();
+            if ( entryLength != 6 ) { std::cerr << "[" << __func__ << "]: " << "expected <x0,n> file entries" << std::endl; return EXIT_FAILURE; }
+
+            std::vector<float>   coeffs;
+            std::vector<int32_t> gids, dids;
+            std::vector<int8_t>  statuses;
+            std::vector<float>   genAngles;
+            for ( outer_const_iterator gid_it = primitives.begin(); gid_it != primitives.end(); ++gid_it )
+            {
+                _inner_const_iterator lid_end_it = containers::valueOf<PrimitiveT>(gid_it).end();
+                for ( _inner_const_iterator lid_it = containers::valueOf<PrimitiveT>(gid_it).begin(); lid_it != lid_end_it; ++lid_it )
+                {
+                    for ( int d = 0; d != 3; ++d ) coeffs.push_back( lid_it->pos()(d) );
+                    for ( int d = 0; d != 3; ++d ) coeffs.push_back( lid_it->normal()(d) );
+                    gids     .push_back( lid_it->getTag(PrimitiveT::TAGS::GID      ) );
+                    dids     .push_back( lid_it->getTag(PrimitiveT::TAGS::DIR_GID  ) );
+                    statuses .push_back( lid_it->getTag(PrimitiveT::TAGS::STATUS   ) );
+                    genAngles.push_back( lid_it->getTag(PrimitiveT::TAGS::GEN_ANGLE) );
+                }
+            }
+
+            std::vector<BinaryColumns::ColumnData> columns;
+            columns.push_back( BinaryColumns::ColumnData(BinaryColumns::COEFFS   , BinaryColumns::FLOAT32, entryLength, coeffs   .data()) );
+            columns.push_back( BinaryColumns::ColumnData(BinaryColumns::GID      , BinaryColumns::INT32  , 1          , gids     .data()) );
+            columns.push_back( BinaryColumns::ColumnData(BinaryColumns::DIR_GID  , BinaryColumns::INT32  , 1          , dids     .data()) );
+            columns.push_back( BinaryColumns::ColumnData(BinaryColumns::STATUS   , BinaryColumns::INT8   , 1          , statuses .data()) );
+            columns.push_back( BinaryColumns::ColumnData(BinaryColumns::GEN_ANGLE, BinaryColumns::FLOAT32, 1          , genAngles.data()) );
+
+            int err = BinaryColumns::write( path, BinaryColumns::PRIMITIVES, gids.size(), columns );
+            if ( verbose && (EXIT_SUCCESS == err) ) std::cout << "[" << __func__ << "]: " << "saved " << path << std::endl;
+            return err;
+        } //...savePrimitivesBinary()
+
+        //! \brief Binary counterpart of \ref readPrimitives, same output.
+        //! \tparam PatchT Concept: vector< \ref rapter::LinePrimitive2 >.
+        template < class PrimitiveT, class PatchT, class PrimitiveContainerT >
+        inline int readPrimitivesBinary( PrimitiveContainerT &lines, std::string const& path, std::map<GidT, typename PrimitiveContainerT::value_type> *patches = NULL )
+        {
+            typedef typename PrimitiveT::Scalar Scalar;
+            const int entryLength = PrimitiveT::getFileEntryLength();
+
+            BinaryColumns file;
+            if ( EXIT_SUCCESS != file.map(path) )
+                return EXIT_FAILURE;
+            float   const* coeffs    = file.column<float  >( BinaryColumns::COEFFS, entryLength );
+            int32_t const* gids      = file.column<int32_t>( BinaryColumns::GID       );
+            int32_t const* dids      = file.column<int32_t>( BinaryColumns::DIR_GID   );
+            int8_t  const* statuses  = file.column<int8_t >( BinaryColumns::STATUS    );
+            float   const* genAngles = file.column<float  >( BinaryColumns::GEN_ANGLE );
+            if ( (file.kind() != BinaryColumns::PRIMITIVES) || !coeffs || !gids || !dids || !statuses || !genAngles )
+            {
+                std::cerr << "[" << __func__ << "]: " << path << " does not contain primitives" << std::endl;
+                return EXIT_FAILURE;
+            }
+
+            std::map<GidT, PatchT> tmp_lines;
+            std::vector<Scalar>    floats( entryLength );
+            for ( uint64_t row = 0; row != file.rows(); ++row )
+            {
+                const GidT gid = gids[row];
+                if ( gid < 0 )
+                    throw new std::runtime_error("[io::readPrimitivesBinary] code not up to date to handle gid==-1 cases, please add proper GID to primitives");
+
+                std::copy( coeffs + row * entryLength, coeffs + (row+1) * entryLength, floats.begin() );
+                tmp_lines[ gid ].push_back( PrimitiveT::fromFileEntry(floats) );
+                tmp_lines[ gid ].back().setTag( PrimitiveT::TAGS::GID      , gid            );
+                tmp_lines[ gid ].back().setTag( PrimitiveT::TAGS::DIR_GID  , dids[row]      );
+                tmp_lines[ gid ].back().setTag( PrimitiveT::TAGS::STATUS   , statuses[row]  );
+                tmp_lines[ gid ].back().setTag( PrimitiveT::TAGS::GEN_ANGLE, genAngles[row] );
+            }
+
+            // copy all patches from map to vector (so that there are no empty patches in the vector)
+            for ( typename std::map<GidT, PatchT>::const_iterator it = tmp_lines.begin(); it != tmp_lines.end(); ++it )
+            {
+                lines.push_back( PatchT() );
+                lines.back().insert( lines.back().end(), it->second.begin(), it->second.end() );
+            }
+            if ( patches )
+                *patches = tmp_lines;
+
+            return EXIT_SUCCESS;
+        } //...readPrimitivesBinary()
+
+        //! \brief Writes pid, gid and dir_gid (-1) columns, same content as \ref writeAssociations.
+        template < class _PointPrimitiveT, class _PointContainerT >
+        inline int writeAssociationsBinary( _PointContainerT const& points, std::string const& path )
+        {
+            std::vector<int32_t> pids( points.size() ), gids( points.size() ), dids( points.size(), -1 );
+            for ( size_t pid = 0; pid != points.size(); ++pid )
+            {
+                pids[pid] = points[pid].getTag( _PointPrimitiveT::TAGS::PID );
+                gids[pid] = points[pid].getTag( _PointPrimitiveT::TAGS::GID );
+            }
+
+            std::vector<BinaryColumns::ColumnData> columns;
+            columns.push_back( BinaryColumns::ColumnData(BinaryColumns::PID    , BinaryColumns::INT32, 1, pids.data()) );
+            columns.push_back( BinaryColumns::ColumnData(BinaryColumns::GID    , BinaryColumns::INT32, 1, gids.data()) );
+            columns.push_back( BinaryColumns::ColumnData(BinaryColumns::DIR_GID, BinaryColumns::INT32, 1, dids.data()) );
+
+            int err = BinaryColumns::write( path, BinaryColumns::ASSOCIATIONS, points.size(), columns );
+            if ( EXIT_SUCCESS == err ) std::cout << "[" << __func__ << "]: " << "wrote to " << path << std::endl;
+            return err;
+        } //...writeAssociationsBinary()
+
+        //! \brief Binary counterpart of \ref readAssociations, same output.
+        inline int readAssociationsBinary( std::vector<std::pair<PidT,LidT> >      & points_primitives
+                                         , std::string                        const& path
+                                         , std::map<PidT,LidT>                     * linear_indices )
+        {
+            BinaryColumns file;
+            if ( EXIT_SUCCESS != file.map(path) )
+                return EXIT_FAILURE;
+            int32_t const* pids = file.column<int32_t>( BinaryColumns::PID     );
+            int32_t const* gids = file.column<int32_t>( BinaryColumns::GID     );
+            int32_t const* dids = file.column<int32_t>( BinaryColumns::DIR_GID );
+            if ( (file.kind() != BinaryColumns::ASSOCIATIONS) || !pids || !gids || !dids )
+            {
+                std::cerr << "[" << __func__ << "]: " << path << " does not contain associations" << std::endl;
+                return EXIT_FAILURE;
+            }
+
+            std::set< std::pair<LidT,LidT> > lines;
+            for ( uint64_t row = 0; row != file.rows(); ++row )
+            {
+                if ( static_cast<LidT>(points_primitives.size()) <= pids[row] )
+                    points_primitives.resize( pids[row]+1, std::pair<LidT,LidT>(-1,-1) );
+                points_primitives[ pids[row] ] = std::pair<LidT,LidT>( gids[row], dids[row] );
+
+                if ( linear_indices )
+                {
+                    lines.insert( std::pair<LidT,LidT>(gids[row], dids[row]) );
+                    (*linear_indices)[ pids[row] ] = lines.size() - 1; // assumes sorted set
+                }
+            }
+
+            return EXIT_SUCCESS;
+        } //...readAssociationsBinary()
+
+        //! \brief Writes position and normal columns of points.
+        template < class _PointT, class _PointContainerT >
+        inline int writePointsBinary( _PointContainerT const& points, std::string const& path )
+        {
+            std::vector<float> positions( points.size() * 3 ), normals( points.size() * 3 );
+            for ( size_t pid = 0; pid != points.size(); ++pid )
+                for ( int d = 0; d != 3; ++d )
+                {
+                    positions[ pid * 3 + d ] = points[pid].template pos()(d);
+                    normals  [ pid * 3 + d ] = points[pid].template dir()(d);
+                }
+
+            std::vector<BinaryColumns::ColumnData> columns;
+            columns.push_back( BinaryColumns::ColumnData(BinaryColumns::POS   , BinaryColumns::FLOAT32, 3, positions.data()) );
+            columns.push_back( BinaryColumns::ColumnData(BinaryColumns::NORMAL, BinaryColumns::FLOAT32, 3, normals  .data()) );
+            return BinaryColumns::write( path, BinaryColumns::POINTS, points.size(), columns );
+        } //...writePointsBinary()
+
+        //! \brief Binary counterpart of \ref readPoints, PID and GID are set to the point index.
+        template < class _PointT, class _PointContainerT >
+        inline int readPointsBinary( _PointContainerT &points, std::string const& path )
+        {
+            BinaryColumns file;
+            if ( EXIT_SUCCESS != file.map(path) )
+                return EXIT_FAILURE;
+            float const* positions = file.column<float>( BinaryColumns::POS   , 3 );
+            float const* normals   = file.column<float>( BinaryColumns::NORMAL, 3 );
+            if ( (file.kind() != BinaryColumns::POINTS) || !positions || !normals )
+            {
+                std::cerr << "[" << __func__ << "]: " << path << " does not contain points" << std::endl;
+                return EXIT_FAILURE;
+            }
+
+            points.reserve( points.size() + file.rows() );
+            typename _PointT::VectorType raw;
+            for ( uint64_t pid = 0; pid != file.rows(); ++pid )
+            {
+                for ( int d = 0; d != 3; ++d )
+                {
+                    raw( d     ) = positions[ pid * 3 + d ];
+                    raw( d + 3 ) = normals  [ pid * 3 + d ];
+                }
+                points.emplace_back( _PointT(raw) );
+                points.back().setTag( _PointT::TAGS::PID, pid );
+                points.back().setTag( _PointT::TAGS::GID, pid );
+            }
+
+            return EXIT_SUCCESS;
+        } //...readPointsBinary()
+    } //...ns io
+} //...ns rapter
+
+#endif // RAPTER_BINARYIO_HPP
@@ -17,6 +17,9 @@
 #include "rapter/util/pclUtil.h"
 #include "rapter/util/impl/pclUtil.hpp"
 #include "rapter/util/containers.hpp"
+#include "rapter/io/binaryIo.hpp"           // BinaryColumns
+#include "rapter/io/plyReader.hpp"          // PlyReader
+#include "rapter/primitives/extentCache.h"  // ExtentCache
 
 
 namespace rapter
@@ -27,7 +30,8 @@ namespace rapter
         //typedef          pcl::PointCloud<PclPointT> PclCloudT;
         //typedef typename PclCloudT::Ptr             PclCloudPtrT;
 
-        //! \brief Dumps primitives with GID and DIR_GID to disk.
+        //! \brief Dumps primitives with GID and DIR_GID to disk. Writes \ref BinaryColumns instead of CSV, if \ref useBinary().
+        //!        Writes the \ref ExtentCache to "<out_file_name>.extents", if it is persistent.
         //! \tparam PrimitiveT Concept: PrimitiveContainerT::value_type::value_type aka rapter::LinePrimitive2.
         //! \tparam PrimitiveContainerT Concept: vector< vector< rapter::LinePrimitive2 > >.
         template <class PrimitiveT, class _inner_const_iterator, class PrimitiveContainerT> inline int
@@ -41,6 +45,13 @@ namespace rapter
             //const int Dim = PrimitiveT::Dim;
             typedef typename PrimitiveT::VectorType VectorType;
 
+            // extents of this iteration, for the next invocation to read back next to the primitives
+            if ( ExtentCache::instance().isPersistent() )
+                ExtentCache::instance().save( ExtentCache::sideFile(out_file_name) );
+
+            if ( useBinary(out_file_name) )
+                return savePrimitivesBinary<PrimitiveT,_inner_const_iterator>( primitives, out_file_name, verbose );
+
             // out_lines
             std::string parent_path = boost::filesystem::path(out_file_name).parent_path().string();
             if ( !parent_path.empty() )
@@ -79,7 +90,8 @@ namespace rapter
             return EXIT_SUCCESS;
         }
 
-        //! \brief Reads primitives with their GIDs and dir_GIDs from file.
+        //! \brief Reads primitives with their GIDs and dir_GIDs from file. Recognizes \ref BinaryColumns by its magic bytes.
+        //!        Loads "<path>.extents" into the \ref ExtentCache, if it is persistent.
         //! \tparam PatchT Concept: vector< \ref rapter::LinePrimitive2 >.
         template <
                    class       PrimitiveT          /*= typename PrimitiveContainerT::value_type::value_type*/
@@ -98,6 +110,12 @@ namespace rapter
             //typedef typename PrimitiveContainerT::value_type PatchT;
             typedef std::map<GidT, PatchT>                    PatchMap; // <GID, vector<primitives> >
 
+            if ( ExtentCache::instance().isPersistent() && boost::filesystem::exists(ExtentCache::sideFile(path)) )
+                ExtentCache::instance().load( ExtentCache::sideFile(path) );
+
+            if ( BinaryColumns::isBinary(path) )
+                return readPrimitivesBinary<PrimitiveT,PatchT>( lines, path, patches );
+
             // open file
             std::ifstream file( path.c_str() );
             if ( !file.is_open() )
@@ -197,7 +215,7 @@ namespace rapter
             return EXIT_SUCCESS;
         } // ... readPrimitives()
 
-        //! \brief                      Reads point-primitive associations from file
+        //! \brief                      Reads point-primitive associations from file. Recognizes \ref BinaryColumns by its magic bytes.
         //! \param points_primitives    [Out]    points_primitives[pid] = pair<lid,lid1>
         //! \param path                 [In]     Path of file to read
         //! \param linear_indices       [In/Out] If not null, will get filled like this: linear_indices[pid] = line_id
@@ -206,6 +224,9 @@ namespace rapter
                                      , std::string                    const& path
                                      , std::map<PidT,LidT>                   * linear_indices )
         {
+            if ( BinaryColumns::isBinary(path) )
+                return readAssociationsBinary( points_primitives, path, linear_indices );
+
             std::ifstream f( path.c_str() );
             if ( !f.is_open() )
             {
@@ -253,7 +274,7 @@ namespace rapter
             return EXIT_SUCCESS;
         } // ... readAssociations
 
-        //! \brief                       Write points' associations to GID and DIR_GID.
+        //! \brief                       Write points' associations to GID and DIR_GID. Writes \ref BinaryColumns instead of CSV, if \ref useBinary().
         //! \tparam     _PointPrimitiveT Concept: \ref rapter::PointPrimitive.
         //! \tparam     _PointContainerT Concept: vector< \ref rapter::PointPrimitive >
         //! \param[in]  points           Output point vector
@@ -265,6 +286,9 @@ namespace rapter
         inline int writeAssociations( _PointContainerT const& points
                                     , std::string const& f_assoc_path )
         {
+            if ( useBinary(f_assoc_path) )
+                return writeAssociationsBinary<_PointPrimitiveT>( points, f_assoc_path );
+
             // open
             std::ofstream f_assoc( f_assoc_path );
             if ( !f_assoc.is_open() ) { std::cerr << "[" << __func__ << "]: " << "could not open " << f_assoc_path << " for writing..." << std::endl; return EXIT_FAILURE; }
@@ -287,7 +311,24 @@ namespace rapter
             return EXIT_SUCCESS;
         } //...writeAssociations
 
-        //! \brief                    Read stored points, and convert them to non-PCL format.
+        //! \brief                    Copies \p points from \p offset on to a new PCL cloud.
+        template < class _PointContainerT >
+        inline PclCloudPtrT toPclCloud( _PointContainerT const& points, size_t const offset = 0 )
+        {
+            PclCloudPtrT cloud( new PclCloudT() );
+            cloud->reserve( points.size() - offset );
+            for ( size_t pid = offset; pid != points.size(); ++pid )
+            {
+                pcl::PointNormal pnt;
+                pnt.getVector3fMap()       = points[pid].template pos().template cast<float>();
+                pnt.getNormalVector3fMap() = points[pid].template dir().template cast<float>();
+                cloud->push_back( pnt );
+            }
+            return cloud;
+        }
+
+        //! \brief                    Read stored points, and convert them to non-PCL format. Recognizes \ref BinaryColumns and PLY by their magic bytes.
+        //!                           PLY files are parsed straight into \p points by \ref PlyReader, PCL only reads PCD files, and PLY files \ref PlyReader does not support.
         //! \param[out] points        Output point vector
         //! \param[in]  path          PLY source path
         //! \return                   EXIT_SUCCESS
@@ -302,6 +343,36 @@ namespace rapter
         {
             pcl::PointCloud<pcl::PointNormal>::Ptr cloud;
 
+            if ( BinaryColumns::isBinary(path) )
+            {
+                const size_t offset = points.size();
+                if ( EXIT_SUCCESS != readPointsBinary<_PointT>(points, path) )
+                    return EXIT_FAILURE;
+
+                if ( cloud_arg )
+                    *cloud_arg = toPclCloud( points, offset );
+                return EXIT_SUCCESS;
+            }
+
+            if ( PlyReader::isPly(path) )
+            {
+                const size_t offset = points.size();
+                PlyReader    reader;
+                if ( EXIT_SUCCESS == reader.open(path) )
+                {
+                    if ( EXIT_SUCCESS != reader.read<_PointT>(points) )
+                    {
+                        points.resize( offset );
+                        return EXIT_FAILURE;
+                    }
+
+                    if ( cloud_arg )
+                        *cloud_arg = toPclCloud( points, offset );
+                    return EXIT_SUCCESS;
+                }
+                std::cout << "[" << __func__ << "]: " << "falling back to PCL for " << path << std::endl;
+            }
+
             // sample image
             if ( !cloud ) cloud.reset( new PclCloudT() );
             if ( path.find("ply") != std::string::npos )
@@ -330,7 +401,86 @@ namespace rapter
             return EXIT_SUCCESS;
         } // ...Solver::readPoints()
 
-        //! \brief                   Write points to almost PLY
+        /*! \brief                    Hands the points of \p path to \p onChunk in chunks of at most \p chunkSize points, without keeping the cloud in memory.
+         *                            Binary point containers are memory mapped and streamed, PLY files are streamed by \ref PlyReader.
+         *                            Other formats are read by \ref readPoints as a whole first.
+         *  \tparam _ChunkFunctorT    Called as int onChunk( std::vector<_PointT> const& chunk, PidT firstPid ), stops the stream, unless it returns EXIT_SUCCESS.
+         *  \param[in] path           Cloud to read.
+         *  \param[in] chunkSize      Points per call.
+         *  \return                   EXIT_SUCCESS, the first failing return value of \p onChunk, or EXIT_FAILURE, if \p path could not be read.
+         */
+        template < class _PointT, class _ChunkFunctorT >
+        inline int streamPoints( std::string const& path, size_t const chunkSize, _ChunkFunctorT &onChunk )
+        {
+            std::vector<_PointT> chunk;
+            chunk.reserve( chunkSize );
+
+            if ( BinaryColumns::isBinary(path) )
+            {
+                BinaryColumns file;
+                if ( EXIT_SUCCESS != file.map(path) )
+                    return EXIT_FAILURE;
+                float const* positions = file.column<float>( BinaryColumns::POS   , 3 );
+                float const* normals   = file.column<float>( BinaryColumns::NORMAL, 3 );
+                if ( (file.kind() != BinaryColumns::POINTS) || !positions || !normals )
+                {
+                    std::cerr << "[" << __func__ << "]: " << path << " does not contain points" << std::endl;
+                    return EXIT_FAILURE;
+                }
+
+                typename _PointT::VectorType raw;
+                for ( uint64_t first = 0; first < file.rows(); first += chunkSize )
+                {
+                    chunk.clear();
+                    for ( uint64_t pid = first; pid != std::min(file.rows(), uint64_t(first + chunkSize)); ++pid )
+                    {
+                        for ( int d = 0; d != 3; ++d )
+                        {
+                            raw( d     ) = positions[ pid * 3 + d ];
+                            raw( d + 3 ) = normals  [ pid * 3 + d ];
+                        }
+                        chunk.push_back( _PointT(raw) );
+                        chunk.back().setTag( _PointT::TAGS::PID, pid );
+                        chunk.back().setTag( _PointT::TAGS::GID, pid );
+                    }
+
+                    int err = onChunk( chunk, PidT(first) );
+                    if ( EXIT_SUCCESS != err )
+                        return err;
+                }
+                return EXIT_SUCCESS;
+            } //...binary
+
+            PlyReader reader;
+            if ( PlyReader::isPly(path) && (EXIT_SUCCESS == reader.open(path)) )
+            {
+                for ( PidT first = 0; first < PidT(reader.getVertexCount()); first += chunk.size() )
+                {
+                    chunk.clear();
+                    if ( EXIT_SUCCESS != reader.next<_PointT>(chunk, chunkSize) )
+                        return EXIT_FAILURE;
+
+                    int err = onChunk( chunk, first );
+                    if ( EXIT_SUCCESS != err )
+                        return err;
+                }
+                return EXIT_SUCCESS;
+            } //...ply
+
+            std::vector<_PointT> points;
+            if ( EXIT_SUCCESS != readPoints<_PointT>(points, path) )
+                return EXIT_FAILURE;
+            for ( size_t first = 0; first < points.size(); first += chunkSize )
+            {
+                chunk.assign( points.begin() + first, points.begin() + std::min(points.size(), first + chunkSize) );
+                int err = onChunk( chunk, PidT(first) );
+                if ( EXIT_SUCCESS != err )
+                    return err;
+            }
+            return EXIT_SUCCESS;
+        } //...streamPoints()
+
+        //! \brief                   Write points to almost PLY, or to \ref BinaryColumns, if \p path ends in ".rbin".
         //! \param[in] points        Points
         //! \param[in] path          PLY destination path
         //! \return EXIT_SUCCESS
@@ -341,6 +491,9 @@ namespace rapter
         writePoints( _PointContainerT &points
                    , std::string       path )
         {
+            if ( useBinary(path, /* points: */ true) )
+                return writePointsBinary<_PointT>( points, path );
+
             std::ofstream file( path.c_str() );
             if ( ! file.is_open() ) { std::cerr << "[" << __func__ << "]: " << "could not open " << path << std::endl; return EXIT_FAILURE; }
 
@@ -0,0 +1,479 @@
+#ifndef RAPTER_PLYREADER_HPP
+#define RAPTER_PLYREADER_HPP
+
+#include <vector>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include <algorithm>                            // std::min, std::reverse
+#include <cstdlib>                              // strtod
+#include <cstring>                              // memcpy
+#include <stdint.h>
+
+#include "omp.h"
+
+#include "rapter/simpleTypes.h"                 // PidT
+
+namespace rapter
+{
+    namespace io
+    {
+        /*! \brief Streaming reader for the vertices of ASCII, and little and big endian binary PLY files.
+         *
+         *  Only the position ("x,y,z") and normal ("nx,ny,nz" or "normal_x,normal_y,normal_z") properties of the "vertex" element are decoded,
+         *  all other properties are skipped. Missing normals are read as zero.
+         *  The vertices are read in chunks straight into the point container, so no intermediate cloud is kept.
+         *  ASCII chunks are split at line ends and parsed by all OpenMP threads, binary chunks are decoded in parallel.
+         *  Vertex elements with list properties are not supported, \ref open fails on them, so that the caller can fall back to PCL.
+         */
+        class PlyReader
+        {
+            public:
+                enum FORMAT { ASCII = 0, BINARY_LITTLE_ENDIAN = 1, BINARY_BIG_ENDIAN = 2 };
+                enum TYPE   { INVALID = 0, INT8, UINT8, INT16, UINT16, INT32, UINT32, FLOAT32, FLOAT64, LIST };
+
+                //! \brief A scalar vertex property.
+                struct Property
+                {
+                    std::string name;
+                    int         type;
+                    int         offset;     //!< \brief Byte offset in a binary vertex.
+                };
+
+                //! \param[in] threads  OpenMP threads to parse with, 0 for omp_get_max_threads().
+                PlyReader( int const threads = 0 )
+                    : _threads( threads ), _format( ASCII ), _vertexCount( 0 ), _stride( 0 ), _skipLines( 0 ), _read( 0 ), _begin( 0 ), _end( 0 ), _eof( false )
+                {
+                    std::fill( _slots, _slots + 6, -1 );
+                }
+
+                //! \brief Checks the magic line at the beginning of \p path.
+                static inline bool isPly( std::string const& path )
+                {
+                    std::ifstream f( path.c_str(), std::ios::binary );
+                    char magic[4];
+                    if ( !f.is_open() || !f.read(magic, 4) )
+                        return false;
+                    return (magic[0] == 'p') && (magic[1] == 'l') && (magic[2] == 'y') && ((magic[3] == '\n') || (magic[3] == '\r'));
+                }
+
+                /*! \brief Parses the header of \p path, and positions the stream at the first vertex.
+                 *  \return EXIT_SUCCESS, if \p path is a PLY file with a supported vertex element.
+                 */
+                inline int open( std::string const& path )
+                {
+                    _file.close();
+                    _file.clear();
+                    _file.open( path.c_str(), std::ios::binary );
+                    if ( !_file.is_open() ) { std::cerr << "[" << __func__ << "]: " << "could not open " << path << std::endl; return EXIT_FAILURE; }
+
+                    _props.clear();
+                    std::fill( _slots, _slots + 6, -1 );
+                    _vertexCount = _stride = _skipLines = _read = _begin = _end = 0;
+                    _eof = false;
+
+                    std::string line, keyword;
+                    std::getline( _file, line );
+                    if ( trim(line) != "ply" ) { std::cerr << "[" << __func__ << "]: " << path << " is not a PLY file" << std::endl; return EXIT_FAILURE; }
+
+                    // elements before "vertex" have to be skipped: by line in ASCII, by bytes in binary
+                    uint64_t skipBytes     = 0;
+                    uint64_t count         = 0;
+                    int      elementStride = 0;
+                    bool     inVertex      = false, foundVertex = false, hasList = false, gotFormat = false;
+                    while ( std::getline(_file, line) )
+                    {
+                        std::istringstream ss( trim(line) );
+                        ss >> keyword;
+                        if ( keyword == "format" )
+                        {
+                            std::string format;
+                            ss >> format;
+                            if      ( format == "ascii"                ) _format = ASCII;
+                            else if ( format == "binary_little_endian" ) _format = BINARY_LITTLE_ENDIAN;
+                            else if ( format == "binary_big_endian"    ) _format = BINARY_BIG_ENDIAN;
+                            else { std::cerr << "[" << __func__ << "]: " << "unknown format " << format << std::endl; return EXIT_FAILURE; }
+                            gotFormat = true;
+                        }
+                        else if ( (keyword == "element") || (keyword == "end_header") )
+                        {
+                            // close previous element
+                            if ( !foundVertex && !inVertex && count )
+                            {
+                                if ( hasList && (_format != ASCII) ) { std::cerr << "[" << __func__ << "]: " << "can not skip list properties before the vertices" << std::endl; return EXIT_FAILURE; }
+                                skipBytes  += count * elementStride;
+                                _skipLines += count;
+                            }
+                            if ( inVertex )
+                            {
+                                foundVertex = true;
+                                inVertex    = false;
+                            }
+                            if ( keyword == "end_header" )
+                                break;
+
+                            std::string name;
+                            ss >> name >> count;
+                            elementStride = 0;
+                            hasList       = false;
+                            if ( !foundVertex && (name == "vertex") )
+                            {
+                                inVertex     = true;
+                                _vertexCount = count;
+                            }
+                        }
+                        else if ( keyword == "property" )
+                        {
+                            std::string typeName, name;
+                            ss >> typeName;
+                            const int type = typeOf( typeName );
+                            if ( type == LIST )
+                            {
+                                hasList = true;
+                                if ( inVertex ) { std::cerr << "[" << __func__ << "]: " << "list properties of vertices are not supported" << std::endl; return EXIT_FAILURE; }
+                                continue;
+                            }
+                            if ( type == INVALID ) { std::cerr << "[" << __func__ << "]: " << "unknown property type " << typeName << std::endl; return EXIT_FAILURE; }
+                            ss >> name;
+
+                            if ( inVertex )
+                            {
+                                Property prop;
+                                prop.name   = name;
+                                prop.type   = type;
+                                prop.offset = _stride;
+                                _props.push_back( prop );
+                                _stride += sizeOf( type );
+                            }
+                            else
+                                elementStride += sizeOf( type );
+                        }
+                        // "comment", "obj_info" skipped
+                    } //...header
+
+                    if ( !gotFormat || !foundVertex ) { std::cerr << "[" << __func__ << "]: " << path << " has no format or vertex element" << std::endl; return EXIT_FAILURE; }
+
+                    const char* names[2][6] = { { "x", "y", "z", "nx"      , "ny"      , "nz"       }
+                                              , { "x", "y", "z", "normal_x", "normal_y", "normal_z" } };
+                    for ( int slot = 0; slot != 6; ++slot )
+                        for ( size_t p = 0; (p != _props.size()) && (_slots[slot] < 0); ++p )
+                            if ( (_props[p].name == names[0][slot]) || (_props[p].name == names[1][slot]) )
+                                _slots[ slot ] = p;
+                    if ( (_slots[0] < 0) || (_slots[1] < 0) || (_slots[2] < 0) ) { std::cerr << "[" << __func__ << "]: " << path << " has no vertex positions" << std::endl; return EXIT_FAILURE; }
+
+                    if ( _format == ASCII )
+                    {
+                        for ( uint64_t l = 0; l != _skipLines; ++l )
+                            std::getline( _file, line );
+                    }
+                    else
+                        _file.seekg( skipBytes, std::ios::cur );
+
+                    return _file.good() ? EXIT_SUCCESS : EXIT_FAILURE;
+                } //...open()
+
+                inline int      getFormat     () const { return _format; }
+                inline uint64_t getVertexCount() const { return _vertexCount; }
+                //! \brief Whether the vertices have normals.
+                inline bool     hasNormals    () const { return (_slots[3] >= 0) && (_slots[4] >= 0) && (_slots[5] >= 0); }
+
+                /*! \brief Reads the next at most \p maxPoints vertices, and appends them to \p points.
+                 *  \param[in,out] points   Points with PID and GID set to their vertex index in the file, appended.
+                 *  \return                 EXIT_SUCCESS, also after the last vertex, when nothing is appended, EXIT_FAILURE on malformed or truncated files.
+                 */
+                template <class _PointT, class _PointContainerT>
+                inline int next( _PointContainerT &points, size_t const maxPoints )
+                {
+                    const size_t n = std::min( uint64_t(maxPoints), _vertexCount - _read );
+                    if ( !n )
+                        return EXIT_SUCCESS;
+                    return _format == ASCII ? this->nextAscii<_PointT>( points, n )
+                                            : this->nextBinary<_PointT>( points, n );
+                }
+
+                /*! \brief Reads all remaining vertices to \p points.
+                 *  \param[in,out] points   Points with PID and GID set to their vertex index in the file, appended.
+                 */
+                template <class _PointT, class _PointContainerT>
+                inline int read( _PointContainerT &points )
+                {
+                    points.reserve( points.size() + _vertexCount - _read );
+                    while ( _read < _vertexCount )
+                    {
+                        const size_t before = points.size();
+                        if ( EXIT_SUCCESS != this->next<_PointT>(points, 1 << 20) )
+                            return EXIT_FAILURE;
+                        if ( points.size() == before ) { std::cerr << "[" << __func__ << "]: " << "file ended after " << _read << " of " << _vertexCount << " vertices" << std::endl; return EXIT_FAILURE; }
+                    }
+                    return EXIT_SUCCESS;
+                }
+
+            protected:
+                static inline std::string trim( std::string const& line )
+                {
+                    const size_t first = line.find_first_not_of( " \t\r" );
+                    if ( first == std::string::npos )
+                        return std::string();
+                    return line.substr( first, line.find_last_not_of(" \t\r") - first + 1 );
+                }
+
+                static inline int typeOf( std::string const& name )
+                {
+                    if ( name == "char"   || name == "int8"    ) return INT8;
+                    if ( name == "uchar"  || name == "uint8"   ) return UINT8;
+                    if ( name == "short"  || name == "int16"   ) return INT16;
+                    if ( name == "ushort" || name == "uint16"  ) return UINT16;
+                    if ( name == "int"    || name == "int32"   ) return INT32;
+                    if ( name == "uint"   || name == "uint32"  ) return UINT32;
+                    if ( name == "float"  || name == "float32" ) return FLOAT32;
+                    if ( name == "double" || name == "float64" ) return FLOAT64;
+                    if ( name == "list" )                        return LIST;
+                    return INVALID;
+                }
+
+                static inline int sizeOf( int const type )
+                {
+                    switch ( type )
+                    {
+                        case INT8:    case UINT8:   return 1;
+                        case INT16:   case UINT16:  return 2;
+                        case INT32:   case UINT32:  case FLOAT32: return 4;
+                        case FLOAT64:               return 8;
+                        default:                    return 0;
+                    }
+                }
+
+                //! \brief Decodes a binary property at \p data, swapping its bytes, if \p swap.
+                static inline double decode( char const* data, int const type, bool const swap )
+                {
+                    char bytes[8];
+                    const int size = sizeOf( type );
+                    std::memcpy( bytes, data, size );
+                    if ( swap )
+                        std::reverse( bytes, bytes + size );
+
+                    switch ( type )
+                    {
+                        case INT8:    { int8_t   v; std::memcpy( &v, bytes, 1 ); return v; }
+                        case UINT8:   { uint8_t  v; std::memcpy( &v, bytes, 1 ); return v; }
+                        case INT16:   { int16_t  v; std::memcpy( &v, bytes, 2 ); return v; }
+                        case UINT16:  { uint16_t v; std::memcpy( &v, bytes, 2 ); return v; }
+                        case INT32:   { int32_t  v; std::memcpy( &v, bytes, 4 ); return v; }
+                        case UINT32:  { uint32_t v; std::memcpy( &v, bytes, 4 ); return v; }
+                        case FLOAT32: { float    v; std::memcpy( &v, bytes, 4 ); return v; }
+                        case FLOAT64: { double   v; std::memcpy( &v, bytes, 8 ); return v; }
+                        default:      return 0.;
+                    }
+                }
+
+                static inline bool isBlank( char const c ) { return (c == ' ') || (c == '\t') || (c == '\r'); }
+
+                /*! \brief Parses a decimal number at \p p, and moves \p p behind it. Falls back to strtod for anything but [+-]digits[.digits][e[+-]digits].
+                 *  \return false, if there was no number at \p p.
+                 */
+                static inline bool parseNumber( char const* &p, double &value )
+                {
+                    char const* start = p;
+                    bool negative = false;
+                    if ( (*p == '-') || (*p == '+') )
+                        negative = (*p++ == '-');
+
+                    uint64_t mantissa = 0;
+                    int      exponent = 0, digits = 0;
+                    for ( ; (*p >= '0') && (*p <= '9'); ++p, ++digits )
+                    {
+                        if ( mantissa < (uint64_t(1) << 59) ) mantissa = mantissa * 10 + (*p - '0');
+                        else                                  ++exponent;
+                    }
+                    if ( *p == '.' )
+                        for ( ++p; (*p >= '0') && (*p <= '9'); ++p, ++digits )
+                            if ( mantissa < (uint64_t(1) << 59) ) { mantissa = mantissa * 10 + (*p - '0'); --exponent; }
+                    if ( digits && ((*p == 'e') || (*p == 'E')) )
+                    {
+                        char const* e = p + 1;
+                        bool negativeExp = false;
+                        if ( (*e == '-') || (*e == '+') )
+                            negativeExp = (*e++ == '-');
+                        int exp = 0;
+                        if ( (*e >= '0') && (*e <= '9') )
+                        {
+                            for ( ; (*e >= '0') && (*e <= '9'); ++e )
+                                if ( exp < 10000 ) exp = exp * 10 + (*e - '0');
+                            exponent += negativeExp ? -exp : exp;
+                            p = e;
+                        }
+                    }
+
+                    if ( !digits || (!isBlank(*p) && (*p != '\n') && (*p != '\0')) || (exponent < -300) || (exponent > 300) )
+                    {
+                        // nan, inf, hex, or out of the fast path's range
+                        char* end = NULL;
+                        value = strtod( start, &end );
+                        p = end;
+                        return end != start;
+                    }
+
+                    static const double pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+                    value = double( mantissa );
+                    for ( ; exponent >  22; exponent -= 22 ) value *= 1e22;
+                    for ( ; exponent < -22; exponent += 22 ) value /= 1e22;
+                    value = exponent < 0 ? value / pow10[-exponent] : value * pow10[exponent];
+                    if ( negative )
+                        value = -value;
+                    return true;
+                } //...parseNumber()
+
+                //! \brief Parses the vertex line at \p p to \p raw, zero normals, if there are none.
+                inline bool parseLine( char const* p, double raw[6] ) const
+                {
+                    std::fill( raw, raw + 6, 0. );
+                    for ( size_t prop = 0; prop != _props.size(); ++prop )
+                    {
+                        while ( isBlank(*p) ) ++p;
+                        if ( (*p == '\n') || (*p == '\0') )
+                            return false;
+
+                        int slot = 0;
+                        while ( (slot != 6) && (_slots[slot] != int(prop)) ) ++slot;
+                        if ( slot == 6 )
+                        {
+                            // skip not needed property
+                            while ( !isBlank(*p) && (*p != '\n') && (*p != '\0') ) ++p;
+                            continue;
+                        }
+
+                        if ( !parseNumber(p, raw[slot]) )
+                            return false;
+                    }
+                    return true;
+                }
+
+                template <class _PointT, class _PointContainerT>
+                inline void setPoint( _PointContainerT &points, size_t const i, PidT const pid, double const raw[6] ) const
+                {
+                    typename _PointT::VectorType coeffs;
+                    for ( int d = 0; d != 6; ++d )
+                        coeffs( d ) = raw[ d ];
+                    points[ i ] = _PointT( coeffs );
+                    points[ i ].setTag( _PointT::TAGS::PID, pid );
+                    points[ i ].setTag( _PointT::TAGS::GID, pid );
+                }
+
+                inline int threads() const { return _threads > 0 ? _threads : std::max( 1, omp_get_max_threads() ); }
+
+                template <class _PointT, class _PointContainerT>
+                inline int nextBinary( _PointContainerT &points, size_t const n )
+                {
+                    _buffer.resize( n * _stride );
+                    if ( !_file.read(&_buffer[0], n * _stride) ) { std::cerr << "[" << __func__ << "]: " << "file ended before vertex " << _read + n << " of " << _vertexCount << std::endl; return EXIT_FAILURE; }
+
+                    const bool   swap   = (_format == BINARY_BIG_ENDIAN) == isLittleEndian();
+                    const size_t offset = points.size();
+                    points.resize( offset + n );
+#                   pragma omp parallel for num_threads(this->threads()) schedule(static)
+                    for ( long i = 0; i < long(n); ++i )
+                    {
+                        char const* vertex = &_buffer[0] + i * _stride;
+                        double raw[6] = { 0., 0., 0., 0., 0., 0. };
+                        for ( int slot = 0; slot != 6; ++slot )
+                            if ( _slots[slot] >= 0 )
+                                raw[ slot ] = decode( vertex + _props[_slots[slot]].offset, _props[_slots[slot]].type, swap );
+                        this->setPoint<_PointT>( points, offset + i, _read + i, raw );
+                    }
+
+                    _read += n;
+                    return EXIT_SUCCESS;
+                } //...nextBinary()
+
+                template <class _PointT, class _PointContainerT>
+                inline int nextAscii( _PointContainerT &points, size_t const n )
+                {
+                    const int nThreads = this->threads();
+                    std::vector<size_t> lineEnds;
+                    while ( true )
+                    {
+                        // keep the unparsed tail, fill up the rest of the buffer
+                        if ( _begin )
+                        {
+                            std::copy( _buffer.begin() + _begin, _buffer.begin() + _end, _buffer.begin() );
+                            _end  -= _begin;
+                            _begin = 0;
+                        }
+                        if ( _buffer.size() < BlockBytes + 1 )
+                            _buffer.resize( BlockBytes + 1 );
+                        if ( !_eof && (_end + 1 < _buffer.size()) )
+                        {
+                            _file.read( &_buffer[_end], _buffer.size() - 1 - _end );
+                            _end += _file.gcount();
+                            _eof  = !_file.good();
+                        }
+                        _buffer[ _end ] = '\0';
+
+                        // find line ends in parallel, each thread in its byte range
+                        std::vector< std::vector<size_t> > threadEnds( nThreads );
+#                       pragma omp parallel num_threads(nThreads)
+                        {
+                            const int    tid   = omp_get_thread_num();
+                            const size_t first = _end * tid / nThreads, last = _end * (tid + 1) / nThreads;
+                            for ( size_t c = first; c != last; ++c )
+                                if ( _buffer[c] == '\n' )
+                                    threadEnds[ tid ].push_back( c );
+                        }
+                        lineEnds.clear();
+                        for ( int tid = 0; tid != nThreads; ++tid )
+                            lineEnds.insert( lineEnds.end(), threadEnds[tid].begin(), threadEnds[tid].end() );
+                        // last line without line end
+                        if ( _eof && _end && (lineEnds.empty() || (lineEnds.back() + 1 != _end)) )
+                            lineEnds.push_back( _end );
+
+                        if ( (lineEnds.size() >= n) || _eof )
+                            break;
+                        if ( lineEnds.empty() || (_end + 1 == _buffer.size()) )
+                            _buffer.resize( _buffer.size() * 2 );   // not even n lines fit, grow
+                        // else: buffer not full yet, read on
+                    } //...while not enough lines
+
+                    const size_t count = std::min( n, lineEnds.size() );
+                    if ( count < n ) { std::cerr << "[" << __func__ << "]: " << "file ended after " << _read + count << " of " << _vertexCount << " vertices" << std::endl; return EXIT_FAILURE; }
+
+                    const size_t offset = points.size();
+                    points.resize( offset + count );
+                    int errors = 0;
+#                   pragma omp parallel for num_threads(nThreads) schedule(static) reduction(+:errors)
+                    for ( long line = 0; line < long(count); ++line )
+                    {
+                        double raw[6];
+                        if ( !this->parseLine(&_buffer[0] + (line ? lineEnds[line - 1] + 1 : 0), raw) )
+                            ++errors;
+                        this->setPoint<_PointT>( points, offset + line, _read + line, raw );
+                    }
+                    if ( errors ) { std::cerr << "[" << __func__ << "]: " << errors << " malformed vertex lines after vertex " << _read << std::endl; return EXIT_FAILURE; }
+
+                    _begin = std::min( _end, lineEnds[count - 1] + 1 );
+                    _read += count;
+                    return EXIT_SUCCESS;
+                } //...nextAscii()
+
+                static inline bool isLittleEndian() { const uint16_t probe = 1; return *reinterpret_cast<char const*>(&probe) == 1; }
+
+                static const size_t BlockBytes = 1 << 24;  //!< \brief ASCII bytes read at once, grows, if a chunk's lines don't fit.
+
+                int                   _threads;
+                int                   _format;
+                uint64_t              _vertexCount;
+                int                   _stride;      //!< \brief Bytes per binary vertex.
+                uint64_t              _skipLines;   //!< \brief ASCII lines of elements before the vertices.
+                std::vector<Property> _props;       //!< \brief Vertex properties in file order.
+                int                   _slots[6];    //!< \brief Property index of x,y,z,nx,ny,nz, -1 if missing.
+
+                std::ifstream         _file;
+                uint64_t              _read;        //!< \brief Vertices read so far.
+                std::vector<char>     _buffer;
+                size_t                _begin, _end; //!< \brief Unparsed ASCII bytes in \ref _buffer.
+                bool                  _eof;
+        }; //...class PlyReader
+    } //...ns io
+} //...ns rapter
+
+#endif // RAPTER_PLYREADER_HPP
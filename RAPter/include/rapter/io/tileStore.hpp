@@ -0,0 +1,154 @@
+#ifndef RAPTER_TILESTORE_HPP
+#define RAPTER_TILESTORE_HPP
+
+#include <map>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include <stdint.h>
+
+#include "boost/filesystem.hpp"
+
+#include "rapter/simpleTypes.h"                 // PidT, GidT
+
+namespace rapter
+{
+    namespace io
+    {
+        /*! \brief Append-only point files, one per tile, in a directory. Used by \ref TiledPipeline to spill the cloud to disk tile by tile.
+         *
+         *  Points are buffered in memory and appended to "<dir>/tile_<id>.pts" as fixed size \ref Record -s,
+         *  whenever the buffers hold more than \ref getBufferLimit() points, so that memory use does not depend on the cloud size.
+         */
+        class TileStore
+        {
+            public:
+                //! \brief 40 bytes on disk.
+                struct Record
+                {
+                    float   pos   [3];
+                    float   normal[3];
+                    int64_t pid;        //!< \brief Index of the point in the input cloud.
+                    int64_t gid;        //!< \brief Primitive GID of the point, -1 if not assigned.
+                };
+
+                /*! \param[in] dir         Directory of the tile files, created if missing.
+                 *  \param[in] bufferLimit Points buffered in total before flushing.
+                 */
+                TileStore( std::string const& dir, size_t const bufferLimit = 1 << 22 )
+                    : _dir( dir ), _bufferLimit( bufferLimit ), _buffered( 0 )
+                {
+                    if ( !boost::filesystem::exists(_dir) )
+                        boost::filesystem::create_directories( _dir );
+                }
+
+                ~TileStore() { this->flush(); }
+
+                inline std::string const& getDir        () const { return _dir; }
+                inline size_t             getBufferLimit() const { return _bufferLimit; }
+
+                //! \brief "<dir>/tile_<tile>.pts".
+                inline std::string getPath( int const tile ) const
+                {
+                    std::stringstream ss;
+                    ss << _dir << "/tile_" << tile << ".pts";
+                    return ss.str();
+                }
+
+                //! \brief Appends a point to \p tile.
+                template <class _PointT>
+                inline int append( int const tile, _PointT const& point, PidT const pid, GidT const gid = -1 )
+                {
+                    Record record;
+                    for ( int d = 0; d != 3; ++d )
+                    {
+                        record.pos   [d] = point.template pos()(d);
+                        record.normal[d] = point.template dir()(d);
+                    }
+                    record.pid = pid;
+                    record.gid = gid;
+                    _buffers[ tile ].push_back( record );
+
+                    if ( ++_buffered >= _bufferLimit )
+                        return this->flush();
+                    return EXIT_SUCCESS;
+                }
+
+                //! \brief Appends all buffered points to their files.
+                inline int flush()
+                {
+                    int err = EXIT_SUCCESS;
+                    for ( std::map<int, std::vector<Record> >::iterator it = _buffers.begin(); it != _buffers.end(); ++it )
+                    {
+                        if ( it->second.empty() )
+                            continue;
+
+                        std::ofstream f( this->getPath(it->first).c_str(), std::ios::binary | std::ios::app );
+                        f.write( reinterpret_cast<char const*>(it->second.data()), sizeof(Record) * it->second.size() );
+                        if ( !f.good() )
+                        {
+                            std::cerr << "[" << __func__ << "]: " << "could not write " << this->getPath(it->first) << std::endl;
+                            err = EXIT_FAILURE;
+                        }
+                    }
+                    _buffers.clear();
+                    _buffered = 0;
+                    return err;
+                }
+
+                /*! \brief Reads the points of \p tile. Flush before reading.
+                 *  \param[out] points Points with PID and GID set to their index in \p points, appended.
+                 *  \param[out] pids   Input cloud index of each point, if not NULL.
+                 *  \param[out] gids   Stored GID of each point, if not NULL.
+                 *  \return EXIT_SUCCESS, also if the tile is empty.
+                 */
+                template <class _PointT, class _PointContainerT>
+                inline int read( _PointContainerT &points, int const tile, std::vector<PidT> *pids = NULL, std::vector<GidT> *gids = NULL ) const
+                {
+                    const std::string path = this->getPath( tile );
+                    if ( !boost::filesystem::exists(path) )
+                        return EXIT_SUCCESS;
+
+                    const size_t count = boost::filesystem::file_size( path ) / sizeof(Record);
+                    std::vector<Record> records( count );
+                    std::ifstream f( path.c_str(), std::ios::binary );
+                    if ( !f.read(reinterpret_cast<char*>(records.data()), sizeof(Record) * count) )
+                    {
+                        std::cerr << "[" << __func__ << "]: " << "could not read " << path << std::endl;
+                        return EXIT_FAILURE;
+                    }
+
+                    points.reserve( points.size() + count );
+                    typename _PointT::VectorType raw;
+                    for ( size_t i = 0; i != count; ++i )
+                    {
+                        for ( int d = 0; d != 3; ++d )
+                        {
+                            raw( d     ) = records[i].pos   [d];
+                            raw( d + 3 ) = records[i].normal[d];
+                        }
+                        points.emplace_back( _PointT(raw) );
+                        points.back().setTag( _PointT::TAGS::PID, points.size() - 1 );
+                        points.back().setTag( _PointT::TAGS::GID, points.size() - 1 );
+                        if ( pids ) pids->push_back( records[i].pid );
+                        if ( gids ) gids->push_back( records[i].gid );
+                    }
+
+                    return EXIT_SUCCESS;
+                } //...read()
+
+                //! \brief Deletes the file of \p tile.
+                inline void remove( int const tile ) { boost::filesystem::remove( this->getPath(tile) ); }
+
+            protected:
+                std::string                         _dir;
+                size_t                              _bufferLimit;
+                size_t                              _buffered;
+                std::map<int, std::vector<Record> > _buffers;   //!< \brief Points not written yet, by tile.
+        }; //...class TileStore
+    } //...ns io
+} //...ns rapter
+
+#endif // RAPTER_TILESTORE_HPP
@@ -68,6 +68,33 @@ namespace rapter
                     , bool                             const  verbose = false
                     );
 
+            /*! \brief Runs \ref generate on in-memory data, and reruns it in safe mode, if the first run produced too many variables.
+             *         Used by \ref generateCli and \ref Pipeline.
+             *
+             *  \tparam _PrimitiveMapT         Concept: \ref containers::PrimitiveContainer< \ref rapter::LinePrimitive2 >.
+             *  \param[out]    primitives      Output candidates.
+             *  \param[in,out] patches         Input patches, some of them get promoted.
+             *  \param[in,out] params          Uses scale, angles, small_thresh_mult and var_limit. safe_mode gets switched on for the rerun.
+             *  \param[in]     angleGensInRad  Angle generators in radians.
+             *  \return                        Count of patches left to promote on this level (>0), 0 if all were promoted, <0 if even the safe run exceeded the limit.
+             */
+            template < class    _PrimitiveT
+                     , class    _PrimitiveMapT
+                     , class    _PointContainerT
+                     , typename _Scalar
+                     >
+            static inline int
+            generateStep( _PrimitiveMapT                          & primitives
+                        , _PrimitiveMapT                          & patches
+                        , _PointContainerT                   const& points
+                        , CandidateGeneratorParams<_Scalar>       & params
+                        , AnglesT                            const& angleGensInRad
+                        , bool                               const  keepSingles
+                        , bool                               const  allowPromoted
+                        , bool                               const  tripletSafe
+                        , bool                               const  verbose = false
+                        );
+
     }; //...class CandidateGenerator
 } // ...ns rapter
 
@@ -0,0 +1,140 @@
+#ifndef RAPTER_ENERGYEVALUATOR_H
+#define RAPTER_ENERGYEVALUATOR_H
+
+#include <algorithm> // copy, max
+#include <vector>
+#include "Eigen/Sparse"
+#include "qcqpcpp/optProblem.h" // OptProblem
+#include "rapter/simpleTypes.h" // LidT
+
+namespace rapter
+{
+
+/*! \brief Evaluates E(x) = qo' * x + x' * Qo * x of a formulated problem (see \ref ProblemSetup::formulate2), and its change, if a variable is flipped.
+ *         Qo is stored once in symmetric CSR form, its diagonal separately, and the pairwise gradient of the current x is cached,
+ *         so \ref flipDelta is O(1) and \ref flip is O(degree). Flipping assumes binary x.
+ */
+template <typename _Scalar>
+class EnergyEvaluator
+{
+    public:
+        typedef qcqpcpp::OptProblem<_Scalar>                 OptProblemT;
+        typedef Eigen::SparseMatrix<_Scalar,Eigen::RowMajor> SparseMatrix;
+
+        //! \brief Builds the CSR from the objective entry lists of \p problem, x is all zeros.
+        inline EnergyEvaluator( OptProblemT const& problem )
+        {
+            _qo.assign( problem.getVarCount(), _Scalar(0) );
+            std::vector<_Scalar> const& qo = problem.getLinObjectives();
+            std::copy( qo.begin(), qo.end(), _qo.begin() );
+            init( problem.getQuadraticObjectives() );
+        }
+
+        //! \brief Builds the CSR from assembled objective matrices, as \ref Solver::checkSolution gets them.
+        //! \param[in] qo Column or row vector.
+        //! \param[in] Qo Square, one triangle or both.
+        inline EnergyEvaluator( SparseMatrix const& qo, SparseMatrix const& Qo )
+        {
+            _qo.assign( std::max(qo.rows(), qo.cols()), _Scalar(0) );
+            for ( int k = 0; k < qo.outerSize(); ++k )
+                for ( typename SparseMatrix::InnerIterator it(qo, k); it; ++it )
+                    _qo[ std::max(it.row(), it.col()) ] += it.value();
+
+            std::vector< Eigen::Triplet<_Scalar> > entries;
+            entries.reserve( Qo.nonZeros() );
+            for ( int k = 0; k < Qo.outerSize(); ++k )
+                for ( typename SparseMatrix::InnerIterator it(Qo, k); it; ++it )
+                    entries.push_back( Eigen::Triplet<_Scalar>(it.row(), it.col(), it.value()) );
+            init( entries );
+        }
+
+        //! \brief Sets x, and recomputes the cached gradient and energies. O(nnz).
+        template <class _VectorT>
+        inline void setX( _VectorT const& x )
+        {
+            _x.assign( _qo.size(), _Scalar(0) );
+            for ( size_t j = 0; j != _x.size(); ++j )
+                _x[j] = x[j];
+
+            _linear = _Scalar(0);
+            for ( size_t j = 0; j != _x.size(); ++j )
+            {
+                _linear  += _qo[j] * _x[j];
+                _field[j] = _diag[j] * _x[j];
+                for ( typename SparseMatrix::InnerIterator it(_Qs, j); it; ++it )
+                    _field[j] += it.value() * _x[ it.col() ];
+            }
+
+            // x' * Qo * x = sum_j x_j * ( Qo_jj * x_j + 1/2 * sum_k Qs_jk * x_k )
+            _pairwise = _Scalar(0);
+            for ( size_t j = 0; j != _x.size(); ++j )
+                _pairwise += _x[j] * ( _field[j] + _diag[j] * _x[j] ) / _Scalar(2);
+        }
+
+        //! \brief Energy change, if binary variable \p j was flipped. O(1).
+        inline _Scalar flipDelta( LidT const j ) const
+        {
+            return (_x[j] > _Scalar(0.5) ? _Scalar(-1) : _Scalar(1)) * ( _qo[j] + _diag[j] + pairwiseGradient(j) );
+        }
+
+        //! \brief Flips binary variable \p j, and updates the cached gradient of its neighbours. O(degree).
+        inline void flip( LidT const j )
+        {
+            const _Scalar d = _x[j] > _Scalar(0.5) ? _Scalar(-1) : _Scalar(1);
+            _linear   += d * _qo[j];
+            _pairwise += d * ( _diag[j] + pairwiseGradient(j) );
+            _field[j] += d * _diag[j];
+            for ( typename SparseMatrix::InnerIterator it(_Qs, j); it; ++it )
+                _field[ it.col() ] += d * it.value();
+            _x[j] = d > _Scalar(0) ? _Scalar(1) : _Scalar(0);
+        }
+
+        inline _Scalar                      linear   () const { return _linear; }             //!< \brief qo' * x.
+        inline _Scalar                      pairwise () const { return _pairwise; }           //!< \brief x' * Qo * x.
+        inline _Scalar                      energy   () const { return _linear + _pairwise; } //!< \brief qo' * x + x' * Qo * x.
+        inline std::vector<_Scalar>  const& getX     () const { return _x; }
+        inline LidT                         getVarCount() const { return _qo.size(); }
+
+    protected:
+        //! \brief Off-diagonal part of d(x' * Qo * x) / dx_j. The cache holds diag * x_j on top of it.
+        inline _Scalar pairwiseGradient( LidT const j ) const { return _field[j] - _diag[j] * _x[j]; }
+
+        //! \brief Splits \p entries into the diagonal and the symmetric off-diagonal CSR. Duplicates add up.
+        template <class _EntriesT>
+        inline void init( _EntriesT const& entries )
+        {
+            const LidT n = _qo.size();
+            _diag.assign( n, _Scalar(0) );
+            std::vector< Eigen::Triplet<_Scalar> > offDiag;
+            offDiag.reserve( 2 * entries.size() );
+            for ( typename _EntriesT::const_iterator it = entries.begin(); it != entries.end(); ++it )
+            {
+                if ( it->row() == it->col() )
+                    _diag[ it->row() ] += it->value();
+                else
+                {
+                    offDiag.push_back( Eigen::Triplet<_Scalar>(it->row(), it->col(), it->value()) );
+                    offDiag.push_back( Eigen::Triplet<_Scalar>(it->col(), it->row(), it->value()) );
+                }
+            }
+            _Qs.resize( n, n );
+            _Qs.setFromTriplets( offDiag.begin(), offDiag.end() );
+            _Qs.makeCompressed();
+
+            _field.assign( n, _Scalar(0) );
+            _x.assign( n, _Scalar(0) );
+            _linear = _pairwise = _Scalar(0);
+        }
+
+        std::vector<_Scalar> _qo;       //!< \brief Linear objective.
+        std::vector<_Scalar> _diag;     //!< \brief Diagonal of Qo.
+        SparseMatrix         _Qs;       //!< \brief Off-diagonal Qo + Qo', CSR.
+        std::vector<_Scalar> _x;        //!< \brief Current point.
+        std::vector<_Scalar> _field;    //!< \brief Qs * x + diag * x, cached.
+        _Scalar              _linear;   //!< \brief Cached qo' * x.
+        _Scalar              _pairwise; //!< \brief Cached x' * Qo * x.
+}; //...class EnergyEvaluator
+
+} //...ns rapter
+
+#endif // RAPTER_ENERGYEVALUATOR_H
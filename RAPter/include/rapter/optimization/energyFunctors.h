@@ -4,6 +4,7 @@
 #include <vector>
 //#include "rapter/my_types.h" // angleInRad
 #include "rapter/processing/impl/angle.hpp" // angleInRad
+#include "rapter/processing/angleLookup.h"  // AngleLookup
 #include "rapter/parameters.h"
 
 #include <Eigen/StdVector>
@@ -298,6 +299,31 @@ namespace rapter
 
             return min_angle;
         } //...eval()
+
+        //! \brief                      \copydoc MyPrimitivePrimitiveAngleFunctor
+        //!                             Reads the precomputed \p lookup instead, matches the above up to \ref processing::AngleLookup::maxInterpolationError().
+        template <typename Scalar, class PrimitiveT>
+        static inline Scalar
+        eval( PrimitiveT                                const& p1
+            , PrimitiveT                                const& p2
+            , processing::AngleLookup<Scalar>           const& lookup
+            , int                                            * closest_angle_id = NULL )
+        {
+            return lookup.eval( p1.dir(), p2.dir(), closest_angle_id );
+        } //...eval()
+
+        //! \brief                      Batched \ref eval() of \p p1 against the directions \p dirs of other primitives.
+        //! \param[out] diffs           diffs[i] = Absolute angle difference of p1 and dirs[i] to the closest allowed angle.
+        template <typename Scalar, class PrimitiveT>
+        static inline void
+        evalBatch( std::vector<Scalar>                           & diffs
+                 , PrimitiveT                               const& p1
+                 , processing::kernels::PositionArrays<Scalar> const& dirs
+                 , processing::AngleLookup<Scalar>          const& lookup
+                 , std::vector<int>                             * closest_angle_ids = NULL )
+        {
+            lookup.evalBatch( diffs, p1.dir(), dirs, closest_angle_ids );
+        } //...evalBatch()
     }; //...MyPrimitivePrimitiveAngleFunctor
 
     template <typename Scalar, class PrimitiveT>
@@ -0,0 +1,151 @@
+#ifndef RAPTER_HIERARCHICALSOLVER_H
+#define RAPTER_HIERARCHICALSOLVER_H
+
+#include <set>
+#include <vector>
+#include "rapter/parameters.h"                      // ProblemSetupParams
+#include "rapter/optimization/solver.h"             // Solver::SOLVER
+#include "rapter/util/pclUtil.h"                    // PclCloudPtrT
+#include "rapter/processing/neighbourhoodGraph.hpp" // NeighbourhoodGraph
+
+namespace rapter
+{
+    /*! \brief Coarse-to-fine selection for candidate sets too large to formulate and solve at once.
+     *
+     *  Patches are clustered spatially (\ref clusterPatches). Each cluster is represented by the most populous patch of each of its
+     *  most populous directions (\ref coarseCandidates), and a coarse problem over only these representatives decides, which directions are used.
+     *  The candidates are then restricted to the chosen directions (\ref restrictCandidates), and every cluster is formulated over its own points,
+     *  and solved on its own. Pairwise costs between clusters are only seen by the coarse problem, that is the price of near-linear scaling.
+     */
+    class HierarchicalSolver
+    {
+        public:
+            //! \brief Sizes and timings of a \ref solve.
+            struct Stats
+            {
+                Stats() : clusters( 0 ), coarseVars( 0 ), fineVars( 0 ), maxFineVars( 0 ), coarseDirs( 0 ), coarseSeconds( 0. ), fineSeconds( 0. ) {}
+                size_t clusters;
+                LidT   coarseVars, fineVars, maxFineVars;
+                size_t coarseDirs;      //!< \brief Directions chosen by the coarse problem.
+                double coarseSeconds, fineSeconds;
+            };
+
+            /*! \brief Splits the patches of \p prims at the median of their population centroids along the longest axis, until at most \p clusterSize patches are left in a part.
+             *  \param[out] clusters     Indices into \p prims, one vector per cluster.
+             *  \param[in]  prims        Candidates grouped by patch.
+             *  \param[in]  points       Points tagged by the GID of their patch.
+             *  \param[in]  populations  Point ids of each GID in \p points.
+             *  \param[in]  clusterSize  Maximum patch count of a cluster.
+             */
+            template < class _PrimitiveT, class _PrimitiveContainerT, class _PointContainerT, class _GidPidVectorMap >
+            static inline void clusterPatches( std::vector< std::vector<size_t> >       & clusters
+                                             , _PrimitiveContainerT                const& prims
+                                             , _PointContainerT                    const& points
+                                             , _GidPidVectorMap                    const& populations
+                                             , size_t                              const  clusterSize );
+
+            /*! \brief Picks the coarse problem's patches: the most populous patch of each of the \p reps most populous directions of a cluster.
+             *  \param[out] coarse       Non-SMALL candidates of the representative patches, grouped by patch.
+             *  \param[in]  reps         Directions per cluster.
+             */
+            template < class _PrimitiveT, class _PrimitiveContainerT, class _GidPidVectorMap >
+            static inline void coarseCandidates( _PrimitiveContainerT                     & coarse
+                                               , _PrimitiveContainerT                const& prims
+                                               , std::vector< std::vector<size_t> >  const& clusters
+                                               , _GidPidVectorMap                    const& populations
+                                               , int                                 const  reps );
+
+            /*! \brief Keeps the candidates of \p patch with directions in \p dirs, and SMALL ones. Keeps all of them, if none of their directions is in \p dirs.
+             *  \return Count of non-SMALL candidates kept.
+             */
+            template < class _PrimitiveT, class _InnerPrimitiveContainerT >
+            static inline LidT restrictCandidates( _InnerPrimitiveContainerT       & out
+                                                 , _InnerPrimitiveContainerT  const& patch
+                                                 , std::set<DidT>             const& dirs );
+
+            /*! \brief Clusters, solves the coarse problem, restricts the candidates, and solves the clusters, in parallel, if the solver is \ref Solver::NATIVE.
+             *  \tparam _FiniteFiniteDistFunctor Concept: \ref rapter::_2d::MyFiniteLineToFiniteLineCompatFunctor.
+             *  \param[out] out_prims           One patch per cluster appended, as \ref Solver::selectPrimitives does.
+             *  \param[in]  prims               Candidates grouped by patch in GID order.
+             *  \param[in]  points              Points tagged with the GID of their patch.
+             *  \param[in]  problemParams       Formulation parameters, angles already generated.
+             *  \param[in]  angle_gens_in_rad   Angle generators in radians.
+             *  \param[in]  clusterSize         Patches per cluster.
+             *  \param[in]  reps                Directions per cluster in the coarse problem.
+             *  \param[out] stats               Sizes and timings, if not NULL.
+             *  \return                         EXIT_SUCCESS, or the first failing formulation's or solve's error code.
+             */
+            template < class _PointPrimitiveDistanceFunctor
+                     , class _FiniteFiniteDistFunctor
+                     , class _PrimitiveT
+                     , class _PrimitiveContainerT
+                     , class _PointContainerT
+                     , typename _Scalar
+                     >
+            static inline int solve( _PrimitiveContainerT                     & out_prims
+                                   , _PrimitiveContainerT                const& prims
+                                   , _PointContainerT                    const& points
+                                   , PclCloudPtrT                             & pclCloud
+                                   , ProblemSetupParams<_Scalar>         const& problemParams
+                                   , AnglesT                             const& angle_gens_in_rad
+                                   , Solver::SOLVER                      const  solver
+                                   , _Scalar                             const  max_time
+                                   , int                                 const  bmode
+                                   , int                                 const  clusterSize
+                                   , int                                 const  reps
+                                   , Stats                                    * stats   = NULL
+                                   , bool                                const  verbose = false );
+
+            /*! \brief Formulates \p prims over \p points, that are usually only their own points, and solves the problem.
+             *  \param[out] out_prims   Gets one patch appended, see \ref Solver::selectPrimitives.
+             *  \param[out] varCount    Variable count of the formulated problem.
+             */
+            template < class _PointPrimitiveDistanceFunctor
+                     , class _FiniteFiniteDistFunctor
+                     , class _PrimitiveT
+                     , class _PrimitiveContainerT
+                     , class _PointContainerT
+                     , typename _Scalar
+                     >
+            static inline int solveSubset( _PrimitiveContainerT                     & out_prims
+                                         , LidT                                     & varCount
+                                         , _PrimitiveContainerT                const& prims
+                                         , _PointContainerT                    const& points
+                                         , PclCloudPtrT                             & pclCloud
+                                         , ProblemSetupParams<_Scalar>         const& problemParams
+                                         , AnglesT                             const& angle_gens_in_rad
+                                         , Solver::SOLVER                      const  solver
+                                         , _Scalar                             const  max_time
+                                         , int                                 const  bmode
+                                         , bool                                const  verbose );
+
+            /*! \brief Formulates and solves \p prims flat, and prints the flat problem's energy of both the flat solution and \p hierOut, and their runtimes.
+             *  \param[in] hierOut      Output of \ref solve on \p prims.
+             *  \param[in] hierSeconds  Runtime of \ref solve.
+             *  \return                 EXIT_SUCCESS, or the flat formulation's or solve's error code.
+             */
+            template < class _PointPrimitiveDistanceFunctor
+                     , class _FiniteFiniteDistFunctor
+                     , class _PrimitiveT
+                     , class _PrimitiveContainerT
+                     , class _PointContainerT
+                     , typename _Scalar
+                     >
+            static inline int compare( _PrimitiveContainerT                const& hierOut
+                                     , double                              const  hierSeconds
+                                     , _PrimitiveContainerT                const& prims
+                                     , _PointContainerT                    const& points
+                                     , PclCloudPtrT                             & pclCloud
+                                     , ProblemSetupParams<_Scalar>         const& problemParams
+                                     , AnglesT                             const& angle_gens_in_rad
+                                     , Solver::SOLVER                      const  solver
+                                     , _Scalar                             const  max_time
+                                     , int                                 const  bmode
+                                     , processing::NeighbourhoodGraph      const* neighGraph
+                                     , bool                                const  verbose );
+    }; //...class HierarchicalSolver
+} //...ns rapter
+
+#include "rapter/optimization/impl/hierarchicalSolver.hpp"
+
+#endif // RAPTER_HIERARCHICALSOLVER_H
@@ -2,10 +2,15 @@
 #define RAPTER_CANDIDATEGENERATOR_HPP
 
 #include <map>
+#include <tuple>     // CellT in listCandidatePairs
+#include <algorithm> // upper_bound
 
 #include "rapter/io/io.h"                         // readPrimities,savePrimitives,etc.
 #include "rapter/optimization/energyFunctors.h"   // MyPointPrimitiveDistanceFunctor
 #include "rapter/processing/util.hpp"             // calcPopulations()
+#include "rapter/processing/populationIndex.hpp"  // PopulationIndex
+#include "rapter/processing/distanceKernels.hpp"  // PositionArrays
+#include "rapter/processing/angleLookup.h"       // AngleLookup
 #include "rapter/processing/impl/angleUtil.hpp"       // selectAngles
 #include "rapter/util/diskUtil.hpp"               // saveBackup
 #include "rapter/util/impl/pclUtil.hpp"           // PCLPointAllocator
@@ -157,6 +162,7 @@ namespace rapter
      *  \param[in/out] copied           [gid] = [ <dir0,angle_id0>, <dir0,angle_id1>, <dir2,angle_id0>, ... ]
      *  \param[in/out] generated        Records, how many extra candidates the input primitive generated in the output.
      *  \param[in/out] nLines           Keeps track of overall output size.
+     *  \param[in]     populationIndex  Point ids of each patch, used when a triplet-cancelled candidate is overwritten by a parallel copy.
      *  \param[in/out] aliases          Keeps track of diretion ids and their assigned generator angles. If not set, not enabled. NULL is used at the second phase, when aliases are added.
      */
     template < class _PrimitivePrimitiveAngleFunctorT, class _AliasesT
@@ -178,6 +184,7 @@ namespace rapter
                            , LidT                    & nLines
                            , _PrimitiveContainerT    & out_prims
                            , _PointContainerT   const& points
+                           , processing::PopulationIndex const& populationIndex
                            , _Scalar            const  scale
                            , _AliasesT               * aliases
                            , bool               const  tripletSafe  = false
@@ -267,7 +274,10 @@ namespace rapter
             {
                 typename _PrimitiveT::ExtremaT  extrema;
                 std::vector<PidT>               population;
-                processing::getPopulationOf( population, gid0, points );
+                populationIndex.getPopulationOf( population, gid0 );
+                processing::kernels::PositionArrays<_Scalar> positions;
+                processing::kernels::gatherPositions( positions, points, &population );
+                std::vector<_Scalar>            distances;
                 _PrimitiveT const*              bestPrim = NULL;
                 _Scalar                         bestDataCost = std::numeric_limits<_Scalar>::max();
 
@@ -287,8 +297,9 @@ namespace rapter
                         else
                         {
                             _Scalar distSum( 0. );
-                            for ( UPidT pid_id = 0; pid_id != population.size(); ++pid_id )
-                                distSum += cand0.getFiniteDistance( extrema, points[ population[pid_id] ].template pos() );
+                            cand0.getFiniteDistances( distances, extrema, positions );
+                            for ( UPidT pid_id = 0; pid_id != distances.size(); ++pid_id )
+                                distSum += distances[ pid_id ];
                             if ( distSum < bestDataCost )
                             {
                                 bestDataCost = distSum;
@@ -449,6 +460,234 @@ namespace rapter
 //        }
 //    };
 
+    namespace cgen
+    {
+        /*! \brief Flattened view of an input primitive, in the iteration order of the input container.
+         *         Used by \ref listCandidatePairs() and \ref CandidateGenerator::generate().
+         */
+        template <class _PrimitiveT>
+        struct PairEntry
+        {
+            PairEntry( _PrimitiveT const* prim, GidT const gid, LidT const lid, int const group )
+                : _prim( prim ), _gid( gid ), _lid( lid ), _group( group ), _bucket( -1 ) {}
+
+            _PrimitiveT const* _prim;
+            GidT               _gid;
+            LidT               _lid;    //!< \brief Position inside its patch.
+            int                _group;  //!< \brief Position of its patch in the input container.
+            int                _bucket; //!< \brief Direction bucket (DIR_GID) index, -1 for small primitives.
+        };
+
+        /*! \brief Lists, for every input primitive i, the primitives j > i that \ref addCandidate() might accept in either direction.
+         *
+         *  Primitives are bucketed by DIR_GID. A bucket pair is skipped, if the angle of their representatives minus the two bucket radii
+         *  is already further than \p angle_limit from every angle in \p angles. The distance to a set of angles is 1-Lipschitz in the angle,
+         *  so this never skips a pair, that would pass the angle test in \ref addCandidate(). Small primitives are skipped, since they neither send nor receive.
+         *  If \p prune_radius is finite, patches are additionally bucketed in a uniform grid by the bounding boxes of their point populations,
+         *  and pairs of patches further than \p prune_radius from each other are skipped.
+         *
+         *  \param[out] pairs        pairs[i] = sorted list of entries j > i to try with entry i.
+         *  \param[in]  entries      Flattened input primitives, grouped by patch, see \ref PairEntry. _bucket gets filled here.
+         *  \param[in]  groupRanges  Entry ranges [first,second) of each patch in \p entries.
+         *  \param[in]  populations  Point ids of each patch, to estimate the spatial extent of the patch.
+         *  \param[in]  prune_radius Maximum distance between two patch extents. Negative means infinite (no spatial pruning).
+         *  \return     Number of pairs listed.
+         */
+        template < class _PrimitivePrimitiveAngleFunctorT, class _PrimitiveT, class _PointContainerT, class _PopulationsT, typename _Scalar >
+        inline size_t listCandidatePairs( std::vector< std::vector<int> >              & pairs
+                                        , std::vector< PairEntry<_PrimitiveT> >        & entries
+                                        , std::vector< std::pair<int,int> >       const& groupRanges
+                                        , _PopulationsT                           const& populations
+                                        , _PointContainerT                        const& points
+                                        , AnglesT                                 const& angles
+                                        , _Scalar                                 const  angle_limit
+                                        , _Scalar                                 const  prune_radius
+                                        , bool                                    const  verbose = false )
+        {
+            typedef Eigen::Matrix<_Scalar,3,1> Position;
+            typedef std::tuple<int,int,int>    CellT;
+            // keeps rounding errors of the bound from pruning borderline pairs
+            const _Scalar angle_margin = _Scalar(1.e-4);
+
+            // ____ (1) direction buckets ____
+            std::map<DidT,int>       bucketIds;  // [dir_gid] = bucket id
+            std::vector<int>         reps;       // [bucket id] = entry id of representative (first member)
+            std::vector<_Scalar>     radii;      // [bucket id] = max angle between representative and members
+            std::vector< std::vector<int> > members; // [bucket id] = sorted entry ids
+            for ( size_t i = 0; i != entries.size(); ++i )
+            {
+                _PrimitiveT const& prim = *entries[i]._prim;
+                if ( !notSMALL(prim) )
+                    continue;
+
+                const DidT did = prim.getTag( _PrimitiveT::TAGS::DIR_GID );
+                auto it = bucketIds.find( did );
+                if ( it == bucketIds.end() )
+                {
+                    it = bucketIds.insert( std::make_pair(did, static_cast<int>(reps.size())) ).first;
+                    reps   .push_back( i );
+                    radii  .push_back( _Scalar(0.) );
+                    members.push_back( std::vector<int>() );
+                }
+                const int b = it->second;
+                entries[i]._bucket = b;
+                members[b].push_back( i );
+
+                // the triangle inequality does not hold for degenerate directions, disable pruning for the bucket
+                _PrimitiveT const& rep = *entries[ reps[b] ]._prim;
+                if ( (prim.dir().norm() < _Scalar(1.e-12)) || (rep.dir().norm() < _Scalar(1.e-12)) )
+                    radii[b] = _Scalar( M_PI );
+                else
+                    radii[b] = std::max( radii[b], angleInRad(rep.dir(), prim.dir()) );
+            }
+
+            // ____ (2) angularly compatible bucket pairs ____
+            // each representative against all representatives' directions at once, through the lookup, its error is far below angle_margin
+            const int nBuckets = reps.size();
+            const processing::AngleLookup<_Scalar> angleLookup( angles );
+            processing::kernels::PositionArrays<_Scalar> repDirs;
+            repDirs.resize( nBuckets );
+            for ( int b = 0; b != nBuckets; ++b )
+            {
+                const Position dir = entries[ reps[b] ]._prim->dir();
+                repDirs.x[b] = dir(0); repDirs.y[b] = dir(1); repDirs.z[b] = dir(2);
+            }
+
+            std::vector< std::vector<int> > compatible( nBuckets ); // [bucket id] = sorted compatible bucket ids
+#           pragma omp parallel for schedule(dynamic,16)
+            for ( int b0 = 0; b0 < nBuckets; ++b0 )
+            {
+                std::vector<_Scalar> angleDiffs;
+                _PrimitivePrimitiveAngleFunctorT::template evalBatch<_Scalar>( angleDiffs, *entries[reps[b0]]._prim, repDirs, angleLookup );
+                for ( int b1 = 0; b1 != nBuckets; ++b1 )
+                {
+                    const _Scalar lowerBound = angleDiffs[b1] - radii[b0] - radii[b1] - angle_margin;
+                    if ( lowerBound < angle_limit )
+                        compatible[b0].push_back( b1 );
+                }
+            }
+
+            // ____ (3) spatial neighbourhoods of patches ____
+            const bool spatial = prune_radius >= _Scalar(0.);
+            const int  nGroups = groupRanges.size();
+            std::vector< std::vector<int> > groupNeighs; // [group id] = sorted group ids closer than prune_radius
+            if ( spatial )
+            {
+                // bounding boxes of point populations
+                std::vector<Position> minPt( nGroups ), maxPt( nGroups );
+                std::vector<bool>     hasBox( nGroups, false );
+                _Scalar               meanExtent = 0.;
+                int                   nBoxes     = 0;
+                for ( int g = 0; g != nGroups; ++g )
+                {
+                    auto popIt = populations.find( entries[ groupRanges[g].first ]._gid );
+                    if ( (popIt == populations.end()) || popIt->second.empty() )
+                        continue;
+
+                    minPt[g].setConstant(  std::numeric_limits<_Scalar>::max() );
+                    maxPt[g].setConstant( -std::numeric_limits<_Scalar>::max() );
+                    for ( auto pidIt = popIt->second.begin(); pidIt != popIt->second.end(); ++pidIt )
+                    {
+                        const Position pos = points[*pidIt].template pos();
+                        minPt[g] = minPt[g].cwiseMin( pos );
+                        maxPt[g] = maxPt[g].cwiseMax( pos );
+                    }
+                    hasBox[g]   = true;
+                    meanExtent += (maxPt[g] - minPt[g]).maxCoeff();
+                    ++nBoxes;
+                }
+                if ( nBoxes ) meanExtent /= nBoxes;
+
+                // grid, boxes are inflated by half the radius, so that close boxes share a cell
+                const _Scalar cellSize = std::max( std::max(prune_radius, meanExtent), _Scalar(1.e-6) );
+                std::map< CellT, std::vector<int> > grid;
+                std::vector<int>                    unboxed; // patches without population are close to everything
+                for ( int g = 0; g != nGroups; ++g )
+                {
+                    if ( !hasBox[g] ) { unboxed.push_back( g ); continue; }
+                    const Eigen::Vector3i lo = ((minPt[g].array() - prune_radius/_Scalar(2.)) / cellSize).floor().template cast<int>();
+                    const Eigen::Vector3i hi = ((maxPt[g].array() + prune_radius/_Scalar(2.)) / cellSize).floor().template cast<int>();
+                    for ( int x = lo(0); x <= hi(0); ++x )
+                        for ( int y = lo(1); y <= hi(1); ++y )
+                            for ( int z = lo(2); z <= hi(2); ++z )
+                                grid[ CellT(x,y,z) ].push_back( g );
+                }
+
+                const _Scalar sqrRadius = prune_radius * prune_radius;
+                groupNeighs.resize( nGroups );
+#               pragma omp parallel for schedule(dynamic,16)
+                for ( int g0 = 0; g0 < nGroups; ++g0 )
+                {
+                    std::vector<int> &neighs = groupNeighs[g0];
+                    if ( !hasBox[g0] )
+                    {
+                        neighs.resize( nGroups );
+                        for ( int g1 = 0; g1 != nGroups; ++g1 ) neighs[g1] = g1;
+                        continue;
+                    }
+
+                    neighs = unboxed;
+                    const Eigen::Vector3i lo = ((minPt[g0].array() - prune_radius/_Scalar(2.)) / cellSize).floor().template cast<int>();
+                    const Eigen::Vector3i hi = ((maxPt[g0].array() + prune_radius/_Scalar(2.)) / cellSize).floor().template cast<int>();
+                    for ( int x = lo(0); x <= hi(0); ++x )
+                        for ( int y = lo(1); y <= hi(1); ++y )
+                            for ( int z = lo(2); z <= hi(2); ++z )
+                            {
+                                auto cellIt = grid.find( CellT(x,y,z) );
+                                if ( cellIt == grid.end() ) continue;
+                                for ( auto gIt = cellIt->second.begin(); gIt != cellIt->second.end(); ++gIt )
+                                {
+                                    // squared gap between the two boxes
+                                    const Position gap = (minPt[*gIt] - maxPt[g0]).cwiseMax( minPt[g0] - maxPt[*gIt] ).cwiseMax( Position::Zero() );
+                                    if ( gap.squaredNorm() <= sqrRadius )
+                                        neighs.push_back( *gIt );
+                                }
+                            }
+                    std::sort( neighs.begin(), neighs.end() );
+                    neighs.erase( std::unique(neighs.begin(), neighs.end()), neighs.end() );
+                }
+            } //...if spatial
+
+            // ____ (4) pairs ____
+            const int nEntries = entries.size();
+            pairs.clear();
+            pairs.resize( nEntries );
+            size_t nPairs = 0;
+#           pragma omp parallel for schedule(dynamic,64) reduction(+:nPairs)
+            for ( int i = 0; i < nEntries; ++i )
+            {
+                const int b0 = entries[i]._bucket;
+                if ( b0 < 0 )
+                    continue;
+
+                std::vector<int> &out = pairs[i];
+                if ( !spatial )
+                {
+                    for ( auto bIt = compatible[b0].begin(); bIt != compatible[b0].end(); ++bIt )
+                        out.insert( out.end(), std::upper_bound(members[*bIt].begin(), members[*bIt].end(), i), members[*bIt].end() );
+                }
+                else
+                {
+                    std::vector<int> const& neighs = groupNeighs[ entries[i]._group ];
+                    for ( auto gIt = std::lower_bound(neighs.begin(), neighs.end(), entries[i]._group); gIt != neighs.end(); ++gIt )
+                        for ( int j = std::max(i + 1, groupRanges[*gIt].first); j < groupRanges[*gIt].second; ++j )
+                            if ( (entries[j]._bucket >= 0) && std::binary_search(compatible[b0].begin(), compatible[b0].end(), entries[j]._bucket) )
+                                out.push_back( j );
+                }
+
+                // same order as the exhaustive loops
+                std::sort( out.begin(), out.end() );
+                nPairs += out.size();
+            }
+
+            if ( verbose )
+                std::cout << "[" << __func__ << "]: " << "listed " << nPairs << " pairs of " << nEntries << " primitives in " << nBuckets << " direction buckets"
+                          << ( spatial ? ", pruned spatially" : "" ) << std::endl;
+
+            return nPairs;
+        } //...listCandidatePairs()
+    } //...ns cgen
+
     /*! \brief Main functionality to generate lines from points.
      *
      *  \tparam _PointPrimitiveDistanceFunctorT Concept: \ref MyPointPrimitiveDistanceFunctor.
@@ -520,8 +759,10 @@ namespace rapter
 
         // count patch populations
         if ( verbose ) { std::cout << "[" << __func__ << "]: " << "populations start" << std::endl; fflush(stdout); }
+        processing::PopulationIndex populationIndex; // O(1) population lookup for candidates overwritten in addCandidate
+        populationIndex.build( points );
         GidPidVectorMap populations; // populations[patch_id] = all points with GID==patch_id
-        processing::getPopulations( populations, points );
+        populationIndex.getPopulations( populations );
         if ( verbose ) { std::cout << "[" << __func__ << "]: " << "populations end" << std::endl; fflush(stdout); }
 
         // _________ (1) promotion _________
@@ -710,61 +951,113 @@ namespace rapter
 
         DidT maxDid = 0; // collects currently existing maximum cluster id (!small, active, all!)
 
-        GidT gid0, gid1, dir_gid0, dir_gid1, lid0, lid1;
-        gid0 = gid1 = dir_gid0 = dir_gid1 = _PrimitiveT::TAG_UNSET; // group tags cached
-        for ( outer_const_iterator outer_it0  = inPrims.begin(); outer_it0 != inPrims.end(); ++outer_it0 )
+        if ( params.exhaustive_pairs )
         {
-            gid0 = -2; // -1 is unset, -2 is unread
-            lid0 =  0;
-            for ( inner_const_iterator inner_it0  = (*outer_it0).second.begin(); inner_it0 != (*outer_it0).second.end(); ++inner_it0, ++lid0 )
+            GidT gid0, gid1, dir_gid0, dir_gid1, lid0, lid1;
+            gid0 = gid1 = dir_gid0 = dir_gid1 = _PrimitiveT::TAG_UNSET; // group tags cached
+            for ( outer_const_iterator outer_it0  = inPrims.begin(); outer_it0 != inPrims.end(); ++outer_it0 )
             {
-                // cache outer primitive
-                _PrimitiveT const& prim0 = *inner_it0;
-                dir_gid0                 = prim0.getTag( _PrimitiveT::TAGS::DIR_GID );
+                gid0 = -2; // -1 is unset, -2 is unread
+                lid0 =  0;
+                for ( inner_const_iterator inner_it0  = (*outer_it0).second.begin(); inner_it0 != (*outer_it0).second.end(); ++inner_it0, ++lid0 )
+                {
+                    // cache outer primitive
+                    _PrimitiveT const& prim0 = *inner_it0;
+                    dir_gid0                 = prim0.getTag( _PrimitiveT::TAGS::DIR_GID );
 
-                if ( dir_gid0 > maxDid ) maxDid = dir_gid0; // small, active, uninited!
+                    if ( dir_gid0 > maxDid ) maxDid = dir_gid0; // small, active, uninited!
 
-                // cache group id of patch at first member
-                     if ( gid0 == -2               )  gid0 = prim0.getTag( _PrimitiveT::TAGS::GID ); // store gid of first member in patch
-                else if ( gid0 != outer_it0->first )  std::cerr << "[" << __func__ << "]: " << "Not good, prims under one gid don't have same GID..." << std::endl;
+                    // cache group id of patch at first member
+                         if ( gid0 == -2               )  gid0 = prim0.getTag( _PrimitiveT::TAGS::GID ); // store gid of first member in patch
+                    else if ( gid0 != outer_it0->first )  std::cerr << "[" << __func__ << "]: " << "Not good, prims under one gid don't have same GID..." << std::endl;
 
-                for ( outer_const_iterator outer_it1  = outer_it0; outer_it1 != inPrims.end(); ++outer_it1 )
-                {
-                    gid1 = -2; // -1 is unset, -2 is unread
-                    lid1 = 0;
-                    for ( inner_const_iterator inner_it1  = (outer_it0 == outer_it1) ? ++inner_const_iterator( inner_it0 )
-                                                                                     : (*outer_it1).second.begin();
-                                               inner_it1 != (*outer_it1).second.end();
-                                             ++inner_it1, ++lid1 )
+                    for ( outer_const_iterator outer_it1  = outer_it0; outer_it1 != inPrims.end(); ++outer_it1 )
                     {
-                        // cache inner primitive
-                        _PrimitiveT const& prim1 = containers::valueOf<_PrimitiveT>( inner_it1 );
-
-                        // cache group id of patch at first member
-                             if ( gid1 == -2               )    gid1 = prim1.getTag( _PrimitiveT::TAGS::GID );
-                        else if ( gid1 != outer_it1->first )    std::cerr << "[" << __func__ << "]: " << "Not good, prims under one gid don't have same GID in inner loop..." << std::endl;
-
-                        addCandidate<_PrimitivePrimitiveAngleFunctorT>(
-                                    prim0, prim1, lid0, lid1, safe_mode, allowPromoted, angle_limit, angles, angle_gens_in_rad, promoted,
-                                    allowedAngles, copied, generated, nlines, outPrims, points, scale, &aliases, tripletSafe, verbose );
-                        addCandidate<_PrimitivePrimitiveAngleFunctorT>(
-                                    prim1, prim0, lid1, lid0, safe_mode, allowPromoted, angle_limit, angles, angle_gens_in_rad, promoted,
-                                    allowedAngles, copied, generated, nlines, outPrims, points, scale, &aliases, tripletSafe, verbose );
-
-//#warning "wasteful 19/4/2015"
-
-//                        AnglesT tmpAngles = AnglesT({0.});
-//                        addCandidate<_PrimitivePrimitiveAngleFunctorT>(
-//                                    prim0, prim1, lid0, lid1, safe_mode, allowPromoted, angle_limit, tmpAngles, angle_gens_in_rad, promoted,
-//                                    allowedAngles, copied, generated, nlines, outPrims, points, scale, &aliases, tripletSafe, verbose );
-//                        addCandidate<_PrimitivePrimitiveAngleFunctorT>(
-//                                    prim1, prim0, lid1, lid0, safe_mode, allowPromoted, angle_limit, tmpAngles, angle_gens_in_rad, promoted,
-//                                    allowedAngles, copied, generated, nlines, outPrims, points, scale, &aliases, tripletSafe, verbose );
-
-                    } //...for l3
-                } //...for l2
-            } //...for l1
-        } //...for l0
+                        gid1 = -2; // -1 is unset, -2 is unread
+                        lid1 = 0;
+                        for ( inner_const_iterator inner_it1  = (outer_it0 == outer_it1) ? ++inner_const_iterator( inner_it0 )
+                                                                                         : (*outer_it1).second.begin();
+                                                   inner_it1 != (*outer_it1).second.end();
+                                                 ++inner_it1, ++lid1 )
+                        {
+                            // cache inner primitive
+                            _PrimitiveT const& prim1 = containers::valueOf<_PrimitiveT>( inner_it1 );
+
+                            // cache group id of patch at first member
+                                 if ( gid1 == -2               )    gid1 = prim1.getTag( _PrimitiveT::TAGS::GID );
+                            else if ( gid1 != outer_it1->first )    std::cerr << "[" << __func__ << "]: " << "Not good, prims under one gid don't have same GID in inner loop..." << std::endl;
+
+                            addCandidate<_PrimitivePrimitiveAngleFunctorT>(
+                                        prim0, prim1, lid0, lid1, safe_mode, allowPromoted, angle_limit, angles, angle_gens_in_rad, promoted,
+                                        allowedAngles, copied, generated, nlines, outPrims, points, populationIndex, scale, &aliases, tripletSafe, verbose );
+                            addCandidate<_PrimitivePrimitiveAngleFunctorT>(
+                                        prim1, prim0, lid1, lid0, safe_mode, allowPromoted, angle_limit, angles, angle_gens_in_rad, promoted,
+                                        allowedAngles, copied, generated, nlines, outPrims, points, populationIndex, scale, &aliases, tripletSafe, verbose );
+
+    //#warning "wasteful 19/4/2015"
+
+    //                        AnglesT tmpAngles = AnglesT({0.});
+    //                        addCandidate<_PrimitivePrimitiveAngleFunctorT>(
+    //                                    prim0, prim1, lid0, lid1, safe_mode, allowPromoted, angle_limit, tmpAngles, angle_gens_in_rad, promoted,
+    //                                    allowedAngles, copied, generated, nlines, outPrims, points, populationIndex, scale, &aliases, tripletSafe, verbose );
+    //                        addCandidate<_PrimitivePrimitiveAngleFunctorT>(
+    //                                    prim1, prim0, lid1, lid0, safe_mode, allowPromoted, angle_limit, tmpAngles, angle_gens_in_rad, promoted,
+    //                                    allowedAngles, copied, generated, nlines, outPrims, points, populationIndex, scale, &aliases, tripletSafe, verbose );
+
+                        } //...for l3
+                    } //...for l2
+                } //...for l1
+            } //...for l0
+        } //...exhaustive
+        else
+        {
+            // flatten input in iteration order
+            std::vector< cgen::PairEntry<_PrimitiveT> > entries;
+            std::vector< std::pair<int,int> >           groupRanges; // [group] = [first,second) in entries
+            for ( outer_const_iterator outer_it0  = inPrims.begin(); outer_it0 != inPrims.end(); ++outer_it0 )
+            {
+                groupRanges.push_back( std::pair<int,int>(entries.size(),entries.size()) );
+                LidT lid0 = 0;
+                for ( inner_const_iterator inner_it0  = (*outer_it0).second.begin(); inner_it0 != (*outer_it0).second.end(); ++inner_it0, ++lid0 )
+                {
+                    _PrimitiveT const& prim0    = *inner_it0;
+                    const DidT         dir_gid0 = prim0.getTag( _PrimitiveT::TAGS::DIR_GID );
+                    if ( dir_gid0 > maxDid ) maxDid = dir_gid0; // small, active, uninited!
+
+                    const GidT gid0 = prim0.getTag( _PrimitiveT::TAGS::GID );
+                    if ( gid0 != outer_it0->first ) std::cerr << "[" << __func__ << "]: " << "Not good, prims under one gid don't have same GID..." << std::endl;
+
+                    entries.push_back( cgen::PairEntry<_PrimitiveT>(&prim0, gid0, lid0, groupRanges.size()-1) );
+                }
+                groupRanges.back().second = entries.size();
+            }
+
+            // list pairs, that can pass the angle (and proximity) test, in parallel
+            std::vector< std::vector<int> > pairs;
+            cgen::listCandidatePairs<_PrimitivePrimitiveAngleFunctorT>( pairs, entries, groupRanges, populations, points, angles, angle_limit
+                                                                       , params.pair_prune_radius_mult < _Scalar(0.) ? _Scalar(-1.) : params.pair_prune_radius_mult * scale
+                                                                       , verbose );
+
+            // addCandidate depends on the order of calls through copied, aliases and outPrims, so apply sequentially, in the exhaustive order
+            for ( size_t i = 0; i != pairs.size(); ++i )
+            {
+                cgen::PairEntry<_PrimitiveT> const& e0 = entries[i];
+                for ( auto jIt = pairs[i].begin(); jIt != pairs[i].end(); ++jIt )
+                {
+                    cgen::PairEntry<_PrimitiveT> const& e1 = entries[*jIt];
+                    // the exhaustive inner loop restarts counting lid1 after prim0, if in the same patch
+                    const LidT lid0 = e0._lid;
+                    const LidT lid1 = (e0._group == e1._group) ? e1._lid - e0._lid - 1 : e1._lid;
+
+                    addCandidate<_PrimitivePrimitiveAngleFunctorT>(
+                                *e0._prim, *e1._prim, lid0, lid1, safe_mode, allowPromoted, angle_limit, angles, angle_gens_in_rad, promoted,
+                                allowedAngles, copied, generated, nlines, outPrims, points, populationIndex, scale, &aliases, tripletSafe, verbose );
+                    addCandidate<_PrimitivePrimitiveAngleFunctorT>(
+                                *e1._prim, *e0._prim, lid1, lid0, safe_mode, allowPromoted, angle_limit, angles, angle_gens_in_rad, promoted,
+                                allowedAngles, copied, generated, nlines, outPrims, points, populationIndex, scale, &aliases, tripletSafe, verbose );
+                }
+            }
+        } //...indexed
         if ( verbose ) { std::cout << "[" << __func__ << "]: " << "generate end" << std::endl; fflush(stdout); }
 
         // ___________ (4) ALIASES _______________
@@ -819,7 +1112,7 @@ namespace rapter
                         // copy prim0 (the alias) to all compatible receivers given allowedAngles.
                         addCandidate<_PrimitivePrimitiveAngleFunctorT,AliasesT<_PrimitiveT,_Scalar> >(
                             prim1, prim0, lid1, lid0, safe_mode, allowPromoted, angle_limit, angles, angle_gens_in_rad, promoted,
-                            allowedAngles, copied, generated, nlines, outPrims, points, scale, nullptr, tripletSafe, verbose );
+                            allowedAngles, copied, generated, nlines, outPrims, points, populationIndex, scale, nullptr, tripletSafe, verbose );
 
                     } //...inner for
                 } //...outer for
@@ -966,6 +1259,68 @@ namespace rapter
         return ret;
     } // ...CandidateGenerator::generate()
 
+    template < class    _PrimitiveT
+             , class    _PrimitiveMapT
+             , class    _PointContainerT
+             , typename _Scalar
+             >
+    int
+    CandidateGenerator::generateStep( _PrimitiveMapT                          & primitives
+                                    , _PrimitiveMapT                          & patches
+                                    , _PointContainerT                   const& points
+                                    , CandidateGeneratorParams<_Scalar>       & params
+                                    , AnglesT                            const& angleGensInRad
+                                    , bool                               const  keepSingles
+                                    , bool                               const  allowPromoted
+                                    , bool                               const  tripletSafe
+                                    , bool                               const  verbose )
+    {
+        int ret = EXIT_SUCCESS;
+        int attempts = 0, attemptLimit = 1;
+
+        // runs once, 0<1, unless too many actives in output,
+        // in which case, runs twice (0<1, 1<2) with safe_mode on second run
+        while ( attempts < attemptLimit )
+        {
+            ++attempts;
+
+            ret = CandidateGenerator::generate< MyPrimitivePrimitiveAngleFunctor, MyPointPrimitiveDistanceFunctor, _PrimitiveT >
+                    (   /* out: */ primitives
+                      , /*  in: */ patches
+                      , points
+                      , params.scale
+                      , params.angles
+                      , params
+                      , params.small_thresh_mult
+                      , angleGensInRad
+                      , params.safe_mode
+                      , params.var_limit
+                      , keepSingles
+                      , allowPromoted
+                      , tripletSafe
+                      , false
+                      , verbose
+                      );
+
+            if ( ret > 0 )
+                std::cout << "[" << __func__ << "]: " << "Not all patches were promoted( " << ret << " left), will need rerun on same threshold..." << std::endl;
+            else if ( ret < 0 )
+            {
+                std::cout << "[" << __func__ << "]: " << "rerunning in safe mode, all active..." << std::endl;
+                attemptLimit = 2;
+                params.safe_mode = 1;
+                primitives.clear();
+
+                // demote back all promoted
+                for ( typename containers::PrimitiveContainer<_PrimitiveT>::Iterator it(patches); it.hasNext(); it.step() )
+                    if ( it->getTag(_PrimitiveT::TAGS::STATUS) == _PrimitiveT::STATUS_VALUES::UNSET )
+                         it->setTag( _PrimitiveT::TAGS::STATUS, _PrimitiveT::STATUS_VALUES::SMALL );
+            }
+        }
+
+        return ret;
+    } // ...CandidateGenerator::generateStep()
+
     /*! \brief                  Step 1. Generates primitives from a cloud. Reads "cloud.ply" and saves "candidates.csv".
      *  \param argc             Contains --cloud cloud.ply, and --scale scale.
      *  \param argv             Contains --cloud cloud.ply, and --scale scale.
@@ -1050,6 +1405,8 @@ namespace rapter
             if ( generatorParams.safe_mode )
                 std::cout << "[" << __func__ << "]: " << "__________________________\n__________________________RUNNING SAFE______________________\n_____________________________" << std::endl;
             pcl::console::parse_argument( argc, argv, "--var-limit", generatorParams.var_limit );
+            generatorParams.exhaustive_pairs = pcl::console::find_switch( argc, argv, "--exhaustive-pairs" );
+            pcl::console::parse_argument( argc, argv, "--pair-prune-radius", generatorParams.pair_prune_radius_mult ); // gets multiplied by scale
             // patchDistMode
             pcl::console::parse_argument( argc, argv, "--mode", mode_string );
             generatorParams.parsePatchDistMode( mode_string );
@@ -1102,6 +1459,8 @@ namespace rapter
                     std::cout << "\t [--no-paral]\n";
                     std::cout << "\t [--safe-mode]\n";
                     std::cout << "\t [--var-limit " << generatorParams.var_limit << "\t Decides how many variables we want as output. 0 means unlimited.]\n";
+                    std::cout << "\t [--exhaustive-pairs " << (generatorParams.exhaustive_pairs?"YES":"NO") << "\t Compare all primitive pairs instead of the direction/proximity indexed ones]\n";
+                    std::cout << "\t [--pair-prune-radius " << generatorParams.pair_prune_radius_mult << "\t Skip patch pairs further than this times scale. Negative means infinite, identical to exhaustive.]\n";
                     std::cout << "\t [--keep-singles " << (keepSingles?"YES":"NO") << "\t Decides, if we should throw away single directions]\n";
                     std::cout << "\t [--allow-promoted " << (allowPromoted?"YES":"NO") << "\t Decides, if we should allow promoted patches to distribute their directions]\n";
                     std::cout << "\t [--triplet-safe " << (tripletSafe?"YES":"NO") << "]\t Ensure, that perfect angle is respected for every member of DiD\n";
@@ -1167,49 +1526,10 @@ namespace rapter
         //PrimitiveContainerT primitives;
         PrimitiveMapT primitives;
         int ret = EXIT_SUCCESS;
-        int attempts = 0, attemptLimit = 1;
         if ( EXIT_SUCCESS == err )
         {
-            // runs once, 0<1, unless too many actives in output,
-            // in which case, runs twice (0<1, 1<2) with safe_mode on second run
-            while ( attempts < attemptLimit )
-            {
-                ++attempts;
-
-                ret = CandidateGenerator::generate< MyPrimitivePrimitiveAngleFunctor, MyPointPrimitiveDistanceFunctor, _PrimitiveT >
-                        (   /* out: */ primitives
-                          , /*  in: */ patches
-                          , points
-                          , generatorParams.scale
-                          , generatorParams.angles
-                          , generatorParams
-                          , generatorParams.small_thresh_mult
-                          , angleGensInRad
-                          , generatorParams.safe_mode
-                          , generatorParams.var_limit
-                          , keepSingles
-                          , allowPromoted
-                          , tripletSafe
-                          , false
-                          , verbose
-                          );
-
-                //if ( err != EXIT_SUCCESS ) std::cerr << "[" << __func__ << "]: " << "generate exited with error! Code: " << err << std::endl;
-                if ( ret > 0 )
-                    std::cout << "[" << __func__ << "]: " << "Not all patches were promoted( " << ret << " left), will need rerun on same threshold..." << std::endl;
-                else if ( ret < 0 )
-                {
-                    std::cout << "[" << __func__ << "]: " << "rerunning in safe mode, all active..." << std::endl;
-                    attemptLimit = 2;
-                    generatorParams.safe_mode = 1;
-                    primitives.clear();
-
-                    // demote back all promoted
-                    for ( typename containers::PrimitiveContainer<_PrimitiveT>::Iterator it(patches); it.hasNext(); it.step() )
-                        if ( it->getTag(_PrimitiveT::TAGS::STATUS) == _PrimitiveT::STATUS_VALUES::UNSET )
-                             it->setTag( _PrimitiveT::TAGS::STATUS, _PrimitiveT::STATUS_VALUES::SMALL );
-                }
-            }
+            ret = CandidateGenerator::generateStep<_PrimitiveT>( /* out: */ primitives, /* in: */ patches, points, generatorParams
+                                                               , angleGensInRad, keepSingles, allowPromoted, tripletSafe, verbose );
         } //...generate
 
     #if 0 // these shouldn't change here
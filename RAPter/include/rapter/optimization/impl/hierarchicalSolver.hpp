@@ -0,0 +1,436 @@
+#ifndef RAPTER_HIERARCHICALSOLVER_HPP
+#define RAPTER_HIERARCHICALSOLVER_HPP
+
+#include <map>
+#include <chrono>
+#include <utility>                                      // pair
+#include <algorithm>                                    // nth_element, sort
+
+#include "omp.h"
+
+#include "rapter/optimization/hierarchicalSolver.h"
+#include "rapter/optimization/problemSetup.h"           // formulateStep
+#include "rapter/optimization/impl/problemSetup.hpp"
+#include "rapter/optimization/solver.h"                 // optimizeProblem, selectPrimitives, evalSolution
+#include "rapter/processing/util.hpp"                   // getPopulations
+
+namespace rapter
+{
+    namespace hierarchical
+    {
+        //! \brief Orders patch indices by one coordinate of their centroid.
+        template <typename _Scalar>
+        struct CentroidLessFunctor
+        {
+            CentroidLessFunctor( std::vector< Eigen::Matrix<_Scalar,3,1> > const& centroids, int const axis ) : _centroids( centroids ), _axis( axis ) {}
+            inline bool operator()( size_t const a, size_t const b ) const
+            {
+                return (_centroids[a](_axis) < _centroids[b](_axis)) || ((_centroids[a](_axis) == _centroids[b](_axis)) && (a < b));
+            }
+            std::vector< Eigen::Matrix<_Scalar,3,1> > const& _centroids;
+            int                                              _axis;
+        };
+
+        //! \brief Orders (direction, weight) pairs descending by weight, ascending by direction on ties.
+        template <typename _Scalar>
+        inline bool heavierDirection( std::pair<DidT,_Scalar> const& a, std::pair<DidT,_Scalar> const& b )
+        {
+            return (a.second > b.second) || ((a.second == b.second) && (a.first < b.first));
+        }
+
+        //! \brief Count of candidates in \p prims, that are variables, i.e. not SMALL.
+        template <class _PrimitiveT, class _PrimitiveContainerT>
+        inline LidT countVariables( _PrimitiveContainerT const& prims )
+        {
+            LidT count = 0;
+            for ( size_t l = 0; l != prims.size(); ++l )
+                for ( size_t l1 = 0; l1 != prims[l].size(); ++l1 )
+                    count += ( prims[l][l1].getTag(_PrimitiveT::TAGS::STATUS) != _PrimitiveT::STATUS_VALUES::SMALL );
+            return count;
+        }
+
+        //! \brief Copies the points of \p points assigned to \p gids. Their PID tags stay, their order too.
+        template <class _PointPrimitiveT, class _PointContainerT>
+        inline void copyPoints( _PointContainerT &out, _PointContainerT const& points, std::set<GidT> const& gids )
+        {
+            for ( size_t pid = 0; pid != points.size(); ++pid )
+                if ( gids.count(points[pid].getTag(_PointPrimitiveT::TAGS::GID)) )
+                    out.push_back( points[pid] );
+        }
+    } //...ns hierarchical
+
+    template < class _PrimitiveT, class _PrimitiveContainerT, class _PointContainerT, class _GidPidVectorMap > void
+    HierarchicalSolver::clusterPatches( std::vector< std::vector<size_t> >       & clusters
+                                      , _PrimitiveContainerT                const& prims
+                                      , _PointContainerT                    const& points
+                                      , _GidPidVectorMap                    const& populations
+                                      , size_t                              const  clusterSize )
+    {
+        typedef typename _PrimitiveT::Scalar      Scalar;
+        typedef Eigen::Matrix<Scalar,3,1>         Position;
+        typedef std::pair<size_t,size_t>          RangeT;
+
+        // population centroids, the primitive's position for empty patches
+        std::vector<Position> centroids( prims.size(), Position::Zero() );
+        std::vector<size_t>   ids;
+        ids.reserve( prims.size() );
+        for ( size_t l = 0; l != prims.size(); ++l )
+        {
+            if ( prims[l].empty() )
+                continue;
+            ids.push_back( l );
+
+            typename _GidPidVectorMap::const_iterator popIt = populations.find( prims[l].front().getTag(_PrimitiveT::TAGS::GID) );
+            if ( (popIt == populations.end()) || popIt->second.empty() )
+            {
+                centroids[l] = prims[l].front().template pos();
+                continue;
+            }
+            for ( size_t i = 0; i != popIt->second.size(); ++i )
+                centroids[l] += points[ popIt->second[i] ].template pos();
+            centroids[l] /= Scalar( popIt->second.size() );
+        }
+
+        // split at the median of the longest axis, depth first, so that consecutive clusters are close
+        clusters.clear();
+        std::vector<RangeT> stack( 1, RangeT(0, ids.size()) );
+        while ( !stack.empty() )
+        {
+            const RangeT range = stack.back();
+            stack.pop_back();
+            if ( range.second - range.first <= std::max(size_t(1), clusterSize) )
+            {
+                if ( range.second > range.first )
+                    clusters.push_back( std::vector<size_t>(ids.begin() + range.first, ids.begin() + range.second) );
+                continue;
+            }
+
+            Position min = centroids[ ids[range.first] ], max = min;
+            for ( size_t i = range.first + 1; i != range.second; ++i )
+            {
+                min = min.cwiseMin( centroids[ids[i]] );
+                max = max.cwiseMax( centroids[ids[i]] );
+            }
+            int axis;
+            (max - min).maxCoeff( &axis );
+
+            const size_t mid = (range.first + range.second) / 2;
+            std::nth_element( ids.begin() + range.first, ids.begin() + mid, ids.begin() + range.second, hierarchical::CentroidLessFunctor<Scalar>(centroids, axis) );
+            stack.push_back( RangeT(mid, range.second) );
+            stack.push_back( RangeT(range.first, mid) );
+        }
+    } //...HierarchicalSolver::clusterPatches()
+
+    template < class _PrimitiveT, class _PrimitiveContainerT, class _GidPidVectorMap > void
+    HierarchicalSolver::coarseCandidates( _PrimitiveContainerT                     & coarse
+                                        , _PrimitiveContainerT                const& prims
+                                        , std::vector< std::vector<size_t> >  const& clusters
+                                        , _GidPidVectorMap                    const& populations
+                                        , int                                 const  reps )
+    {
+        typedef typename _PrimitiveT::Scalar         Scalar;
+        typedef std::pair<DidT,Scalar>               DirWeightT;
+        typedef typename _PrimitiveContainerT::value_type InnerPrimitiveContainerT;
+
+        for ( size_t c = 0; c != clusters.size(); ++c )
+        {
+            // population weighted direction histogram, and the most populous patch of each direction
+            std::map<DidT, Scalar>                    histogram;
+            std::map<DidT, std::pair<size_t,size_t> > largest;   // did -> (population, patch)
+            for ( size_t i = 0; i != clusters[c].size(); ++i )
+            {
+                InnerPrimitiveContainerT const& patch = prims[ clusters[c][i] ];
+                if ( patch.empty() )
+                    continue;
+                typename _GidPidVectorMap::const_iterator popIt = populations.find( patch.front().getTag(_PrimitiveT::TAGS::GID) );
+                const size_t population = (popIt != populations.end()) ? popIt->second.size() : 0;
+
+                for ( size_t l1 = 0; l1 != patch.size(); ++l1 )
+                {
+                    if ( patch[l1].getTag(_PrimitiveT::TAGS::STATUS) == _PrimitiveT::STATUS_VALUES::SMALL )
+                        continue;
+                    const DidT did = patch[l1].getTag( _PrimitiveT::TAGS::DIR_GID );
+                    histogram[ did ] += Scalar( population );
+                    if ( !largest.count(did) || (largest[did].first < population) )
+                        largest[ did ] = std::pair<size_t,size_t>( population, clusters[c][i] );
+                }
+            }
+
+            std::vector<DirWeightT> dirs( histogram.begin(), histogram.end() );
+            std::sort( dirs.begin(), dirs.end(), hierarchical::heavierDirection<Scalar> );
+
+            std::set<size_t> representatives;
+            for ( size_t d = 0; (d != dirs.size()) && (d != size_t(std::max(1, reps))); ++d )
+                representatives.insert( largest[dirs[d].first].second );
+
+            for ( std::set<size_t>::const_iterator it = representatives.begin(); it != representatives.end(); ++it )
+            {
+                coarse.push_back( InnerPrimitiveContainerT() );
+                for ( size_t l1 = 0; l1 != prims[*it].size(); ++l1 )
+                    if ( prims[*it][l1].getTag(_PrimitiveT::TAGS::STATUS) != _PrimitiveT::STATUS_VALUES::SMALL )
+                        coarse.back().push_back( prims[*it][l1] );
+            }
+        } //...for clusters
+    } //...HierarchicalSolver::coarseCandidates()
+
+    template < class _PrimitiveT, class _InnerPrimitiveContainerT > LidT
+    HierarchicalSolver::restrictCandidates( _InnerPrimitiveContainerT       & out
+                                          , _InnerPrimitiveContainerT  const& patch
+                                          , std::set<DidT>             const& dirs )
+    {
+        LidT kept = 0;
+        for ( size_t l1 = 0; l1 != patch.size(); ++l1 )
+        {
+            if ( patch[l1].getTag(_PrimitiveT::TAGS::STATUS) == _PrimitiveT::STATUS_VALUES::SMALL )
+                out.push_back( patch[l1] );
+            else if ( dirs.count(patch[l1].getTag(_PrimitiveT::TAGS::DIR_GID)) )
+            {
+                out.push_back( patch[l1] );
+                ++kept;
+            }
+        }
+
+        // no chosen direction fits this patch, let it choose from all of its own
+        if ( !kept )
+        {
+            out = patch;
+            for ( size_t l1 = 0; l1 != patch.size(); ++l1 )
+                kept += ( patch[l1].getTag(_PrimitiveT::TAGS::STATUS) != _PrimitiveT::STATUS_VALUES::SMALL );
+        }
+
+        return kept;
+    } //...HierarchicalSolver::restrictCandidates()
+
+    template < class _PointPrimitiveDistanceFunctor
+             , class _FiniteFiniteDistFunctor
+             , class _PrimitiveT
+             , class _PrimitiveContainerT
+             , class _PointContainerT
+             , typename _Scalar
+             > int
+    HierarchicalSolver::solveSubset( _PrimitiveContainerT                     & out_prims
+                                   , LidT                                     & varCount
+                                   , _PrimitiveContainerT                const& prims
+                                   , _PointContainerT                    const& points
+                                   , PclCloudPtrT                             & pclCloud
+                                   , ProblemSetupParams<_Scalar>         const& problemParams
+                                   , AnglesT                             const& angle_gens_in_rad
+                                   , Solver::SOLVER                      const  solver
+                                   , _Scalar                             const  max_time
+                                   , int                                 const  bmode
+                                   , bool                                const  verbose )
+    {
+        varCount = 0;
+
+        // only SMALL candidates, nothing to choose
+        if ( !hierarchical::countVariables<_PrimitiveT>(prims) )
+        {
+            std::vector<double> none;
+            Solver::selectPrimitives<_PrimitiveT>( out_prims, prims, none );
+            return EXIT_SUCCESS;
+        }
+
+        problemSetup::OptProblemT problem;
+        int err = ProblemSetup::formulateStep<_PointPrimitiveDistanceFunctor, _FiniteFiniteDistFunctor>
+                    ( problem, prims, points, problemParams, angle_gens_in_rad, pclCloud, /* clustersMode: */ 0, /* neighGraph: */ NULL, verbose );
+        if ( EXIT_SUCCESS != err )
+            return err;
+        varCount = problem.getVarCount();
+
+        std::vector<double> x_out;
+        err = Solver::DO_RETRY; // flip to enter
+        for ( int attemptCount = 0; (err == Solver::DO_RETRY) && (attemptCount < 2); ++attemptCount )
+        {
+            x_out.clear();
+            err = Solver::optimizeProblem( x_out, problem, solver, max_time, bmode, attemptCount, NULL, verbose );
+        }
+        if ( EXIT_SUCCESS != err )
+            return err;
+
+        Solver::selectPrimitives<_PrimitiveT>( out_prims, prims, x_out );
+        return EXIT_SUCCESS;
+    } //...HierarchicalSolver::solveSubset()
+
+    template < class _PointPrimitiveDistanceFunctor
+             , class _FiniteFiniteDistFunctor
+             , class _PrimitiveT
+             , class _PrimitiveContainerT
+             , class _PointContainerT
+             , typename _Scalar
+             > int
+    HierarchicalSolver::solve( _PrimitiveContainerT                     & out_prims
+                             , _PrimitiveContainerT                const& prims
+                             , _PointContainerT                    const& points
+                             , PclCloudPtrT                             & pclCloud
+                             , ProblemSetupParams<_Scalar>         const& problemParams
+                             , AnglesT                             const& angle_gens_in_rad
+                             , Solver::SOLVER                      const  solver
+                             , _Scalar                             const  max_time
+                             , int                                 const  bmode
+                             , int                                 const  clusterSize
+                             , int                                 const  reps
+                             , Stats                                    * stats
+                             , bool                                const  verbose )
+    {
+        typedef typename _PointContainerT::value_type           PointPrimitiveT;
+        typedef std::map<GidT, std::vector<PidT> >              GidPidVectorMapT;
+
+        Stats localStats;
+        if ( !stats )
+            stats = &localStats;
+        *stats = Stats();
+
+        GidPidVectorMapT populations;
+        processing::getPopulations( populations, points );
+
+        std::vector< std::vector<size_t> > clusters;
+        clusterPatches<_PrimitiveT>( clusters, prims, points, populations, clusterSize );
+        stats->clusters = clusters.size();
+
+        // coarse: decide the directions on the clusters' representatives
+        auto start = std::chrono::system_clock::now();
+        std::set<DidT> dirs;
+        if ( clusters.size() > 1 )
+        {
+            _PrimitiveContainerT coarse, coarseOut;
+            coarseCandidates<_PrimitiveT>( coarse, prims, clusters, populations, reps );
+
+            std::set<GidT> coarseGids;
+            for ( size_t l = 0; l != coarse.size(); ++l )
+                if ( !coarse[l].empty() )
+                    coarseGids.insert( coarse[l].front().getTag(_PrimitiveT::TAGS::GID) );
+            _PointContainerT coarsePoints;
+            hierarchical::copyPoints<PointPrimitiveT>( coarsePoints, points, coarseGids );
+
+            int err = solveSubset<_PointPrimitiveDistanceFunctor, _FiniteFiniteDistFunctor, _PrimitiveT>
+                        ( coarseOut, stats->coarseVars, coarse, coarsePoints, pclCloud, problemParams, angle_gens_in_rad, solver, max_time, bmode, verbose );
+            if ( EXIT_SUCCESS == err )
+            {
+                for ( size_t l = 0; l != coarseOut.size(); ++l )
+                    for ( size_t l1 = 0; l1 != coarseOut[l].size(); ++l1 )
+                        if ( coarseOut[l][l1].getTag(_PrimitiveT::TAGS::STATUS) == _PrimitiveT::STATUS_VALUES::ACTIVE )
+                            dirs.insert( coarseOut[l][l1].getTag(_PrimitiveT::TAGS::DIR_GID) );
+            }
+            else
+                std::cerr << "[" << __func__ << "]: " << "coarse solve failed with " << err << ", clusters keep all their candidates" << std::endl;
+        } //...coarse
+        stats->coarseDirs    = dirs.size();
+        stats->coarseSeconds = std::chrono::duration<double>( std::chrono::system_clock::now() - start ).count();
+
+        // fine: restrict candidates to the chosen directions, and give each cluster its own points
+        start = std::chrono::system_clock::now();
+        std::vector<_PrimitiveContainerT> clusterPrims ( clusters.size() );
+        std::vector<_PointContainerT>     clusterPoints( clusters.size() );
+        {
+            std::map<GidT, size_t> clusterOf;
+            for ( size_t c = 0; c != clusters.size(); ++c )
+                for ( size_t i = 0; i != clusters[c].size(); ++i )
+                {
+                    typename _PrimitiveContainerT::value_type const& patch = prims[ clusters[c][i] ];
+                    clusterOf[ patch.front().getTag(_PrimitiveT::TAGS::GID) ] = c;
+                    clusterPrims[c].push_back( typename _PrimitiveContainerT::value_type() );
+                    restrictCandidates<_PrimitiveT>( clusterPrims[c].back(), patch, dirs );
+                }
+
+            for ( size_t pid = 0; pid != points.size(); ++pid )
+            {
+                std::map<GidT, size_t>::const_iterator it = clusterOf.find( points[pid].getTag(PointPrimitiveT::TAGS::GID) );
+                if ( it != clusterOf.end() )
+                    clusterPoints[ it->second ].push_back( points[pid] );
+            }
+        }
+
+        std::vector<_PrimitiveContainerT> clusterOut( clusters.size() );
+        std::vector<LidT>                 clusterVars( clusters.size(), 0 );
+        std::vector<int>                  clusterErr ( clusters.size(), EXIT_SUCCESS );
+        // Bonmin is not reentrant, only the native solver runs the clusters in parallel
+#       pragma omp parallel for schedule(dynamic) if(solver == Solver::NATIVE)
+        for ( long c = 0; c < long(clusters.size()); ++c )
+        {
+            clusterErr[c] = solveSubset<_PointPrimitiveDistanceFunctor, _FiniteFiniteDistFunctor, _PrimitiveT>
+                              ( clusterOut[c], clusterVars[c], clusterPrims[c], clusterPoints[c], pclCloud, problemParams, angle_gens_in_rad, solver, max_time, bmode, false );
+        }
+
+        int err = EXIT_SUCCESS;
+        for ( size_t c = 0; c != clusters.size(); ++c )
+        {
+            if ( EXIT_SUCCESS != clusterErr[c] )
+            {
+                std::cerr << "[" << __func__ << "]: " << "cluster " << c << " failed with " << clusterErr[c] << std::endl;
+                if ( EXIT_SUCCESS == err )
+                    err = clusterErr[c];
+                continue;
+            }
+            out_prims.insert( out_prims.end(), clusterOut[c].begin(), clusterOut[c].end() );
+            stats->fineVars    += clusterVars[c];
+            stats->maxFineVars  = std::max( stats->maxFineVars, clusterVars[c] );
+        }
+        stats->fineSeconds = std::chrono::duration<double>( std::chrono::system_clock::now() - start ).count();
+
+        if ( verbose )
+            std::cout << "[" << __func__ << "]: " << prims.size() << " patches in " << stats->clusters << " clusters, coarse: " << stats->coarseVars << " vars, "
+                      << stats->coarseDirs << " directions chosen, fine: " << stats->fineVars << " vars, max " << stats->maxFineVars << " per cluster" << std::endl;
+
+        return err;
+    } //...HierarchicalSolver::solve()
+
+    template < class _PointPrimitiveDistanceFunctor
+             , class _FiniteFiniteDistFunctor
+             , class _PrimitiveT
+             , class _PrimitiveContainerT
+             , class _PointContainerT
+             , typename _Scalar
+             > int
+    HierarchicalSolver::compare( _PrimitiveContainerT                const& hierOut
+                               , double                              const  hierSeconds
+                               , _PrimitiveContainerT                const& prims
+                               , _PointContainerT                    const& points
+                               , PclCloudPtrT                             & pclCloud
+                               , ProblemSetupParams<_Scalar>         const& problemParams
+                               , AnglesT                             const& angle_gens_in_rad
+                               , Solver::SOLVER                      const  solver
+                               , _Scalar                             const  max_time
+                               , int                                 const  bmode
+                               , processing::NeighbourhoodGraph      const* neighGraph
+                               , bool                                const  verbose )
+    {
+        typedef Solver::OptProblemT OptProblemT;
+
+        auto start = std::chrono::system_clock::now();
+        OptProblemT problem;
+        int err = ProblemSetup::formulateStep<_PointPrimitiveDistanceFunctor, _FiniteFiniteDistFunctor>
+                    ( problem, prims, points, problemParams, angle_gens_in_rad, pclCloud, /* clustersMode: */ 0, neighGraph, verbose );
+        if ( EXIT_SUCCESS != err )
+            return err;
+
+        std::vector<double> x_flat;
+        err = Solver::DO_RETRY; // flip to enter
+        for ( int attemptCount = 0; (err == Solver::DO_RETRY) && (attemptCount < 2); ++attemptCount )
+        {
+            x_flat.clear();
+            err = Solver::optimizeProblem( x_flat, problem, solver, max_time, bmode, attemptCount, NULL, verbose );
+        }
+        if ( EXIT_SUCCESS != err )
+            return err;
+        const double flatSeconds = std::chrono::duration<double>( std::chrono::system_clock::now() - start ).count();
+
+        double flatE = 0., hierE = 0.;
+        const bool flatFeasible = Solver::evalSolution( flatE, problem, Eigen::Map<const OptProblemT::VectorX>(x_flat.data(), x_flat.size()) );
+
+        // the hierarchical selection as a point of the flat problem
+        bool hierFeasible = false;
+        OptProblemT::SparseMatrix x_hier;
+        if ( Solver::startingPointFromSelection<_PrimitiveT>(x_hier, problem.getVarCount(), prims, hierOut) >= 0 )
+            hierFeasible = Solver::evalSolution( hierE, problem, OptProblemT::VectorX(x_hier) );
+        else
+            std::cerr << "[" << __func__ << "]: " << "could not map the hierarchical selection to the flat problem" << std::endl;
+
+        std::cout << "[" << __func__ << "]: " << "vars,flat_E,flat_feasible,flat_sec,hier_E,hier_feasible,hier_sec" << std::endl;
+        std::cout << "[" << __func__ << "]: " << problem.getVarCount() << "," << flatE << "," << flatFeasible << "," << flatSeconds << ","
+                  << hierE << "," << hierFeasible << "," << hierSeconds << std::endl;
+
+        return EXIT_SUCCESS;
+    } //...HierarchicalSolver::compare()
+} //...ns rapter
+
+#endif // RAPTER_HIERARCHICALSOLVER_HPP
@@ -2,6 +2,8 @@
 #define RAPTER_MERGING_HPP
 
 #include <iostream>
+#include <tuple>     // CellT in listMergeDecisions
+#include <algorithm> // upper_bound
 
 #include "rapter/util/parse.h"
 
@@ -12,7 +14,7 @@
 #include "rapter/parameters.h"
 //#include "rapter/visualization/visualization.h"
 #include "rapter/io/io.h"
-#include "rapter/processing/util.hpp"          //getPopulations()
+#include "rapter/processing/util.hpp"          //getPopulations(), PopulationIndex
 #include "rapter/processing/impl/angleUtil.hpp" // appendAngles...
 #include "rapter/optimization/patchDistanceFunctors.h" // RepresentativeSqrPatchPatchDistanceFunctorT
 #include "rapter/util/util.hpp"
@@ -556,6 +558,125 @@ namespace merging
 
         std::cout << "[" << __func__ << "]: " << "primcount: " << prims.size() << " -> " << outPartition.getPrimitives().size() << std::endl;
     } //...partition
+
+    //! \brief A primitive of \ref Merging::mergeSameDirGids with its extrema, in traversal order.
+    template <class _PrimitiveT, typename _Scalar>
+    struct MergeEntry
+    {
+        typedef Eigen::Matrix<_Scalar,3,1>   Position;
+        typedef std::vector<Position>        ExtremaT;
+
+        _PrimitiveT const* _prim;
+        ExtremaT    const* _extrema;
+        GidT               _gid;
+        Position           _min, _max;  //!< \brief Bounding box of _extrema.
+        bool               _boxed;      //!< \brief False, if _extrema are empty or not finite, such entries are paired with everything.
+    };
+
+    //! \brief Outcome of comparing two \ref MergeEntry -s in \ref listMergeDecisions().
+    enum MergeDecision { MERGE_NO = 0, MERGE_YES = 1, MERGE_COMPARED = 2 };
+
+    /*! \brief Evaluates the merge decision of every pair of entries i < j, that can merge at all, in parallel.
+     *
+     *  Entries are put in a uniform grid by their bounding boxes, pairs with boxes further apart than
+     *  _PrimitiveDecideMergeFunctorT::maxReach( scale ) are never compared, since the functor would reject them.
+     *  Pairs already in \p comparedUids are not evaluated either, but listed as MERGE_COMPARED, so that the caller can replay
+     *  the greedy merge sequentially in traversal order, and get the same merges, that comparing all pairs in that order would give.
+     *
+     *  \param[out] decisions  decisions[i] = <j, MergeDecision> for the candidates j > i of entry i, in increasing j.
+     *  \return     Number of pairs evaluated.
+     */
+    template < class _PrimitiveDecideMergeFunctorT, class _PrimitiveT, typename _Scalar, class _ComparedUidsT >
+    inline size_t listMergeDecisions( std::vector< std::vector< std::pair<int,char> > >        & decisions
+                                    , std::vector< MergeEntry<_PrimitiveT,_Scalar> >      const& entries
+                                    , _PrimitiveDecideMergeFunctorT                       const& primitiveDecideMergeFunct
+                                    , _ComparedUidsT                                      const& comparedUids
+                                    , _Scalar                                             const  scale )
+    {
+        typedef typename MergeEntry<_PrimitiveT,_Scalar>::Position Position;
+        typedef std::tuple<int,int,int>                             CellT;
+        typedef typename _ComparedUidsT::ElementT                   UidPairT;
+
+        const _Scalar reach = _PrimitiveDecideMergeFunctorT::maxReach( scale );
+        const int     n     = entries.size();
+
+        // grid, boxes are inflated by half the reach, so that boxes within reach share a cell
+        _Scalar meanExtent = 0.;
+        int     nBoxes     = 0;
+        for ( int i = 0; i != n; ++i )
+            if ( entries[i]._boxed )
+            {
+                meanExtent += (entries[i]._max - entries[i]._min).maxCoeff();
+                ++nBoxes;
+            }
+        if ( nBoxes ) meanExtent /= nBoxes;
+        const _Scalar cellSize = std::max( std::max(reach, meanExtent), _Scalar(1.e-6) );
+
+        std::map< CellT, std::vector<int> > grid;
+        std::vector<int>                    unboxed;
+        std::vector< std::vector<CellT> >   cells( n );
+        for ( int i = 0; i != n; ++i )
+        {
+            if ( !entries[i]._boxed ) { unboxed.push_back( i ); continue; }
+            const Eigen::Vector3i lo = ((entries[i]._min.array() - reach / _Scalar(2.)) / cellSize).floor().template cast<int>();
+            const Eigen::Vector3i hi = ((entries[i]._max.array() + reach / _Scalar(2.)) / cellSize).floor().template cast<int>();
+            for ( int x = lo(0); x <= hi(0); ++x )
+                for ( int y = lo(1); y <= hi(1); ++y )
+                    for ( int z = lo(2); z <= hi(2); ++z )
+                    {
+                        grid[ CellT(x,y,z) ].push_back( i );
+                        cells[i].push_back( CellT(x,y,z) );
+                    }
+        }
+
+        decisions.clear();
+        decisions.resize( n );
+        size_t evaluated = 0;
+#       pragma omp parallel for schedule(dynamic,16) reduction(+:evaluated)
+        for ( int i = 0; i < n; ++i )
+        {
+            MergeEntry<_PrimitiveT,_Scalar> const& e0 = entries[i];
+
+            // candidates after i: everything for unboxed entries, cell neighbours and unboxed ones otherwise
+            std::vector<int> candidates;
+            if ( !e0._boxed )
+                for ( int j = i + 1; j < n; ++j )
+                    candidates.push_back( j );
+            else
+            {
+                for ( size_t c = 0; c != cells[i].size(); ++c )
+                {
+                    std::vector<int> const& members = grid.find( cells[i][c] )->second;
+                    for ( std::vector<int>::const_iterator it = std::upper_bound(members.begin(), members.end(), i); it != members.end(); ++it )
+                        if ( ((entries[*it]._min - e0._max).array() <= reach).all() && ((e0._min - entries[*it]._max).array() <= reach).all() )
+                            candidates.push_back( *it );
+                }
+                for ( std::vector<int>::const_iterator it = std::upper_bound(unboxed.begin(), unboxed.end(), i); it != unboxed.end(); ++it )
+                    candidates.push_back( *it );
+                std::sort( candidates.begin(), candidates.end() );
+                candidates.erase( std::unique(candidates.begin(), candidates.end()), candidates.end() );
+            }
+
+            // decide
+            const PidT uid40 = e0._prim->getTag( _PrimitiveT::USER_TAGS::USER_ID4 );
+            for ( size_t c = 0; c != candidates.size(); ++c )
+            {
+                MergeEntry<_PrimitiveT,_Scalar> const& e1 = entries[ candidates[c] ];
+                const PidT     uid41    = e1._prim->getTag( _PrimitiveT::USER_TAGS::USER_ID4 );
+                const UidPairT uid4Pair = (uid40 > uid41) ? UidPairT(uid41,uid40) : UidPairT(uid40,uid41);
+
+                char decision = MERGE_COMPARED;
+                if ( comparedUids.find(uid4Pair) == comparedUids.end() )
+                {
+                    decision = primitiveDecideMergeFunct.eval( *e0._extrema, *e0._prim, *e1._extrema, *e1._prim, scale ) ? MERGE_YES : MERGE_NO;
+                    ++evaluated;
+                }
+                decisions[i].push_back( std::make_pair(candidates[c], decision) );
+            }
+        } //...for entries
+
+        return evaluated;
+    } //...listMergeDecisions()
 } //...merging
 
 template < class    _PrimitiveContainerT
@@ -664,31 +785,8 @@ Merging::mergeCli( int argc, char** argv )
 
     //____________________________WORK____________________________
 
-    // ADOPT
-    if ( params.do_adopt )
-    {
-        std::cout << "starting adoptPoints" << std::endl; fflush(stdout);
-        if (params.is3D)
-            adoptPoints<rapter::MyPointFinitePlaneDistanceFunctor, _PointPrimitiveT, _PrimitiveT, typename PrimitiveMapT::mapped_type::const_iterator>
-                    ( points, prims_map, params.scale, params.do_adopt, params.patch_population_limit );
-        else
-            adoptPoints<rapter::MyPointFiniteLineDistanceFunctor, _PointPrimitiveT, _PrimitiveT, typename PrimitiveMapT::mapped_type::const_iterator>
-                    ( points, prims_map, params.scale, params.do_adopt, params.patch_population_limit );
-    }
-
-
-
     PrimitiveMapT out_prims;
-    if ( (sizeLimit == 0) || (prims_map.size() <= sizeLimit) ) // Assumes one primitive in each gid...
-        merging::iterativeMerge<_PointPrimitiveT,_PrimitiveT, _PointContainerT>
-                ( /* out: */ out_prims, points, /* in: */ prims_map, params );
-    else
-    {
-        merging::MergePartition<PrimitiveMapT, _PointContainerT> outPartition;
-        partition( outPartition, prims_map, points, params, sizeLimit );
-        out_prims = outPartition.getPrimitives();
-        points = outPartition.getPoints();
-    }
+    mergeStep<_PointPrimitiveT,_PrimitiveT>( /* out: */ out_prims, points, /* in: */ prims_map, params, sizeLimit );
 
     // SAVE
     std::string o_path;
@@ -715,6 +813,45 @@ Merging::mergeCli( int argc, char** argv )
     return EXIT_SUCCESS;
 }//...Merging::mergeCli()
 
+template < class    _PointPrimitiveT
+         , class    _PrimitiveT
+         , class    _PrimitiveMapT
+         , class    _PointContainerT
+         , typename _Scalar
+         >
+int
+Merging::mergeStep( _PrimitiveMapT             & out_prims
+                  , _PointContainerT           & points
+                  , _PrimitiveMapT        const& prims_map
+                  , MergeParams<_Scalar>  const& params
+                  , size_t                const  sizeLimit )
+{
+    // ADOPT
+    if ( params.do_adopt )
+    {
+        std::cout << "starting adoptPoints" << std::endl; fflush(stdout);
+        if (params.is3D)
+            adoptPoints<rapter::MyPointFinitePlaneDistanceFunctor, _PointPrimitiveT, _PrimitiveT, typename _PrimitiveMapT::mapped_type::const_iterator>
+                    ( points, prims_map, params.scale, params.do_adopt, params.patch_population_limit );
+        else
+            adoptPoints<rapter::MyPointFiniteLineDistanceFunctor, _PointPrimitiveT, _PrimitiveT, typename _PrimitiveMapT::mapped_type::const_iterator>
+                    ( points, prims_map, params.scale, params.do_adopt, params.patch_population_limit );
+    }
+
+    if ( (sizeLimit == 0) || (prims_map.size() <= sizeLimit) ) // Assumes one primitive in each gid...
+        merging::iterativeMerge<_PointPrimitiveT,_PrimitiveT, _PointContainerT>
+                ( /* out: */ out_prims, points, /* in: */ prims_map, params );
+    else
+    {
+        merging::MergePartition<_PrimitiveMapT, _PointContainerT> outPartition;
+        partition( outPartition, prims_map, points, params, sizeLimit );
+        out_prims = outPartition.getPrimitives();
+        points = outPartition.getPoints();
+    }
+
+    return EXIT_SUCCESS;
+} //...Merging::mergeStep()
+
 /*! \brief Greedily assigns points with GID-s that are not in prims to prims that explain them.
 *        Unambiguous assignments go through first, than based on proximity, capped by scale.
 *
@@ -758,20 +895,18 @@ int Merging::adoptPoints( _PointContainerT          & points
     bool changed = false;
     int haCount = 0, orphanReCount = 0;
 
+    // Populations, built once, and updated with the points adopted in each pass
+    processing::PopulationIndex populationIndex;
+    err = populationIndex.build( points );
+    CHECK( err, "populationIndex.build" );
+
     // Loop over all points, and select orphans
     do
     {
         changed = false;
 
         _PointPrimitiveDistanceFunctor distFunctor;
-
-        // Populations
-        GidPidVectorMap populations; // populations[gid] == std::vector<int> {pid0,pid1,...}
-        if ( EXIT_SUCCESS == err )
-        {
-            err = processing::getPopulations( populations, points );
-            CHECK( err, "getPopulations" );
-        }
+        std::vector< std::pair<PidT,GidT> > adopted; // <pid, old gid>, applied to populationIndex after the pass
 
         // cache extrema
         GidLidExtremaT extremaMap;
@@ -811,12 +946,14 @@ int Merging::adoptPoints( _PointContainerT          & points
                         {
                             if ( extremaMap.find(GidLid(gid,lid)) == extremaMap.end() )
                             {
+                                PidVector population;
+                                populationIndex.getPopulationOf( population, gid );
                                 it2->template setExtentOutdated(); // we want to recalculate to be sure, points might have been reassigned
                                 err = it2->template getExtent<_PointPrimitiveT>
                                         ( extremaMap[ GidLid(gid,lid) ]
                                         , points
                                         , scale
-                                        , populations[gid].size() ? &(populations[gid]) : NULL );
+                                        , population.size() ? &population : NULL );
                             }
 
                             _Scalar dist = distFunctor.eval( extremaMap[ GidLid(gid,lid) ], *it2, pos );
@@ -840,6 +977,7 @@ int Merging::adoptPoints( _PointContainerT          & points
                 if ( (minDist < scale) && (minDist >= _Scalar(0.)) )
                 {
                     // reassign point
+                    adopted.push_back( std::pair<PidT,GidT>(pIdId, pointGId) );
                     points[pIdId].setTag( _PointPrimitiveT::TAGS::GID, minGid );
                     ++orphanReCount;
                     if ( !(orphanReCount % 1000) )
@@ -849,6 +987,9 @@ int Merging::adoptPoints( _PointContainerT          & points
                 }
             } //...if reassign point
         }//...for all points
+
+        for ( size_t i = 0; i != adopted.size(); ++i )
+            populationIndex.retag( adopted[i].first, adopted[i].second, points[adopted[i].first].getTag(_PointPrimitiveT::TAGS::GID) );
     } while (changed);
     std::cout << std::endl;
 
@@ -920,6 +1061,12 @@ int Merging::mergeSameDirGids( _PrimitiveContainerT               & out_primitiv
     GidLidExtremaT extrema; // <gid,lid> -> vector<x0, x1, ...>
     if ( EXIT_SUCCESS == err )
     {
+        // tag and list the primitives in order, then calculate their extents in parallel
+        std::vector< _PrimitiveT const* >  extentPrims;
+        std::vector< ExtremaT* >           extentOuts;
+        std::vector< typename GidPidVectorMap::mapped_type const* > extentPops; // NULL, if the patch has no points
+        std::vector< GidLid >              extentIds;
+
         // for all patches
         for ( outer_iterator outer_it  = primitives.begin();
                                   (outer_it != primitives.end()); // we now handle error
@@ -953,31 +1100,42 @@ int Merging::mergeSameDirGids( _PrimitiveContainerT               & out_primitiv
                     if ( extrema.find(gid) != extrema.end() )   std::cerr << "[" << __func__ << "]: " << "GID not unique for patch...:-S" << std::endl;
                 }
 
-                if ( populations[gid].size() )
-                {
-                    err = inner_it->template getExtent<_PointPrimitiveT>
-                                                               ( extrema[gid][lid]
-                                                               , points
-                                                               , scale
-                                                               , &(populations[gid])
-                                                               );
-                }
-                else
-                    err = EXIT_FAILURE;
-
-                if ( err != EXIT_SUCCESS )
-                {
-                    std::cerr << "Issue when computing extent of ("
-                              << primitives.at(gid).at(lid).getTag(_PrimitiveT::TAGS::GID )     << ","
-                              << primitives.at(gid).at(lid).getTag(_PrimitiveT::TAGS::DIR_GID ) << ")"
-                              << std::endl
-                              << "Ignored later... " << std::endl;
-
-                    ignoreList.insert(gid);
-                }
+                extentPrims.push_back( &(*inner_it) );
+                extentOuts .push_back( &(extrema[gid][lid]) );
+                extentPops .push_back( populations[gid].size() ? &(populations[gid]) : NULL );
+                extentIds  .push_back( GidLid(gid, lid) );
             } //...for primitives
         } //...for patches
 
+        std::vector<int> extentErrs( extentPrims.size(), EXIT_FAILURE );
+#       pragma omp parallel for schedule(dynamic)
+        for ( int i = 0; i < static_cast<int>(extentPrims.size()); ++i )
+        {
+            if ( extentPops[i] )
+                extentErrs[i] = extentPrims[i]->template getExtent<_PointPrimitiveT>( *extentOuts[i]
+                                                                                     , points
+                                                                                     , scale
+                                                                                     , extentPops[i]
+                                                                                     );
+        }
+
+        for ( size_t i = 0; i != extentErrs.size(); ++i )
+        {
+            err = extentErrs[i];
+            if ( err != EXIT_SUCCESS )
+            {
+                const GidT gid = extentIds[i].first;
+                const LidT lid = extentIds[i].second;
+                std::cerr << "Issue when computing extent of ("
+                          << primitives.at(gid).at(lid).getTag(_PrimitiveT::TAGS::GID )     << ","
+                          << primitives.at(gid).at(lid).getTag(_PrimitiveT::TAGS::DIR_GID ) << ")"
+                          << std::endl
+                          << "Ignored later... " << std::endl;
+
+                ignoreList.insert(gid);
+            }
+        }
+
         CHECK( err, "calcExtrema" )
     } //...getExtrema
 
@@ -1012,152 +1170,107 @@ int Merging::mergeSameDirGids( _PrimitiveContainerT               & out_primitiv
 #endif
     std::cout << "[" << __func__ << "]: " << "max_dir_gid: " << maxDirGId << std::endl;
 
-    // Here are two first loops to iterate over the map entries, and for each of them over the
-    // linear array containing primitives (we call them ref. primitive in the following).
-    //
-    // For each of these ref. primitives, we check for merging candidates. They can be in:
-    //   - the same map entry, after the ref. primitive in the linear Primitive array
-    //   - the next map entries, any index
-    //
-    // For each couple ref/candidate, we check if we can merge. If yes, we do it and then invalidate
-    // both the ref and the candidate to prevent to merge them with other primitives. Indeed, the
-    // merging process can potentially remove the primitives, or at least change their properties.
-    // Primitives are invalidated by storing them as key in the ignoreList structure.
-    //
-    // After processing, the ignoreList contains any candidate described by a GidLid gl:
-    //   ignoreList [gl];
-    //
-    // The output buffer is initialized with the input. All merging operations will remove
-    // old primitives and replace them by merged one.
-    out_primitives = primitives;
-
-    //bool merged = false;
-
-    // Reference traversal
+    // Flatten the primitives that take part in traversal order. Patches ignored by now (small, or without extent) never merge.
+    std::vector< merging::MergeEntry<_PrimitiveT,_Scalar> > entries;
     for ( GidIt gid_it = extrema.cbegin(); gid_it != extrema.cend(); ++gid_it )
     {
-        const GidT gid0 = gid_it->first;
+        if ( ignoreList.find(gid_it->first) != ignoreList.end() )
+            continue;
 
         for ( PrimIt prim_it = gid_it->second.cbegin(); prim_it != gid_it->second.cend(); ++prim_it )
         {
-            // linear id of the reference
-            const LidT lid0 = std::distance<typename LidExtremaT::const_iterator>( gid_it ->second.cbegin(), prim_it );
-
-            // Reference primitive key, used to check if it has not been merged previously
-            GidLid refGidLid (gid0, lid0);
-
-            // check if this primitives has not been merged previously
-            if (ignoreList.find(gid0) != ignoreList.end()) continue;
-
-            // reference primitive
-            const _PrimitiveT& prim0 = primitives.at(gid0).at(lid0);
-
-            // is the reference valid, i.e. no merge occured
-            bool is0Valid = true;
-
-
-            // Candidates traversal
-            // This loop and the nested one check if the ref primitive is still valid for comparison,
-            // i.e. no merge occured.
-            // This construction prevent to use two successive break commands (this loop and the nested one)
-            for ( GidIt gid_it1 = gid_it; is0Valid && gid_it1 != extrema.cend(); ++gid_it1 )
+            merging::MergeEntry<_PrimitiveT,_Scalar> entry;
+            entry._prim    = &( primitives.at(gid_it->first).at(prim_it->first) );
+            entry._extrema = &( prim_it->second );
+            entry._gid     = gid_it->first;
+            entry._boxed   = !prim_it->second.empty();
+            if ( entry._boxed )
             {
-
-                GidT gid1 = gid_it1->first;
-
-                // Given the ref. primitive, we check for merging candidates. They can be in:
-                //   - the same map entry, after the ref. primitive in the linear Primitive array
-                //   - the next map entries, any index
-                for ( PrimIt prim_it1 = (gid_it1 == gid_it) ? ++PrimIt(prim_it) :       // for the same map entry, after the ref. primitive
-                                                              gid_it1->second.cbegin(); // for the next map entries, any index
-                      is0Valid && prim_it1 != gid_it1->second.cend();
-                      ++prim_it1 )
+                entry._min = entry._max = prim_it->second.front();
+                for ( typename ExtremaT::const_iterator it = prim_it->second.begin(); it != prim_it->second.end(); ++it )
                 {
+                    entry._min = entry._min.cwiseMin( *it );
+                    entry._max = entry._max.cwiseMax( *it );
+                }
+                entry._boxed = entry._min.allFinite() && entry._max.allFinite();
+            }
+            entries.push_back( entry );
+        }
+    }
 
-                    const LidT lid1 = std::distance<typename LidExtremaT::const_iterator>( gid_it1->second.cbegin(), prim_it1 );
-
-                    // resume of the candidate primitive, used to record the matching operation for later and
-                    // detect previous merge operations
-                    GidLid candGidLid (gid1, lid1);
-
-                    // Here we don't need to define
-                    // bool is1Valid,
-                    // calling continue is sufficient to jump to the next primitive after and merge,
-                    // plus here check that a previous merge has not been recorded
-                    if (ignoreList.find(gid1) != ignoreList.end()) continue;
-
-                    const _PrimitiveT& prim1 = primitives.at(gid1).at(lid1);
-
-                    PidT uid40 = prim0.getTag( _PrimitiveT::USER_TAGS::USER_ID4 ),
-                         uid41 = prim1.getTag( _PrimitiveT::USER_TAGS::USER_ID4 );
-
-                    UidPairT uid4Pair;
-                    if ( uid40 > uid41 ) uid4Pair = UidPairT(uid41,uid40);
-                    else                 uid4Pair = UidPairT(uid40,uid41);
+    // Decide all pairs, that can merge, in parallel.
+    std::vector< std::vector< std::pair<int,char> > > decisions;
+    const size_t evaluated = merging::listMergeDecisions( decisions, entries, primitiveDecideMergeFunct, comparedUids, scale );
+    std::cout << "[" << __func__ << "]: " << "compared " << evaluated << " pairs of " << entries.size() << " primitives" << std::endl;
 
-                    if ( comparedUids.find( uid4Pair ) != comparedUids.end() )
-                    {
-                        comparedUids.incHits();
-                        continue;
-                    }
+    // Replay the decisions in traversal order. Each reference merges with its first valid candidate, after which both of
+    // their patches are invalidated by storing their gids in the ignoreList, since merging changes their primitives and populations.
+    // Pairs compared and not merged are recorded in comparedUids, so that later iterations don't compare them again.
+    //
+    // The output buffer is initialized with the input. All merging operations will remove
+    // old primitives and replace them by merged one.
+    out_primitives = primitives;
+    for ( size_t i = 0; i != entries.size(); ++i )
+    {
+        const GidT gid0 = entries[i]._gid;
 
+        // check if this primitives has not been merged previously
+        if ( ignoreList.find(gid0) != ignoreList.end() ) continue;
 
-                    if (primitiveDecideMergeFunct.eval( prim_it->second,  // extrema 0
-                                                        prim0,            // prim 0
-                                                        prim_it1->second, // extrema 1
-                                                        prim1,            // prim 1
-                                                        scale))
-                    {
-                        //std::cout << " YES" << std::endl;
+        const _PrimitiveT& prim0 = *entries[i]._prim;
+        for ( size_t c = 0; c != decisions[i].size(); ++c )
+        {
+            merging::MergeEntry<_PrimitiveT,_Scalar> const& entry1 = entries[ decisions[i][c].first ];
+            const GidT gid1 = entry1._gid;
+            if ( ignoreList.find(gid1) != ignoreList.end() ) continue;
 
-                        // record this to detect unmerged primitives later and invalidate both primitives
-                        ignoreList.insert(gid0);
-                        ignoreList.insert(gid1);
+            const _PrimitiveT& prim1 = *entry1._prim;
 
-                        if (    ( prim0.getTag(_PrimitiveT::TAGS::STATUS) == _PrimitiveT::STATUS_VALUES::SMALL )
-                             || ( prim1.getTag(_PrimitiveT::TAGS::STATUS) == _PrimitiveT::STATUS_VALUES::SMALL ) )
-                        {
-                            std::cout << "[" << __func__ << "]: " << "crap, small patches are merged..." << std::endl; fflush(stdout);
-                            throw new std::runtime_error("asdf");
-                        }
+            PidT uid40 = prim0.getTag( _PrimitiveT::USER_TAGS::USER_ID4 ),
+                 uid41 = prim1.getTag( _PrimitiveT::USER_TAGS::USER_ID4 );
 
-                        merging::merge( out_primitives,     // [out] Container storing merged primitives
-                                        prim0,              // [in]  First primitive (can be invalidated during the call)
-                                        populations[gid0],  // [in]  First primitive population (point ids)
-                                        prim1,              // [in]  Second primitive
-                                        populations[gid1],  // [in]  Second primitive population (point ids)
-                                        points,             // [in]  Point cloud
-                                        scale,              // [in]  Working scale (for refit)
-                                        maxDirGId,          // [in,out] maximum direction id
-                                        comparedUids.getMaxId() // [in,out] maximum new unique id
-                                       );
+            UidPairT uid4Pair;
+            if ( uid40 > uid41 ) uid4Pair = UidPairT(uid41,uid40);
+            else                 uid4Pair = UidPairT(uid40,uid41);
 
-                        //merged = true;
+            if ( decisions[i][c].second == merging::MERGE_COMPARED )
+            {
+                comparedUids.incHits();
+                continue;
+            }
 
-                        is0Valid = false;
+            if ( decisions[i][c].second == merging::MERGE_YES )
+            {
+                // record this to detect unmerged primitives later and invalidate both primitives
+                ignoreList.insert(gid0);
+                ignoreList.insert(gid1);
 
-                        //comparedUids.erase( uid4Pair );
-                        comparedUids.eraseAny( uid4Pair );
+                if (    ( prim0.getTag(_PrimitiveT::TAGS::STATUS) == _PrimitiveT::STATUS_VALUES::SMALL )
+                     || ( prim1.getTag(_PrimitiveT::TAGS::STATUS) == _PrimitiveT::STATUS_VALUES::SMALL ) )
+                {
+                    std::cout << "[" << __func__ << "]: " << "crap, small patches are merged..." << std::endl; fflush(stdout);
+                    throw new std::runtime_error("asdf");
+                }
 
-                        continue;  // jump to the next couple ref/candidate primitive
-                    }
-                    else
-                    {
+                merging::merge( out_primitives,     // [out] Container storing merged primitives
+                                prim0,              // [in]  First primitive (can be invalidated during the call)
+                                populations[gid0],  // [in]  First primitive population (point ids)
+                                prim1,              // [in]  Second primitive
+                                populations[gid1],  // [in]  Second primitive population (point ids)
+                                points,             // [in]  Point cloud
+                                scale,              // [in]  Working scale (for refit)
+                                maxDirGId,          // [in,out] maximum direction id
+                                comparedUids.getMaxId() // [in,out] maximum new unique id
+                               );
 
-                        auto uidPairIt = comparedUids.find( uid4Pair );
-                        if ( uidPairIt != comparedUids.end() )
-                        {
-                            std::cout << "this shouldn't happen, why are we rechecking this pair: " << uid40 << "," << uid41 << std::endl;
-                        }
+                comparedUids.eraseAny( uid4Pair );
 
-                        comparedUids.insert( uid4Pair );
-                    }
-                    //else
-                    //    std::cout << " NO" << std::endl;
-                }
+                break; // the reference is gone, next reference
             }
-        }
-    }
+            else
+                comparedUids.insert( uid4Pair );
+        } //...for candidates
+    } //...for references
 
     //typedef typename _PrimitiveContainerT::mapped_type::iterator inner_iterator;
 
@@ -0,0 +1,460 @@
+#ifndef RAPTER_PIPELINE_HPP
+#define RAPTER_PIPELINE_HPP
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <numeric>                                              // accumulate
+
+#if RAPTER_USE_PCL
+#   include "pcl/console/parse.h"                   // pcl::console::parse_argument
+#endif
+
+#include "boost/filesystem.hpp"
+
+#include "rapter/optimization/pipeline.h"
+#include "rapter/optimization/candidateGenerator.h"     // generateStep
+#include "rapter/optimization/problemSetup.h"           // formulateStep
+#include "rapter/optimization/impl/problemSetup.hpp"
+#include "rapter/optimization/solver.h"                 // optimizeProblem, selectPrimitives
+#include "rapter/optimization/hierarchicalSolver.h"     // HierarchicalSolver
+#include "rapter/optimization/energyEvaluator.h"        // EnergyEvaluator
+#include "rapter/optimization/merging.h"                // mergeStep
+#include "rapter/processing/neighbourhoodGraph.hpp"     // NeighbourhoodGraph
+#include "rapter/processing/impl/angleUtil.hpp"         // appendAnglesFromGenerators
+#include "rapter/io/io.h"                               // readPoints, readPrimitives, savePrimitives
+#include "rapter/primitives/extentCache.h"             // ExtentCache
+#include "rapter/util/containers.hpp"                   // PrimitiveContainer
+#include "rapter/util/parse.h"                          // rapter::console
+
+namespace rapter
+{
+    namespace pipeline
+    {
+        //! \brief Copies the non-empty patches of \p prims_map in GID order, the layout \ref io::readPrimitives produces.
+        template <class _PrimitiveContainerT, class _PrimitiveMapT>
+        inline void flatten( _PrimitiveContainerT &prims, _PrimitiveMapT const& prims_map )
+        {
+            prims.reserve( prims.size() + prims_map.size() );
+            for ( typename _PrimitiveMapT::const_iterator it = prims_map.begin(); it != prims_map.end(); ++it )
+                if ( !it->second.empty() )
+                    prims.push_back( it->second );
+        } //...flatten()
+
+        //! \brief Groups \p prims by their GID tag, as \ref io::readPrimitives does.
+        template <class _PrimitiveT, class _PrimitiveMapT, class _PrimitiveContainerT>
+        inline void group( _PrimitiveMapT &prims_map, _PrimitiveContainerT const& prims )
+        {
+            for ( size_t l = 0; l != prims.size(); ++l )
+                for ( size_t l1 = 0; l1 != prims[l].size(); ++l1 )
+                    prims_map[ prims[l][l1].getTag(_PrimitiveT::TAGS::GID) ].push_back( prims[l][l1] );
+        } //...group()
+
+        //! \brief Angle generators in degrees to radians.
+        inline AnglesT toRad( AnglesT const& angle_gens )
+        {
+            AnglesT angle_gens_in_rad;
+            for ( AnglesT::const_iterator it = angle_gens.begin(); it != angle_gens.end(); ++it )
+                angle_gens_in_rad.push_back( *it * M_PI / AnglesT::Scalar(180.) );
+            return angle_gens_in_rad;
+        } //...toRad()
+
+        //! \brief "<dir>/<stem><iteration><suffix>", the file names scripts/run.sh uses.
+        inline std::string iterationPath( std::string const& dir, std::string const& stem, int const iteration, std::string const& suffix )
+        {
+            std::stringstream ss;
+            ss << dir << stem << iteration << suffix;
+            return ss.str();
+        } //...iterationPath()
+    } //...ns pipeline
+
+    template < class _PrimitiveContainerT
+             , class _PointContainerT
+             , class _PrimitiveT
+             , class _PointPrimitiveT
+             , class _FiniteFiniteDistFunctor
+             > int
+    Pipeline::runCli( int argc, char** argv )
+    {
+        typedef typename _PointPrimitiveT::Scalar           Scalar;
+        typedef typename _PrimitiveContainerT::value_type   InnerPrimitiveContainerT;
+        typedef containers::PrimitiveContainer<_PrimitiveT> PrimitiveMapT;
+
+        PipelineParams<Scalar> params;
+        std::string cloud_path  = "cloud.ply",
+                    prims_path  = "patches.csv",
+                    assoc_path  = "points_primitives.csv";
+        bool        verbose     = false;
+
+        // parse params
+        {
+            bool valid_input = true;
+            params.is3D = pcl::console::find_switch( argc, argv, "--pipeline3D" );
+            verbose     = pcl::console::find_switch( argc, argv, "--verbose" ) || pcl::console::find_switch( argc, argv, "-v" );
+
+            if ( (pcl::console::parse_argument( argc, argv, "--scale", params.scale ) < 0) && (pcl::console::parse_argument( argc, argv, "-sc", params.scale ) < 0) )
+            {
+                std::cerr << "[" << __func__ << "]: " << "--scale is compulsory" << std::endl;
+                valid_input = false;
+            }
+            pcl::console::parse_argument( argc, argv, "--cloud", cloud_path );
+            if ( boost::filesystem::is_directory(cloud_path) )
+                cloud_path += "/cloud.ply";
+            valid_input &= boost::filesystem::exists( cloud_path );
+            // tiles are segmented in-process, so there is no segmentation output to read
+            pcl::console::parse_argument( argc, argv, "--tile-size"         , params.tile_size );
+            pcl::console::parse_argument( argc, argv, "--tile-overlap"      , params.tile_overlap_mult );
+            rapter::console::parse_argument( argc, argv, "--tile-buffer"    , params.tile_buffer );
+            pcl::console::parse_x_arguments( argc, argv, "--segment-angle-gens", params.segment_angle_gens );
+            const bool tiled = params.tile_size > Scalar(0.);
+
+            pcl::console::parse_argument( argc, argv, "--prims", prims_path );
+            pcl::console::parse_argument( argc, argv, "-p"     , prims_path );
+            valid_input &= tiled || boost::filesystem::exists( prims_path );
+            pcl::console::parse_argument( argc, argv, "--assoc", assoc_path );
+            pcl::console::parse_argument( argc, argv, "-a"     , assoc_path );
+            valid_input &= tiled || boost::filesystem::exists( assoc_path );
+
+            pcl::console::parse_argument( argc, argv, "--angle-limit"       , params.angle_limit );
+            pcl::console::parse_argument( argc, argv, "-al"                 , params.angle_limit );
+            pcl::console::parse_argument( argc, argv, "--angle-limit-div"   , params.angle_limit_div );
+            pcl::console::parse_argument( argc, argv, "-ald"                , params.angle_limit_div );
+            pcl::console::parse_argument( argc, argv, "--unary"             , params.weights(0) );
+            pcl::console::parse_argument( argc, argv, "--pw"                , params.weights(1) );
+            pcl::console::parse_argument( argc, argv, "--cmp"               , params.weights(2) );
+            pcl::console::parse_argument( argc, argv, "--spat-weight"       , params.spatial_weight_coeff );
+            pcl::console::parse_argument( argc, argv, "--spat-dist-mult"    , params.spatial_weight_dist_mult );
+            pcl::console::parse_argument( argc, argv, "--trunc-angle"       , params.trunc_angle );
+            pcl::console::parse_argument( argc, argv, "--collapse-angle-deg", params.collapse_angle_deg );
+            pcl::console::parse_argument( argc, argv, "--patch-pop-limit"   , params.patch_population_limit );
+            pcl::console::parse_argument( argc, argv, "--small-thresh"      , params.small_thresh );
+            pcl::console::parse_argument( argc, argv, "--small-thresh-div"  , params.small_thresh_div );
+            pcl::console::parse_argument( argc, argv, "--small-thresh-limit", params.small_thresh_limit );
+            pcl::console::parse_argument( argc, argv, "--iterations"        , params.iterations );
+            pcl::console::parse_argument( argc, argv, "--var-limit"         , params.var_limit );
+            pcl::console::parse_argument( argc, argv, "--hier-cluster-size" , params.hier_cluster_size );
+            pcl::console::parse_argument( argc, argv, "--hier-reps"         , params.hier_reps );
+            params.hier_compare = pcl::console::find_switch( argc, argv, "--hier-compare" );
+            params.decompose    = pcl::console::find_switch( argc, argv, "--decompose" );
+            pcl::console::parse_argument( argc, argv, "--merge-mult"        , params.merge_mult );
+            pcl::console::parse_x_arguments( argc, argv, "--angle-gens"     , params.angle_gens );
+            pcl::console::parse_x_arguments( argc, argv, "--cand-angle-gens", params.cand_angle_gens );
+            pcl::console::parse_x_arguments( argc, argv, "--extended-angle-gens", params.extended_angle_gens );
+            pcl::console::parse_argument( argc, argv, "--use90"             , params.use90 );
+            pcl::console::parse_argument( argc, argv, "--time"              , params.max_time );
+            pcl::console::parse_argument( argc, argv, "--bmode"             , params.bmode );
+            {
+                std::string solver_str = "bonmin";
+                pcl::console::parse_argument( argc, argv, "--solver", solver_str );
+                params.native_solver = !solver_str.compare( "native" );
+                valid_input &= params.native_solver || !solver_str.compare( "bonmin" );
+            }
+            params.triplet_safe = pcl::console::find_switch( argc, argv, "--triplet-safe" );
+            params.checkpoint   = pcl::console::find_switch( argc, argv, "--checkpoint" );
+
+            if ( params.spatial_weight_coeff < Scalar(0.) )
+                params.spatial_weight_coeff = params.weights(1) / Scalar(10.);
+
+            if ( !valid_input || pcl::console::find_switch(argc,argv,"--help") || pcl::console::find_switch(argc,argv,"-h") )
+            {
+                std::cout << "[" << __func__ << "]: " << "Usage:\t " << argv[0] << " --pipeline[3D]\n"
+                          << "\t -sc,--scale " << params.scale << "\n"
+                          << "\t --cloud " << cloud_path << "\n"
+                          << "\t -p,--prims " << prims_path << "\t segmentation output\n"
+                          << "\t -a,--assoc " << assoc_path << "\n"
+                          << "\t [-al,--angle-limit " << params.angle_limit << "]\n"
+                          << "\t [-ald,--angle-limit-div " << params.angle_limit_div << "]\n"
+                          << "\t [--unary " << params.weights(0) << "]\n"
+                          << "\t [--pw " << params.weights(1) << "]\n"
+                          << "\t [--cmp " << params.weights(2) << "]\n"
+                          << "\t [--spat-weight " << params.spatial_weight_coeff << "\t default: pw / 10]\n"
+                          << "\t [--spat-dist-mult " << params.spatial_weight_dist_mult << "]\n"
+                          << "\t [--trunc-angle " << params.trunc_angle << "\t negative: angle-limit]\n"
+                          << "\t [--collapse-angle-deg " << params.collapse_angle_deg << "]\n"
+                          << "\t [--patch-pop-limit " << params.patch_population_limit << "]\n"
+                          << "\t [--small-thresh " << params.small_thresh << "\t first working scale]\n"
+                          << "\t [--small-thresh-div " << params.small_thresh_div << "]\n"
+                          << "\t [--small-thresh-limit " << params.small_thresh_limit << "]\n"
+                          << "\t [--iterations " << params.iterations << "]\n"
+                          << "\t [--var-limit " << params.var_limit << "]\n"
+                          << "\t [--hier-cluster-size " << params.hier_cluster_size << "\t above var-limit candidates, solve coarse-to-fine with clusters of this many patches, instead of dropping candidates]\n"
+                          << "\t [--hier-reps " << params.hier_reps << "\t directions per cluster in the coarse problem]\n"
+                          << "\t [--hier-compare]\t also solve flat, and print both energies and runtimes\n"
+                          << "\t [--decompose]\t solve the independent components of the problem separately\n"
+                          << "\t [--merge-mult " << params.merge_mult << "]\n"
+                          << "\t [--angle-gens "; for(size_t vi=0;vi!=params.angle_gens.size();++vi)std::cout<<params.angle_gens[vi]<<","; std::cout << "]\n";
+                std::cout << "\t [--cand-angle-gens "; for(size_t vi=0;vi!=params.cand_angle_gens.size();++vi)std::cout<<params.cand_angle_gens[vi]<<","; std::cout << "]\n";
+                std::cout << "\t [--extended-angle-gens "; for(size_t vi=0;vi!=params.extended_angle_gens.size();++vi)std::cout<<params.extended_angle_gens[vi]<<","; std::cout << "]\n";
+                std::cout << "\t [--use90 " << params.use90 << "\t iteration after which extended angle gens are used]\n"
+                          << "\t [--time " << params.max_time << "]\n"
+                          << "\t [--bmode " << params.bmode << "]\n"
+                          << "\t [--solver " << (params.native_solver ? "native" : "bonmin") << "\t bonmin | native]\n"
+                          << "\t [--triplet-safe]\n"
+                          << "\t [--checkpoint]\t write every iteration's output, not just the final one\n"
+                          << "\t [--tile-size " << params.tile_size << "\t segment and iterate tiles of this size one by one, then stitch them, -p and -a are not needed]\n"
+                          << "\t [--tile-overlap " << params.tile_overlap_mult << "\t tile overlap, multiplied by scale]\n"
+                          << "\t [--tile-buffer " << params.tile_buffer << "\t points read and buffered at once while tiling]\n"
+                          << "\t [--segment-angle-gens "; for(size_t vi=0;vi!=params.segment_angle_gens.size();++vi)std::cout<<params.segment_angle_gens[vi]<<","; std::cout << "\t used to segment tiles]\n";
+                std::cout << "\t [--verbose]\n"
+                          << std::endl;
+                return EXIT_FAILURE;
+            }
+        } //...parse params
+
+        if ( params.tile_size > Scalar(0.) )
+            return TiledPipeline::run<_PrimitiveContainerT, _PrimitiveT, _PointPrimitiveT, _FiniteFiniteDistFunctor, _PointContainerT>( cloud_path, params, verbose );
+
+        // read points
+        _PointContainerT points;
+        PclCloudPtrT     pclCloud( new PclCloudT() );
+        if ( EXIT_SUCCESS != io::readPoints<_PointPrimitiveT>(points, cloud_path, &pclCloud) )
+        {
+            std::cerr << "[" << __func__ << "]: " << "could not read points from " << cloud_path << std::endl;
+            return EXIT_FAILURE;
+        } //...read points
+
+        // read associations
+        std::vector<std::pair<PidT,LidT> > points_primitives;
+        io::readAssociations( points_primitives, assoc_path, NULL );
+        if ( points_primitives.size() < points.size() )
+        {
+            std::cerr << "more points than associations..." << std::endl;
+            return EXIT_FAILURE;
+        }
+        for ( size_t i = 0; i != points.size(); ++i )
+            points[i].setTag( _PointPrimitiveT::TAGS::GID, points_primitives[i].first );
+
+        // read patches
+        _PrimitiveContainerT initial_primitives;
+        PrimitiveMapT        patches;
+        if ( EXIT_SUCCESS != io::readPrimitives<_PrimitiveT, InnerPrimitiveContainerT>(initial_primitives, prims_path, &patches) )
+        {
+            std::cerr << "[" << __func__ << "]: " << "could not read primitives from " << prims_path << std::endl;
+            return EXIT_FAILURE;
+        } //...read patches
+
+        return run<_PrimitiveT, _PointPrimitiveT, _FiniteFiniteDistFunctor>( patches, points, pclCloud, params, cloud_path, verbose );
+    } //...Pipeline::runCli()
+
+    template < class _PrimitiveT
+             , class _PointPrimitiveT
+             , class _FiniteFiniteDistFunctor
+             , class _PrimitiveMapT
+             , class _PointContainerT
+             , typename _Scalar
+             > int
+    Pipeline::run( _PrimitiveMapT                    & patches
+                 , _PointContainerT                  & points
+                 , PclCloudPtrT                      & pclCloud
+                 , PipelineParams<_Scalar>      const& params
+                 , std::string                  const& cloud_path
+                 , bool                         const  verbose )
+    {
+        typedef typename _PrimitiveMapT::mapped_type                  InnerPrimitiveContainerT;
+        typedef std::vector<InnerPrimitiveContainerT>                 PrimitiveContainerT;
+        typedef typename InnerPrimitiveContainerT::const_iterator     InnerConstIteratorT;
+
+        std::string o_path = boost::filesystem::path( cloud_path ).parent_path().string();
+        if ( !o_path.empty() )
+            o_path += "/";
+
+        // the neighbourhood radius does not change between iterations, so it is mapped or built once
+        processing::NeighbourhoodGraph        neighGraph;
+        processing::NeighbourhoodGraph const* neighGraphPtr = NULL;
+        if ( params.spatial_weight_coeff != _Scalar(0.) )
+        {
+            if ( EXIT_SUCCESS == neighGraph.getOrBuild( processing::NeighbourhoodGraph::getPath(cloud_path), points, params.spatial_weight_dist_mult * params.scale, 3, verbose ) )
+                neighGraphPtr = &neighGraph;
+        } //...neighGraph
+
+        AnglesT         angleGens      = params.angle_gens;
+        AnglesT         candAngleGens  = params.cand_angle_gens;
+        int             smallThresh    = params.small_thresh;
+        int             adopt          = 0;
+        bool            allowPromoted  = true;
+        bool            keepSingles    = true;
+        bool            decreaseLevel  = false; // if false, stay on the same level for one more iteration (patches left to promote)
+        int             nbExtraIter    = params.iterations;
+        int             promRem        = 0;     // count of remaining patches to promote
+        int             err            = EXIT_SUCCESS;
+        PrimitiveContainerT out_prims;          // last solution
+
+        int c = 0;
+        for ( ; (c <= nbExtraIter) && (EXIT_SUCCESS == err); ++c )
+        {
+            // decrease, unless there is more to do on the same level
+            if ( decreaseLevel )
+                smallThresh = int( _Scalar(smallThresh) / params.small_thresh_div );
+
+            // if we reached the bottom working scale, points can be re-assigned, once all patches are promoted
+            if ( (smallThresh < params.small_thresh_limit) || (smallThresh == 0) )
+            {
+                smallThresh = params.small_thresh_limit;
+                if ( decreaseLevel )
+                    adopt = 1;
+            }
+            decreaseLevel = true;
+
+            std::cout << "[" << __func__ << "]: " << "Start iteration " << c << ", smallThreshMult: " << smallThresh << std::endl;
+
+            // generate
+            _PrimitiveMapT candidates;
+            {
+                CandidateGeneratorParams<_Scalar> generatorParams;
+                generatorParams.scale                  = params.scale;
+                generatorParams.angle_limit            = params.angle_limit;
+                generatorParams.angle_limit_div        = params.angle_limit_div;
+                generatorParams.patch_population_limit = params.patch_population_limit;
+                generatorParams.small_mode             = CandidateGeneratorParams<_Scalar>::IGNORE;
+                generatorParams.small_thresh_mult      = smallThresh;
+                generatorParams.var_limit              = (params.hier_cluster_size > 0) ? 0 : params.var_limit; // hierarchical solve keeps all candidates
+                angles::appendAnglesFromGenerators( generatorParams.angles, candAngleGens, false, false );
+
+                promRem = CandidateGenerator::generateStep<_PrimitiveT>( candidates, patches, points, generatorParams, pipeline::toRad(candAngleGens)
+                                                                       , keepSingles, allowPromoted, params.triplet_safe, verbose );
+                std::cout << "[" << __func__ << "]: " << "Remaining smalls to promote: " << promRem << std::endl;
+                if ( promRem != 0 )
+                    decreaseLevel = false;
+            } //...generate
+
+            PrimitiveContainerT prims;
+            pipeline::flatten( prims, candidates );
+            if ( params.checkpoint )
+                io::savePrimitives<_PrimitiveT, InnerConstIteratorT>( prims, pipeline::iterationPath(o_path, "candidates_it", c, ".csv") );
+
+            // formulate and solve
+            {
+                ProblemSetupParams<_Scalar> problemParams;
+                problemParams.scale                    = params.scale;
+                problemParams.weights                  = params.weights;
+                problemParams.constr_mode              = ProblemSetupParams<_Scalar>::PATCH_WISE;
+                problemParams.patch_population_limit   = params.patch_population_limit;
+                problemParams.spatial_weight_coeff     = params.spatial_weight_coeff;
+                problemParams.spatial_weight_dist_mult = params.spatial_weight_dist_mult;
+                problemParams.truncAngle               = params.trunc_angle < _Scalar(0.) ? params.angle_limit : params.trunc_angle;
+                problemParams.collapseAngleSqrt        = std::sqrt( params.collapse_angle_deg * M_PI / _Scalar(180.) );
+                problemParams.var_names                = false;
+                angles::appendAnglesFromGenerators( problemParams.angles, angleGens, false, verbose );
+
+                const Solver::SOLVER solverType = params.native_solver ? Solver::NATIVE : Solver::BONMIN;
+
+                // too many candidates for one problem: coarse-to-fine
+                if (    (params.hier_cluster_size > 0) && (prims.size() > size_t(params.hier_cluster_size))
+                     && (hierarchical::countVariables<_PrimitiveT>(prims) > params.var_limit) )
+                {
+                    HierarchicalSolver::Stats stats;
+                    out_prims.clear();
+                    err = HierarchicalSolver::solve<MyPointPrimitiveDistanceFunctor, _FiniteFiniteDistFunctor, _PrimitiveT>
+                            ( out_prims, prims, points, pclCloud, problemParams, pipeline::toRad(angleGens), solverType, params.max_time, params.bmode
+                            , params.hier_cluster_size, params.hier_reps, &stats, verbose );
+                    if ( EXIT_SUCCESS != err )
+                    {
+                        std::cerr << "[" << __func__ << "]: " << "hierarchical solve failed with " << err << std::endl;
+                        break;
+                    }
+                    std::cout << "[" << __func__ << "]: " << "it" << c << " hierarchical: " << stats.clusters << " clusters, coarse " << stats.coarseVars << " vars, "
+                              << stats.coarseDirs << " directions in " << stats.coarseSeconds << " s, fine " << stats.fineVars << " vars (max " << stats.maxFineVars
+                              << " per cluster) in " << stats.fineSeconds << " s" << std::endl;
+
+                    if ( params.hier_compare )
+                        HierarchicalSolver::compare<MyPointPrimitiveDistanceFunctor, _FiniteFiniteDistFunctor, _PrimitiveT>
+                            ( out_prims, stats.coarseSeconds + stats.fineSeconds, prims, points, pclCloud, problemParams, pipeline::toRad(angleGens)
+                            , solverType, params.max_time, params.bmode, neighGraphPtr, verbose );
+                }
+                else
+                {
+                    problemSetup::OptProblemT problem;
+                    err = ProblemSetup::formulateStep<MyPointPrimitiveDistanceFunctor, _FiniteFiniteDistFunctor>
+                            ( problem, prims, points, problemParams, pipeline::toRad(angleGens), pclCloud, /* clustersMode: */ 0, neighGraphPtr, verbose );
+                    if ( EXIT_SUCCESS != err )
+                    {
+                        std::cerr << "[" << __func__ << "]: " << "formulate failed with " << err << std::endl;
+                        break;
+                    }
+
+                    std::vector<double> x_out;
+                    err = Solver::DO_RETRY; // flip to enter
+                    for ( int attemptCount = 0; (err == Solver::DO_RETRY) && (attemptCount < 2); ++attemptCount )
+                    {
+                        x_out.clear();
+                        if ( params.decompose )
+                            err = Solver::optimizeDecomposed( x_out, problem, solverType, params.max_time, params.bmode, attemptCount, NULL, verbose );
+                        else
+                            err = Solver::optimizeProblem   ( x_out, problem, solverType, params.max_time, params.bmode, attemptCount, NULL, verbose );
+                    }
+                    if ( EXIT_SUCCESS != err )
+                    {
+                        std::cerr << "[" << __func__ << "]: " << "solve failed with " << err << std::endl;
+                        break;
+                    }
+
+                    EnergyEvaluator<double> energy( problem );
+                    energy.setX( x_out );
+                    // complexity is weights(2) on every selected candidate, the rest of qo' * x is data, direction variables follow the candidates
+                    const size_t candCount   = std::min( size_t(hierarchical::countVariables<_PrimitiveT>(prims)), x_out.size() );
+                    const double complexityC = params.weights(2) * std::accumulate( x_out.begin(), x_out.begin() + candCount, 0. );
+                    std::cout << "[" << __func__ << "]: " << "it" << c << " E = " << energy.energy() << " = " << energy.linear() - complexityC << " (data) + "
+                              << energy.pairwise() << " (pw) + " << complexityC << " (cmplx)" << std::endl;
+
+                    out_prims.clear();
+                    Solver::selectPrimitives<_PrimitiveT>( out_prims, prims, x_out );
+                }
+            } //...formulate and solve
+
+            if ( params.checkpoint )
+                io::savePrimitives<_PrimitiveT, InnerConstIteratorT>( out_prims, pipeline::iterationPath(o_path, "primitives_it", c, params.native_solver ? ".native.csv" : ".bonmin.csv") );
+
+            // use the extended angles only after this iteration's solve
+            if ( c == params.use90 )
+            {
+                angleGens     = params.extended_angle_gens;
+                candAngleGens = angleGens;
+            }
+
+            // merge
+            {
+                MergeParams<_Scalar> mergeParams;
+                mergeParams.scale                  = params.scale * params.merge_mult;
+                mergeParams.do_adopt               = adopt;
+                mergeParams.patch_population_limit = params.patch_population_limit;
+                mergeParams.is3D                   = params.is3D;
+                angles::appendAnglesFromGenerators( mergeParams.angles, angleGens, false, verbose );
+
+                _PrimitiveMapT prims_map;
+                pipeline::group<_PrimitiveT>( prims_map, out_prims );
+
+                patches.clear();
+                err = Merging::mergeStep<_PointPrimitiveT,_PrimitiveT>( /* out: */ patches, points, /* in: */ prims_map, mergeParams );
+            } //...merge
+
+            if ( params.checkpoint )
+            {
+                io::savePrimitives<_PrimitiveT, InnerConstIteratorT>( patches, pipeline::iterationPath(o_path, "primitives_merged_it", c, ".csv") );
+                io::writeAssociations<_PointPrimitiveT>( points, pipeline::iterationPath(o_path, "points_primitives_it", c, ".csv") );
+            }
+
+            // don't copy promoted patches' directions to other patches after a few iterations, since they are not reliable anymore
+            if ( c == params.allow_promoted_until ) allowPromoted = false;
+            // don't throw away single directions in the first iterations
+            if ( c == params.keep_singles_until   ) keepSingles   = false;
+
+            // if we are still promoting small patches on this working scale, make sure to run more iterations
+            if ( (c == nbExtraIter) && (promRem != 0) )
+                ++nbExtraIter;
+        } //...for iterations
+
+        // final output, unless already written as checkpoint
+        if ( (EXIT_SUCCESS == err) && !params.checkpoint && (c > 0) )
+        {
+            io::savePrimitives<_PrimitiveT, InnerConstIteratorT>( out_prims, pipeline::iterationPath(o_path, "primitives_it", c - 1, params.native_solver ? ".native.csv" : ".bonmin.csv") );
+            io::savePrimitives<_PrimitiveT, InnerConstIteratorT>( patches  , pipeline::iterationPath(o_path, "primitives_merged_it", c - 1, ".csv") );
+            io::writeAssociations<_PointPrimitiveT>( points, pipeline::iterationPath(o_path, "points_primitives_it", c - 1, ".csv") );
+        }
+        std::cout << "[" << __func__ << "]: " << "finished after " << c << " iterations" << std::endl;
+        std::cout << "[" << __func__ << "]: " << "extent cache " << ExtentCache::instance().stats() << std::endl;
+
+        return err;
+    } //...Pipeline::run()
+} //...ns rapter
+
+#endif // RAPTER_PIPELINE_HPP
@@ -5,6 +5,9 @@
 #include <vector>
 #include <map>
 #include <set> // edgelist
+#include <algorithm>                              // sort, unique
+#include <chrono>                                 // formulation benchmark
+#include <sstream>                                // stringstream
 #include "Eigen/Dense"
 
 #if RAPTER_USE_PCL
@@ -14,13 +17,16 @@
 #include "qcqpcpp/optProblem.h"                   // OptProblem
 
 #include "rapter/optimization/energyFunctors.h" // AbstractPrimitivePrimitiveEnergyFunctor,
+#include "rapter/optimization/energyEvaluator.h" // EnergyEvaluator
 #include "rapter/parameters.h"                  // ProblemSetupParams
 #include "rapter/processing/util.hpp"           // getPopulation()
+#include "rapter/processing/distanceKernels.hpp" // PositionArrays
 #include "rapter/processing/impl/angleUtil.hpp" // appendAngle...
 #include "rapter/io/io.h"                       // readPrimitives(), readPoints()
 #include "rapter/util/pclUtil.h"                // PclCloudPtrT
 
 #include "rapter/processing/graph.hpp"
+#include "rapter/processing/neighbourhoodGraph.hpp" // NeighbourhoodGraph
 #include "rapter/processing/impl/angleUtil.hpp" // appendAnglefromgen
 #include "omp.h"
 
@@ -64,6 +70,12 @@ ProblemSetup::formulateCli( int    argc
     std::string               energy_path        = "energy.csv";
     int                       clustersMode       = 1;
     bool                      calc_energy        = false; // instead of writing the problem, calculate the energy of selecting all input lines.
+    bool                      use_neigh_graph    = true;
+    bool                      bench              = false; // time formulation on growing subsets of the patches instead of writing the problem
+    bool                      pw_check           = false; // compare the pruned pairwise terms to the dense ones instead of writing the problem
+    bool                      write_qcqp         = false; // write problem.qcqp instead of the csv files
+    bool                      write_mps          = false; // export problem.mps next to the problem
+    bool                      write_lp           = false; // export problem.lp next to the problem
     // parse params
     {
         bool valid_input = true;
@@ -83,6 +95,14 @@ ProblemSetup::formulateCli( int    argc
         pcl::console::parse_argument( argc, argv, "--rod"  , problem_rel_path );
         pcl::console::parse_x_arguments( argc, argv, "--angle-gens", angle_gens );
         pcl::console::parse_argument( argc, argv, "--dir-bias", params.dir_id_bias );
+        use_neigh_graph = !pcl::console::find_switch( argc, argv, "--no-neigh-graph" );
+        params.var_names = !pcl::console::find_switch( argc, argv, "--no-var-names" );
+        bench           = pcl::console::find_switch( argc, argv, "--bench" );
+        pw_check        = pcl::console::find_switch( argc, argv, "--pw-check" );
+        write_qcqp      = pcl::console::find_switch( argc, argv, "--qcqp" );
+        write_mps       = pcl::console::find_switch( argc, argv, "--mps" );
+        write_lp        = pcl::console::find_switch( argc, argv, "--lp" );
+        pcl::console::parse_argument( argc, argv, "--pw-eps", params.pw_prune_eps );
         if ( (pcl::console::parse_argument( argc, argv, "--assoc", assoc_path) < 0) && pcl::console::parse_argument( argc, argv, "-a", assoc_path ) < 0 )
         {
             std::cerr << "[" << __func__ << "]: " << "associations (points_primitives.csv) is compulsory!" << std::endl;
@@ -156,10 +176,18 @@ ProblemSetup::formulateCli( int    argc
                       << " [--constr-mode *" << (int)params.constr_mode << "* (patch | point | hybrid ) ]\n"
                       << " [--srand " << srand_val << "]\n"
                       << " [--rod " << problem_rel_path << "]\t\tRelative output path of the output matrix files\n"
+                      << " [--qcqp]\t Write the problem as a single binary problem.qcqp instead of the matrix files, solve reads either.\n"
+                      << " [--mps]\t Export the problem to problem.mps as well, for other solvers.\n"
+                      << " [--lp]\t Export the problem to problem.lp as well, for other solvers.\n"
                       << " [--patch-pop-limit " << params.patch_population_limit << "]\n"
                       << " [--freq-weight " << params.freq_weight << "]\n"
                       << " [--energy-out " << energy_path << "]\n"
                       << " [--no-paral]\n"
+                      << " [--no-neigh-graph]\t Don't map or store the neighbourhood graph next to the cloud.\n"
+                      << " [--no-var-names]\t Don't name the problem variables.\n"
+                      << " [--bench]\t Report formulation time vs. variable count on 1/8, 1/4, 1/2 and all patches, don't write the problem.\n"
+                      << " [--pw-eps " << params.pw_prune_eps << "]\t Leave out direction pairs with a weighted pairwise cost below this.\n"
+                      << " [--pw-check]\t Compare Qo, unpruned and at --pw-eps, against the dense both-ways assembly, don't write the problem.\n"
                       << " [--no-clusters " << clustersMode << "]\n"
                       << " [--spat-weight " << params.spatial_weight_coeff << "]\t How much penalty is added for mismatching primitives for patches in proximity.\n"
                       << " [--spat-dist-mult" << params.spatial_weight_dist_mult << "]\t How many times scale is proximity threshold \n"
@@ -216,69 +244,112 @@ ProblemSetup::formulateCli( int    argc
     if ( nrWarnings )
         std::cerr << "[" << __func__ << "]: " << nrWarnings << "/" << points.size() << " points unAssigned!" << std::endl;
 
-    //AbstractPrimitivePrimitiveEnergyFunctor<Scalar,_PrimitiveT> *primPrimDistFunctor = NULL;
-    SpatialSqrtPrimitivePrimitiveEnergyFunctor<_FiniteFiniteDistFunctor, _PointContainerT, Scalar,_PrimitiveT> *primPrimDistFunctor = NULL;
     // parse cost function
+    if ( cost_string.compare("spatsqrt") )
     {
-        if ( !cost_string.compare("spatsqrt") )
-        {
-            primPrimDistFunctor = new SpatialSqrtPrimitivePrimitiveEnergyFunctor<_FiniteFiniteDistFunctor, _PointContainerT, Scalar,_PrimitiveT>
-                    ( params.angles, points, params.scale );
-            primPrimDistFunctor->_verbose = verbose;
-            primPrimDistFunctor->setUseAngleGen( params.useAngleGen );
-            primPrimDistFunctor->setDirIdBias  ( params.dir_id_bias );
-            primPrimDistFunctor->setTruncAngle ( params.truncAngle );
-            primPrimDistFunctor->setSpatialWeightCoeff( params.spatial_weight_coeff );
-            primPrimDistFunctor->setSpatialWeightDistMult( params.spatial_weight_dist_mult );
-        }
-        else
-        {
-            std::cerr << "[" << __func__ << "]: " << "unrecognized primitive-primitive cost function: " << cost_string << " you probably need --cost-fn \"spatsqrt\""<< std::endl;
-            throw new std::runtime_error( "Unrecognized primitive-primitive cost function" );
-        }
-//             if ( !cost_string.compare("cexp") )    primPrimDistFunctor = new CExpPrimitivePrimitiveEnergyFunctor<Scalar,_PrimitiveT>( params.angles );
-//        else if ( !cost_string.compare("sqrt") )    primPrimDistFunctor = new SqrtPrimitivePrimitiveEnergyFunctor<Scalar,_PrimitiveT>( params.angles );
-//        else                                        std::cerr << "[" << __func__ << "]: " << "Could not parse cost functor input..." << std::endl;
+        std::cerr << "[" << __func__ << "]: " << "unrecognized primitive-primitive cost function: " << cost_string << " you probably need --cost-fn \"spatsqrt\""<< std::endl;
+        throw new std::runtime_error( "Unrecognized primitive-primitive cost function" );
     } //...parse cost function
 
-    // WORK
-    problemSetup::OptProblemT problem;
+    // map or build the point neighbourhoods for the proximity pass
+    processing::NeighbourhoodGraph neighGraph;
+    processing::NeighbourhoodGraph const* neighGraphPtr = NULL;
+    if ( use_neigh_graph && ((params.spatial_weight_coeff != Scalar(0.)) || clustersMode) ) // same as needPairwise in formulate2
+    {
+        if ( EXIT_SUCCESS == neighGraph.getOrBuild( processing::NeighbourhoodGraph::getPath(cloud_path), points, params.spatial_weight_dist_mult * params.scale, 3, verbose ) )
+            neighGraphPtr = &neighGraph;
+    } //...neighGraph
+
     AnglesT angle_gens_in_rad;
     for ( AnglesT::const_iterator angle_it = angle_gens.begin(); angle_it != angle_gens.end(); ++angle_it )
         angle_gens_in_rad.push_back( *angle_it * M_PI / 180. );
-#if 1
-    int err = formulate2<_PointPrimitiveDistanceFunctor>( problem
-                                                        , prims
-                                                        , points
-                                                        , params.constr_mode
-                                                        , params.data_cost_mode
-                                                        , params.scale
-                                                        , params.weights
-                                                        , primPrimDistFunctor
-                                                        , angle_gens_in_rad
-                                                        , params.patch_population_limit
-                                                        , pclCloud
-                                                        , !calc_energy && verbose
-                                                        , params.freq_weight
-                                                        , clustersMode
-                                                        , params.collapseAngleSqrt
-                                                        );
-#else
-    int err = formulate<_PointPrimitiveDistanceFunctor>( problem
-                                                           , prims
-                                                           , points
-                                                           , params.constr_mode
-                                                           , params.data_cost_mode
-                                                           , params.scale
-                                                           , params.weights
-                                                           , primPrimDistFunctor
-                                                           , angle_gens_in_rad
-                                                           , params.patch_population_limit
-                                                           //, params.dir_id_bias
-                                                           , !calc_energy && verbose
-                                                           , params.freq_weight
-                                                           , clustersMode );
-#endif
+
+    // benchmark
+    if ( bench )
+    {
+        std::vector<std::string> report;
+        for ( size_t div = 8; div != 0; div /= 2 )
+        {
+            const size_t patchCount = prims.size() / div;
+            if ( !patchCount ) continue;
+
+            _PrimitiveContainerT      subPrims( prims.begin(), prims.begin() + patchCount );
+            problemSetup::OptProblemT subProblem;
+
+            auto start = std::chrono::system_clock::now();
+            int benchErr = formulateStep<_PointPrimitiveDistanceFunctor, _FiniteFiniteDistFunctor>( subProblem, subPrims, points, params, angle_gens_in_rad, pclCloud, clustersMode, neighGraphPtr, false );
+            std::chrono::duration<double> elapsed_seconds = std::chrono::system_clock::now() - start;
+            if ( EXIT_SUCCESS != benchErr )
+                return benchErr;
+
+            std::stringstream line;
+            line << patchCount << "," << subProblem.getVarCount() << "," << subProblem.getConstraintCount() << ","
+                 << subProblem.getQuadraticObjectives().size() << "," << elapsed_seconds.count();
+            report.push_back( line.str() );
+        } //...for patch subsets
+
+        std::cout << "[" << __func__ << "]: " << "patches,vars,constraints,qo_entries,seconds" << std::endl;
+        for ( size_t i = 0; i != report.size(); ++i )
+            std::cout << "[" << __func__ << "]: " << report[i] << std::endl;
+        return EXIT_SUCCESS;
+    } //...bench
+
+    // pruning check: the symmetric assembly against the dense both-ways reference, unpruned and at --pw-eps
+    if ( pw_check )
+    {
+        typedef problemSetup::OptProblemT::SparseMatrix SparseMatrix;
+
+        problemSetup::OptProblemT          referenceProblem, denseProblem, prunedProblem;
+        rapter::ProblemSetupParams<Scalar> referenceParams( params ), denseParams( params );
+        referenceParams.pw_reference = true;
+        denseParams.pw_prune_eps     = Scalar( 0. );
+        int checkErr = formulateStep<_PointPrimitiveDistanceFunctor, _FiniteFiniteDistFunctor>( referenceProblem, prims, points, referenceParams, angle_gens_in_rad, pclCloud, clustersMode, neighGraphPtr, false );
+        if ( EXIT_SUCCESS == checkErr )
+            checkErr = formulateStep<_PointPrimitiveDistanceFunctor, _FiniteFiniteDistFunctor>( denseProblem    , prims, points, denseParams    , angle_gens_in_rad, pclCloud, clustersMode, neighGraphPtr, false );
+        if ( EXIT_SUCCESS == checkErr )
+            checkErr = formulateStep<_PointPrimitiveDistanceFunctor, _FiniteFiniteDistFunctor>( prunedProblem   , prims, points, params         , angle_gens_in_rad, pclCloud, clustersMode, neighGraphPtr, false );
+        if ( EXIT_SUCCESS != checkErr )
+            return checkErr;
+
+        // x'Qo x only depends on Qo + Qo', the reference has (i,j) and (j,i), the symmetric assembly only i < j
+        auto maxAbs = []( SparseMatrix const& mx ) -> double
+        {
+            double maxValue = 0.;
+            for ( int k = 0; k < mx.outerSize(); ++k )
+                for ( SparseMatrix::InnerIterator it(mx, k); it; ++it )
+                    maxValue = std::max( maxValue, std::abs(it.value()) );
+            return maxValue;
+        };
+        const SparseMatrix referenceQo = referenceProblem.getQuadraticObjectivesMatrix();
+        const SparseMatrix denseQo     = denseProblem    .getQuadraticObjectivesMatrix();
+        const SparseMatrix prunedQo    = prunedProblem   .getQuadraticObjectivesMatrix();
+        const SparseMatrix referenceS  = referenceQo + SparseMatrix( referenceQo.transpose() );
+        const SparseMatrix denseDiff   = referenceS  - (denseQo  + SparseMatrix( denseQo .transpose() ));
+        const SparseMatrix prunedDiff  = referenceS  - (prunedQo + SparseMatrix( prunedQo.transpose() ));
+        const double       tol         = 1.e-6 * std::max( 1., maxAbs(referenceS) ); // calcPwCost in _Scalar, both orderings may round apart
+        const double       denseMax    = maxAbs( denseDiff  );
+        const double       prunedMax   = maxAbs( prunedDiff );
+        // spatial entries are the same in both, so the missing entries are the pruned direction pairs
+        const size_t       prunedPairs = denseProblem.getQuadraticObjectives().size() - prunedProblem.getQuadraticObjectives().size();
+
+        std::cout << "[" << __func__ << "]: " << "Qo entries: " << referenceProblem.getQuadraticObjectives().size() << " reference, " << denseProblem.getQuadraticObjectives().size()
+                  << " symmetric, " << prunedProblem.getQuadraticObjectives().size() << " pruned (" << prunedPairs << " direction pairs below eps " << params.pw_prune_eps << ")" << std::endl;
+        std::cout << "[" << __func__ << "]: " << "max Qo + Qo' difference to the reference: " << denseMax << " unpruned, " << prunedMax << " pruned (bound " << 2. * params.pw_prune_eps << ")" << std::endl;
+        return ( (denseMax <= tol) && (prunedMax <= 2. * params.pw_prune_eps + tol) ) ? EXIT_SUCCESS : EXIT_FAILURE;
+    } //...pw_check
+
+    // WORK
+    problemSetup::OptProblemT problem;
+    int err = formulateStep<_PointPrimitiveDistanceFunctor, _FiniteFiniteDistFunctor>( problem
+                                                                                     , prims
+                                                                                     , points
+                                                                                     , params
+                                                                                     , angle_gens_in_rad
+                                                                                     , pclCloud
+                                                                                     , clustersMode
+                                                                                     , neighGraphPtr
+                                                                                     , !calc_energy && verbose
+                                                                                     );
 
     // dump. default output: ./problem/*.csv; change by --rod
     if ( EXIT_SUCCESS == err )
@@ -290,16 +361,31 @@ ProblemSetup::formulateCli( int    argc
         if ( !calc_energy )
         {
             std::string problem_path = parent_path + "/" + problem_rel_path;
-            problem.write( problem_path );
+            if ( write_qcqp )
+            {
+                // a stale problem.proj would be read instead
+                boost::filesystem::create_directories( problem_path );
+                boost::filesystem::remove( problem_path + "/problem.proj" );
+                err = problem.writeBinary( problem_path + "/" + problem.getBinaryName(), params.var_names );
+            }
+            else
+                problem.write( problem_path );
+
+            if ( write_mps && (EXIT_SUCCESS == err) )
+                err = problem.writeMps( problem_path + "/" + problem.getMpsName() );
+            if ( write_lp  && (EXIT_SUCCESS == err) )
+                err = problem.writeLp ( problem_path + "/" + problem.getLpName() );
         }
         else
         {
             problemSetup::OptProblemT::VectorX x( problem.getVarCount(), 1 );
             x.setOnes();
-            Scalar dataPlusCmplx = (x.transpose() * problem.getLinObjectivesMatrix()).coeff(0);
+            EnergyEvaluator<problemSetup::OptProblemT::Scalar> energy( problem );
+            energy.setX( x );
+            Scalar dataPlusCmplx = energy.linear();
             Scalar complexityC   = x.sum() * params.weights(2);
             Scalar dataC         = dataPlusCmplx - complexityC;
-            Scalar pairwiseC     = (x.transpose() * problem.getQuadraticObjectivesMatrix() * x );
+            Scalar pairwiseC     = energy.pairwise();
             std::cout << "E = " << dataC + pairwiseC + complexityC << " = "
                       << dataC << " (data) + " << pairwiseC << "(pw) + " << complexityC << " (cmplx)"
                       << " = "
@@ -313,25 +399,76 @@ ProblemSetup::formulateCli( int    argc
         }
     } //...dump
 
-    // cleanup
-    if ( primPrimDistFunctor ) { delete primPrimDistFunctor; primPrimDistFunctor = NULL; }
-
     return err;
 } //...ProblemSetup::formulateCli()
 
+template < class _PointPrimitiveDistanceFunctor
+         , class _FiniteFiniteDistFunctor
+         , class _PrimitiveContainerT
+         , class _PointContainerT
+         , typename _Scalar
+         , class _PrimitiveT
+         > int
+ProblemSetup::formulateStep( problemSetup::OptProblemT                & problem
+                           , _PrimitiveContainerT                const& prims
+                           , _PointContainerT                    const& points
+                           , ProblemSetupParams<_Scalar>         const& params
+                           , AnglesT                             const& angle_gens_in_rad
+                           , PclCloudPtrT                             & pclCloud
+                           , int                                 const  clustersMode
+                           , processing::NeighbourhoodGraph      const* neighGraph
+                           , bool                                const  verbose )
+{
+    typedef SpatialSqrtPrimitivePrimitiveEnergyFunctor<_FiniteFiniteDistFunctor, _PointContainerT, _Scalar, _PrimitiveT> PrimPrimDistFunctorT;
+
+    PrimPrimDistFunctorT primPrimDistFunctor( params.angles, points, params.scale );
+    primPrimDistFunctor._verbose = verbose;
+    primPrimDistFunctor.setUseAngleGen( params.useAngleGen );
+    primPrimDistFunctor.setDirIdBias  ( params.dir_id_bias );
+    primPrimDistFunctor.setTruncAngle ( params.truncAngle );
+    primPrimDistFunctor.setSpatialWeightCoeff( params.spatial_weight_coeff );
+    primPrimDistFunctor.setSpatialWeightDistMult( params.spatial_weight_dist_mult );
+
+    PrimPrimDistFunctorT *primPrimDistFunctorPtr = &primPrimDistFunctor;
+    return formulate2<_PointPrimitiveDistanceFunctor>( problem
+                                                     , prims
+                                                     , points
+                                                     , params.constr_mode
+                                                     , params.data_cost_mode
+                                                     , params.scale
+                                                     , params.weights
+                                                     , primPrimDistFunctorPtr
+                                                     , angle_gens_in_rad
+                                                     , params.patch_population_limit
+                                                     , pclCloud
+                                                     , verbose
+                                                     , params.freq_weight
+                                                     , clustersMode
+                                                     , params.collapseAngleSqrt
+                                                     , neighGraph
+                                                     , params.var_names
+                                                     , params.pw_prune_eps
+                                                     , params.pw_reference
+                                                     );
+} //...ProblemSetup::formulateStep()
+
 /*! \brief                  Calculate vicinity of patches based on smallest point-point distance.
  * \tparam      NeighMapT   map<GidT,set<GidT>>
  * \param[in]   radius      Lookup radius, usually 2x scale (\ref ProblemSetupParams::spatial_weight_distance)
+ * \param[in]   neighGraph  Optional precomputed neighbourhoods, a kd-tree is built, if NULL or not covering \p radius.
  */
 template <class NeighMapT, typename _PointContainerT, typename _Scalar>
-inline void calculateNeighbourhoods( NeighMapT &proximity, _PointContainerT const& points, const _Scalar radius )
+inline void calculateNeighbourhoods( NeighMapT &proximity, _PointContainerT const& points, const _Scalar radius, processing::NeighbourhoodGraph const* neighGraph = NULL )
 {
     typedef typename _PointContainerT::PrimitiveT PointPrimitiveT;
     //typedef typename PointPrimitiveT::Scalar Scalar;
     using pclutil::PclSearchPointT;
     typedef Eigen::Vector3f Colour;
 
-    pclutil::PclSearchTreePtrT tree = pclutil::buildANN( points );
+    const bool useGraph = neighGraph && (neighGraph->size() == points.size()) && neighGraph->covers( radius, 0 );
+    pclutil::PclSearchTreePtrT tree;
+    if ( !useGraph )
+        tree = pclutil::buildANN( points );
 
     std::vector<int>    k_indices;
     std::vector<float>  k_sqr_distances;
@@ -343,9 +480,14 @@ inline void calculateNeighbourhoods( NeighMapT &proximity, _PointContainerT cons
 
         if ( gidI == PointPrimitiveT::TAG_UNSET ) continue;
 
-        pclutil::PclSearchPointT pnt;
-        pnt.getVector3fMap() = points[i].template pos();
-        tree->radiusSearch( pnt, radius, k_indices, k_sqr_distances, /*maxnn:*/ 0 );
+        if ( useGraph )
+            neighGraph->radiusSearch( i, radius, k_indices, k_sqr_distances, /*maxnn:*/ 0 );
+        else
+        {
+            pclutil::PclSearchPointT pnt;
+            pnt.getVector3fMap() = points[i].template pos();
+            tree->radiusSearch( pnt, radius, k_indices, k_sqr_distances, /*maxnn:*/ 0 );
+        }
 
 #       pragma omp critical (NEIGHWARN)
         if ( k_indices.size() > 1000 )
@@ -395,6 +537,10 @@ ProblemSetup::formulate2( problemSetup::OptProblemT
                        , _Scalar                                                       const  freq_weight /* = 0. */
                        , int                                                           const  clusterMode
                        , _Scalar                                                       const  collapseThreshold /* = 0.07 */ // sqrt( 0.1 * PI / 180 ) == 0.06605545496
+                       , processing::NeighbourhoodGraph                                const* neighGraph /* = NULL */
+                       , bool                                                          const  varNames /* = true */
+                       , _Scalar                                                       const  pwPruneEps /* = 0. */
+                       , bool                                                          const  pwReference /* = false */
         )
 {
     using problemSetup::OptProblemT;
@@ -413,8 +559,7 @@ ProblemSetup::formulate2( problemSetup::OptProblemT
     // log
     if ( verbose ) { std::cout << "[" << __func__ << "]: " << "formulating problem...\n"; fflush(stdout); }
 
-    typedef std::pair<LidT   ,LidT> IntPair;
-    /*   */ std::map <IntPair,LidT> lids_varids;
+    problemSetup::VarIdMap          lids_varids; // contiguous, prims[lid][lid1] -> varId
     /*   */ std::map <DidT   ,LidT> dIdsVarIds;
     std::set<LidT> chosen_varids;
 
@@ -436,12 +581,14 @@ ProblemSetup::formulate2( problemSetup::OptProblemT
     _Scalar minScore = std::numeric_limits<_Scalar>::max();
     std::map< DidT, ULidT > dIdPopuls; // <did, pointcount>
     {
-        std::set< DIdPair > visited;
+        // The pair (did,did2) used to be scored by the first primitives of did and did2 met in a nested loop over all primitives.
+        // Keeping the first valid primitive of each direction in order of appearance gives the same pairs in the same order in O(#dirs^2).
+        std::vector< _PrimitiveT const* > dIdReps;
+        std::set< DidT >                  seen;
         for ( size_t lid = 0; lid != prims.size(); ++lid )
             for ( size_t lid1 = 0; lid1 != prims[lid].size(); ++lid1 )
             {
                 // skip small
-                //if ( prims[lid][lid1].getTag(_PrimitiveT::TAGS::STATUS) == _PrimitiveT::STATUS_VALUES::SMALL ) continue;
                 if ( !(   (prims[lid][lid1].getTag(_PrimitiveT::TAGS::STATUS) == _PrimitiveT::STATUS_VALUES::ACTIVE)
                        || (prims[lid][lid1].getTag(_PrimitiveT::TAGS::STATUS) == _PrimitiveT::STATUS_VALUES::FIXED)
                       )
@@ -452,40 +599,27 @@ ProblemSetup::formulate2( problemSetup::OptProblemT
                 const GidT gid = prims[lid][lid1].getTag(_PrimitiveT::TAGS::GID);
 
                 // skip empty
-                if ( (populations.find(gid) != populations.end()) && !populations[gid].size() ) continue;
+                GidPidVectorMap::const_iterator popIt = populations.find( gid );
+                if ( (popIt != populations.end()) && !popIt->second.size() ) continue;
 
-                dIdPopuls[did] += ( (populations.find( gid ) != populations.end()) ? populations[gid].size()
-                                                                                   : 0 );
+                dIdPopuls[did] += ( (popIt != populations.end()) ? popIt->second.size() : 0 );
 
-                for ( size_t lid2 = 0; lid2 != prims.size(); ++lid2 )
-                    for ( size_t lid3 = 0; lid3 != prims[lid2].size(); ++lid3 )
-                    {
-                        //if ( prims[lid2][lid3].getTag(_PrimitiveT::TAGS::STATUS) == _PrimitiveT::STATUS_VALUES::SMALL ) continue;
-
-                        if ( !(   (prims[lid2][lid3].getTag(_PrimitiveT::TAGS::STATUS) == _PrimitiveT::STATUS_VALUES::ACTIVE)
-                               || (prims[lid2][lid3].getTag(_PrimitiveT::TAGS::STATUS) == _PrimitiveT::STATUS_VALUES::FIXED)
-                              )
-                           )
-                            continue;
+                if ( seen.insert(did).second )
+                    dIdReps.push_back( &(prims[lid][lid1]) );
+            } //...for prims
 
-                        const DidT did2 = prims[lid2][lid3].getTag(_PrimitiveT::TAGS::DIR_GID);
-                        const GidT gid2 = prims[lid2][lid3].getTag(_PrimitiveT::TAGS::GID);
-                        if ( did == did2 ) continue;
-                        if ( (populations.find(gid2) != populations.end()) && !populations[gid2].size() ) continue;
+        for ( size_t i = 0; i != dIdReps.size(); ++i )
+            for ( size_t j = 0; j != dIdReps.size(); ++j )
+            {
+                if ( i == j ) continue;
 
-                        DIdPair pair = DIdPair(did,did2);
-                        if ( visited.find( pair ) == visited.end() )
-                        {
-                            _Scalar score = calcPwCost<_Scalar>( prims[lid][lid1], prims[lid2][lid3], angles );
-                            if ( score < minScore )
-                            {
-                                minScore = score;
-                                minPair = pair;
-                            }
-                            visited.insert( pair );
-                        } //...if not visited
-                    } //...inner
-            } //...outer
+                _Scalar score = calcPwCost<_Scalar>( *dIdReps[i], *dIdReps[j], angles );
+                if ( score < minScore )
+                {
+                    minScore = score;
+                    minPair  = DIdPair( dIdReps[i]->getTag(_PrimitiveT::TAGS::DIR_GID), dIdReps[j]->getTag(_PrimitiveT::TAGS::DIR_GID) );
+                }
+            } //...for representative pairs
     } //...smallest pwcost
     std::cout << "[" << __func__ << "]: " << "mincost: " << minScore << " by " << minPair.first << "-" << minPair.second
               << ", populs: " << dIdPopuls[ minPair.first ] << " vs " << dIdPopuls[ minPair.second ]
@@ -518,7 +652,8 @@ ProblemSetup::formulate2( problemSetup::OptProblemT
     std::map< DidT, std::vector< LidT > > dIdsPrimVarIds;
     std::map< DidT, _PrimitiveT const* > dIdsPrims; // representatives for direction read later
     {
-        char name[16];
+        char name[64] = "";
+        lids_varids.reset( prims );
         for ( size_t lid = 0; lid != prims.size(); ++lid )
         {
             for ( size_t lid1 = 0; lid1 != prims[lid].size(); ++lid1 )
@@ -530,12 +665,13 @@ ProblemSetup::formulate2( problemSetup::OptProblemT
                 // add var
                 GidT gId = prims[lid][lid1].getTag( _PrimitiveT::TAGS::GID     );
                 LidT dId = prims[lid][lid1].getTag( _PrimitiveT::TAGS::DIR_GID );
-                sprintf( name, "x_%ld_%ld", gId, dId );
+                if ( varNames )
+                    sprintf( name, "x_%ld_%ld", gId, dId );
 
                 // store var_id for later, add binary variable
                 const UidT var_id = problem.addVariable( OptProblemT::BOUND::RANGE, 0.0, 1.0, OptProblemT::VAR_TYPE::INTEGER
                                                       , OptProblemT::LINEARITY::LINEAR, name ); // changed to nonlinear by Aron on 29.12.2014
-                lids_varids[ IntPair(lid,lid1) ] = var_id;
+                lids_varids.set( lid, lid1, var_id );
 
                 // save for initial starting point: 1. [active && ( no replace OR has not dId to be replaced )] OR [ replace set && has the dId to replace by ]
                 if (    (    (prims[lid][lid1].getTag(_PrimitiveT::TAGS::STATUS) == _PrimitiveT::STATUS_VALUES::ACTIVE)
@@ -567,7 +703,8 @@ ProblemSetup::formulate2( problemSetup::OptProblemT
             DidT dId     = dIdsIt->first;
             auto &varIds = dIdsIt->second;
 
-            sprintf( name, "dId%ld", dId );
+            if ( varNames )
+                sprintf( name, "dId%ld", dId );
 
             // store varId for later, add binary variable
             const LidT varId = problem.addVariable( OptProblemT::BOUND::RANGE, 0.0, 1.0, OptProblemT::VAR_TYPE::BINARY
@@ -669,21 +806,32 @@ ProblemSetup::formulate2( problemSetup::OptProblemT
         if ( needPairwise )
         {
             std::cout << "[" << __func__ << "]: " << "proximity start..." << std::endl; fflush(stdout);
-            calculateNeighbourhoods( proximities, points, primPrimDistFunctor->getSpatialWeightDistMult() * scale );
+            calculateNeighbourhoods( proximities, points, primPrimDistFunctor->getSpatialWeightDistMult() * scale, neighGraph );
             std::cout << "[" << __func__ << "]: " << "proximity end..." << std::endl; fflush(stdout);
         }
 
         //GraphT::testGraph();
         std::set< EdgeT > edgesList;
 
-        const _Scalar halfSpatialWeightCoeff = primPrimDistFunctor->getSpatialWeightCoeff() / _Scalar(2.); // we add both ways, so adds up
+        const _Scalar spatialWeightCoeff = primPrimDistFunctor->getSpatialWeightCoeff(); // added once for varId0 < varId1, used to be half of it both ways
         if ( needPairwise )
         {
             if ( verbose ) {  std::cout << "[" << __func__ << "]: " << "spatial start..." << std::endl; fflush(stdout); }
 
-#           pragma omp parallel for num_threads(RAPTER_MAX_OMP_THREADS)
+            // variables of each patch, so that only patches in proximity are visited
+            std::map< GidT, std::vector<LidLid> > gidLids;
+            for ( size_t lid = 0; lid != prims.size(); ++lid )
+                for ( size_t lid1 = 0; lid1 != prims[lid].size(); ++lid1 )
+                    if ( prims[lid][lid1].getTag( _PrimitiveT::TAGS::STATUS ) != _PrimitiveT::STATUS_VALUES::SMALL )
+                        gidLids[ prims[lid][lid1].getTag(_PrimitiveT::TAGS::GID) ].push_back( LidLid(lid,lid1) );
+
+            // per-thread entry lists, assembled once below instead of locking the problem for each entry
+            std::vector< std::vector<SparseEntry> > threadEntries( RAPTER_MAX_OMP_THREADS );
+            ULidT spatialCandidates = 0; // non-small primitives, the dense path used to test each pair of them
+#           pragma omp parallel for num_threads(RAPTER_MAX_OMP_THREADS) schedule(dynamic) reduction(+:spatialCandidates)
             for ( size_t lid = 0; lid < prims.size(); ++lid )
             {
+                std::vector<SparseEntry> &entries = threadEntries[ omp_get_thread_num() ];
                 for ( size_t lid1 = 0; lid1 != prims[lid].size(); ++lid1 )
                 {
                     _PrimitiveT const& prim = prims[lid][lid1];
@@ -693,59 +841,55 @@ ProblemSetup::formulate2( problemSetup::OptProblemT
                     const GidT gid = prim.getTag( _PrimitiveT::TAGS::GID );
                     const DidT did = prim.getTag( _PrimitiveT::TAGS::DIR_GID );
 
-                    // extremas key
-                    LidLid lidLid1( lid, lid1 );
+                    ++spatialCandidates;
 
-                    for ( size_t lidOth = 0; lidOth != prims.size(); ++lidOth )
+                    // we don't want to pollute problem with unnecessary edges, proximities never contain gid itself
+                    ProximityMapT::const_iterator gidNeighsIt = proximities.find( gid );
+                    if ( gidNeighsIt == proximities.end() )
+                        continue;
+
+                    const LidT varId0 = lids_varids.get( lid, lid1 );
+                    for ( auto gIdOtherIt = gidNeighsIt->second.begin(); gIdOtherIt != gidNeighsIt->second.end(); ++gIdOtherIt )
                     {
-                        for ( size_t lid1Oth = 0; lid1Oth != prims[lidOth].size(); ++lid1Oth )
-                        {
-                            _PrimitiveT const& prim1 = prims[lidOth][lid1Oth];
+                        typename std::map< GidT, std::vector<LidLid> >::const_iterator othersIt = gidLids.find( *gIdOtherIt );
+                        if ( othersIt == gidLids.end() )
+                            continue;
 
-                            if ( prim1.getTag( _PrimitiveT::TAGS::STATUS ) == _PrimitiveT::STATUS_VALUES::SMALL )
+                        for ( auto lidLidOth = othersIt->second.begin(); lidLidOth != othersIt->second.end(); ++lidLidOth )
+                        {
+                            // proximities are symmetric, so the other half is visited from varId1
+                            const LidT varId1 = lids_varids.get( lidLidOth->first, lidLidOth->second );
+                            if ( (varId1 < varId0) && !pwReference )
                                 continue;
 
-                            // skip same line, that's always zero
-                            if ( (lid == lidOth) && (lid1 == lid1Oth) ) continue;
-
-                            const GidT gIdOther = prim1.getTag( _PrimitiveT::TAGS::GID );
-                            const DidT dIdOther = prim1.getTag( _PrimitiveT::TAGS::DIR_GID );
-
-                            ProximityMapT::const_iterator gidNeighsIt = proximities.find( gid );
-                            if (    /*( did != dIdOther )
-                                 && */( gid != gIdOther ) // we don't want to pollute problem with unnecessary edges
-                                 && (    (gidNeighsIt                        != proximities.end()        )
-                                      && (gidNeighsIt->second.find(gIdOther) != gidNeighsIt->second.end())
-                                    )
-                               )
-                            {
-//                                std::cout << "adding spatw " << halfSpatialWeightCoeff << " to "
-//                                          << lid << ", " << lid1 << " - "
-//                                          << lidOth  << ", " << lid1Oth
-//                                          << std::endl;
-                                const LidT varId0 = lids_varids.at( lidLid1 );
-                                const LidT varId1 = lids_varids.at( IntPair(lidOth,lid1Oth) );
-#                               pragma omp critical (PS_PROBLEM)
-                                {
-                                    if ( did != dIdOther )
-                                        problem.addQObjective( varId0, varId1, halfSpatialWeightCoeff ); // /2, since it's going to be added both ways Aron 6/1/2015
-#if 0
-                                    else { // encourage parallel added by Aron 19/4/2015
-#warning "Temporary Tweak"
-                                        Scalar ang = rapter::angleInRad( prim.template dir(), prim1.template dir() );
-                                        while ( ang > M_PI ) ang -= M_PI;
-                                        ang = std::min( ang, Scalar(M_PI - ang) );
-                                        if ( ang > 0.01 )
-                                            problem.addQObjective( varId0, varId1, halfSpatialWeightCoeff/2. ); // /2, since it's going to be added both ways Aron 6/1/2015
-                                    }
-#endif
-                                }
-                            }
-                        } // ... olid1
-                    } // ... olid
+                            _PrimitiveT const& prim1 = prims[lidLidOth->first][lidLidOth->second];
+                            if ( did != prim1.getTag( _PrimitiveT::TAGS::DIR_GID ) )
+                                entries.push_back( SparseEntry(varId0, varId1, pwReference ? spatialWeightCoeff / _Scalar(2.) : spatialWeightCoeff) ); // reference: /2, added both ways
+                        }
+                    } // ... gIdOther
                 } // ... lid1
             } // ... lid
 
+            // one assembly for all spatial entries, the problem sums duplicates lazily
+            {
+                size_t entryCount = 0;
+                for ( size_t t = 0; t != threadEntries.size(); ++t )
+                    entryCount += threadEntries[t].size();
+                std::vector<SparseEntry> &entries = threadEntries[0];
+                entries.reserve( entryCount );
+                for ( size_t t = 1; t < threadEntries.size(); ++t )
+                {
+                    entries.insert( entries.end(), threadEntries[t].begin(), threadEntries[t].end() );
+                    std::vector<SparseEntry>().swap( threadEntries[t] );
+                }
+
+                SparseMatrix spatialQo( problem.getVarCount(), problem.getVarCount() );
+                spatialQo.setFromTriplets( entries.begin(), entries.end() );
+                std::vector<SparseEntry>().swap( entries );
+                err = problem.addQObjectives( spatialQo );
+                std::cout << "[" << __func__ << "]: " << "spatial pairs: " << entryCount << " of " << spatialCandidates * (spatialCandidates - 1) / 2 << " candidate pairs in proximity" << std::endl;
+            }
+
             if ( clusterMode )
             {
                 throw new std::runtime_error("turn off clusterMode!");
@@ -871,28 +1015,36 @@ ProblemSetup::formulate2( problemSetup::OptProblemT
     // ____________________________________________________
     // dId pw cost
     {
-        //#pragma omp parallel for num_threads(RAPTER_MAX_OMP_THREADS)
-        for ( auto it0 = dIdsVarIds.begin(); it0 != dIdsVarIds.end(); ++it0 )
-            for ( auto it1 = dIdsVarIds.begin(); it1 != dIdsVarIds.end(); ++it1 )
+        // the cost is symmetric, so each pair is evaluated once and gets the weight of both (i,j) and (j,i)
+        std::vector< std::pair<DidT,LidT> > dIdVarIds( dIdsVarIds.begin(), dIdsVarIds.end() ); // <dId, varId>
+        ULidT pruned = 0;
+        for ( size_t i = 0; i < dIdVarIds.size(); ++i )
+            for ( size_t j = pwReference ? 0 : i + 1; j < dIdVarIds.size(); ++j )
             {
-                // first: dId
-                // second: varId
+                if ( i == j ) continue; // self pw cost is 0
 
-                if ( it1->second == it0->second ) continue; // self pw cost is 0
-
-                _PrimitiveT const* p0 = dIdsPrims[it0->first];
-                _PrimitiveT const* p1 = dIdsPrims[it1->first];
+                _PrimitiveT const* p0 = dIdsPrims[ dIdVarIds[i].first ];
+                _PrimitiveT const* p1 = dIdsPrims[ dIdVarIds[j].first ];
                 //
                 //_Scalar score = weights(1) * sqrt( rapter::angleInRad(p0->template dir(), p1->template dir()) );
                 //_Scalar score = weights(1) * sqrt( MyPrimitivePrimitiveAngleFunctor::eval( *p0, *p1, angles ) ); //changed 16:11 15/01/2015
                 _Scalar score = weights(1) * calcPwCost<_Scalar>( *p0, *p1, angles );
-//#               pragma omp critical (PS_PROBLEM)
+                if ( pwReference )
                 {
-                    problem.addQObjective( it0->second, it1->second
-                                           , score // score
-                                           );
+                    problem.addQObjective( dIdVarIds[i].second, dIdVarIds[j].second, score ); // each ordering, as the dense path
+                    continue;
                 }
+                if ( score < pwPruneEps )
+                {
+                    ++pruned;
+                    continue;
+                }
+
+                problem.addQObjective( dIdVarIds[i].second, dIdVarIds[j].second
+                                     , score + score // both ways
+                                     );
             }
+        std::cout << "[" << __func__ << "]: " << "direction pairs: " << dIdVarIds.size() * (dIdVarIds.size() - 1) / 2 << ", pruned " << pruned << " below " << pwPruneEps << std::endl;
     } //...dId pw cost
     if ( verbose ) {  std::cout << "[" << __func__ << "]: " << "lvl2 pw end..." << std::endl; fflush(stdout); }
 
@@ -951,20 +1103,18 @@ namespace problemSetup {
                                       , _Scalar              const  /*scale*/
                                       , bool                 const  verbose     /* = false */ )
     {
-        typedef typename _AssocT::key_type IntPair;
+        typedef typename _AssocT::key_type          IntPair;
+        typedef typename _OptProblemT::SparseMatrix SparseMatrix;
 
         int err = EXIT_SUCCESS;
 
         // one direction / patch needs to be choosen
-        std::vector< double              > coeffs ( problem.getVarCount(), 0 ); // constraint coefficient line in A
-        std::set   < std::vector<double> > uniqueA;                             // to ensure unique constraints
+        std::vector< LidT              > varIds;  // non-zero columns of the constraint line in A
+        std::set   < std::vector<LidT> > uniqueA; // to ensure unique constraints
         // for all patches
         for ( size_t lid = 0; lid != prims.size(); ++lid )
         {
-            bool non_zero_line = false;
-
-            // init row to 0
-            std::fill( coeffs.begin(), coeffs.end(), 0 );
+            varIds.clear();
 
             // add 1 for each direction patch -> at least one direction has to be chosen for this patch
             for ( size_t lid1 = 0; lid1 != prims[lid].size(); ++lid1 )
@@ -973,20 +1123,23 @@ namespace problemSetup {
                     continue;
 
                 if ( verbose && (lid1 == 0) ) std::cout << "[" << __func__ << "]: " << "Constraining " << prims[lid][lid1].getTag( _PrimitiveT::TAGS::GID ) << " to choose one of ";
-                coeffs[ /* varid: */ lids_varids.at(IntPair(lid,lid1)) ] = 1.0;
-                non_zero_line = true;
+                varIds.push_back( /* varid: */ lids_varids.at(IntPair(lid,lid1)) );
                 if ( verbose ) std::cout << prims[lid][lid1].getTag( _PrimitiveT::TAGS::DIR_GID ) << ", ";
             }
             if ( verbose )std::cout << " directions";
 
-            if ( non_zero_line )
+            if ( varIds.size() )
             {
                 // unique insertion
-                unsigned prev_size = uniqueA.size(); // store prev set size to check for unique insert
-                uniqueA.insert( coeffs );            // insert into set
-                if ( uniqueA.size() > prev_size )    // if line was unique, add to problem
+                std::sort( varIds.begin(), varIds.end() );
+                varIds.erase( std::unique(varIds.begin(), varIds.end()), varIds.end() );
+                if ( uniqueA.insert( varIds ).second ) // if line was unique, add to problem
                 {
-                    problem.addLinConstraint( _OptProblemT::BOUND::GREATER_EQ, 1, problem.getINF(), coeffs ); // 1 <= A( lid, : ) * X <= INF
+                    SparseMatrix coeffs( 1, problem.getVarCount() );
+                    coeffs.reserve( varIds.size() );
+                    for ( size_t i = 0; i != varIds.size(); ++i )
+                        coeffs.insert( 0, varIds[i] ) = 1.0;
+                    problem.addConstraint( _OptProblemT::BOUND::GREATER_EQ, 1, problem.getINF(), &coeffs ); // 1 <= A( lid, : ) * X <= INF
                     if  ( verbose )     std::cout << " ADDED\n";
                 }
                 else
@@ -1061,6 +1214,14 @@ namespace problemSetup {
 
             // cache patch group id to match with point group ids
             const GidT gid = prims[lid][0].getTag( _PrimitiveT::TAGS::GID );
+            // points with GID == gid in ascending order, read-only lookup, since we are in a parallel loop
+            GidPidVectorMap::const_iterator popIt = populations.find( gid );
+            const bool hasPopulation = (popIt != populations.end()) && popIt->second.size();
+            // positions of the population, shared by all directions of the patch
+            processing::kernels::PositionArrays<_Scalar> positions;
+            if ( hasPopulation )
+                processing::kernels::gatherPositions( positions, points, &(popIt->second) );
+            std::vector<_Scalar> distances;
 
             // for each direction
             for ( size_t lid1 = 0; lid1 < prims[lid].size(); ++lid1 )
@@ -1073,34 +1234,31 @@ namespace problemSetup {
                         ( extrema
                         , points
                         , scale
-                        , populations[gid].size() ? &(populations[gid]) : NULL );
+                        , hasPopulation ? &(popIt->second) : NULL );
 
                 // point count for normalization
                 unsigned cnt = 0;
                 // data-cost coefficient (output)
                 _Scalar unary_i = _Scalar(0);
-                // for each point, check if assigned to main patch (TODO: move assignment test to earlier, it's indep of lid1)
-                for ( size_t pid = 0; pid != points.size(); ++pid )
+                // for each point assigned to main patch
+                if ( hasPopulation )
                 {
-                    //if ( points[pid].getTag( PointPrimitiveT::TAGS::GID ) == static_cast<int>(lid) )
-                    if ( points[pid].getTag( _PointPrimitiveT::TAGS::GID ) == gid )
+                    // changed by Aron on 6/1/2015
+                    if ( err == EXIT_SUCCESS )
                     {
-                        // if within scale, add unary cost
+                        //dist = MyPointFiniteLineDistanceFunctor::eval( extrema, prims[lid][lid1], points[pid].template pos() );
+                        prims[lid][lid1].getFiniteDistances( distances, extrema, positions );
+                    }
+                    else
+                    {
+                        //dist = _PointPrimitiveDistanceFunctor::template eval<_Scalar>( points[pid], prims[lid][lid1] );
 
-                        // changed by Aron on 6/1/2015
-                         _Scalar dist = std::numeric_limits<_Scalar>::max();
-                        if ( err == EXIT_SUCCESS )
-                        {
-                            //dist = MyPointFiniteLineDistanceFunctor::eval( extrema, prims[lid][lid1], points[pid].template pos() );
-                            dist = prims[lid][lid1].getFiniteDistance( extrema, points[pid].template pos() );
-                        }
-                        else
-                        {
-                            //dist = _PointPrimitiveDistanceFunctor::template eval<_Scalar>( points[pid], prims[lid][lid1] );
+                        distances.assign( positions.size(), _Scalar(2.) ); // we don't want an empty primitive
+                    }
 
-                            dist = 2.; // we don't want an empty primitive
-                        }
-                        unary_i += dist * dist; //changed on 18/09/14
+                    for ( size_t pidId = 0; pidId != distances.size(); ++pidId )
+                    {
+                        unary_i += distances[pidId] * distances[pidId]; //changed on 18/09/14
                         ++cnt;              // normalizer
                     }
                 } // for points
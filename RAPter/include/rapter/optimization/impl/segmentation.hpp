@@ -4,6 +4,7 @@
 //#include "rapter/optimization/segmentation.h"
 
 #include <vector>
+#include <deque>
 
 #include "omp.h"
 #include "boost/filesystem.hpp"
@@ -22,6 +23,8 @@
 #include "rapter/io/io.h"                               // readPoints
 #include "rapter/optimization/patchDistanceFunctors.h"  // RepresentativeSqrPatchPatchDistanceFunctorT
 #include "rapter/util/impl/pclUtil.hpp"                 // smartgeometry::
+#include "rapter/processing/neighbourhoodGraph.hpp"     // NeighbourhoodGraph
+#include "rapter/processing/localFit.hpp"               // localfit::fitNeighbourhood
 
 
 #include <chrono>
@@ -50,7 +53,9 @@ int
 Segmentation::orientPoints( _PointContainerT          &points
                           , _Scalar             const  scale
                           , int                 const  nn_K
-                          , int                 const  verbose )
+                          , int                 const  verbose
+                          , processing::NeighbourhoodGraph const* neighGraph
+                          , int                 const  scaleCount )
 {
     typedef pcl::PointCloud<pcl::PointXYZ>        CloudXYZ;
 
@@ -71,7 +76,9 @@ Segmentation::orientPoints( _PointContainerT          &points
                , /*         nn_radius: */ scale
                , /*       soft_radius: */ true
                , /* [out]     mapping: */ &point_ids
-               , verbose ); // contains point id for fit_line
+               , verbose                                // contains point id for fit_line
+               , /*        neighGraph: */ neighGraph
+               , /*        scaleCount: */ scaleCount );
 
         // copy line direction into point
         for ( UPidT pid_id = 0; pid_id != point_ids.size(); ++pid_id )
@@ -85,6 +92,7 @@ Segmentation::orientPoints( _PointContainerT          &points
 } //...Segmentation::orientPoints()
 
 /*! \brief Fits a local direction to each point and it's neighourhood.
+ *         Points are processed in parallel, with the closed form fits of \ref processing::localfit, the output is in point order.
  *  \tparam PrimitiveContainerT Concept: vector< vector< LinePrimitive2/PlanePrimitive > >.
  *  \tparam _PointContainerPtrT Concept: pcl::PointCloud<pcl::PointXYZRGB>::Ptr.
  */
@@ -98,6 +106,8 @@ Segmentation:: fitLocal( _PrimitiveContainerT        & primitives
                        , bool                   const  soft_radius
                        , std::vector<PidT>            * point_ids
                        , int                    const  verbose
+                       , processing::NeighbourhoodGraph const* neighGraph
+                       , int                    const  scaleCount
                        )
 {
     using std::vector;
@@ -107,109 +117,152 @@ Segmentation:: fitLocal( _PrimitiveContainerT        & primitives
 
     if ( indices ) { std::cerr << __PRETTY_FUNCTION__ << "]: indices must be NULL, not implemented yet..." << std::endl; return EXIT_FAILURE; }
 
-    // get neighbourhoods
-    if ( verbose ) std::cout << "[" << __func__ << "]: " << "starting neighbourhood queries";
-    std::vector< std::vector<int   > > neighs;
-    std::vector< std::vector<Scalar> > sqr_dists;
-    processing::getNeighbourhoodIndices( /*   [out] neighbours: */ neighs
-                                       , /* [in]  pointCloud: */ cloud
-                                       , /* [in]     indices: */ indices
-                                       , /* [out]  sqr_dists: */ &sqr_dists
-                                       , /* [in]        nn_K: */ K              // 15
-                                       , /* [in]      radius: */ radius         // 0.02f
-                                       , /* [in] soft_radius: */ soft_radius    // true
-                                       );
-    if ( verbose ) std::cout << "ok...\n";
+    // radii to fit at, the neighbourhood of the largest one is queried, and the smaller ones are prefixes of it
+    const bool                doRadiusSearch = radius > 0.f;
+    const std::vector<Scalar> radii          = doRadiusSearch ? processing::localfit::scaleRadii<Scalar>( radius, scaleCount )
+                                                              : std::vector<Scalar>( 1, radius );
+    const Scalar              maxRadius      = radii.back();
+    const LidT                N              = cloud->size();
+    // multi-scale compares surface variation, any 3 points are coplanar and any 2 collinear with a variation of 0,
+    // so a smaller radius competes only with at least one point more than the primitive needs, or K points
+    const LidT                minMultiCount  = radii.size() > 1 ? std::max( LidT(K), LidT(PrimitiveT::EmbedSpaceDim == 3 ? 4 : 3) ) : 2;
+
+    const bool useGraph = doRadiusSearch && neighGraph && (neighGraph->size() == cloud->size()) && neighGraph->covers(maxRadius, 3);
+    typename pcl::search::KdTree<typename PointsT::PointType>::Ptr tree;
+    if ( !useGraph )
+    {
+        tree.reset( new pcl::search::KdTree<typename PointsT::PointType>() );
+        tree->setInputCloud( cloud );
+    }
+    if ( verbose ) std::cout << "[" << __func__ << "]: " << "fitting at " << radii.size() << " radii up to " << maxRadius
+                             << (useGraph ? " from the neighbourhood graph" : " with kd-tree queries") << std::endl;
+
+    // every point fits a primitive to its neighbourhood, in parallel, each thread reusing its own query and fit buffers
+    std::vector< processing::localfit::Fit<Scalar> > fits  ( N );
+    std::vector< int                               > chosen( N, -1 );   // radius index of the fit, -1: skipped
+    std::vector< LidT                              > counts( N,  0 );   // neighbourhood size at the largest radius
+    LidT enough = 0;                                                    // points with more than 2 neighbours
+#   pragma omp parallel
+    {
+        std::vector<int>                                neighs;
+        std::vector<float>                              sqr_dists;
+        processing::kernels::PositionArrays<Scalar>     block;
+        std::vector<Scalar>                             weights;
+        processing::localfit::Fit<Scalar>               fit;
+
+#       pragma omp for schedule(dynamic,1024) reduction(+:enough)
+        for ( LidT pid = 0; pid < N; ++pid )
+        {
+            // same queries as getNeighbourhoodIndices
+            int found_points_count = 0;
+            if ( useGraph )
+            {
+                found_points_count = neighGraph->radiusSearch( pid, maxRadius, neighs, sqr_dists, /* all: */ 0 );
+                if ( (found_points_count < 2) && soft_radius )
+                    found_points_count = neighGraph->nearestKSearch( pid, 3, neighs, sqr_dists );
+            }
+            else
+            {
+                if ( doRadiusSearch )
+                    found_points_count = tree->radiusSearch  ( (*cloud)[pid], maxRadius, neighs, sqr_dists, /* all: */ 0 );
+                else
+                    found_points_count = tree->nearestKSearch( (*cloud)[pid],         K, neighs, sqr_dists );
+                if ( (found_points_count < 2) && soft_radius )
+                    found_points_count = tree->nearestKSearch( (*cloud)[pid],         3, neighs, sqr_dists );
+            }
+            if ( found_points_count <= 0 )
+                neighs.clear();
+
+            counts[pid] = neighs.size();
+            enough     += neighs.size() > 2;
+            if ( neighs.size() < 2 )
+                continue;
+
+            // neighbourhood positions, sorted by distance
+            block.resize( neighs.size() );
+            for ( size_t i = 0; i != neighs.size(); ++i )
+            {
+                block.x[i] = (*cloud)[ neighs[i] ].x;
+                block.y[i] = (*cloud)[ neighs[i] ].y;
+                block.z[i] = (*cloud)[ neighs[i] ].z;
+            }
+
+            // fit at every radius with enough points, keep the flattest (lowest variation) fit,
+            // or the largest radius' fit, if no radius had enough
+            for ( int r = radii.size() - 1; r >= 0; --r )
+            {
+                LidT count = std::upper_bound( sqr_dists.begin(), sqr_dists.end(), float(radii[r] * radii[r]) ) - sqr_dists.begin();
+                if ( !doRadiusSearch || (found_points_count < 2) || (r + 1 == int(radii.size())) ) // K nearest, soft radius, or the queried radius
+                    count = neighs.size();
+                if ( (count < minMultiCount) && (chosen[pid] >= 0 || count < 2) )
+                    continue;
+
+                const int err = ( PrimitiveT::EmbedSpaceDim == 2 ) ? processing::localfit::fitNeighbourhood<6>( fit, block, radii[r], /* refit times: */ 2, weights, count )
+                                                                   : processing::localfit::fitNeighbourhood<4>( fit, block, radii[r], /* refit times: */ 2, weights, count );
+                if ( (err == EXIT_SUCCESS) && ((chosen[pid] < 0) || (fit.variation < fits[pid].variation)) )
+                {
+                    fits  [pid] = fit;
+                    chosen[pid] = r;
+                }
+            }
+        } //...for points
+    } //...omp parallel
 
     // only use, if more then 2 data-points
-    if ( std::count_if( neighs.begin(), neighs.end(), [] (vector<int> const& n1) { return n1.size() > 2; } ) < 2 )
+    if ( enough < 2 )
     {
         std::cerr << "[" << __func__ << "]: " << "not enough to work with (<2)...change scale " << radius << std::endl;
         return EXIT_SUCCESS;
     }
 
-    // every point proposes primitive[s] using its neighbourhood
-    unsigned int step_count(0);
+    // output in point order
     LidT skipped = 0;
-    for ( size_t pid = 0; pid != neighs.size(); ++pid )
+    std::vector<LidT> chosenCounts( radii.size(), 0 );
+    for ( LidT pid = 0; pid != N; ++pid )
     {
         // can't fit a line to 0 or 1 points
-        if ( neighs[pid].size() < 2 )
+        if ( chosen[pid] < 0 )
         {
             ++skipped;
-            std::cout << "[" << __func__ << "]: " << "skipped " << neighs[pid].size() << " neighs" << std::endl;
+            std::cout << "[" << __func__ << "]: " << "skipped " << counts[pid] << " neighs" << std::endl;
             continue;
         }
+        ++chosenCounts[ chosen[pid] ];
 
-        int err = EXIT_SUCCESS;
+        processing::localfit::Fit<Scalar> const& fit = fits[pid];
         if ( PrimitiveT::EmbedSpaceDim == 2 ) // we are in 2D, and TLine is LinePrimitive2
         {
+            // Create a LinePrimitive from its coeffs <x0, dir>
             Eigen::Matrix<Scalar,6,1> line;
-            err = smartgeometry::geometry::fitLinearPrimitive<PointsT,Scalar,6>( /*           output: */ line , /*         points: */ *cloud
-                                                                                          , /*          scale: */ radius
-                                                                                          , /*        indices: */ &(neighs[pid])
-                                                                                          , /*    refit times: */ 2
-                                                                                          , /* use input line: */ false
-                                                                                          );
-            if ( err == EXIT_SUCCESS )
-            {
-                // Create a LinePrimitive from its coeffs <x0, dir>
-                primitives.emplace_back( PrimitiveT(line) );
-            }
+            line << fit.centroid, fit.dir;
+            primitives.emplace_back( PrimitiveT(line) );
         }
         else // we are in 3D, and TLine is PlanePrimitive
         {
-//            std::cout << "fitting to " << (*cloud)[pid].getVector3fMap().transpose() << " and neighbours:\n";
-//            for ( int j = 0; j != neighs[pid].size(); ++j )
-//                std::cout << "\t" << (*cloud)[ neighs[pid][j] ].getVector3fMap().transpose() << "\n";
-
-            // fitLInearPirmitive uses "rows==4" to fit a plane TODO: use processing::fitlinearprimitive instead.
-            Eigen::Matrix<Scalar,4,1> plane;
-            err = smartgeometry::geometry::fitLinearPrimitive<PointsT,Scalar,4>( /*         output: */ plane
-                                                                               , /*         points: */ *cloud
-                                                                               , /*          scale: */ radius
-                                                                               , /*        indices: */ &(neighs[pid])
-                                                                               , /*    refit times: */ 2
-                                                                               , /* use input line: */ false
-                                                                               );
-            if ( err == EXIT_SUCCESS )
-            {
-                // Create a PlanePrimitive from < n, d > format
-                // by using n, and the center point of the neighbourhood.
-                primitives.emplace_back(  PrimitiveT( /*     x0: */ Eigen::Matrix<Scalar,3,1>::Zero() + plane.template head<3>() * plane(3) // (*cloud)[pid].getVector3fMap()
-                                                    , /* normal: */ plane.template head<3>() )  );
-#if 0
-                std::cout << "fit " << primitives.back().toString() << " to\n";
-                for ( int i = 0; i != neighs[pid].size(); ++i )
-                {
-                    const int pj = neighs[pid][i];
-                    std::cout << (*cloud)[pj].getVector3fMap().transpose()
-                              << ", with dist " << sqr_dists[pid][i] << " == " << sqr_dists[pid][i] << " < " << radius << std::endl;
-                }
-#endif
-            }
-            else
-            {
-                std::cout << "[" << __func__ << "]: " << "no primitive for " << neighs[pid].size() << "neighbours " << std::endl;
-            }
+            // Create a PlanePrimitive from < n, d > format
+            // by using n, and the center point of the neighbourhood.
+            const Scalar d = -fit.dir.dot( fit.centroid );
+            primitives.emplace_back(  PrimitiveT( /*     x0: */ Eigen::Matrix<Scalar,3,1>::Zero() + fit.dir * d
+                                                , /* normal: */ fit.dir )  );
         }
 
-
         if ( point_ids )
         {
             point_ids->emplace_back( pid );
         }
-
-        if ( verbose && !(++step_count % 100000) )
-        {
-            std::cout << "fit to " << primitives.size() << " / " << neighs.size() << "(" << (Scalar)(primitives.size()) / neighs.size() << "%)" << std::endl;
-            fflush(stdout);
-        }
     } //...for points
 
+    if ( verbose && (radii.size() > 1) )
+    {
+        std::cout << "[" << __func__ << "]: " << "chosen radii:";
+        for ( size_t r = 0; r != radii.size(); ++r )
+            std::cout << " " << radii[r] << ": " << chosenCounts[r];
+        std::cout << std::endl;
+    }
+
     std::cout << "[" << __func__ << "]: "
-              << skipped << "/" << neighs.size() << ": " << skipped / static_cast<float>(neighs.size()) * 100.f << "% of points did not produce primitives, so the primitive count is:"
-              << primitives.size() << " = " << primitives.size() / static_cast<float>(neighs.size()) *100.f << "%" << std::endl;
+              << skipped << "/" << N << ": " << skipped / static_cast<float>(N) * 100.f << "% of points did not produce primitives, so the primitive count is:"
+              << primitives.size() << " = " << primitives.size() / static_cast<float>(N) *100.f << "%" << std::endl;
 
     return EXIT_SUCCESS;
 } // ...Segment::propose()
@@ -241,6 +294,7 @@ Segmentation::patchify( _PrimitiveContainerT                   & patches
                       , int                               const  nn_K
                       , int                               const  verbose
                       , size_t                            const patchPopLimit
+                      , processing::NeighbourhoodGraph    const* neighGraph
                       )
 {
     typedef segmentation::Patch<_Scalar,_PrimitiveT> PatchT;
@@ -261,7 +315,8 @@ Segmentation::patchify( _PrimitiveContainerT                   & patches
                   , /* [in] patchPatchDistanceFunctor: */ patchPatchDistanceFunctor
                   , /* [in]              gid_tag_name: */ PointPrimitiveT::TAGS::GID
                   , /* [in]                      nn_K: */ nn_K
-                  , /* [in]                   verbose: */ verbose );
+                  , /* [in]                   verbose: */ verbose
+                  , /* [in]                neighGraph: */ neighGraph );
     } // ... (1) group
 
     // (2) Create PrimitiveContainer
@@ -375,6 +430,12 @@ Segmentation::patchify( _PrimitiveContainerT                   & patches
  *                                       that only contains a neighbouring point, and decides. See in \ref RepresentativeSqrPatchPatchDistanceFunctorT.
  *  \param[in] gid_tag_name              The key value of GID in _PointT. Suggested to be: _PointT::GID.
  *  \param[in] nn_K                      Number of nearest neighbour points looked for.
+ *
+ *  The kd-tree is built once and only read afterwards, so every thread queries it with its own search buffers.
+ *  Points are claimed by an atomic fetch-or on their status byte, each thread grows its patches into a private
+ *  buffer, and the buffers are merged at the end ordered by the position of the patch's seed in the (shuffled) seed list.
+ *  With one thread this reproduces the sequential output exactly, with more threads the patch ids stay in seed order,
+ *  but two threads racing for the border of the same surface can split it differently.
  */
 template < class       _PrimitiveT
          , class       _PointContainerT
@@ -389,6 +450,7 @@ Segmentation::regionGrow( _PointContainerT                       & points
                         , GidT                              const  gid_tag_name
                         , int                               const  nn_K
                         , bool                              const  verbose
+                        , processing::NeighbourhoodGraph    const* neighGraph
                         )
 {
     std::cout << "[" << __func__ << "]: " << "running with " << patchPatchDistanceFunctor.toString() << std::endl;
@@ -399,220 +461,179 @@ Segmentation::regionGrow( _PointContainerT                       & points
     typedef          std::vector<PatchT>     Patches;
 
     // create patches with a single point in them
-    std::cout << "[" << __func__ << "]: " << "starting deque" << std::endl; fflush(stdout);
-    std::deque<PidT> seeds;
+    std::cout << "[" << __func__ << "]: " << "starting seeds" << std::endl; fflush(stdout);
+    std::vector<PidT> seeds( points.size() );
     for ( UPidT pid = 0; pid != points.size(); ++pid )
     {
-        //const int pid = point_ids_arg ? (*point_ids_arg)[ pid_id ] : pid_id;
         if ( std::abs(_Scalar(1)-points[pid].template dir().norm()) > _Scalar(1.e-2) )
             std::cerr << "unoriented point at pid " << pid << "? " << points[pid].template dir().transpose() << ", norm: " << points[pid].template dir().norm() << std::endl;
-        seeds.push_back( pid );
+        seeds[pid] = pid;
     }
-    std::cout << "[" << __func__ << "]: " << "finished deque" << std::endl; fflush(stdout);
     std::random_shuffle( seeds.begin(), seeds.end() );
+    std::cout << "[" << __func__ << "]: " << "finished seeds" << std::endl; fflush(stdout);
 
-    // prebulid ann cloud
-    std::cout << "[" << __func__ << "]: " << "starting create ann cloud" << std::endl; fflush(stdout);
-    pcl::PointCloud<pcl::PointXYZ>::Ptr ann_cloud( new pcl::PointCloud<pcl::PointXYZ>() );
+    const _Scalar       max_dist            = patchPatchDistanceFunctor.getSpatialThreshold();// * _Scalar(3.5); // longest axis of ellipse)
+    const _Scalar       max_ang_diff        = patchPatchDistanceFunctor.getAngularThreshold();
+    const long          seedBatchSize       = 256; // seeds handed out to a thread at once
+
+    // use the precomputed neighbourhoods, if they reach far enough, build a tree otherwise
+    const bool useGraph = neighGraph && (neighGraph->size() == points.size()) && neighGraph->covers( max_dist, 0 );
+    typename pcl::search::KdTree<pcl::PointXYZ>::Ptr tree;
+    if ( useGraph )
+        std::cout << "[" << __func__ << "]: " << "using neighbourhood graph" << std::endl;
+    else
     {
-        ann_cloud->resize( points.size() );
-#       pragma omp parallel for
-        for ( size_t pid = 0; pid < points.size(); ++pid )
-            ann_cloud->at(pid).getVector3fMap() = points[pid].template pos();
+        // prebulid ann cloud
+        std::cout << "[" << __func__ << "]: " << "starting create ann cloud" << std::endl; fflush(stdout);
+        pcl::PointCloud<pcl::PointXYZ>::Ptr ann_cloud( new pcl::PointCloud<pcl::PointXYZ>() );
+        {
+            ann_cloud->resize( points.size() );
+#           pragma omp parallel for
+            for ( size_t pid = 0; pid < points.size(); ++pid )
+                ann_cloud->at(pid).getVector3fMap() = points[pid].template pos();
+        }
+        std::cout << "[" << __func__ << "]: " << "finished create ann cloud" << std::endl; fflush(stdout);
+
+        // the tree is read-only from here on, concurrent searches are safe
+        std::cout << "[" << __func__ << "]: " << "starting create ann TREE" << std::endl; fflush(stdout);
+        tree.reset( new pcl::search::KdTree<pcl::PointXYZ> );
+        tree->setInputCloud( ann_cloud );
+        std::cout << "[" << __func__ << "]: " << "finished create ann TREE" << std::endl; fflush(stdout);
     }
-    std::cout << "[" << __func__ << "]: " << "finished create ann cloud" << std::endl; fflush(stdout);
 
-    std::cout << "[" << __func__ << "]: " << "starting create ann TREE" << std::endl; fflush(stdout);
-    typename pcl::search::KdTree<pcl::PointXYZ>::Ptr tree( new pcl::search::KdTree<pcl::PointXYZ> );
-    tree->setInputCloud( ann_cloud );
-    std::cout << "[" << __func__ << "]: " << "finished create ann TREE" << std::endl; fflush(stdout);
+    const int nThreads = std::max( 1, omp_get_max_threads() );
 
-    //Patches patches; patches.reserve( std::max(1.5*sqrt(points.size()),10.) );
-    std::vector< Patches > patchesVector( RAPTER_MAX_OMP_THREADS );
+    // one patch buffer per thread, and the seed order of each patch for the deterministic merge
+    std::vector< Patches >           patchesVector( nThreads );
+    std::vector< std::vector<PidT> > patchSeedIds ( nThreads );
     for ( size_t i = 0; i != patchesVector.size(); ++i )
-        patchesVector[i].reserve( std::max(1.5*sqrt(points.size()),1000.) );
+    {
+        patchesVector[i].reserve( std::max(1.5*sqrt(points.size()) / nThreads,1000.) );
+        patchSeedIds [i].reserve( patchesVector[i].capacity() );
+    }
 
-    // get unassigned point
-    const char VISITED = 2;
+    // a point is claimed by the first thread that sets its ASSIGNED bit
     const char ASSIGNED = 1;
     std::vector<char> status( points.size(), 0 );
-//    std::vector<bool> assigned( points.size(), false );
-//    std::vector<bool> visited( points.size(), false );
 
-    const _Scalar       max_dist            = patchPatchDistanceFunctor.getSpatialThreshold();// * _Scalar(3.5); // longest axis of ellipse)
-
-    unsigned step_count = 0; // for logging
-    //int tid; //omp thread_id
     TIC
     // look for neighbours, merge most similar
-    std::cout << "[" << __func__ << "]: " << "starting reggrow loop" << std::endl; fflush(stdout);
-    std::map< PidT, int > patchesVectorId;
-#   pragma omp parallel num_threads(RAPTER_MAX_OMP_THREADS) shared(seeds)
-    while ( seeds.size() )
+    std::cout << "[" << __func__ << "]: " << "starting reggrow loop with " << nThreads << " threads" << std::endl; fflush(stdout);
+#   pragma omp parallel num_threads(nThreads)
     {
-        const int tid = omp_get_thread_num();
-        std::vector< int >  neighs( nn_K );
-        std::vector<float>  sqr_dists( nn_K );
+        const int          tid            = omp_get_thread_num();
+        Patches           &privatePatches = patchesVector[tid];
+        std::vector<PidT> &privateSeedIds = patchSeedIds [tid];
 
-        //PidT                found_points_count  = 0;
+        // per-thread search context
+        std::vector< int >  neighs;
+        std::vector<float>  sqr_dists;
         pcl::PointXYZ       searchPoint;
+        std::deque<PidT>    privateSeeds;
+        unsigned            step_count = 0; // for logging
 
-        PidT seed = -1;
-        std::deque<PidT> privateSeeds;
+#       pragma omp for schedule(dynamic,seedBatchSize)
+        for ( long seed_id = 0; seed_id < static_cast<long>(seeds.size()); ++seed_id )
         {
-            bool quit = false;
-#           pragma omp critical (RG_SEEDS)
-            {
-                if ( !seeds.size() )    quit = true;
-                else
-                {
-                    seed = seeds.front();
-                    seeds.pop_front();
-                }
-            }
-            if ( quit ) continue;
+            const PidT seed = seeds[ seed_id ];
 
-            privateSeeds.push_front( seed );
-#pragma omp critical (RG_PVID)
+            // claim seed, or skip, if somebody else already took it
             {
-                patchesVectorId[ seed ] = tid;
+                char prevStatus;
+#               pragma omp atomic capture
+                { prevStatus = status[seed]; status[seed] |= ASSIGNED; }
+                if ( prevStatus & ASSIGNED )
+                    continue;
             }
 
             // add to new cluster
-            {
-                bool addPatch = false;
-#               pragma omp critical (RG_STATUS)
-                {
-                    if ( !(status[seed] & ASSIGNED) )
-                    {
-                        status[ seed ] |= ASSIGNED;
-                        addPatch       = true;
-                    }
-                } //...assigned
-
-                if ( addPatch )
-                {
-#                   pragma omp critical (RG_PVID)
-                    {
-                        PatchT tmp_patch; tmp_patch.push_back( segmentation::PidLid(seed,-1) );
-                        patchesVector[patchesVectorId[seed]].push_back( tmp_patch );
-                        patchesVector[patchesVectorId[seed]].back().update( points );
-                    }
-                } //...if addPatch
-            } //...new cluster
-        } // init privateSeeds
-
-        while ( privateSeeds.size() )
-        {
-            if ( tid != omp_get_thread_num() )
-            {
-                std::cout << "[" << __func__ << "]: " << "tid " << tid << " != " << omp_get_thread_num() << std::endl;
-            }
-            //tid = omp_get_thread_num();
-
-            //        #pragma omp critical (RG_COUT)
-            //std::cout << "thread_id: " << tid << std::endl; fflush(stdout);
-
-            if ( verbose && !(++step_count % 50000) )
-            {
-                std::cout << seeds.size() << " "; fflush(stdout);
-            }
-
-            // remove point from unassigned
-            PidT pid = -1;
-            pid = privateSeeds.front();
-            privateSeeds.pop_front();
+            privatePatches.push_back( PatchT(segmentation::PidLid(seed,-1)) );
+            privateSeedIds.push_back( seed_id );
+            PatchT &patch = privatePatches.back();
+            patch.update( points );
 
+            privateSeeds.push_front( seed );
+            while ( privateSeeds.size() )
             {
-                bool quit = false;
-#               pragma omp critical (RG_STATUS)
+                if ( verbose && !tid && !(++step_count % 50000) )
                 {
-                    if ( status[pid] & VISITED ) quit          = true;
-                    else                         status[pid] |= VISITED;
+                    std::cout << seed_id << " "; fflush(stdout);
                 }
-                if ( quit ) continue;
-            }
-
-            // look for unassigned neighbours
-#pragma omp critical (RG_KDTREE)
-            {
-                searchPoint.getVector3fMap() = points[ pid ].template pos();
-                /*found_points_count = */ tree->radiusSearch( searchPoint, max_dist, neighs, sqr_dists, 0);
-            }
 
-            for ( size_t pid_id = 1; pid_id < neighs.size(); ++pid_id )
-            {
-                const PidT pid2 = neighs[ pid_id ];
+                // every point in privateSeeds has been claimed by this thread, so it's visited exactly once
+                const PidT pid = privateSeeds.front();
+                privateSeeds.pop_front();
 
-                // if !assigned[pid2]
+                // look for unassigned neighbours
+                if ( useGraph )
+                    neighGraph->radiusSearch( pid, max_dist, neighs, sqr_dists, 0 );
+                else
                 {
-                    bool quit = false;
-#                   pragma omp critical (RG_STATUS)
-                    {
-                        if ( status[pid2] & ASSIGNED )   quit = true;
-                    }
-                    if ( quit ) continue;
+                    searchPoint.getVector3fMap() = points[ pid ].template pos();
+                    tree->radiusSearch( searchPoint, max_dist, neighs, sqr_dists, 0 );
                 }
 
-                _Scalar ang_diff( 0. );
-#               pragma omp critical (RG_PVID)
+                for ( size_t pid_id = 1; pid_id < neighs.size(); ++pid_id )
                 {
-                    ang_diff = rapter::angleInRad( patchesVector[patchesVectorId[seed]].back().template dir(), points[pid2].template dir() );
-                }
-                // map 90..180 to 0..90:
-                if ( ang_diff > M_PI_2 )    ang_diff = M_PI - ang_diff;
+                    const PidT pid2 = neighs[ pid_id ];
 
-                // location from point, but direction is the representative's
-                if (     (ang_diff > patchPatchDistanceFunctor.getAngularThreshold())
-                     //|| ((points[pid].template pos() - points[pid2].template pos()).norm() > max_dist)
-                         ) // original condition
-                    continue;
-
-#               pragma omp critical (RG_STATUS)
-                {
-                    status[pid2] |= ASSIGNED;
-#                   pragma omp critical (RG_PVID)
+                    // cheap early out, the claim below decides
                     {
-                        patchesVector[patchesVectorId[seed]].back().push_back( segmentation::PidLid(pid2,-1) );
-                        patchesVector[patchesVectorId[seed]].back().updateWithPoint( points[pid2] );
+                        char curStatus;
+#                       pragma omp atomic read
+                        curStatus = status[pid2];
+                        if ( curStatus & ASSIGNED )
+                            continue;
                     }
-                } //...RG_PATCHES
 
-                //#pragma omp critical (RG_PRIV_SEEDS)
-                {
+                    _Scalar ang_diff = rapter::angleInRad( patch.template dir(), points[pid2].template dir() );
+                    // map 90..180 to 0..90:
+                    if ( ang_diff > M_PI_2 )    ang_diff = M_PI - ang_diff;
+
+                    // location from point, but direction is the representative's
+                    if ( ang_diff > max_ang_diff )
+                        continue;
+
+                    char prevStatus;
+#                   pragma omp atomic capture
+                    { prevStatus = status[pid2]; status[pid2] |= ASSIGNED; }
+                    if ( prevStatus & ASSIGNED )
+                        continue;
+
+                    patch.push_back( segmentation::PidLid(pid2,-1) );
+                    patch.updateWithPoint( points[pid2] );
+
                     // enqueue for visit
-                    //seeds.push_front( pid2 );
                     privateSeeds.push_front( pid2 );
-                }
-            }
-        } //...while privateSeeds
-#                   pragma omp critical (RG_PVID)
-        {
-            if ( patchesVectorId.find(seed) == patchesVectorId.end() ) std::cerr << "[" << tid << "] can't find seed point ..." << std::endl;
-            patchesVectorId.erase( seed );
-        }
-    } //...while seeds
+                } //...for neighs
+            } //...while privateSeeds
+        } //...for seeds
+    } //...omp parallel
 
-    for ( size_t i = 1; i < patchesVector.size(); ++i )
+    // merge thread-local patches ordered by their seeds' positions in the shuffled seed list
     {
-        patchesVector[0].reserve( patchesVector.size() + patchesVector[i].size() );
-        for ( size_t j = 0; j < patchesVector[i].size(); ++j )
-            if ( patchesVector[i][j].getSize() )
-                patchesVector[0].push_back( patchesVector[i][j] );
+        typedef std::pair<PidT, std::pair<int,LidT> > SeedIdTidLid;
+        std::vector<SeedIdTidLid> order;
+        for ( int tid = 0; tid != nThreads; ++tid )
+            for ( size_t lid = 0; lid != patchesVector[tid].size(); ++lid )
+                order.push_back( SeedIdTidLid(patchSeedIds[tid][lid], std::pair<int,LidT>(tid,lid)) );
+        std::sort( order.begin(), order.end() );
+
+        groups_arg.reserve( groups_arg.size() + order.size() );
+        for ( size_t i = 0; i != order.size(); ++i )
+        {
+            PatchT const& patch = patchesVector[ order[i].second.first ][ order[i].second.second ];
+            if ( patch.getSize() )
+                groups_arg.push_back( patch );
             else
                 std::cout << "[" << __func__ << "]: " << "empty group created...." << std::endl;
-        //patchesVector[0].insert( patchesVector[0].end(), patchesVector[i].begin(), patchesVector[i].end() );
+        }
     }
 
     std::cout << std::endl;
     TOC( "Reggrow", 1)
     std::cout << "[" << __func__ << "]: " << "finished reggrow loop" << std::endl; fflush(stdout);
 
-    // copy patches to groups
-    std::cout << "[" << __func__ << "]: " << "copying patches" << std::endl; fflush(stdout);
-    groups_arg.insert( groups_arg.end(), patchesVector[0].begin(), patchesVector[0].end() );
-    std::cout << "[" << __func__ << "]: " << "finished copying patches" << std::endl; fflush(stdout);
-
     // assign points to patches
     _tagPointsFromGroups<_PointPrimitiveT,_Scalar>
                         ( points, groups_arg, patchPatchDistanceFunctor, gid_tag_name );
@@ -621,29 +642,39 @@ Segmentation::regionGrow( _PointContainerT                       & points
     // gather orphans
     // add left out points to closest patch
 #if 1
-    std::vector<int> neighs(nn_K);
-    std::vector<float>  sqr_dists( nn_K );
-#   pragma omp parallel for num_threads(RAPTER_MAX_OMP_THREADS) private(neighs,sqr_dists)
-    for ( UPidT pid = 0; pid < points.size(); ++pid )
+    // look up first, write after, so that no thread reads a tag while another one writes it
+    std::vector<GidT> adopted( points.size(), _PointPrimitiveT::LONG_VALUES::UNSET );
+#   pragma omp parallel
     {
-        if ( points[pid].getTag( gid_tag_name ) != _PointPrimitiveT::LONG_VALUES::UNSET ) continue;
-
-        #pragma omp critical (RG_KDTREE)
+        std::vector<int>    neighs(nn_K);
+        std::vector<float>  sqr_dists( nn_K );
+        pcl::PointXYZ       searchPoint;
+#       pragma omp for
+        for ( long pid = 0; pid < static_cast<long>(points.size()); ++pid )
         {
-            pcl::PointXYZ       searchPoint;
-            searchPoint.getVector3fMap() = points[ pid ].template pos();
-            tree->radiusSearch( searchPoint, 0., neighs, sqr_dists, nn_K );
-        }
-        for ( size_t pid_id = 0; pid_id != neighs.size(); ++pid_id )
-            if ( points[neighs[pid_id]].getTag( _PointPrimitiveT::TAGS::GID ) != _PointPrimitiveT::LONG_VALUES::UNSET )
+            if ( points[pid].getTag( gid_tag_name ) != _PointPrimitiveT::LONG_VALUES::UNSET ) continue;
+
+            if ( useGraph )
+                neighGraph->radiusSearch( pid, 0., neighs, sqr_dists, nn_K );
+            else
             {
-                std::cout << "useful " << std::endl; fflush(stdout);
-                points[pid].setTag( gid_tag_name, points[neighs[pid_id]].getTag(_PointPrimitiveT::TAGS::GID) );
-                break;
+                searchPoint.getVector3fMap() = points[ pid ].template pos();
+                tree->radiusSearch( searchPoint, 0., neighs, sqr_dists, nn_K );
             }
-        if ( !neighs.size() )
-            std::cout << "not useful" << std::endl;
+            for ( size_t pid_id = 0; pid_id != neighs.size(); ++pid_id )
+                if ( points[neighs[pid_id]].getTag( _PointPrimitiveT::TAGS::GID ) != _PointPrimitiveT::LONG_VALUES::UNSET )
+                {
+                    adopted[pid] = points[neighs[pid_id]].getTag(_PointPrimitiveT::TAGS::GID);
+                    break;
+                }
+            if ( !neighs.size() )
+                std::cout << "not useful" << std::endl;
+        }
     }
+
+    for ( UPidT pid = 0; pid != points.size(); ++pid )
+        if ( adopted[pid] != _PointPrimitiveT::LONG_VALUES::UNSET )
+            points[pid].setTag( gid_tag_name, adopted[pid] );
 #endif
 
     return EXIT_SUCCESS;
@@ -673,6 +704,9 @@ Segmentation::segmentCli( int    argc
     std::string                 mode_string             = "representative_sqr";
     std::vector<std::string>    mode_opts               = { "representative_sqr" };
     bool                        verbose                 = false;
+    int                         n_threads               = -1;
+    int                         bench_threads           = 0;
+    bool                        use_neigh_graph         = true;
 
     // parse input
     if ( err == EXIT_SUCCESS )
@@ -709,6 +743,12 @@ Segmentation::segmentCli( int    argc
         pcl::console::parse_x_arguments( argc, argv, "--angle-gens", angle_gens );
 
         pcl::console::parse_argument( argc, argv, "--patch-pop-limit", generatorParams.patch_population_limit );
+        pcl::console::parse_argument( argc, argv, "--threads", n_threads );
+        if ( n_threads > 0 )
+            omp_set_num_threads( n_threads );
+        pcl::console::parse_argument( argc, argv, "--bench-threads", bench_threads );
+        pcl::console::parse_argument( argc, argv, "--orient-scales", generatorParams.orient_scales );
+        use_neigh_graph = !pcl::console::find_switch( argc, argv, "--no-neigh-graph" );
 
         // print usage
         {
@@ -727,6 +767,10 @@ Segmentation::segmentCli( int    argc
             std::cerr << "\t [--angle-gens "; for(size_t i=0;i!=angle_gens.size();++i)std::cerr<<angle_gens[i];std::cerr<<"]\n";
             std::cerr << "\t [--no-paral]\n";
             std::cerr << "\t [--pop-limit " << generatorParams.patch_population_limit << "]\t Filters patches smaller than this.\n";
+            std::cerr << "\t [--threads " << n_threads << "]\t Region growing threads, all cores if not set.\n";
+            std::cerr << "\t [--bench-threads " << bench_threads << "]\t Run region growing with 1..N threads, report points/sec and exit.\n";
+            std::cerr << "\t [--orient-scales " << generatorParams.orient_scales << "]\t Compare local orientation fits at this many radii around scale, keep the flattest.\n";
+            std::cerr << "\t [--no-neigh-graph]\t Don't map or store the neighbourhood graph next to the cloud.\n";
             std::cerr << "\t [-v, --verbose]\n";
             std::cerr << std::endl;
 
@@ -772,16 +816,66 @@ Segmentation::segmentCli( int    argc
 
     } //...read points
 
+    // Map or build neighbourhoods, reaching far enough for both local fits and region growing
+    processing::NeighbourhoodGraph neighGraph;
+    if ( (EXIT_SUCCESS == err) && use_neigh_graph )
+    {
+        err = neighGraph.getOrBuild( processing::NeighbourhoodGraph::getPath(cloud_path)
+                                   , points
+                                   , std::max( processing::localfit::scaleRadii( generatorParams.scale, generatorParams.orient_scales ).back()
+                                             , generatorParams.scale * generatorParams.patch_dist_limit_mult )
+                                   , 3
+                                   , verbose );
+        if ( err != EXIT_SUCCESS ) std::cerr << "[" << __func__ << "]: " << "neighbourhood graph failed, falling back to kd-tree queries" << std::endl;
+        err = EXIT_SUCCESS;
+    } //...neighGraph
+    processing::NeighbourhoodGraph const* neighGraphPtr = (use_neigh_graph && neighGraph.size()) ? &neighGraph : NULL;
+
     //_____________________WORK_______________________
     //_______________________________________________
 
     // orientPoints
     if ( (EXIT_SUCCESS == err) && !isOriented )
     {
-        err = Segmentation::orientPoints<_PointPrimitiveT,_PrimitiveT>( points, generatorParams.scale, generatorParams.nn_K, verbose );
+        err = Segmentation::orientPoints<_PointPrimitiveT,_PrimitiveT>( points, generatorParams.scale, generatorParams.nn_K, verbose, neighGraphPtr, generatorParams.orient_scales );
         if ( err != EXIT_SUCCESS ) std::cerr << "[" << __func__ << "]: " << "orientPoints exited with error! Code: " << err << std::endl;
     } //...orientPoints
 
+    // scaling benchmark of regionGrow, runs on copies of the oriented points
+    if ( (EXIT_SUCCESS == err) && (bench_threads > 0) )
+    {
+        typedef segmentation::Patch<_Scalar,_PrimitiveT> PatchT;
+        RepresentativeSqrPatchPatchDistanceFunctorT< _Scalar,SpatialPatchPatchSingleDistanceFunctorT<_Scalar>
+                                                   > patchPatchDistanceFunctor( generatorParams.scale * generatorParams.patch_dist_limit_mult
+                                                                              , generatorParams.angle_limit
+                                                                              , generatorParams.scale
+                                                                              , generatorParams.patch_spatial_weight );
+        std::vector< std::pair<int,double> > timings;
+        for ( int threads = 1; threads <= bench_threads; ++threads )
+        {
+            _PointContainerT      pointsCopy( points );
+            std::vector<PatchT>   groups;
+            omp_set_num_threads( threads );
+            std::srand( 0 ); // same seed order for every run
+
+            auto start = std::chrono::system_clock::now();
+            Segmentation::regionGrow<_PrimitiveT>( pointsCopy, groups, generatorParams.scale, patchPatchDistanceFunctor, _PointPrimitiveT::TAGS::GID, generatorParams.nn_K, false, neighGraphPtr );
+            std::chrono::duration<double> elapsed_seconds = std::chrono::system_clock::now() - start;
+            timings.push_back( std::pair<int,double>(threads, elapsed_seconds.count()) );
+            std::cout << "[" << __func__ << "]: " << "regionGrow with " << threads << " threads: " << groups.size() << " patches" << std::endl;
+        }
+
+        std::cout << "[" << __func__ << "]: " << "regionGrow scaling on " << points.size() << " points:\n";
+        for ( size_t i = 0; i != timings.size(); ++i )
+            std::cout << "\tthreads: " << timings[i].first
+                      << "\ttime: "     << timings[i].second << " s"
+                      << "\tpoints/s: " << points.size() / timings[i].second
+                      << "\tspeedup: "  << timings[0].second / timings[i].second << "\n";
+        std::cout << std::endl;
+
+        return EXIT_SUCCESS;
+    } //...bench_threads
+
     _PrimitiveContainerT initial_primitives;
     if ( EXIT_SUCCESS == err )
     {
@@ -803,6 +897,7 @@ Segmentation::segmentCli( int    argc
                                             , generatorParams.nn_K
                                             , verbose
                                             , ((generatorParams.patch_population_limit > 0) ? generatorParams.patch_population_limit : 0)
+                                            , neighGraphPtr
                                             );
             }
                 break;
@@ -1,6 +1,11 @@
 #ifndef RAPTER_SOLVER_HPP
 #define RAPTER_SOLVER_HPP
 
+#include <chrono>                                     // time to first feasible
+#include <limits>
+#include <map>
+#include <numeric>                                    // accumulate
+#include <set>
 #include "Eigen/Sparse"
 
 #ifdef RAPTER_USE_PCL
@@ -10,6 +15,7 @@
 #ifdef RAPTER_WITH_BONMIN
 #   include "qcqpcpp/bonminOptProblem.h"
 #endif
+#include "qcqpcpp/localSearchOptProblem.h"
 
 #include "rapter/util/diskUtil.hpp"                 // saveBAckup
 #include "rapter/util/util.hpp"                     // timestamp2Str
@@ -18,7 +24,9 @@
 //#include "rapter/optimization/candidateGenerator.h" // generate()
 //#include "rapter/optimization/energyFunctors.h"     // PointLineDistanceFunctor,
 #include "rapter/optimization/problemSetup.h"         // everyPatchNeedsDirection()
+#include "rapter/optimization/energyEvaluator.h"      // EnergyEvaluator
 #include "rapter/processing/diagnostic.hpp"           // Diagnostic
+#include "rapter/processing/graph.hpp"                // Graph::getComponents
 #include "rapter/processing/impl/angleUtil.hpp"
 
 namespace rapter
@@ -39,12 +47,16 @@ Solver::solve( int    argc
     int                                   err           = EXIT_SUCCESS;
 
     bool                                  verbose       = false;
-    enum SOLVER { MOSEK, BONMIN, GUROBI } solver        = MOSEK;
+    SOLVER                                solver        = MOSEK;
     std::string                           project_path  = "problem", solver_str = "bonmin";
     Scalar                                max_time      = 360;
     int                                   bmode         = 0; // Bonmin solver mode, B_Bb by default
     std::string                           rel_out_path  = ".";
     std::string                           x0_path       = "";
+    std::string                           warm_path     = "";   // previous selection to build x0 from, found next to the candidates, if empty
+    bool                                  warm          = true; // build x0 from the previous iteration's selection, if no --x0
+    bool                                  gap           = false; // also run the other of native and bonmin, and compare objectives
+    bool                                  decompose     = false; // solve the connected components separately
     int                                   attemptCount  = 0;
     std::string                           energy_path        = "energy.csv";
 
@@ -63,6 +75,7 @@ Solver::solve( int    argc
                  if ( !solver_str.compare("mosek")  ) solver = MOSEK;
             else if ( !solver_str.compare("bonmin") ) solver = BONMIN;
             else if ( !solver_str.compare("gurobi") ) solver = GUROBI;
+            else if ( !solver_str.compare("native") ) solver = NATIVE;
             else
             {
                 std::cerr << "[" << __func__ << "]: " << "Cannot parse solver " << solver_str << std::endl;
@@ -91,9 +104,19 @@ Solver::solve( int    argc
             }
         }
 
+        // warm start
+        warm = !pcl::console::find_switch( argc, argv, "--no-warm" );
+        pcl::console::parse_argument( argc, argv, "--warm", warm_path );
+
+        // compare to the other solver
+        gap = pcl::console::find_switch( argc, argv, "--gap" );
+
+        // independent components
+        decompose = pcl::console::find_switch( argc, argv, "--decompose" );
+
         // usage print
         std::cerr << "[" << __func__ << "]: " << "Usage:\t gurobi_opt\n"
-                  << "\t--solver *" << solver_str << "* (mosek | bonmin | gurobi)\n"
+                  << "\t--solver *" << solver_str << "* (mosek | bonmin | gurobi | native)\n"
                   << "\t--problem " << project_path << "\n"
                   << "\t[--time] " << max_time << "\n"
                   << "\t[--bmode *" << bmode << "*\n"
@@ -106,6 +129,10 @@ Solver::solve( int    argc
                   << "\t[--verbose] " << "\n"
                   << "\t[--rod " << rel_out_path << "]\t\t Relative output directory\n"
                   << "\t[--x0 " << x0_path << "]\t Path to starting point sparse matrix\n"
+                  << "\t[--warm " << warm_path << "]\t Previous selection to start from, default: primitives_merged_it<N-1>.csv or primitives_it<N-1>.<solver>.csv next to --candidates\n"
+                  << "\t[--no-warm]\t Don't start from the previous selection\n"
+                  << "\t[--gap]\t Run bonmin as well for native, native for bonmin, and report the gap between the objectives\n"
+                  << "\t[--decompose]\t Solve the independent components of the problem separately, in parallel with native\n"
                   << "\t[--help, -h] "
                   << std::endl;
 
@@ -117,279 +144,717 @@ Solver::solve( int    argc
         } //...if valid_input
     } //...parse
 
+    typedef double                    OptScalar; // Mosek, and Bonmin uses double internally, so that's what we have to do...
+    typedef OptProblemT::SparseMatrix SparseMatrix;
+
+    // problem.read(), once for all attempts
+    OptProblemT problem;
+    if ( EXIT_SUCCESS != problem.read(project_path) )
+    {
+        std::cerr << "[" << __func__ << "]: " << "Could not read problem, exiting" << std::endl;
+        return EXIT_FAILURE;
+    } //...problem.read()
+
+    // read primitives
+    std::string          candidates_path;
+    _PrimitiveContainerT prims;
+    if ( pcl::console::parse_argument( argc, argv, "--candidates", candidates_path ) >= 0 )
+    {
+        if ( verbose ) std::cout << "[" << __func__ << "]: " << "reading primitives from " << candidates_path << "...";
+        io::readPrimitives<_PrimitiveT, _InnerPrimitiveContainerT>( prims, candidates_path );
+        if ( verbose ) std::cout << "reading primitives ok\n";
+    } //...read primitives
+
+    // X0
+    SparseMatrix x0;
+    if ( !x0_path.empty() )
+        x0 = qcqpcpp::io::readSparseMatrix<OptScalar>( x0_path, 0 );
+    else if ( warm && !candidates_path.empty() )
+    {
+        // previous iteration's output, mapped to the candidates by GID and DIR_GID
+        if ( warm_path.empty() )
+        {
+            const int   iteration   = util::parseIteration( candidates_path );
+            std::string parent_path = boost::filesystem::path(candidates_path).parent_path().string();
+            if ( parent_path.empty() )  parent_path = "./";
+            else                        parent_path += "/";
+
+            std::stringstream merged, selected;
+            merged   << parent_path << "primitives_merged_it" << iteration - 1 << ".csv";
+            selected << parent_path << rel_out_path << "/primitives_it" << iteration - 1 << "." << solver_str << ".csv";
+            if      ( iteration > 0 && boost::filesystem::exists(merged.str())   ) warm_path = merged.str();
+            else if ( iteration > 0 && boost::filesystem::exists(selected.str()) ) warm_path = selected.str();
+        }
+
+        if ( !warm_path.empty() )
+        {
+            _PrimitiveContainerT selection;
+            io::readPrimitives<_PrimitiveT, _InnerPrimitiveContainerT>( selection, warm_path );
+            const LidT onCount = startingPointFromSelection<_PrimitiveT>( x0, problem.getVarCount(), prims, selection );
+            if ( onCount < 0 )
+            {
+                x0.resize( 0, 0 );
+                std::cerr << "[" << __func__ << "]: " << "could not map " << warm_path << " to the problem, not warm starting" << std::endl;
+            }
+            else
+                std::cout << "[" << __func__ << "]: " << "warm start from " << warm_path << ", " << onCount << " candidates on" << std::endl;
+        }
+    } //...X0
+
+    std::vector<OptScalar> x_out;
     err = DO_RETRY; // flip to enter
     while ( (err == DO_RETRY) && (attemptCount < 2) )
     {
-        err = EXIT_SUCCESS; // reset flag
+        x_out.clear();
+        if ( decompose )
+            err = optimizeDecomposed( x_out, problem, solver, max_time, bmode, attemptCount, x0.rows() ? &x0 : NULL, verbose );
+        else
+            err = optimizeProblem   ( x_out, problem, solver, max_time, bmode, attemptCount, x0.rows() ? &x0 : NULL, verbose );
+        if ( err == DO_RETRY )
+            ++attemptCount;
+    } //...err == doRetry
+
+    // gap between native and bonmin
+    if ( gap && (EXIT_SUCCESS == err) )
+    {
+#   ifdef RAPTER_WITH_BONMIN
+        if ( (solver == NATIVE) || (solver == BONMIN) )
+        {
+            const SOLVER           other = (solver == NATIVE) ? BONMIN : NATIVE;
+            std::vector<OptScalar> x_other;
+            int                    otherErr = optimizeProblem( x_other, problem, other, max_time, bmode, /* attemptCount: */ 0, x0.rows() ? &x0 : NULL, verbose, /* useIncumbent: */ false );
+
+            OptScalar nativeE, bonminE;
+            evalSolution( (solver == NATIVE) ? nativeE : bonminE, problem, Eigen::Map<const OptProblemT::VectorX>(x_out.data(), x_out.size()) );
+            if ( (EXIT_SUCCESS == otherErr) && evalSolution((solver == NATIVE) ? bonminE : nativeE, problem, Eigen::Map<const OptProblemT::VectorX>(x_other.data(), x_other.size())) )
+                std::cout << "[" << __func__ << "]: " << "native E = " << nativeE << ", bonmin E = " << bonminE
+                          << ", gap: " << (nativeE - bonminE) / std::max(std::abs(bonminE), OptScalar(1e-12)) * OptScalar(100.) << " %" << std::endl;
+            else
+                std::cerr << "[" << __func__ << "]: " << "no feasible solution from " << (other == NATIVE ? "native" : "bonmin") << ", no gap to report" << std::endl;
+        }
+        else
+#   endif // WITH_BONMIN
+            std::cerr << "[" << __func__ << "]: " << "--gap needs --solver native or bonmin, and Bonmin compiled in" << std::endl;
+    } //...gap
+
+    // dump
+    if ( EXIT_SUCCESS != err ) // by Aron 27/12/2014
+    {
+        std::cout << "err is " << err << ", no saving will happen..." << std::endl;
+        return err;
+    }
 
-        // select solver
-        typedef double OptScalar; // Mosek, and Bonmin uses double internally, so that's what we have to do...
-        typedef qcqpcpp::OptProblem<OptScalar>  OptProblemT;
-        typedef OptProblemT::SparseMatrix       SparseMatrix;
-        OptProblemT *p_problem = NULL;
-        if ( EXIT_SUCCESS == err )
+    Diagnostic<OptScalar> diag( problem.getLinObjectivesMatrix(), problem.getQuadraticObjectivesMatrix() );
+    {
+        std::string x_path = project_path + "/x.csv";
+        SparseMatrix sp_x( x_out.size(), 1 ); // output colvector
+        for ( size_t i = 0; i != x_out.size(); ++i )
         {
-            switch ( solver )
+            if ( int(round(x_out[i])) > 0 )
             {
-                case BONMIN:
-                    p_problem = new qcqpcpp::BonminOpt<OptScalar>();
-                    break;
-
-                default:
-                    std::cerr << "[" << __func__ << "]: " << "Unrecognized solver type, exiting" << std::endl;
-                    err = EXIT_FAILURE;
-                    break;
-            } //...switch
-        } //...select solver
-
-        // problem.read()
-        if ( EXIT_SUCCESS == err )
+                sp_x.insert(i,0) = x_out[i];
+            }
+        }
+        qcqpcpp::io::writeSparseMatrix<OptScalar>( sp_x, x_path, 0 );
+        std::cout << "[" << __func__ << "]: " << "wrote output to " << x_path << std::endl;
+    }
+
+    if ( !candidates_path.empty() )
+    {
+        // save selected primitives
+        _PrimitiveContainerT out_prims;
+        LidT prim_id = selectPrimitives<_PrimitiveT>( out_prims, prims, x_out, &diag );
+
+        const LidT clusterVarsStart = prim_id;
+        std::cout << "clusterVarsStart: " << clusterVarsStart << std::endl;
+        // add rest of nodes (cluster_nodes)
         {
-            err += p_problem->read( project_path );
-            if ( EXIT_SUCCESS != err )
-                std::cerr << "[" << __func__ << "]: " << "Could not read problem, exiting" << std::endl;
-        } //...problem.read()PrimitiveT
+            for ( ; prim_id < static_cast<LidT>(x_out.size()); ++prim_id )
+            {
+                char name[256];
+                if ( int(round(x_out[prim_id])) > 0 )
+                {
+                    sprintf( name,"%ld_on", prim_id );
+                    diag.setNodeName( prim_id, name );
+                }
+                else
+                {
+                    sprintf( name,"%ld_off", prim_id );
+                }
+            }
+        }
 
-        // problem.parametrize()
+        // go over constraints
         {
-            if ( max_time > 0 )
-                p_problem->setTimeLimit( max_time );
-            if ( solver == BONMIN )
+            for ( LidT j = 0; j != static_cast<LidT>(problem.getConstraintCount()); ++j )
             {
-#           ifdef RAPTER_WITH_BONMIN
-                qcqpcpp::BonminOpt<OptScalar>* p_bonminProblem = static_cast<qcqpcpp::BonminOpt<OptScalar>*>(p_problem);
-                p_bonminProblem->setAlgorithm( Bonmin::Algorithm(bmode) );
-                std::cout << "[" << __func__ << "]: " << "setting attemptCount to " << (1 + attemptCount) * 100 << std::endl;
-                p_bonminProblem->setNodeLimit( (1 + attemptCount) * 100 );
-//                if ( attemptCount )
-//                {
-//                    p_bonminProblem->setMaxSolutions( 1 ); // this is evil
-//                }
-                OptProblemT::SparseMatrix x0;
-                if ( !x0_path.empty() )
+                SparseMatrix Qk = problem.getQuadraticConstraintsMatrix( j );
+                if ( !Qk.nonZeros() ) continue;
+
+                for ( LidT row = 0; row != Qk.outerSize(); ++row )
                 {
-                    x0 = qcqpcpp::io::readSparseMatrix<OptScalar>( x0_path, 0 );
-                    static_cast<qcqpcpp::BonminOpt<OptScalar>*>(p_problem)->setStartingPoint( x0 );
+                    for ( typename SparseMatrix::InnerIterator it(Qk,row); it; ++it )
+                    {
+                        if ( it.value() != 0. )
+                            diag.addEdge( it.row(), it.col() );
+                    }
                 }
+            }
+        }
 
-#           endif // WITH_BONMIN
+        std::string parent_path = boost::filesystem::path(candidates_path).parent_path().string();
+        if ( parent_path.empty() )  parent_path = "./";
+        else                        parent_path += "/";
+
+        std::string out_prim_path = parent_path + rel_out_path + "/primitives." + solver_str + ".csv";
+        {
+            int iteration = 0;
+            iteration = std::max(0,util::parseIteration(candidates_path) );
+            {
+                std::stringstream ss;
+                ss << parent_path + rel_out_path << "/primitives_it" << iteration << "." << solver_str << ".csv";
+                out_prim_path = ss.str();
+            }
+
+            {
+                std::stringstream ss;
+                ss << parent_path + rel_out_path << "/diag_it" << iteration << ".gv";
+                diag.draw( ss.str(), false );
             }
         }
 
-        // problem.update()
-        OptProblemT::ReturnType r = 0;
-        if ( EXIT_SUCCESS == err )
+        util::saveBackup    ( out_prim_path );
+        io::savePrimitives<_PrimitiveT, typename _InnerPrimitiveContainerT::const_iterator>( out_prims, out_prim_path, /* verbose: */ true );
+
+    } // if --candidates
+    else
+    {
+        std::cout << "[" << __func__ << "]: " << "You didn't provide candidates, could not save primitives" << std::endl;
+    } // it no --candidates
+
+    // calc Energy
+    {
+        std::string parent_path = boost::filesystem::path(project_path).parent_path().string();
+        EnergyEvaluator<OptScalar> energy( problem );
+        energy.setX( x_out );
+
+        OptScalar dataC     = energy.linear();
+        OptScalar pairwiseC = energy.pairwise();
+        std::cout << "E = " << dataC + pairwiseC << " = "
+                  << dataC << " (data) + " << pairwiseC << "(pw)"
+                  << std::endl;
+        std::ofstream fenergy( parent_path + "/" + energy_path, std::ofstream::out | std::ofstream::app );
+        fenergy << dataC + pairwiseC << "," << dataC << "," << pairwiseC << "," << 0 << std::endl;
+        fenergy.close();
+    } //...calcEnergy
+
+    return err;
+} //...Solver::solve()
+
+int
+Solver::optimizeProblem( std::vector<double>                    & x_out
+                       , OptProblemT                       const& problem
+                       , SOLVER                            const  solver
+                       , Scalar                            const  max_time
+                       , int                               const  bmode
+                       , int                               const  attemptCount
+                       , OptProblemT::SparseMatrix         const* x0
+                       , bool                              const  verbose
+                       , bool                              const  useIncumbent )
+{
+    typedef double OptScalar;
+    int err = EXIT_SUCCESS;
+
+    // select solver, copy formulated problem into it
+    OptProblemT *p_problem = NULL;
+    switch ( solver )
+    {
+#   ifdef RAPTER_WITH_BONMIN
+        case BONMIN:
         {
-            // log
-            if ( verbose ) { std::cout << "[" << __func__ << "]: " << "calling problem update..."; fflush(stdout); }
+            qcqpcpp::BonminOpt<OptScalar>* p_bonminProblem = new qcqpcpp::BonminOpt<OptScalar>();
+            static_cast<OptProblemT&>( *p_bonminProblem ) = problem;
+            p_bonminProblem->setAlgorithm( Bonmin::Algorithm(bmode) );
+            std::cout << "[" << __func__ << "]: " << "setting attemptCount to " << (1 + attemptCount) * 100 << std::endl;
+            p_bonminProblem->setNodeLimit( (1 + attemptCount) * 100 );
+            p_problem = p_bonminProblem;
+            break;
+        }
+#   endif // WITH_BONMIN
+        case NATIVE:
+        {
+            qcqpcpp::LocalSearchOpt<OptScalar>* p_localSearchProblem = new qcqpcpp::LocalSearchOpt<OptScalar>();
+            static_cast<OptProblemT&>( *p_localSearchProblem ) = problem;
+            p_localSearchProblem->setRestarts( (1 + attemptCount) * 8 );
+            p_localSearchProblem->setThreads ( RAPTER_MAX_OMP_THREADS );
+            p_localSearchProblem->setSeed    ( attemptCount );
+            p_problem = p_localSearchProblem;
+            break;
+        }
 
-            // update
-            r = p_problem->update();
+        default:
+            std::cerr << "[" << __func__ << "]: " << "Unrecognized solver type, exiting" << std::endl;
+            err = EXIT_FAILURE;
+            break;
+    } //...switch
 
-            // log
-            if ( verbose ) { std::cout << "[" << __func__ << "]: " << "problem update finished\n"; fflush(stdout); }
-        } //...problem.update()
+    // problem.parametrize()
+    if ( EXIT_SUCCESS == err )
+    {
+        if ( max_time > 0 )
+            p_problem->setTimeLimit( max_time );
+        if ( x0 )
+            p_problem->setStartingPoint( *x0 );
+    } //...problem.parametrize()
+
+    // incumbent: a feasible starting point bounds the search, and is the answer, if nothing better is found
+    bool                 haveIncumbent = false;
+    double               incumbentObj  = std::numeric_limits<double>::max();
+    OptProblemT::VectorX incumbent;
+    if ( (EXIT_SUCCESS == err) && useIncumbent && p_problem->isUseStartingPoint() )
+    {
+        incumbent     = p_problem->getStartingPoint();
+        haveIncumbent = evalSolution( incumbentObj, problem, incumbent );
+        std::cout << "[" << __func__ << "]: " << "starting point is " << (haveIncumbent ? "feasible" : "infeasible") << ", E = " << incumbentObj << std::endl;
+#   ifdef RAPTER_WITH_BONMIN
+        if ( haveIncumbent && (solver == BONMIN) )
+            static_cast<qcqpcpp::BonminOpt<OptScalar>*>( p_problem )->setCutoff( incumbentObj );
+#   endif // WITH_BONMIN
+    } //...incumbent
+
+    // problem.update()
+    OptProblemT::ReturnType r = 0;
+    if ( EXIT_SUCCESS == err )
+    {
+        if ( verbose ) { std::cout << "[" << __func__ << "]: " << "calling problem update..."; fflush(stdout); }
+        r = p_problem->update();
+        if ( verbose ) { std::cout << "[" << __func__ << "]: " << "problem update finished\n"; fflush(stdout); }
+    } //...problem.update()
 
-        // problem.optimize()
-        if ( EXIT_SUCCESS == err )
+    // problem.optimize()
+    if ( EXIT_SUCCESS == err )
+    {
+        if ( r == p_problem->getOkCode() )
         {
-            // optimize
-            std::vector<OptScalar> x_out;
-            if ( r == p_problem->getOkCode() )
-            {
-                // log
-                if ( verbose ) { std::cout << "[" << __func__ << "]: " << "calling problem optimize...\n"; fflush(stdout); }
+            if ( verbose ) { std::cout << "[" << __func__ << "]: " << "calling problem optimize...\n"; fflush(stdout); }
 
-                // work
-                r = p_problem->optimize( &x_out, OptProblemT::OBJ_SENSE::MINIMIZE );
+            auto start = std::chrono::system_clock::now();
+            r = p_problem->optimize( &x_out, OptProblemT::OBJ_SENSE::MINIMIZE );
+            std::chrono::duration<double> elapsed_seconds = std::chrono::system_clock::now() - start;
 
-                // check output
-                if ( r != p_problem->getOkCode() )
-                {
-                    std::cerr << "[" << __func__ << "]: " << "ooo...optimize didn't work with code " << r << std::endl; fflush(stderr);
-                    err = r;
-                }
-            } //...optimize
+            // check output
+            if ( r != p_problem->getOkCode() )
+            {
+                std::cerr << "[" << __func__ << "]: " << "ooo...optimize didn't work with code " << r << std::endl; fflush(stderr);
+                err = r;
+            }
 
-            if ( !x_out.size() || std::accumulate(x_out.begin(),x_out.end(),0) == 0 )
+            // keep incumbent, if the solver did not improve on it
+            double solutionObj = std::numeric_limits<double>::max();
+            const bool feasible = (x_out.size() == problem.getVarCount())
+                                  && evalSolution( solutionObj, problem, Eigen::Map<const OptProblemT::VectorX>(x_out.data(), x_out.size()) );
+            if ( haveIncumbent )
             {
-                std::cerr << "No output from optimizer, exiting" << std::endl;
+                if ( !feasible || (solutionObj > incumbentObj) )
                 {
-                    err = DO_RETRY;
-                    ++attemptCount;
+                    x_out.assign( incumbent.data(), incumbent.data() + incumbent.size() );
+                    err = EXIT_SUCCESS;
+                    std::cout << "[" << __func__ << "]: " << "kept starting point, solver found " << (feasible ? "no better" : "no feasible") << " solution" << std::endl;
                 }
+                std::cout << "[" << __func__ << "]: " << "time to first feasible: 0 s (starting point), solve: " << elapsed_seconds.count() << " s"
+                          << ", E: " << incumbentObj << " -> " << std::min(incumbentObj, solutionObj) << std::endl;
             }
-            else
-                std::cout << "accumulate: " << std::accumulate(x_out.begin(),x_out.end(),0) << std::endl;
+            else if ( feasible )
+                std::cout << "[" << __func__ << "]: " << "time to first feasible: " << elapsed_seconds.count() << " s (solve), E: " << solutionObj << std::endl;
+        } //...optimize
 
-            // copy output
-            std::vector<Scalar> scalar_x_out( x_out.size() );
-            if ( EXIT_SUCCESS == err )
+        if ( !x_out.size() || std::accumulate(x_out.begin(),x_out.end(),0) == 0 )
+        {
+            std::cerr << "No output from optimizer, exiting" << std::endl;
+            err = DO_RETRY;
+        }
+        else
+            std::cout << "accumulate: " << std::accumulate(x_out.begin(),x_out.end(),0) << std::endl;
+    } //...problem.optimize()
+
+    if ( p_problem ) { delete p_problem; p_problem = NULL; }
+
+    return err;
+} //...Solver::optimizeProblem()
+
+int
+Solver::decompose( std::vector<OptProblemT>                 & parts
+                 , std::vector< std::vector<LidT> >         & varIds
+                 , OptProblemT                         const& problem )
+{
+    typedef OptProblemT::SparseEntries                                      SparseEntries;
+    typedef OptProblemT::SparseEntry                                        SparseEntry;
+    typedef Graph< double, MyGraphConfig<double>::UndirectedGraph >          GraphT;
+
+    const LidT varCount    = problem.getVarCount();
+    const LidT constrCount = problem.getConstraintCount();
+    parts .clear();
+    varIds.clear();
+    if ( !varCount )
+        return EXIT_SUCCESS;
+
+    // interaction graph: Qo entries, and a star over the variables of each constraint around its first variable
+    GraphT            graph( varCount );
+    std::vector<LidT> constrVar( constrCount, -1 ); // first variable of each constraint
+    {
+        SparseEntries const& Qo = problem.getQuadraticObjectives();
+        for ( SparseEntries::const_iterator it = Qo.begin(); it != Qo.end(); ++it )
+            if ( it->row() != it->col() )
+                graph.addEdge( it->row(), it->col(), 1. );
+
+        SparseEntries const& A = problem.getLinConstraints();
+        for ( SparseEntries::const_iterator it = A.begin(); it != A.end(); ++it )
+        {
+            if      ( constrVar[it->row()] < 0           ) constrVar[ it->row() ] = it->col();
+            else if ( constrVar[it->row()] != it->col()  ) graph.addEdge( constrVar[it->row()], it->col(), 1. );
+        }
+
+        for ( LidT i = 0; i < static_cast<LidT>(problem.getQuadraticConstraints().size()); ++i )
+        {
+            SparseEntries const& Qi = problem.getQuadraticConstraints( i );
+            for ( SparseEntries::const_iterator it = Qi.begin(); it != Qi.end(); ++it )
             {
-                // copy
-                std::copy( x_out.begin(), x_out.end(), scalar_x_out.begin() );
-            } //...copy output
+                if ( constrVar[i] < 0 )
+                    constrVar[i] = it->row();
+                if ( constrVar[i] != it->row() ) graph.addEdge( constrVar[i], it->row(), 1. );
+                if ( constrVar[i] != it->col() ) graph.addEdge( constrVar[i], it->col(), 1. );
+            }
+        }
+    }
+
+    // components are numbered in the order of their first variable
+    GraphT::ComponentListT components;
+    const int partCount = graph.getComponents( components );
+    parts .resize( partCount );
+    varIds.resize( partCount );
+
+    // variables
+    std::vector<LidT>          localIds( varCount );
+    std::vector<double> const& qo = problem.getLinObjectives();
+    for ( LidT j = 0; j != varCount; ++j )
+    {
+        OptProblemT& part = parts[ components[j] ];
+        localIds[j] = part.addVariable( problem.getVarBoundType(j), problem.getVarLowerBound(j), problem.getVarUpperBound(j)
+                                      , problem.getVarType(j), problem.getVarLinearity(j), problem.getVarName(j) );
+        varIds[ components[j] ].push_back( j );
+        if ( j < static_cast<LidT>(qo.size()) )
+            part.setLinObjective( localIds[j], qo[j] );
+    }
+
+    // objective
+    parts[0].setObjectiveBias( problem.getObjectiveBias() );
+    {
+        SparseEntries const& Qo = problem.getQuadraticObjectives();
+        for ( SparseEntries::const_iterator it = Qo.begin(); it != Qo.end(); ++it )
+            parts[ components[it->row()] ].addQObjective( localIds[it->row()], localIds[it->col()], it->value() );
+    }
+
+    // constraints
+    std::vector<LidT> localConstrIds( constrCount );
+    for ( LidT i = 0; i != constrCount; ++i )
+    {
+        OptProblemT& part = parts[ constrVar[i] < 0 ? 0 : components[constrVar[i]] ];
+        localConstrIds[i] = part.getConstraintCount();
+        if ( EXIT_SUCCESS != part.addConstraint(problem.getConstraintBoundType(i), problem.getConstraintLowerBound(i), problem.getConstraintUpperBound(i)
+                                               , /* row_vector: */ NULL, problem.getConstraintLinearity(i)) )
+            return EXIT_FAILURE;
+    }
+    {
+        std::vector<SparseEntries>  partEntries( partCount );
+        SparseEntries        const& A = problem.getLinConstraints();
+        for ( SparseEntries::const_iterator it = A.begin(); it != A.end(); ++it )
+            partEntries[ components[it->col()] ].push_back( SparseEntry(localConstrIds[it->row()], localIds[it->col()], it->value()) );
+
+        for ( int p = 0; p != partCount; ++p )
+        {
+            if ( partEntries[p].empty() )
+                continue;
+            OptProblemT::SparseMatrix partA( parts[p].getConstraintCount(), parts[p].getVarCount() );
+            partA.setFromTriplets( partEntries[p].begin(), partEntries[p].end() );
+            if ( EXIT_SUCCESS != parts[p].addLinConstraints(partA) )
+                return EXIT_FAILURE;
+        }
+    }
+    for ( LidT i = 0; i < static_cast<LidT>(problem.getQuadraticConstraints().size()); ++i )
+    {
+        SparseEntries const& Qi = problem.getQuadraticConstraints( i );
+        for ( SparseEntries::const_iterator it = Qi.begin(); it != Qi.end(); ++it )
+            parts[ components[it->row()] ].addQConstraint( localConstrIds[i], localIds[it->row()], localIds[it->col()], it->value() );
+    }
+
+    // starting point
+    if ( problem.isUseStartingPoint() )
+    {
+        OptProblemT::VectorX const& x0 = problem.getStartingPoint();
+        for ( int p = 0; p != partCount; ++p )
+        {
+            OptProblemT::VectorX partX0( varIds[p].size() );
+            for ( size_t k = 0; k != varIds[p].size(); ++k )
+                partX0( k ) = x0( varIds[p][k] );
+            parts[p].setStartingPointDense( partX0 );
+        }
+    }
 
-            // dump
-            if ( EXIT_SUCCESS != err ) // by Aron 27/12/2014
+    return EXIT_SUCCESS;
+} //...Solver::decompose()
+
+int
+Solver::optimizeDecomposed( std::vector<double>                    & x_out
+                          , OptProblemT                       const& problem
+                          , SOLVER                            const  solver
+                          , Scalar                            const  max_time
+                          , int                               const  bmode
+                          , int                               const  attemptCount
+                          , OptProblemT::SparseMatrix         const* x0
+                          , bool                              const  verbose
+                          , bool                              const  useIncumbent )
+{
+    std::vector<OptProblemT>         parts;
+    std::vector< std::vector<LidT> > varIds;
+    int err = decompose( parts, varIds, problem );
+    if ( EXIT_SUCCESS != err )
+    {
+        std::cerr << "[" << __func__ << "]: " << "could not decompose problem, solving it whole" << std::endl;
+        return optimizeProblem( x_out, problem, solver, max_time, bmode, attemptCount, x0, verbose, useIncumbent );
+    }
+    if ( parts.size() < 2 )
+        return optimizeProblem( x_out, problem, solver, max_time, bmode, attemptCount, x0, verbose, useIncumbent );
+
+    size_t maxVars = 0;
+    for ( size_t p = 0; p != parts.size(); ++p )
+        maxVars = std::max( maxVars, parts[p].getVarCount() );
+    std::cout << "[" << __func__ << "]: " << "solving " << parts.size() << " components, largest has " << maxVars << " of " << problem.getVarCount() << " variables" << std::endl;
+
+    // starting point of each part
+    std::vector<OptProblemT::SparseMatrix> partX0s( x0 ? parts.size() : 0 );
+    if ( x0 )
+    {
+        std::vector<int>  partIds ( problem.getVarCount() );
+        std::vector<LidT> localIds( problem.getVarCount() );
+        for ( size_t p = 0; p != parts.size(); ++p )
+        {
+            partX0s[p].resize( varIds[p].size(), 1 );
+            for ( size_t k = 0; k != varIds[p].size(); ++k )
             {
-                std::cout << "err is " << err << ", no saving will happen..." << std::endl;
+                partIds [ varIds[p][k] ] = p;
+                localIds[ varIds[p][k] ] = k;
             }
-            if ( EXIT_SUCCESS == err)
+        }
+
+        for ( int row = 0; row < x0->outerSize(); ++row )
+            for ( OptProblemT::SparseMatrix::InnerIterator it(*x0, row); it; ++it )
+                if ( it.row() < static_cast<LidT>(partIds.size()) )
+                    partX0s[ partIds[it.row()] ].insert( localIds[it.row()], 0 ) = it.value();
+    }
+
+    // Bonmin is not reentrant, the native solver is
+    std::vector< std::vector<double> > partXs( parts.size() );
+    std::vector<int>                   partErrs( parts.size(), DO_RETRY );
+    auto start = std::chrono::system_clock::now();
+#   pragma omp parallel for schedule(dynamic) if(solver == NATIVE)
+    for ( int p = 0; p < static_cast<int>(parts.size()); ++p )
+    {
+        for ( int attempt = attemptCount; (partErrs[p] == DO_RETRY) && (attempt <= attemptCount + 1); ++attempt )
+        {
+            partXs[p].clear();
+            partErrs[p] = optimizeProblem( partXs[p], parts[p], solver, max_time, bmode, attempt, x0 ? &partX0s[p] : NULL, verbose, useIncumbent );
+
+            // a component may well have no variable switched on
+            double partObj;
+            if (    (partErrs[p] == DO_RETRY) && (partXs[p].size() == parts[p].getVarCount())
+                 && evalSolution(partObj, parts[p], Eigen::Map<const OptProblemT::VectorX>(partXs[p].data(), partXs[p].size())) )
+                partErrs[p] = EXIT_SUCCESS;
+        }
+    }
+    std::chrono::duration<double> elapsed_seconds = std::chrono::system_clock::now() - start;
+
+    // assemble
+    x_out.assign( problem.getVarCount(), 0. );
+    for ( size_t p = 0; p != parts.size(); ++p )
+    {
+        if ( EXIT_SUCCESS != partErrs[p] )
+        {
+            std::cerr << "[" << __func__ << "]: " << "component " << p << " failed with " << partErrs[p] << std::endl;
+            if ( EXIT_SUCCESS == err )
+                err = partErrs[p];
+            continue;
+        }
+        for ( size_t k = 0; k != varIds[p].size(); ++k )
+            x_out[ varIds[p][k] ] = partXs[p][k];
+    }
+
+    double objective;
+    const bool feasible = evalSolution( objective, problem, Eigen::Map<const OptProblemT::VectorX>(x_out.data(), x_out.size()) );
+    std::cout << "[" << __func__ << "]: " << "solved " << parts.size() << " components in " << elapsed_seconds.count() << " s, E = " << objective
+              << (feasible ? "" : " (infeasible)") << std::endl;
+
+    return err;
+} //...Solver::optimizeDecomposed()
+
+bool
+Solver::evalSolution( double                         & objective
+                    , OptProblemT               const& problem
+                    , OptProblemT::VectorX      const& x
+                    , double                    const  tol )
+{
+    typedef OptProblemT::SparseEntries SparseEntries;
+
+    objective = std::numeric_limits<double>::max();
+    if ( x.rows() != static_cast<OptProblemT::VectorX::Index>(problem.getVarCount()) )
+        return false;
+
+    // objective, from the entry lists, duplicates add up as in the assembled matrices
+    objective = 0.;
+    std::vector<double> const& qo = problem.getLinObjectives();
+    for ( size_t j = 0; j != qo.size(); ++j )
+        objective += qo[j] * x(j);
+    SparseEntries const& Qo = problem.getQuadraticObjectives();
+    for ( SparseEntries::const_iterator it = Qo.begin(); it != Qo.end(); ++it )
+        objective += it->value() * x(it->row()) * x(it->col());
+
+    // checks value against a bound type
+    auto inBounds = [tol]( double value, OptProblemT::BOUND bound, double lower, double upper )
+    {
+        const bool hasLower = (bound == OptProblemT::BOUND::GREATER_EQ) || (bound == OptProblemT::BOUND::RANGE) || (bound == OptProblemT::BOUND::EQUAL);
+        const bool hasUpper = (bound == OptProblemT::BOUND::LESS_EQ   ) || (bound == OptProblemT::BOUND::RANGE) || (bound == OptProblemT::BOUND::EQUAL);
+        return (!hasLower || (value >= lower - tol)) && (!hasUpper || (value <= upper + tol));
+    };
+
+    // variables
+    for ( size_t j = 0; j != problem.getVarCount(); ++j )
+    {
+        if ( !inBounds(x(j), problem.getVarBoundType(j), problem.getVarLowerBound(j), problem.getVarUpperBound(j)) )
+            return false;
+        if ( (problem.getVarType(j) != OptProblemT::VAR_TYPE::CONTINUOUS) && (std::abs(x(j) - std::round(x(j))) > tol) )
+            return false;
+    }
+
+    // constraints
+    std::vector<double> c( problem.getConstraintCount(), 0. );
+    SparseEntries const& A = problem.getLinConstraints();
+    for ( SparseEntries::const_iterator it = A.begin(); it != A.end(); ++it )
+        c[ it->row() ] += it->value() * x( it->col() );
+    for ( size_t i = 0; i != c.size(); ++i )
+    {
+        if ( i < problem.getQuadraticConstraints().size() )
+        {
+            SparseEntries const& Qi = problem.getQuadraticConstraints( i );
+            for ( SparseEntries::const_iterator it = Qi.begin(); it != Qi.end(); ++it )
+                c[i] += it->value() * x(it->row()) * x(it->col());
+        }
+
+        if ( !inBounds(c[i], problem.getConstraintBoundType(i), problem.getConstraintLowerBound(i), problem.getConstraintUpperBound(i)) )
+            return false;
+    }
+
+    return true;
+} //...Solver::evalSolution()
+
+template < class _PrimitiveT
+         , class _PrimitiveContainerT
+         >
+LidT
+Solver::startingPointFromSelection( OptProblemT::SparseMatrix      & x0
+                                  , LidT                      const  varCount
+                                  , _PrimitiveContainerT      const& prims
+                                  , _PrimitiveContainerT      const& selection )
+{
+    typedef std::pair<GidT,DidT> GidDid;
+
+    // previously chosen <gid,did> pairs
+    std::set<GidDid> chosen;
+    for ( size_t l = 0; l != selection.size(); ++l )
+        for ( size_t l1 = 0; l1 != selection[l].size(); ++l1 )
+            if ( selection[l][l1].getTag(_PrimitiveT::TAGS::STATUS) == _PrimitiveT::STATUS_VALUES::ACTIVE )
+                chosen.insert( GidDid(selection[l][l1].getTag(_PrimitiveT::TAGS::GID), selection[l][l1].getTag(_PrimitiveT::TAGS::DIR_GID)) );
+
+    // candidate variables in formulation order, direction variables follow in ascending dId order
+    std::vector<LidT>         on;
+    std::map<DidT, bool>      dIdsOn;
+    LidT                      varId = 0;
+    for ( size_t l = 0; l != prims.size(); ++l )
+        for ( size_t l1 = 0; l1 != prims[l].size(); ++l1 )
+        {
+            if ( prims[l][l1].getTag(_PrimitiveT::TAGS::STATUS) == _PrimitiveT::STATUS_VALUES::SMALL )
+                continue;
+
+            const DidT did = prims[l][l1].getTag( _PrimitiveT::TAGS::DIR_GID );
+            bool &dIdOn = dIdsOn[ did ];
+            if ( chosen.count(GidDid(prims[l][l1].getTag(_PrimitiveT::TAGS::GID), did)) )
             {
-                Diagnostic<OptScalar> diag( p_problem->getLinObjectivesMatrix(), p_problem->getQuadraticObjectivesMatrix() );
-                {
-                    std::string x_path = project_path + "/x.csv";
-                    OptProblemT::SparseMatrix sp_x( x_out.size(), 1 ); // output colvector
-                    for ( size_t i = 0; i != x_out.size(); ++i )
-                    {
-                        if ( int(round(x_out[i])) > 0 )
-                        {
-                            sp_x.insert(i,0) = x_out[i];
-                        }
-                    }
-                    qcqpcpp::io::writeSparseMatrix<OptScalar>( sp_x, x_path, 0 );
-                    std::cout << "[" << __func__ << "]: " << "wrote output to " << x_path << std::endl;
-                }
+                on.push_back( varId );
+                dIdOn = true;
+            }
+            ++varId;
+        } //...for candidates
 
-                std::string candidates_path;
-                if ( pcl::console::parse_argument( argc, argv, "--candidates", candidates_path ) >= 0 )
-                {
-                    // read primitives
-                    _PrimitiveContainerT prims;
-                    {
-                        if ( verbose ) std::cout << "[" << __func__ << "]: " << "reading primitives from " << candidates_path << "...";
-                        io::readPrimitives<_PrimitiveT, _InnerPrimitiveContainerT>( prims, candidates_path );
-                        if ( verbose ) std::cout << "reading primitives ok\n";
-                    } //...read primitives
-
-                    // save selected primitives
-                    _PrimitiveContainerT out_prims( 1 );
-                    LidT prim_id = 0;
-                    for ( size_t l = 0; l != prims.size(); ++l )
-                        for ( size_t l1 = 0; l1 != prims[l].size(); ++l1 )
-                        {
-                            if ( prims[l][l1].getTag( _PrimitiveT::TAGS::STATUS ) == _PrimitiveT::STATUS_VALUES::SMALL )
-                            {
-                                // copy small, keep for later iterations
-                                out_prims.back().push_back( prims[l][l1] );
-                            }
-                            else
-                            {
-                                // copy to output, only, if chosen
-                                if ( int(round(x_out[prim_id])) > 0 )
-                                {
-                                    //std::cout << "saving " << prims[l][l1].getTag(_PrimitiveT::TAGS::GID) << ", " << prims[l][l1].getTag(_PrimitiveT::TAGS::DIR_GID) << ", X: " << x_out[prim_id] << "\t, ";
-                                    prims[l][l1].setTag( _PrimitiveT::TAGS::STATUS, _PrimitiveT::STATUS_VALUES::ACTIVE );
-                                    out_prims.back().push_back( prims[l][l1] );
-
-                                    // diagnostic // 5/1/2015
-                                    char name[256];
-                                    sprintf( name,"p%ld,%ld", prims[l][l1].getTag(_PrimitiveT::TAGS::GID),prims[l][l1].getTag(_PrimitiveT::TAGS::DIR_GID) );
-                                    diag.setNodeName( prim_id, name );
-                                    diag.setNodePos( prim_id, prims[l][l1].template pos() );
-                                }
-
-                                // increment non-small primitive ids
-                                ++prim_id;
-                            }
-                        } // ... for l1
-                    std::cout << std::endl;
-
-                    const LidT clusterVarsStart = prim_id;
-                    std::cout << "clusterVarsStart: " << clusterVarsStart << std::endl;
-                    // add rest of nodes (cluster_nodes)
-                    {
-                        for ( ; prim_id < static_cast<LidT>(x_out.size()); ++prim_id )
-                        {
-                            char name[256];
-                            if ( int(round(x_out[prim_id])) > 0 )
-                            {
-                                sprintf( name,"%ld_on", prim_id );
-                                diag.setNodeName( prim_id, name );
-                            }
-                            else
-                            {
-                                sprintf( name,"%ld_off", prim_id );
-                            }
-                        }
-                    }
+    if ( varId + static_cast<LidT>(dIdsOn.size()) != varCount )
+        return -1;
 
-                    // go over constraints
-                    {
-                        typedef typename OptProblemT::SparseMatrix SparseMatrix;
-                        for ( LidT j = 0; j != static_cast<LidT>(p_problem->getConstraintCount()); ++j )
-                        {
-                            SparseMatrix Qk = p_problem->getQuadraticConstraintsMatrix( j );
-                            if ( !Qk.nonZeros() ) continue;
-
-                            for ( LidT row = 0; row != Qk.outerSize(); ++row )
-                            {
-                                for ( typename SparseMatrix::InnerIterator it(Qk,row); it; ++it )
-                                {
-                                    if ( it.value() != 0. )
-                                        diag.addEdge( it.row(), it.col() );
-                                }
-                            }
-                        }
-                    }
+    const LidT candidatesOn = on.size();
+    for ( std::map<DidT,bool>::const_iterator it = dIdsOn.begin(); it != dIdsOn.end(); ++it, ++varId )
+        if ( it->second )
+            on.push_back( varId );
 
-                    std::string parent_path = boost::filesystem::path(candidates_path).parent_path().string();
-                    if ( parent_path.empty() )  parent_path = "./";
-                    else                        parent_path += "/";
+    x0.resize( varCount, 1 );
+    x0.setZero();
+    x0.reserve( on.size() );
+    for ( size_t i = 0; i != on.size(); ++i )
+        x0.insert( on[i], 0 ) = 1.;
 
-                    std::string out_prim_path = parent_path + rel_out_path + "/primitives." + solver_str + ".csv";
-                    {
-                        int iteration = 0;
-                        iteration = std::max(0,util::parseIteration(candidates_path) );
-                        {
-                            std::stringstream ss;
-                            ss << parent_path + rel_out_path << "/primitives_it" << iteration << "." << solver_str << ".csv";
-                            out_prim_path = ss.str();
-                        }
-
-                        {
-                            std::stringstream ss;
-                            ss << parent_path + rel_out_path << "/diag_it" << iteration << ".gv";
-                            diag.draw( ss.str(), false );
-                        }
-                    }
+    return candidatesOn;
+} //...Solver::startingPointFromSelection()
 
-                    util::saveBackup    ( out_prim_path );
-                    io::savePrimitives<_PrimitiveT, typename _InnerPrimitiveContainerT::const_iterator>( out_prims, out_prim_path, /* verbose: */ true );
+template < class _PrimitiveT
+         , class _PrimitiveContainerT
+         >
+LidT
+Solver::selectPrimitives( _PrimitiveContainerT       & out_prims
+                        , _PrimitiveContainerT  const& prims
+                        , std::vector<double>   const& x_out
+                        , Diagnostic<double>         * diag )
+{
+    out_prims.push_back( typename _PrimitiveContainerT::value_type() );
 
-                } // if --candidates
-                else
+    LidT prim_id = 0;
+    for ( size_t l = 0; l != prims.size(); ++l )
+        for ( size_t l1 = 0; l1 != prims[l].size(); ++l1 )
+        {
+            if ( prims[l][l1].getTag( _PrimitiveT::TAGS::STATUS ) == _PrimitiveT::STATUS_VALUES::SMALL )
+            {
+                // copy small, keep for later iterations
+                out_prims.back().push_back( prims[l][l1] );
+            }
+            else
+            {
+                // copy to output, only, if chosen
+                if ( (prim_id < static_cast<LidT>(x_out.size())) && (int(round(x_out[prim_id])) > 0) )
                 {
-                    std::cout << "[" << __func__ << "]: " << "You didn't provide candidates, could not save primitives" << std::endl;
-                } // it no --candidates
+                    out_prims.back().push_back( prims[l][l1] );
+                    out_prims.back().back().setTag( _PrimitiveT::TAGS::STATUS, _PrimitiveT::STATUS_VALUES::ACTIVE );
 
-                // calc Energy
-                {
-                    std::string parent_path = boost::filesystem::path(project_path).parent_path().string();
-                    SparseMatrix xOut( x_out.size(), 1 );
-                    size_t varId = 0;
-                    for ( auto it = x_out.begin(); it != x_out.end(); ++it, ++varId )
-                        xOut.insert( varId, 0 ) = *it;
-
-                    OptScalar dataC     = (xOut.transpose() * p_problem->getLinObjectivesMatrix()).eval().coeff(0,0);
-                    OptScalar pairwiseC = (xOut.transpose() * p_problem->getQuadraticObjectivesMatrix() * xOut ).eval().coeff(0,0);
-                    std::cout << "E = " << dataC + pairwiseC << " = "
-                              << dataC << " (data) + " << pairwiseC << "(pw)"
-                              << std::endl;
-                    std::ofstream fenergy( parent_path + "/" + energy_path, std::ofstream::out | std::ofstream::app );
-                    fenergy << dataC + pairwiseC << "," << dataC << "," << pairwiseC << "," << 0 << std::endl;
-                    fenergy.close();
-                } //...calcEnergy
-            } //...if exit_success (solved)
-
-        } //...problem.optimize()
-
-        if ( p_problem ) { delete p_problem; p_problem = NULL; }
-    } //...err == doRetry || exit_SUCCESS
+                    // diagnostic // 5/1/2015
+                    if ( diag )
+                    {
+                        char name[256];
+                        sprintf( name,"p%ld,%ld", prims[l][l1].getTag(_PrimitiveT::TAGS::GID),prims[l][l1].getTag(_PrimitiveT::TAGS::DIR_GID) );
+                        diag->setNodeName( prim_id, name );
+                        diag->setNodePos( prim_id, prims[l][l1].template pos() );
+                    }
+                }
 
-    return err;
-}
+                // increment non-small primitive ids
+                ++prim_id;
+            }
+        } // ... for l1
+
+    return prim_id;
+} //...Solver::selectPrimitives()
 
 //! \brief Unfinished function. Supposed to do GlobFit.
 template < class _PrimitiveContainerT
@@ -488,35 +953,18 @@ Solver::checkSolution( std::vector<Scalar> const& x
 {
     Eigen::Matrix<Scalar,3,1> energy; energy.setZero();
 
-    SparseMatrix complexity( x.size(), 1 );
-    for ( size_t row = 0; row != x.size(); ++row )
-        complexity.insert( row, 0 ) = weights(2);
-
-    // X
-    SparseMatrix mx( x.size(), 1 );
-    for ( size_t i = 0; i != x.size(); ++i )
-        mx.insert( i, 0 ) = x[i];
-
-    SparseMatrix data   = linObj - complexity;
+    EnergyEvaluator<Scalar> evaluator( linObj, Qo );
+    evaluator.setX( x );
 
     // qo
-    SparseMatrix e02 = mx.transpose() * linObj;
-    std::cout << "[" << __func__ << "]: " << "qo * x = " << e02.coeffRef(0,0) << std::endl; fflush(stdout);
+    std::cout << "[" << __func__ << "]: " << "qo * x = " << evaluator.linear() << std::endl; fflush(stdout);
 
+    // complexity is weights(2) on every variable
+    energy(2) = weights(2) * std::accumulate( x.begin(), x.end(), Scalar(0) );
     // datacost
-    SparseMatrix e0 = (mx.transpose() * data);
-    energy(0) = e0.coeffRef(0,0);
-    //std::cout << "[" << __func__ << "]: " << "data: " << energy(0) << std::endl; fflush(stdout);
-
+    energy(0) = evaluator.linear() - energy(2);
     // Qo
-    SparseMatrix e1 = mx.transpose() * Qo * mx;
-    energy(1) = e1.coeffRef(0,0);
-    //std::cout << "[" << __func__ << "]: " << "x' * Qo * x = pw = " << energy(1) << std::endl; fflush(stdout);
-
-    // complexity
-    SparseMatrix e2 = mx.transpose() * complexity;
-    energy(2) = e2.coeffRef(0,0);
-    //std::cout << "[" << __func__ << "]: " << "complx = " << energy(2) << std::endl; fflush(stdout);
+    energy(1) = evaluator.pairwise();
     std::cout << "[" << __func__ << "]: " << std::setprecision(9) << energy(0) << " + " << energy(1) << " + " << energy(2) << " = " << energy.sum();
     std::cout                             << std::setprecision(9) << weights(0) << " * " << energy(0)/weights(0)
                                                                   << " + " << weights(1) << " * " << energy(1) / weights(1)
@@ -0,0 +1,434 @@
+#ifndef RAPTER_TILEDPIPELINE_HPP
+#define RAPTER_TILEDPIPELINE_HPP
+
+#include <map>
+#include <set>
+#include <vector>
+#include <limits>
+#include <numeric>                                     // iota
+#include <algorithm>                                   // stable_sort, lower_bound
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "boost/filesystem.hpp"
+
+#include "rapter/optimization/pipeline.h"
+#include "rapter/optimization/segmentation.h"          // orientPoints, patchify
+#include "rapter/optimization/patchDistanceFunctors.h" // RepresentativeSqrPatchPatchDistanceFunctorT
+#include "rapter/optimization/merging.h"               // mergeStep
+#include "rapter/processing/tiling.h"                  // Tiling
+#include "rapter/processing/util.hpp"                  // getPopulations, getCentroid
+#include "rapter/processing/impl/angleUtil.hpp"        // appendAnglesFromGenerators
+#include "rapter/io/io.h"                              // streamPoints, savePrimitives
+#include "rapter/io/tileStore.hpp"                     // TileStore
+
+namespace rapter
+{
+    namespace pipeline
+    {
+        //! \brief Bounding box and point count of a streamed cloud, see \ref io::streamPoints.
+        template <typename _Scalar>
+        struct BoundsChunkFunctor
+        {
+            typedef Eigen::Matrix<_Scalar,3,1> Position;
+
+            BoundsChunkFunctor()
+                : _min( Position::Constant( std::numeric_limits<_Scalar>::max()) )
+                , _max( Position::Constant(-std::numeric_limits<_Scalar>::max()) )
+                , _count( 0 ) {}
+
+            template <class _PointContainerT>
+            inline int operator()( _PointContainerT const& chunk, PidT const /*firstPid*/ )
+            {
+                for ( size_t i = 0; i != chunk.size(); ++i )
+                {
+                    _min = _min.cwiseMin( chunk[i].template pos() );
+                    _max = _max.cwiseMax( chunk[i].template pos() );
+                }
+                _count += chunk.size();
+                return EXIT_SUCCESS;
+            }
+
+            Position _min, _max;
+            PidT     _count;
+        }; //...BoundsChunkFunctor
+
+        //! \brief Appends streamed points to every tile, whose overlap contains them, see \ref io::streamPoints.
+        template <typename _Scalar>
+        struct SplitChunkFunctor
+        {
+            SplitChunkFunctor( processing::Tiling<_Scalar> const& tiling, io::TileStore &store )
+                : _tiling( tiling ), _store( store ) {}
+
+            template <class _PointContainerT>
+            inline int operator()( _PointContainerT const& chunk, PidT const firstPid )
+            {
+                int err = EXIT_SUCCESS;
+                for ( size_t i = 0; (i != chunk.size()) && (EXIT_SUCCESS == err); ++i )
+                {
+                    _tiling.tilesOf( _tiles, chunk[i].template pos() );
+                    for ( size_t t = 0; (t != _tiles.size()) && (EXIT_SUCCESS == err); ++t )
+                        err = _store.append( _tiles[t], chunk[i], firstPid + PidT(i) );
+                }
+                return err;
+            }
+
+            processing::Tiling<_Scalar> const& _tiling;
+            io::TileStore                    & _store;
+            std::vector<int>                   _tiles;
+        }; //...SplitChunkFunctor
+
+        /*! \brief Reads the <pid, gid> records of \p tile in \p store, sorted by pid, a point's records keep their order.
+         *  \param[out] assignments <input cloud index, GID> of every record.
+         */
+        template <class _PointPrimitiveT, class _PointContainerT>
+        inline int readAssignments( std::vector< std::pair<PidT,GidT> > &assignments, io::TileStore const& store, int const tile )
+        {
+            _PointContainerT  records;
+            std::vector<PidT> pids;
+            std::vector<GidT> gids;
+            const int err = store.read<_PointPrimitiveT>( records, tile, &pids, &gids );
+
+            assignments.resize( pids.size() );
+            for ( size_t i = 0; i != pids.size(); ++i )
+                assignments[i] = std::make_pair( pids[i], gids[i] );
+            std::stable_sort( assignments.begin(), assignments.end(), [](std::pair<PidT,GidT> const& a, std::pair<PidT,GidT> const& b) { return a.first < b.first; } );
+
+            return err;
+        } //...readAssignments()
+
+        /*! \brief GID of the first record of \p pid in \p assignments sorted by \ref readAssignments.
+         *  \return False, if \p pid has no record, \p gid is untouched then.
+         */
+        inline bool findAssignment( GidT &gid, std::vector< std::pair<PidT,GidT> > const& assignments, PidT const pid )
+        {
+            std::vector< std::pair<PidT,GidT> >::const_iterator it
+                = std::lower_bound( assignments.begin(), assignments.end(), std::make_pair(pid, std::numeric_limits<GidT>::lowest()) );
+            if ( (it == assignments.end()) || (it->first != pid) )
+                return false;
+            gid = it->second;
+            return true;
+        }
+
+        /*! \brief The in-memory part of \ref Segmentation::segmentCli: orients the points, unless most of them have normals, and groups them to patches.
+         *  \param[out]    patches Segmentation output, one primitive per patch.
+         *  \param[in,out] points  Points, their GID tags are set to their patch.
+         */
+        template < class _PrimitiveT, class _PointPrimitiveT, class _PrimitiveContainerT, class _PointContainerT, typename _Scalar >
+        inline int segment( _PrimitiveContainerT &patches, _PointContainerT &points, PipelineParams<_Scalar> const& params, bool const verbose )
+        {
+            CandidateGeneratorParams<_Scalar> generatorParams;
+            generatorParams.scale                  = params.scale;
+            generatorParams.patch_population_limit = params.patch_population_limit;
+            angles::appendAnglesFromGenerators( generatorParams.angles, params.segment_angle_gens, false, verbose );
+
+            size_t normalCnt = 0;
+            for ( size_t i = 0; i != points.size(); ++i )
+                normalCnt += ( points[i].template dir().norm() > _Scalar(0.1) );
+
+            int err = EXIT_SUCCESS;
+            if ( normalCnt * 2 <= points.size() )
+                err = Segmentation::orientPoints<_PointPrimitiveT,_PrimitiveT>( points, generatorParams.scale, generatorParams.nn_K, verbose, NULL, generatorParams.orient_scales );
+
+            if ( EXIT_SUCCESS == err )
+            {
+                RepresentativeSqrPatchPatchDistanceFunctorT< _Scalar, SpatialPatchPatchSingleDistanceFunctorT<_Scalar>
+                                                           > patchPatchDistanceFunctor( generatorParams.scale * generatorParams.patch_dist_limit_mult
+                                                                                      , generatorParams.angle_limit
+                                                                                      , generatorParams.scale
+                                                                                      , generatorParams.patch_spatial_weight );
+                err = Segmentation::patchify<_PrimitiveT>( patches, points, generatorParams.scale, generatorParams.angles, patchPatchDistanceFunctor
+                                                         , generatorParams.nn_K, verbose
+                                                         , ((generatorParams.patch_population_limit > 0) ? generatorParams.patch_population_limit : 0) );
+            }
+
+            return err;
+        } //...segment()
+    } //...ns pipeline
+
+    template < class _PrimitiveContainerT
+             , class _PrimitiveT
+             , class _PointPrimitiveT
+             , class _FiniteFiniteDistFunctor
+             , class _PointContainerT
+             , typename _Scalar
+             > int
+    TiledPipeline::run( std::string                  const& cloud_path
+                      , PipelineParams<_Scalar>      const& params
+                      , bool                         const  verbose )
+    {
+        typedef containers::PrimitiveContainer<_PrimitiveT>   PrimitiveMapT;
+        typedef typename PrimitiveMapT::mapped_type           InnerPrimitiveContainerT;
+        typedef typename InnerPrimitiveContainerT::const_iterator InnerConstIteratorT;
+        typedef std::map< GidT, std::vector<PidT> >           PopulationsT;
+
+        std::string o_path = boost::filesystem::path( cloud_path ).parent_path().string();
+        if ( o_path.empty() )
+            o_path = ".";
+        o_path += "/";
+        const _Scalar overlap = params.tile_overlap_mult * params.scale;
+
+        // (1) bounding box
+        pipeline::BoundsChunkFunctor<_Scalar> bounds;
+        if ( EXIT_SUCCESS != io::streamPoints<_PointPrimitiveT>(cloud_path, params.tile_buffer, bounds) || !bounds._count )
+        {
+            std::cerr << "[" << __func__ << "]: " << "could not read points from " << cloud_path << std::endl;
+            return EXIT_FAILURE;
+        }
+        const processing::Tiling<_Scalar> tiling( bounds._min, bounds._max, params.tile_size, overlap );
+        std::cout << "[" << __func__ << "]: " << bounds._count << " points in " << tiling.getCounts().transpose() << " tiles of " << params.tile_size
+                  << ", overlap " << overlap << std::endl;
+
+        // (2) spill to tiles
+        io::TileStore tileStore( o_path + "tiles/points", params.tile_buffer );
+        {
+            pipeline::SplitChunkFunctor<_Scalar> split( tiling, tileStore );
+            if ( (EXIT_SUCCESS != io::streamPoints<_PointPrimitiveT>(cloud_path, params.tile_buffer, split)) || (EXIT_SUCCESS != tileStore.flush()) )
+            {
+                std::cerr << "[" << __func__ << "]: " << "could not split " << cloud_path << " to tiles" << std::endl;
+                return EXIT_FAILURE;
+            }
+        } //...split
+
+        // (3) tile by tile: segment, iterate, keep the primitives centred in the core
+        io::TileStore   assignStore( o_path + "tiles/assignments", params.tile_buffer ); // <pid, global gid> by the tile owning the point
+        io::TileStore   seamStore  ( o_path + "tiles/seam"       , params.tile_buffer ); // populations of primitives near seams, tile 0
+        PrimitiveMapT   stitched;                                                           // kept primitives of all tiles, global GIDs
+        std::set<GidT>  seamGids;
+        GidT            gidOffset = 0;
+        DidT            dirOffset = 0;
+        int             err       = EXIT_SUCCESS;
+        for ( int tile = 0; (tile != tiling.size()) && (EXIT_SUCCESS == err); ++tile )
+        {
+            _PointContainerT  points;
+            std::vector<PidT> pids;
+            err = tileStore.read<_PointPrimitiveT>( points, tile, &pids );
+            if ( (EXIT_SUCCESS != err) || points.empty() )
+                continue;
+            std::cout << "[" << __func__ << "]: " << "tile " << tile + 1 << "/" << tiling.size() << ": " << points.size() << " points" << std::endl;
+
+            _PrimitiveContainerT segments;
+            err = pipeline::segment<_PrimitiveT,_PointPrimitiveT>( segments, points, params, verbose );
+            if ( EXIT_SUCCESS != err )
+            {
+                std::cerr << "[" << __func__ << "]: " << "segmentation of tile " << tile << " failed with " << err << std::endl;
+                break;
+            }
+
+            PrimitiveMapT patches;
+            pipeline::group<_PrimitiveT>( patches, segments );
+            if ( patches.empty() )
+                continue;
+
+            std::stringstream tileDir;
+            tileDir << o_path << "tiles/tile_" << tile;
+            boost::filesystem::create_directories( tileDir.str() );
+            PclCloudPtrT pclCloud = io::toPclCloud( points );
+            err = Pipeline::run<_PrimitiveT, _PointPrimitiveT, _FiniteFiniteDistFunctor>( patches, points, pclCloud, params, tileDir.str() + "/cloud.rbin", verbose );
+            if ( EXIT_SUCCESS != err )
+            {
+                std::cerr << "[" << __func__ << "]: " << "tile " << tile << " failed with " << err << std::endl;
+                break;
+            }
+
+            // keep primitives with their population centred in this tile's core, renumbered to global ids
+            PopulationsT populations;
+            processing::getPopulations( populations, points );
+            std::map<GidT, GidT> globalGids;
+            GidT maxGid = -1;
+            DidT maxDir = -1;
+            for ( typename PrimitiveMapT::const_iterator it = patches.begin(); it != patches.end(); ++it )
+            {
+                maxGid = std::max( maxGid, it->first );
+                for ( InnerConstIteratorT it1 = it->second.begin(); it1 != it->second.end(); ++it1 )
+                    maxDir = std::max( maxDir, it1->getTag(_PrimitiveT::TAGS::DIR_GID) );
+
+                typename PopulationsT::const_iterator pop = populations.find( it->first );
+                if ( (pop == populations.end()) || (tiling.owner(processing::getCentroid<_Scalar>(points, &pop->second)) != tile) )
+                    continue;
+
+                const GidT gid = gidOffset + it->first;
+                globalGids[ it->first ] = gid;
+                for ( InnerConstIteratorT it1 = it->second.begin(); it1 != it->second.end(); ++it1 )
+                {
+                    _PrimitiveT prim( *it1 );
+                    prim.setTag( _PrimitiveT::TAGS::GID    , gid );
+                    prim.setTag( _PrimitiveT::TAGS::DIR_GID, dirOffset + it1->getTag(_PrimitiveT::TAGS::DIR_GID) );
+                    stitched[ gid ].push_back( prim );
+                }
+
+                // stitch later, if any of its points is close to a seam
+                for ( size_t i = 0; i != pop->second.size(); ++i )
+                    if ( tiling.distanceToSeam(tile, points[pop->second[i]].template pos()) < overlap )
+                    {
+                        seamGids.insert( gid );
+                        break;
+                    }
+            }
+            gidOffset += maxGid + 1;
+            dirOffset += maxDir + 1;
+
+            // the kept primitives' points, also the ones other tiles own
+            for ( size_t pid = 0; (pid != points.size()) && (EXIT_SUCCESS == err); ++pid )
+            {
+                std::map<GidT, GidT>::const_iterator it = globalGids.find( points[pid].getTag(_PointPrimitiveT::TAGS::GID) );
+                if ( it == globalGids.end() )
+                    continue;
+                err = assignStore.append( tiling.owner(points[pid].template pos()), points[pid], pids[pid], it->second );
+                if ( (EXIT_SUCCESS == err) && seamGids.count(it->second) )
+                    err = seamStore.append( 0, points[pid], pids[pid], it->second );
+            }
+        } //...for tiles
+        err |= assignStore.flush();
+        err |= seamStore.flush();
+        if ( EXIT_SUCCESS != err )
+            return err;
+
+        // (4) merge primitives across seams, on their populations only, the new assignments are stored by the tile owning the point
+        io::TileStore seamAssignStore( o_path + "tiles/seam_assignments", params.tile_buffer );
+        {
+            _PointContainerT  seamPoints;
+            std::vector<PidT> seamPids;
+            std::vector<GidT> seamPointGids;
+            {
+                _PointContainerT  records;
+                std::vector<PidT> recordPids;
+                std::vector<GidT> recordGids;
+                err = seamStore.read<_PointPrimitiveT>( records, 0, &recordPids, &recordGids );
+
+                // points in the overlap of two kept primitives are stored twice, the first one wins
+                std::vector<size_t> order( records.size() );
+                std::iota( order.begin(), order.end(), size_t(0) );
+                std::stable_sort( order.begin(), order.end(), [&recordPids](size_t const a, size_t const b) { return recordPids[a] < recordPids[b]; } );
+                std::vector<char> first( records.size(), 0 );
+                for ( size_t k = 0; k != order.size(); ++k )
+                    first[ order[k] ] = !k || (recordPids[order[k]] != recordPids[order[k-1]]);
+
+                for ( size_t i = 0; i != records.size(); ++i )
+                    if ( first[i] )
+                    {
+                        seamPoints.push_back( records[i] );
+                        seamPoints.back().setTag( _PointPrimitiveT::TAGS::PID, seamPoints.size() - 1 );
+                        seamPoints.back().setTag( _PointPrimitiveT::TAGS::GID, recordGids[i] );
+                        seamPids.push_back( recordPids[i] );
+                    }
+            }
+
+            PrimitiveMapT seamPrims;
+            DidT          maxSeamDir = -1;
+            for ( std::set<GidT>::const_iterator it = seamGids.begin(); it != seamGids.end(); ++it )
+            {
+                typename PrimitiveMapT::iterator prims = stitched.find( *it );
+                for ( InnerConstIteratorT it1 = prims->second.begin(); it1 != prims->second.end(); ++it1 )
+                    maxSeamDir = std::max( maxSeamDir, it1->getTag(_PrimitiveT::TAGS::DIR_GID) );
+                seamPrims[ *it ] = prims->second;
+                stitched.erase( prims );
+            }
+            std::cout << "[" << __func__ << "]: " << "stitching " << seamPrims.size() << " primitives over " << seamPoints.size() << " points" << std::endl;
+
+            if ( (EXIT_SUCCESS == err) && seamPrims.size() )
+            {
+                MergeParams<_Scalar> mergeParams;
+                mergeParams.scale                  = params.scale * params.merge_mult;
+                mergeParams.do_adopt               = 0;
+                mergeParams.patch_population_limit = params.patch_population_limit;
+                mergeParams.is3D                   = params.is3D;
+                angles::appendAnglesFromGenerators( mergeParams.angles, (params.iterations > params.use90) ? params.extended_angle_gens : params.angle_gens, false, verbose );
+
+                PrimitiveMapT merged;
+                err = Merging::mergeStep<_PointPrimitiveT,_PrimitiveT>( /* out: */ merged, seamPoints, /* in: */ seamPrims, mergeParams );
+
+                // merging numbers refit directions after the largest seam direction, move them after all others
+                std::map<DidT, DidT> newDirs;
+                for ( typename PrimitiveMapT::iterator it = merged.begin(); it != merged.end(); ++it )
+                    for ( typename InnerPrimitiveContainerT::iterator it1 = it->second.begin(); it1 != it->second.end(); ++it1 )
+                    {
+                        const DidT dir = it1->getTag( _PrimitiveT::TAGS::DIR_GID );
+                        if ( dir <= maxSeamDir )
+                            continue;
+                        if ( !newDirs.count(dir) )
+                            newDirs[ dir ] = dirOffset++;
+                        it1->setTag( _PrimitiveT::TAGS::DIR_GID, newDirs[dir] );
+                    }
+                stitched.insert( merged.begin(), merged.end() );
+
+                for ( size_t i = 0; (i != seamPoints.size()) && (EXIT_SUCCESS == err); ++i )
+                    err = seamAssignStore.append( tiling.owner(seamPoints[i].template pos()), seamPoints[i], seamPids[i], seamPoints[i].getTag(_PointPrimitiveT::TAGS::GID) );
+                err |= seamAssignStore.flush();
+            }
+            else
+                stitched.insert( seamPrims.begin(), seamPrims.end() );
+        } //...stitch
+        if ( EXIT_SUCCESS != err )
+            return err;
+
+        // (5) save primitives and stream associations tile by tile, every point is written by its owner tile
+        std::vector<InnerPrimitiveContainerT> out_prims;
+        pipeline::flatten( out_prims, stitched );
+        err = io::savePrimitives<_PrimitiveT, InnerConstIteratorT>( out_prims, o_path + "primitives_tiled.csv" );
+
+        // <gid, dir_gid> of every patch, its active primitive's, if it has one
+        std::vector< std::pair<GidT,DidT> > patchDirs;
+        patchDirs.reserve( out_prims.size() );
+        for ( size_t l = 0; l != out_prims.size(); ++l )
+        {
+            if ( out_prims[l].empty() )
+                continue;
+            InnerConstIteratorT prim = out_prims[l].begin();
+            for ( InnerConstIteratorT it1 = out_prims[l].begin(); it1 != out_prims[l].end(); ++it1 )
+                if ( it1->getTag(_PrimitiveT::TAGS::STATUS) == _PrimitiveT::STATUS_VALUES::ACTIVE )
+                {
+                    prim = it1;
+                    break;
+                }
+            patchDirs.push_back( std::make_pair(prim->getTag(_PrimitiveT::TAGS::GID), prim->getTag(_PrimitiveT::TAGS::DIR_GID)) );
+        }
+        std::sort( patchDirs.begin(), patchDirs.end() );
+
+        const std::string assoc_path = o_path + "points_primitives_tiled.csv";
+        std::ofstream f_assoc( assoc_path.c_str() );
+        if ( !f_assoc.is_open() ) { std::cerr << "[" << __func__ << "]: " << "could not open " << assoc_path << " for writing..." << std::endl; return EXIT_FAILURE; }
+        f_assoc << "# point_id,primitive_gid,primitive_dir_gid" << std::endl;
+        for ( int tile = 0; (tile != tiling.size()) && (EXIT_SUCCESS == err); ++tile )
+        {
+            _PointContainerT  points;
+            std::vector<PidT> pids;
+            std::vector< std::pair<PidT,GidT> > gids, seamGidsOfTile;   // <pid, gid>, sorted by pid
+            err  = tileStore.read<_PointPrimitiveT>( points, tile, &pids );
+            err |= pipeline::readAssignments<_PointPrimitiveT, _PointContainerT>( gids          , assignStore    , tile );
+            err |= pipeline::readAssignments<_PointPrimitiveT, _PointContainerT>( seamGidsOfTile, seamAssignStore, tile );
+
+            for ( size_t i = 0; i != points.size(); ++i )
+            {
+                if ( tiling.owner(points[i].template pos()) != tile )
+                    continue;
+
+                // stitched assignment, or the first one the point got in (3)
+                GidT gid = -1;
+                if ( !pipeline::findAssignment(gid, seamGidsOfTile, pids[i]) )
+                    pipeline::findAssignment( gid, gids, pids[i] );
+                DidT dir = -1;
+                if ( gid >= 0 )
+                {
+                    typename std::vector< std::pair<GidT,DidT> >::const_iterator patch
+                        = std::lower_bound( patchDirs.begin(), patchDirs.end(), std::make_pair(gid, std::numeric_limits<DidT>::lowest()) );
+                    if ( (patch != patchDirs.end()) && (patch->first == gid) )
+                        dir = patch->second;
+                }
+                f_assoc << pids[i] << "," << gid << "," << dir << "\n";
+            }
+
+            tileStore      .remove( tile );
+            assignStore    .remove( tile );
+            seamAssignStore.remove( tile );
+        }
+        seamStore.remove( 0 );
+        f_assoc.close();
+
+        std::cout << "[" << __func__ << "]: " << "wrote " << out_prims.size() << " patches to " << o_path << "primitives_tiled.csv and " << assoc_path << std::endl;
+        return err;
+    } //...TiledPipeline::run()
+} //...ns rapter
+
+#endif // RAPTER_TILEDPIPELINE_HPP
@@ -2,6 +2,7 @@
 #define RAPTER_MERGING_H
 
 #include <iostream>
+#include "rapter/parameters.h" // MergeParams
 
 namespace rapter {
 
@@ -17,6 +18,27 @@ class Merging
                  >
         static inline int mergeCli( int argc, char** argv );
 
+        /*! \brief Adopts orphan points, if asked, and merges the primitives on in-memory data. Used by \ref mergeCli and \ref Pipeline.
+         *  \tparam _PrimitiveMapT     Concept: \ref containers::PrimitiveContainer< \ref rapter::LinePrimitive2 >.
+         *  \param[out]    out_prims   Merged primitives.
+         *  \param[in,out] points      Points, their GID tags get updated.
+         *  \param[in]     prims_map   Primitives to merge, grouped by GID.
+         *  \param[in]     params      Uses is3D and do_adopt besides the merge parameters.
+         *  \param[in]     sizeLimit   If >0, a non-spatial recursive partitioning will happen above this primitive count.
+         *  \return                    EXIT_SUCCESS.
+         */
+        template < class    _PointPrimitiveT
+                 , class    _PrimitiveT
+                 , class    _PrimitiveMapT
+                 , class    _PointContainerT
+                 , typename _Scalar
+                 >
+        static inline int mergeStep( _PrimitiveMapT             & out_prims
+                                   , _PointContainerT           & points
+                                   , _PrimitiveMapT        const& prims_map
+                                   , MergeParams<_Scalar>  const& params
+                                   , size_t                const  sizeLimit = 0 );
+
         /*! \brief Greedily assigns points with GID-s that are not in prims to prims that explain them.
         *        Unambiguous assignments go through first, than based on proximity, capped by scale.
         *
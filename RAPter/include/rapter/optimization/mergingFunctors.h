@@ -5,6 +5,12 @@
 
 namespace rapter {
 struct DecideMergeLineFunctor {
+    /*! \brief Bounding boxes of the extrema of two lines, that eval() accepts, are never further apart than this along any axis.
+     *         An endpoint of one has to be within scale of the other's line, and project within scale of its segment, that is at most sqrt(2) * scale from its box.
+     */
+    template <typename _Scalar>
+    static inline _Scalar maxReach( _Scalar scale ) { return _Scalar(2.) * scale; }
+
     template <class _LineT, class _PointContainerT, typename _Scalar>
     inline bool eval(
               _PointContainerT const& extrema0
@@ -167,6 +173,12 @@ private:
     }
 
 public:
+    /*! \brief Bounding boxes of the extrema of two planes, that eval() accepts, are never further apart than this along any axis.
+     *         An extremum of one has to be inside the other's rectangle grown by scale in all three directions, that is at most sqrt(3) * scale from its box.
+     */
+    template <typename _Scalar>
+    static inline _Scalar maxReach( _Scalar scale ) { return _Scalar(2.) * scale; }
+
     template <class _PlaneT, class _PointContainerT, typename _Scalar>
     inline bool eval(
               _PointContainerT const& extrema0
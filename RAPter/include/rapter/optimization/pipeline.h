@@ -0,0 +1,91 @@
+#ifndef RAPTER_PIPELINE_H
+#define RAPTER_PIPELINE_H
+
+#include <string>
+#include "rapter/parameters.h"      // PipelineParams
+#include "rapter/util/pclUtil.h"    // PclCloudPtrT
+
+namespace rapter
+{
+    /*! \brief Runs the generate-formulate-solve-merge iterations of scripts/run.sh in a single process.
+     *         Points, their neighbourhood graph and the primitives stay in memory between the steps,
+     *         files are only written for the final result, or every iteration with \ref PipelineParams::checkpoint.
+     */
+    class Pipeline
+    {
+        public:
+            /*! \brief                          Reads the segmentation output (cloud, patches and associations) and runs \ref run on it.
+             *  \tparam _FiniteFiniteDistFunctor Concept: \ref rapter::_2d::MyFiniteLineToFiniteLineCompatFunctor.
+             *  \param argc                     Number of CLI arguments.
+             *  \param argv                     Vector of CLI arguments.
+             *  \return                         EXIT_SUCCESS, or the first failing step's error code.
+             */
+            template < class _PrimitiveContainerT
+                     , class _PointContainerT
+                     , class _PrimitiveT
+                     , class _PointPrimitiveT
+                     , class _FiniteFiniteDistFunctor
+                     >
+            static inline int runCli( int argc, char** argv );
+
+            /*! \brief                      Iterates \ref CandidateGenerator::generateStep, \ref ProblemSetup::formulateStep,
+             *                              \ref Solver::optimizeProblem and \ref Merging::mergeStep following the schedule in \p params.
+             *  \tparam _PrimitiveMapT      Concept: \ref containers::PrimitiveContainer< \ref rapter::LinePrimitive2 >.
+             *  \param[in,out] patches      Input patches, the last merged primitives on output.
+             *  \param[in,out] points       Points tagged with the GID of their patch, tags are updated by merging.
+             *  \param[in]     pclCloud     Same cloud as \p points, used by formulation.
+             *  \param[in]     params       Schedule and step parameters.
+             *  \param[in]     cloud_path   Locates the neighbourhood graph and the output directory.
+             *  \return                     EXIT_SUCCESS, or the first failing step's error code.
+             */
+            template < class _PrimitiveT
+                     , class _PointPrimitiveT
+                     , class _FiniteFiniteDistFunctor
+                     , class _PrimitiveMapT
+                     , class _PointContainerT
+                     , typename _Scalar
+                     >
+            static inline int run( _PrimitiveMapT                    & patches
+                                 , _PointContainerT                  & points
+                                 , PclCloudPtrT                      & pclCloud
+                                 , PipelineParams<_Scalar>      const& params
+                                 , std::string                  const& cloud_path
+                                 , bool                         const  verbose = false );
+    }; //...class Pipeline
+
+    /*! \brief Runs segmentation and \ref Pipeline::run tile by tile on clouds, that don't fit in memory, then stitches the tiles' primitives.
+     *
+     *  The cloud is streamed twice: once for its bounding box, once to spill it to overlapping tiles on disk (\ref io::TileStore).
+     *  Each tile is then loaded, segmented and iterated on its own, so memory use is bounded by the largest tile.
+     *  A tile keeps the primitives, whose population centroid lies in its core, so every primitive found by neighbouring tiles in their overlap is kept once.
+     *  Kept primitives, that reach within the overlap of a seam, are merged across tiles by a final \ref Merging::mergeStep over their populations only.
+     */
+    class TiledPipeline
+    {
+        public:
+            /*! \brief                          Tiles, segments, iterates and stitches the cloud at \p cloud_path.
+             *  \tparam _PrimitiveContainerT     Concept: vector< vector< \ref rapter::LinePrimitive2 > >, the segmentation output.
+             *  \tparam _FiniteFiniteDistFunctor Concept: \ref rapter::_2d::MyFiniteLineToFiniteLineCompatFunctor.
+             *  \param[in] cloud_path           Cloud to process, streamed.
+             *  \param[in] params               Schedule, step and tiling parameters, \ref PipelineParams::tile_size has to be positive.
+             *  \post                           "tiles/tile_<id>/" holds each tile's \ref Pipeline output, "primitives_tiled.csv" and
+             *                                  "points_primitives_tiled.csv" the stitched result next to \p cloud_path.
+             *  \return                         EXIT_SUCCESS, or the first failing step's error code.
+             */
+            template < class _PrimitiveContainerT
+                     , class _PrimitiveT
+                     , class _PointPrimitiveT
+                     , class _FiniteFiniteDistFunctor
+                     , class _PointContainerT
+                     , typename _Scalar
+                     >
+            static inline int run( std::string                  const& cloud_path
+                                 , PipelineParams<_Scalar>      const& params
+                                 , bool                         const  verbose = false );
+    }; //...class TiledPipeline
+} //...ns rapter
+
+#include "rapter/optimization/impl/pipeline.hpp"
+#include "rapter/optimization/impl/tiledPipeline.hpp"
+
+#endif // RAPTER_PIPELINE_H
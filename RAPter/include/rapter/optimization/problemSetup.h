@@ -4,6 +4,7 @@
 #include <vector>
 #include <map>
 #include <set>
+#include <stdexcept>                // out_of_range
 
 #include "qcqpcpp/optProblem.h"     // OptProblem
 #include "rapter/parameters.h"      // ProblemSetupParams
@@ -11,6 +12,8 @@
 
 namespace rapter
 {
+    namespace processing { class NeighbourhoodGraph; }
+
     // predecl
     template <typename _Scalar, class _PrimitiveT> struct AbstractPrimitivePrimitiveEnergyFunctor;
 
@@ -19,6 +22,48 @@ namespace rapter
         //! \brief General problem type, most implementations require double, so it is fixed to double.
         typedef qcqpcpp::OptProblem<double> OptProblemT;
 
+        /*! \brief Contiguous <lid,lid1> -> variable id lookup, replaces std::map< std::pair<LidT,LidT>, LidT > as _AssocT.
+         *         The ids of prims[lid] are stored consecutively from _offsets[lid], SMALL primitives have no variable (-1).
+         */
+        class VarIdMap
+        {
+            public:
+                typedef std::pair<LidT,LidT> key_type;
+                typedef LidT                 mapped_type;
+
+                VarIdMap() : _size(0) {}
+
+                //! \brief Allocates one unset slot for each primitive in \p prims.
+                template <class _PrimitiveContainerT>
+                inline void reset( _PrimitiveContainerT const& prims )
+                {
+                    _offsets.resize( prims.size() + 1 );
+                    _offsets[0] = 0;
+                    for ( size_t lid = 0; lid != prims.size(); ++lid )
+                        _offsets[lid+1] = _offsets[lid] + prims[lid].size();
+                    _varIds.assign( _offsets.back(), LidT(-1) );
+                    _size = 0;
+                }
+
+                inline void   set ( LidT const lid, LidT const lid1, LidT const varId ) { LidT &v = _varIds[ _offsets[lid] + lid1 ]; if ( v < 0 ) ++_size; v = varId; }
+                //! \return Variable id of prims[lid][lid1], or -1, if it has none.
+                inline LidT   get ( LidT const lid, LidT const lid1 ) const { return _varIds[ _offsets[lid] + lid1 ]; }
+                inline LidT   at  ( key_type const& key ) const
+                {
+                    LidT const varId = ( (key.first >= 0) && (key.first + 1 < LidT(_offsets.size())) && (key.second >= 0) && (key.second < _offsets[key.first+1] - _offsets[key.first]) )
+                                       ? get( key.first, key.second ) : LidT(-1);
+                    if ( varId < 0 )
+                        throw std::out_of_range( "VarIdMap::at" );
+                    return varId;
+                }
+                inline size_t size() const { return _size; } //!< \brief Number of primitives with a variable.
+
+            protected:
+                std::vector<LidT> _offsets; //!< \brief prims.size()+1 prefix sums of the patch sizes.
+                std::vector<LidT> _varIds;  //!< \brief Flat variable ids, -1 if unset.
+                size_t            _size;
+        }; //...class VarIdMap
+
         //! \brief              Adds constraints to \p problem so, that each patch (prims[i] that have the same _PrimitiveT::TAGS::GID) has at least one member j (prims[i][j]) selected.
         //! \tparam _AssocT     Associates a primitive identified by <lid,lid1> with a variable id in the problem. Default: std::map< std::pair<int,int>, int >
         template < class _PointPrimitiveDistanceFunctor
@@ -146,6 +191,10 @@ namespace rapter
              *  \param[in] dir_id_bias          \copydoc ProblemSetupParams::dir_id_bias.
              *  \param[in] verbose              Debug messages display.
              *  \param[in] freq_weight          Multiplies the data cost by freq_weight / DIR_COUNT.
+             *  \param[in] neighGraph           Optional precomputed point neighbourhoods for the patch proximity pass.
+             *  \param[in] varNames             Names the variables "x_<gid>_<did>" and "dId<did>", only needed for debug output.
+             *  \param[in] pwPruneEps           Direction pairs with a weighted pairwise cost below this are left out of Qo. 0 keeps all of them.
+             *  \param[in] pwReference          Assemble the pairwise terms both ways, as the dense path did, ignores \p pwPruneEps. Only for comparing against.
              *  \return                         Outputs EXIT_SUCCESS or the error the OptProblem implementation returns.
              *  \note                           \p points are assumed to be tagged at _PointPrimitiveT::TAGS::GID with the _PrimitiveT::TAGS::GID of the \p prims.
              *  \sa \ref problemSetup::largePatchesNeedDirectionConstraint
@@ -174,8 +223,42 @@ namespace rapter
                      , _Scalar                                                            const  freq_weight            = 0.
                      , int                                                                const  clusterMode            = 1
                      , _Scalar                                                            const  collapseThreshold      = 0.07 // sqrt( 0.1 * PI / 180 ) == 0.06605545496
+                     , processing::NeighbourhoodGraph                                     const* neighGraph             = NULL
+                     , bool                                                               const  varNames               = true
+                     , _Scalar                                                            const  pwPruneEps             = 0.
+                     , bool                                                               const  pwReference            = false
                      );
 
+            /*! \brief                          Sets up the spatial pairwise functor from \p params and calls \ref formulate2 on in-memory data.
+             *                                  Used by \ref formulateCli and \ref Pipeline.
+             *  \tparam _FiniteFiniteDistFunctor Concept: \ref rapter::SpatialSqrtPrimitivePrimitiveEnergyFunctor.
+             *  \param[out] problem             Problem to append to.
+             *  \param[in]  prims               Candidates, grouped by GID in ascending order, as \ref io::readPrimitives reads them.
+             *  \param[in]  points              Points tagged with the GID of their patch.
+             *  \param[in]  params              Needs angles already generated.
+             *  \param[in]  angle_gens_in_rad   Angle generators in radians.
+             *  \param[in]  clustersMode        Adds spatial cluster variables, if non-zero.
+             *  \param[in]  neighGraph          Optional precomputed point neighbourhoods, see \ref formulate2.
+             *  \return                         Outputs EXIT_SUCCESS or the error the OptProblem implementation returns.
+             */
+            template < class _PointPrimitiveDistanceFunctor
+                     , class _FiniteFiniteDistFunctor
+                     , class _PrimitiveContainerT
+                     , class _PointContainerT
+                     , typename _Scalar
+                     , class _PrimitiveT        = typename _PrimitiveContainerT::value_type::value_type
+                     > static inline int
+            formulateStep( problemSetup::OptProblemT                & problem
+                         , _PrimitiveContainerT                const& prims
+                         , _PointContainerT                    const& points
+                         , ProblemSetupParams<_Scalar>         const& params
+                         , AnglesT                             const& angle_gens_in_rad
+                         , PclCloudPtrT                             & pclCloud
+                         , int                                 const  clustersMode
+                         , processing::NeighbourhoodGraph      const* neighGraph = NULL
+                         , bool                                const  verbose    = false
+                         );
+
     }; //...class ProblemSetup
 } //...namespace rapter
 
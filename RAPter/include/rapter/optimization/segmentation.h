@@ -10,6 +10,8 @@
 
 namespace rapter {
 
+namespace processing { class NeighbourhoodGraph; }
+
 namespace segmentation {
     typedef std::pair<PidT,LidT>      PidLid;
 
@@ -101,6 +103,8 @@ class Segmentation
         //! \param[in/out] points
         //! \param[in]     scale    Fit radius
         //! \param[in]     nn_K     Nearest neighbour count to fit primitive to.
+        //! \param[in]     neighGraph Optional precomputed neighbourhoods, used instead of kd-tree queries, if they cover \p scale.
+        //! \param[in]     scaleCount Number of fit radii around \p scale, see \ref fitLocal.
         template < class     _PointPrimitiveT
                  , class     _PrimitiveT
                  , typename  _Scalar
@@ -110,7 +114,9 @@ class Segmentation
         orientPoints( _PointContainerT       &points
                     , _Scalar          const  scale
                     , int              const  nn_K
-                    , int              const  verbose );
+                    , int              const  verbose
+                    , processing::NeighbourhoodGraph const* neighGraph = NULL
+                    , int              const  scaleCount = 1 );
 
         /*!
          * \brief patchify Groups unoriented points into oriented patches represented by a single primitive
@@ -124,6 +130,7 @@ class Segmentation
          * \param[in]  angles                    Desired angles to use for groupings.
          * \param[in]  patchPatchDistanceFunctor #regionGrow() uses the thresholds encoded to group points. The evalSpatial() function is used to assign orphan points.
          * \param[in]  nn_K                      Number of nearest neighbour points looked for in #regionGrow().
+         * \param[in]  neighGraph                Optional precomputed neighbourhoods relayed to #regionGrow().
          */
         template <
                  class       _PrimitiveT
@@ -140,6 +147,7 @@ class Segmentation
                 , int                               const  nn_K
                 , int                               const  verbose
                 , size_t                            const  patchPopLimit
+                , processing::NeighbourhoodGraph    const* neighGraph = NULL
                 );
 
         /*! \brief                               Greedy region growing
@@ -158,6 +166,7 @@ class Segmentation
          *                                       that only contains a neighbouring point, and decides. See in \ref RepresentativeSqrPatchPatchDistanceFunctorT.
          *  \param[in] gid_tag_name              The key value of GID in _PointT. Suggested to be: _PointT::GID.
          *  \param[in] nn_K                      Number of nearest neighbour points looked for.
+         *  \param[in] neighGraph                Optional precomputed neighbourhoods, used instead of building a kd-tree, if they cover the spatial threshold.
          */
         template < class       _PrimitiveT
                  , class       _PointContainerT
@@ -174,12 +183,15 @@ class Segmentation
                   , GidT                        const  gid_tag_name              //= _PointT::GID
                   , int                         const  nn_K
                   , bool                        const  verbose
+                  , processing::NeighbourhoodGraph const* neighGraph = NULL
                   );
 
         /*! \brief  Fits a local direction to each point and it's neighourhood.
          *          Create local fits to local neighbourhoods, these will be the point orientations.
          *  \tparam PrimitiveContainerT Concept: vector< vector< LinePrimitive2/PlanePrimitive > >.
          *  \tparam _PointContainerPtrT Concept: pcl::PointCloud<pcl::PointXYZRGB>::Ptr.
+         *  \param[in] scaleCount        Fits at this many radii around \p radius (see \ref processing::localfit::scaleRadii) from one query,
+         *                               and keeps the fit with the lowest surface variation. 1: \p radius only.
          */
         template <  class _PrimitiveContainerT
                   , class _PointContainerPtrT>
@@ -192,6 +204,8 @@ class Segmentation
                 , bool                 const  soft_radius
                 , std::vector<PidT>          * mapping
                 , int                    const  verbose
+                , processing::NeighbourhoodGraph const* neighGraph = NULL
+                , int                    const  scaleCount = 1
                 );
     protected:
         template < class    _PointPrimitiveT
@@ -3,10 +3,13 @@
 
 //#include "qcqpcpp/io/io.h"    // read/writeSparseMatrix
 #include "Eigen/Sparse"         // Eigen::SparseMatrix (solve)
+#include "qcqpcpp/optProblem.h" // OptProblem (optimizeProblem)
 #include "rapter/typedefs.h"    // rapter::Scalar (solve)
 
 namespace rapter {
 
+template <typename _Scalar> class Diagnostic;
+
 /*! \brief Not used.
  */
 struct SolverParams
@@ -19,8 +22,12 @@ class Solver
     public:
         static const int DO_RETRY = -11; // signal to tell solveCli to run again
 
+        //! \brief Solver backends, BONMIN and NATIVE are implemented. NATIVE is qcqpcpp::LocalSearchOpt, a heuristic without dependencies.
+        enum SOLVER { MOSEK, BONMIN, GUROBI, NATIVE };
+
         //typedef Eigen::Matrix<Scalar,3,1>                   Vector;
         typedef Eigen::SparseMatrix<Scalar,Eigen::RowMajor> SparseMatrix;
+        typedef qcqpcpp::OptProblem<double>                  OptProblemT; //!< \brief Mosek, and Bonmin uses double internally.
 
         template < class _PrimitiveContainerT
                  , class _InnerPrimitiveContainerT
@@ -28,6 +35,96 @@ class Solver
                  >
         static inline int solve      ( int argc, char** argv );
 
+        /*! \brief Copies \p problem into the solver specific problem type and optimizes it. Used by \ref solve and \ref Pipeline.
+         *  \param[out] x_out        Solution, one entry per variable.
+         *  \param[in]  problem      Formulated problem, see \ref ProblemSetup::formulate2.
+         *  \param[in]  max_time     Time limit in seconds, ignored if not positive.
+         *  \param[in]  bmode        Bonmin algorithm code, 0: B_BB.
+         *  \param[in]  attemptCount Bonmin's node limit is (1 + attemptCount) * 100, the native solver's restart count is (1 + attemptCount) * 8.
+         *  \param[in]  x0           Optional starting point, overrides the one stored in \p problem.
+         *  \param[in]  useIncumbent If the starting point is feasible, it bounds the search as incumbent,
+         *                           and is returned, if the solver finds nothing better.
+         *  \return                  EXIT_SUCCESS, \ref DO_RETRY, if the solver returned an empty solution, or the solver's error code.
+         */
+        static inline int optimizeProblem( std::vector<double>                    & x_out
+                                         , OptProblemT                       const& problem
+                                         , SOLVER                            const  solver
+                                         , Scalar                            const  max_time
+                                         , int                               const  bmode
+                                         , int                               const  attemptCount
+                                         , OptProblemT::SparseMatrix         const* x0           = NULL
+                                         , bool                              const  verbose      = false
+                                         , bool                              const  useIncumbent = true );
+
+        /*! \brief Splits \p problem into the connected components of its variable interaction graph. Two variables interact,
+         *         if they share a quadratic objective entry, or appear in the same constraint.
+         *  \param[out] parts   One problem per component, with variables, objectives, constraints and starting point of \p problem restricted to it.
+         *                      Constraints without variables, and the objective bias go to the first part.
+         *  \param[out] varIds  Variable ids in \p problem of the variables of each part, ascending.
+         *  \return             EXIT_SUCCESS, or the error code of building a part.
+         */
+        static inline int decompose( std::vector<OptProblemT>                 & parts
+                                   , std::vector< std::vector<LidT> >         & varIds
+                                   , OptProblemT                         const& problem );
+
+        /*! \brief Solves the components of \p problem (see \ref decompose) as independent problems, in parallel, if the solver is \ref NATIVE,
+         *         and assembles their solutions. Falls back to \ref optimizeProblem, if \p problem is connected.
+         *         A component is retried once on \ref DO_RETRY, and accepted, if its solution is feasible, even if all zero.
+         *  \param[out] x_out    Solution, one entry per variable of \p problem.
+         *  \return              EXIT_SUCCESS, or the first failing component's error code. Parameters as in \ref optimizeProblem.
+         */
+        static inline int optimizeDecomposed( std::vector<double>                    & x_out
+                                            , OptProblemT                       const& problem
+                                            , SOLVER                            const  solver
+                                            , Scalar                            const  max_time
+                                            , int                               const  bmode
+                                            , int                               const  attemptCount
+                                            , OptProblemT::SparseMatrix         const* x0           = NULL
+                                            , bool                              const  verbose      = false
+                                            , bool                              const  useIncumbent = true );
+
+        /*! \brief Objective value and feasibility of \p x, evaluated the way Bonmin does (x' * Qo * x + qo' * x).
+         *  \param[out] objective Objective value of \p x, max(), if \p x has the wrong size.
+         *  \param[in]  tol       Tolerance for bounds, integrality and constraints.
+         *  \return               True, if \p x satisfies all bounds, integralities and constraints of \p problem.
+         */
+        static inline bool evalSolution( double                         & objective
+                                       , OptProblemT               const& problem
+                                       , OptProblemT::VectorX      const& x
+                                       , double                    const  tol = 1e-6 );
+
+        /*! \brief Builds a starting point from a previous selection. A candidate is switched on, if \p selection has an ACTIVE primitive
+         *         with the same GID and DIR_GID. Direction variables follow the candidates in ascending DIR_GID order, as in \ref ProblemSetup::formulate2.
+         *  \param[out] x0         varCount x 1 column vector.
+         *  \param[in]  varCount   Variable count of the problem \p x0 is for.
+         *  \param[in]  prims      Candidates in the order they were formulated.
+         *  \param[in]  selection  Output of a previous iteration, i.e. primitives_it<N-1>.bonmin.csv.
+         *  \return                Count of candidates switched on, -1, if \p varCount does not match the candidates and directions.
+         */
+        template < class _PrimitiveT
+                 , class _PrimitiveContainerT
+                 >
+        static inline LidT startingPointFromSelection( OptProblemT::SparseMatrix      & x0
+                                                     , LidT                      const  varCount
+                                                     , _PrimitiveContainerT      const& prims
+                                                     , _PrimitiveContainerT      const& selection );
+
+        /*! \brief Collects the output of a solve into a single patch: SMALL candidates are kept for later iterations, chosen ones are set ACTIVE.
+         *         Used by \ref solve and \ref Pipeline.
+         *  \param[out] out_prims  Gets one patch appended with the output primitives.
+         *  \param[in]  prims      Candidates in the order they were formulated.
+         *  \param[in]  x_out      Solution from \ref optimizeProblem, indexed by the non-SMALL candidates of \p prims.
+         *  \param[in]  diag       Optional, receives names and positions of the chosen nodes.
+         *  \return                Count of non-SMALL candidates, the first cluster variable's id in \p x_out.
+         */
+        template < class _PrimitiveT
+                 , class _PrimitiveContainerT
+                 >
+        static inline LidT selectPrimitives( _PrimitiveContainerT       & out_prims
+                                           , _PrimitiveContainerT  const& prims
+                                           , std::vector<double>   const& x_out
+                                           , Diagnostic<double>         * diag = NULL );
+
         /*! \brief Globfit planned. \todo: move to datafit.h. */
         template < class _PrimitiveContainerT
                  , class _InnerPrimitiveContainerT
@@ -72,6 +72,10 @@ namespace rapter {
             //!        Used in \ref Segmentation::orientPoints(), \ref Segmentation::regionGrow() relayed from \ref Segmentation::patchify().
             int       nn_K                        = 15;
 
+            //! \brief Number of radii around scale, a factor of sqrt(2) apart, the local orientation fits are compared at, the flattest fit is kept.
+            //!        Used in \ref Segmentation::orientPoints(). 1: fit at scale only.
+            int       orient_scales               = 1;
+
             //! \brief Weight of spatial term in \f$ patch\_spatial\_weight^2 \cdot \frac{spat\_dist^2}{spat\_thresh} + \frac{ang\_diff^2}{ang\_thresh} < 1 \f$ regionGrowing distance functor.
             //!        Used in \ref Segmentation::patchify() and \ref Merging::mergeSameDirGids().
             //! \sa \ref rapter::RepresentativeSqrPatchPatchDistanceFunctorT.
@@ -98,6 +102,15 @@ namespace rapter {
              */
             int var_limit = 0;
 
+            /*! \brief Compare every input primitive with every other in \ref CandidateGenerator::generate(), instead of listing compatible pairs by direction buckets and proximity.
+             */
+            bool exhaustive_pairs = false;
+
+            /*! \brief Pairs of patches further than pair_prune_radius_mult * scale are not compared in \ref CandidateGenerator::generate(). Negative means infinite,
+             *         and produces the same candidates as \ref exhaustive_pairs.
+             */
+            _Scalar pair_prune_radius_mult = _Scalar(-1.);
+
 
             //_____________________________________________
             //____________________Parsers__________________
@@ -174,6 +187,12 @@ namespace rapter {
         //! \brief neighbourhood is this times scale, usually 1.0 or 2.0
         _Scalar spatial_weight_dist_mult = 2.;      // (used to be 3. for 3D)
         _Scalar collapseAngleSqrt = 0.07; // sqrt( 0.1 deg ) == 0.041 (rad^-1)
+        //! \brief Store human readable variable names in the problem. Skipped by the in-process pipeline, the names are never written to disk.
+        bool    var_names = true;
+        //! \brief Direction pairs with a weighted pairwise cost below this are not added to the problem, the Qo entry error is bounded by it.
+        _Scalar pw_prune_eps = _Scalar( 0. );
+        //! \brief Assemble the pairwise terms as the dense path did, half the spatial weight and every direction pair both ways, unpruned. Reference for --pw-check.
+        bool    pw_reference = false;
     };
 
 //    template <typename _Scalar>
@@ -203,6 +222,84 @@ namespace rapter {
         bool is3D;
     };
 
+    //! \brief Schedule of the iterative generate-formulate-solve-merge loop run by \ref Pipeline, defaults follow scripts/run.sh.
+    template <typename _Scalar>
+    struct PipelineParams : public CommonParams<_Scalar>
+    {
+        using CommonParams<_Scalar>::scale;
+        using CommonParams<_Scalar>::patch_population_limit;
+
+        //! \brief Angle threshold passed to generation (-al).
+        _Scalar angle_limit       = _Scalar( 0.08 );
+        //! \brief Divides angle_limit in generation (-ald).
+        _Scalar angle_limit_div   = _Scalar( 1. );
+        //! \brief Optimization weights. [ 0: unary, 1: pairwise, 2: complexity ]
+        Eigen::Matrix<_Scalar,-1,1> weights = (Eigen::Matrix<_Scalar,-1,1>(3,1) << 100000, 1, 0).finished();
+        //! \brief Penalty for mismatching primitives in proximity, negative means pairwise weight / 10.
+        _Scalar spatial_weight_coeff     = _Scalar( -1. );
+        //! \brief Proximity is this times scale.
+        _Scalar spatial_weight_dist_mult = _Scalar( 2. );
+        //! \brief Pairwise cost truncation angle in radians, negative means angle_limit, as scripts/run.sh passes it.
+        _Scalar trunc_angle              = _Scalar( -1. );
+        //! \brief Candidates closer than this in degrees are collapsed in formulation.
+        _Scalar collapse_angle_deg       = _Scalar( 0.4 );
+        //! \brief Merge works on merge_mult * scale.
+        _Scalar merge_mult               = _Scalar( 1. );
+
+        //! \brief First working scale, multiplied by scale it decides what is small. Gets divided by small_thresh_div every level.
+        int     small_thresh             = 0;
+        //! \brief Step size of the working scale.
+        _Scalar small_thresh_div         = _Scalar( 1.5 );
+        //! \brief Last working scale.
+        int     small_thresh_limit       = 0;
+        //! \brief Iteration count, extended while patches remain to be promoted.
+        int     iterations               = 10;
+        //! \brief Generation reruns in safe mode, if candidates exceed this.
+        int     var_limit                = 500;
+        //! \brief Patches per cluster of \ref HierarchicalSolver, used instead of dropping candidates, when they exceed var_limit. Non-positive solves flat.
+        int     hier_cluster_size        = 0;
+        //! \brief Directions per cluster, whose most populous patches represent it in the coarse problem.
+        int     hier_reps                = 3;
+        //! \brief Also formulate and solve flat, and print both energies and runtimes.
+        bool    hier_compare             = false;
+        //! \brief Solve the connected components of the problem separately, see \ref Solver::optimizeDecomposed.
+        bool    decompose                = false;
+        //! \brief Promoted patches distribute their directions until this iteration.
+        int     allow_promoted_until     = 3;
+        //! \brief Single directions are kept until this iteration.
+        int     keep_singles_until       = 1;
+
+        //! \brief Angle generators in degrees used by formulate and merge.
+        AnglesT angle_gens               = AnglesT( {AnglesT::Scalar(0.), AnglesT::Scalar(90.)} );
+        //! \brief Angle generators in degrees used by generate.
+        AnglesT cand_angle_gens          = AnglesT( {AnglesT::Scalar(0.)} );
+        //! \brief Replace both angle generators after this iteration's solve.
+        AnglesT extended_angle_gens      = AnglesT( {AnglesT::Scalar(90.)} );
+        //! \brief Iteration, after which extended_angle_gens are used.
+        int     use90                    = 0;
+
+        //! \brief Solver time limit in seconds, non-positive means unlimited.
+        _Scalar max_time                 = _Scalar( -1. );
+        //! \brief Bonmin algorithm code, 0: B_BB.
+        int     bmode                    = 0;
+        //! \brief Solve with qcqpcpp::LocalSearchOpt instead of Bonmin (--solver native).
+        bool    native_solver            = false;
+
+        bool    triplet_safe             = false;
+        bool    is3D                     = false;
+        //! \brief Write every iteration's output, named as scripts/run.sh does.
+        bool    checkpoint               = false;
+
+        //! \brief Edge length of the tiles \ref TiledPipeline cuts the cloud into, non-positive means no tiling.
+        _Scalar tile_size                = _Scalar( -1. );
+        //! \brief Tiles read points this times scale outside their core, and primitives this close to a seam are stitched.
+        _Scalar tile_overlap_mult        = _Scalar( 20. );
+        //! \brief Points read and buffered at once while splitting the cloud into tiles.
+        size_t  tile_buffer              = 1 << 22;
+        //! \brief Angle generators in degrees used by segmentation in each tile.
+        AnglesT segment_angle_gens       = AnglesT( {AnglesT::Scalar(90.)} );
+    };
+
 }
 
 #endif // RAPTER_PARAMETERS_H
@@ -0,0 +1,228 @@
+#ifndef RAPTER_EXTENTCACHE_H
+#define RAPTER_EXTENTCACHE_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <cstdlib>                                  // EXIT_SUCCESS
+#include <cstring>                                  // memcpy, memcmp
+#include <stdint.h>
+#include <unordered_map>
+#include "Eigen/Dense"
+#include "rapter/simpleTypes.h"                     // __Scalar
+#include "rapter/processing/distanceKernels.hpp"    // PositionArrays
+
+namespace rapter
+{
+    /*! \brief Process wide cache of primitive extents, shared by all steps running in the process (see \ref pipeline).
+     *
+     *  Entries are keyed by a 64 bit hash of the primitive's coefficients, the positions of the points it was fit to
+     *  (its population), the inlier threshold and the axis alignment flag, so an entry stays valid as long as neither the primitive
+     *  nor its population changes, whatever GID or DIR_GID it has by then. \ref PlanePrimitive::getExtent and \ref LinePrimitive::getExtent
+     *  consult it, before selecting inliers.
+     *
+     *  With \ref setPersistent(), \ref io::savePrimitives writes the cache next to the primitives as "<primitives file>.extents",
+     *  and \ref io::readPrimitives loads it back, so the next invocation starts warm.
+     */
+    class ExtentCache
+    {
+        public:
+            typedef __Scalar                         Scalar;
+            typedef Eigen::Matrix<Scalar,3,1>        Position;
+            typedef std::vector<Position>            ExtremaT;
+            typedef uint64_t                         KeyT;
+
+            static const uint32_t Version = 1;
+            static inline char const* Magic() { return "REXT"; }
+            //! \brief Side file of a primitives file.
+            static inline std::string sideFile( std::string const& primitivesPath ) { return primitivesPath + ".extents"; }
+
+            //! \brief The instance shared by all steps in the process.
+            static inline ExtentCache& instance() { static ExtentCache cache; return cache; }
+
+            /*! \brief Hashes the inputs of getExtent().
+             *  \tparam _PrimitiveT Concept: \ref PlanePrimitive.
+             *  \param[in] positions Positions of the population, as getExtent() gathered them.
+             */
+            template <class _PrimitiveT>
+            static inline KeyT key( _PrimitiveT const& primitive, processing::kernels::PositionArrays<Scalar> const& positions
+                                  , double const threshold, bool const forceAxisAligned )
+            {
+                KeyT h = 14695981039346656037ull;
+                h = mix( h, uint32_t(_PrimitiveT::EmbedSpaceDim) );
+                h = mix( h, uint32_t(forceAxisAligned) );
+                h = mix( h, Scalar(threshold) );
+                for ( int d = 0; d != primitive.coeffs().rows(); ++d )
+                    h = mix( h, primitive.coeffs()(d) );
+                h = mix( h, uint32_t(positions.size()) );
+                for ( size_t i = 0; i != positions.size(); ++i )
+                {
+                    h = mix( h, positions.x[i] );
+                    h = mix( h, positions.y[i] );
+                    h = mix( h, positions.z[i] );
+                }
+
+                // final avalanche, so that nearby inputs land far apart
+                h ^= h >> 33; h *= 0xff51afd7ed558ccdull;
+                h ^= h >> 33; h *= 0xc4ceb9fe1a85ec53ull;
+                h ^= h >> 33;
+                return h;
+            }
+
+            //! \brief Copies the extents stored for \p key to \p extrema, and counts a hit, or a miss, if there are none.
+            inline bool find( KeyT const key, ExtremaT & extrema )
+            {
+                if ( !_enabled )
+                    return false;
+
+                bool found = false;
+#               pragma omp critical (rapterExtentCache)
+                {
+                    std::unordered_map<KeyT, ExtremaT>::const_iterator it = _entries.find( key );
+                    if ( it != _entries.end() )
+                    {
+                        extrema = it->second;
+                        found   = true;
+                        ++_hits;
+                    }
+                    else
+                        ++_misses;
+                }
+                return found;
+            }
+
+            //! \brief Stores \p extrema for \p key, unless the cache holds \ref getCapacity() entries already.
+            inline void insert( KeyT const key, ExtremaT const& extrema )
+            {
+                if ( !_enabled )
+                    return;
+
+#               pragma omp critical (rapterExtentCache)
+                {
+                    if ( _entries.size() < _capacity )
+                        _entries[ key ] = extrema;
+                }
+            }
+
+            /*! \brief Writes all entries to \p path. Layout: magic, version, entry count, then per entry the key, the extrema count and the extrema as float32 triplets.
+             *  \return EXIT_SUCCESS, or EXIT_FAILURE, if the file could not be written.
+             */
+            inline int save( std::string const& path ) const
+            {
+                std::ofstream f( path.c_str(), std::ios::binary );
+                if ( !f.is_open() )
+                {
+                    std::cerr << "[" << __func__ << "]: " << "could not open " << path << std::endl;
+                    return EXIT_FAILURE;
+                }
+
+                const uint64_t count   = _entries.size();
+                const uint32_t version = Version;
+                f.write( Magic(), 4 );
+                f.write( reinterpret_cast<char const*>(&version), sizeof(version) );
+                f.write( reinterpret_cast<char const*>(&count)  , sizeof(count) );
+                for ( std::unordered_map<KeyT, ExtremaT>::const_iterator it = _entries.begin(); it != _entries.end(); ++it )
+                {
+                    const uint32_t n = it->second.size();
+                    f.write( reinterpret_cast<char const*>(&it->first), sizeof(KeyT) );
+                    f.write( reinterpret_cast<char const*>(&n)        , sizeof(n) );
+                    for ( uint32_t e = 0; e != n; ++e )
+                    {
+                        const float xyz[3] = { float(it->second[e](0)), float(it->second[e](1)), float(it->second[e](2)) };
+                        f.write( reinterpret_cast<char const*>(xyz), sizeof(xyz) );
+                    }
+                }
+
+                std::cout << "[" << __func__ << "]: " << "saved " << count << " extents to " << path << ", " << stats() << std::endl;
+                return f.good() ? EXIT_SUCCESS : EXIT_FAILURE;
+            }
+
+            /*! \brief Adds the entries from \p path, written by \ref save().
+             *  \return EXIT_SUCCESS, or EXIT_FAILURE, if the file is missing or not an extent cache.
+             */
+            inline int load( std::string const& path )
+            {
+                std::ifstream f( path.c_str(), std::ios::binary );
+                if ( !f.is_open() )
+                    return EXIT_FAILURE;
+
+                char     magic[4];
+                uint32_t version = 0;
+                uint64_t count   = 0;
+                f.read( magic, 4 );
+                f.read( reinterpret_cast<char*>(&version), sizeof(version) );
+                f.read( reinterpret_cast<char*>(&count)  , sizeof(count) );
+                if ( !f.good() || memcmp(magic, Magic(), 4) || version != Version )
+                {
+                    std::cerr << "[" << __func__ << "]: " << path << " is not an extent cache, ignoring it" << std::endl;
+                    return EXIT_FAILURE;
+                }
+
+                for ( uint64_t i = 0; i != count && f.good(); ++i )
+                {
+                    KeyT     key = 0;
+                    uint32_t n   = 0;
+                    f.read( reinterpret_cast<char*>(&key), sizeof(key) );
+                    f.read( reinterpret_cast<char*>(&n)  , sizeof(n) );
+                    ExtremaT extrema( n );
+                    for ( uint32_t e = 0; e != n; ++e )
+                    {
+                        float xyz[3];
+                        f.read( reinterpret_cast<char*>(xyz), sizeof(xyz) );
+                        extrema[e] = Position( xyz[0], xyz[1], xyz[2] );
+                    }
+                    if ( f.good() )
+                        this->insert( key, extrema );
+                }
+
+                std::cout << "[" << __func__ << "]: " << "loaded " << count << " extents from " << path << std::endl;
+                return EXIT_SUCCESS;
+            }
+
+            //! \brief "entries: N, hits: H, misses: M, hit rate: R".
+            inline std::string stats() const
+            {
+                std::stringstream ss;
+                ss << "entries: " << _entries.size() << ", hits: " << _hits << ", misses: " << _misses
+                   << ", hit rate: " << ( (_hits + _misses) ? double(_hits) / double(_hits + _misses) : 0. );
+                return ss.str();
+            }
+
+            inline void   clear        ()                        { _entries.clear(); _hits = _misses = 0; }
+            inline size_t size         ()                  const { return _entries.size(); }
+            inline size_t getHits      ()                  const { return _hits; }
+            inline size_t getMisses    ()                  const { return _misses; }
+            inline bool   isEnabled    ()                  const { return _enabled; }
+            inline void   setEnabled   ( bool const enabled )    { _enabled = enabled; }
+            inline bool   isPersistent ()                  const { return _persistent; }
+            inline void   setPersistent( bool const persistent ) { _persistent = persistent; }
+            inline size_t getCapacity  ()                  const { return _capacity; }
+            inline void   setCapacity  ( size_t const capacity ) { _capacity = capacity; }
+
+        protected:
+            ExtentCache() : _hits( 0 ), _misses( 0 ), _enabled( true ), _persistent( false ), _capacity( 1 << 20 ) {}
+            ExtentCache( ExtentCache const& );              //!< \brief Not copyable.
+            ExtentCache& operator=( ExtentCache const& );   //!< \brief Not copyable.
+
+            //! \brief FNV-1a step on a 32 bit word.
+            static inline KeyT mix( KeyT const h, uint32_t const word ) { return (h ^ word) * 1099511628211ull; }
+            //! \brief FNV-1a step on the bits of a float.
+            static inline KeyT mix( KeyT const h, float const value )
+            {
+                uint32_t word;
+                memcpy( &word, &value, sizeof(word) );
+                return mix( h, word );
+            }
+
+            std::unordered_map<KeyT, ExtremaT> _entries;
+            size_t                             _hits;
+            size_t                             _misses;
+            bool                               _enabled;
+            bool                               _persistent;
+            size_t                             _capacity;     //!< \brief No more entries are stored, once the cache holds this many.
+    }; //...class ExtentCache
+} //...ns rapter
+
+#endif // RAPTER_EXTENTCACHE_H
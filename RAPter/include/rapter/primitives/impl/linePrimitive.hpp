@@ -2,6 +2,7 @@
 #define RAPTER_LINEPRIMITIVE_HPP
 
 #include "rapter/primitives/linePrimitive.h"
+#include "rapter/primitives/extentCache.h"
 
 namespace rapter
 {
@@ -45,15 +46,27 @@ namespace rapter
             return 0;
         }
 
-        // select inliers
+        processing::kernels::PositionArrays<Scalar> positions;
+        processing::kernels::gatherPositions( positions, cloud, indices_arg );
+
+        // same line over the same points: reuse the extent from an earlier iteration
+        const ExtentCache::KeyT cacheKey = ExtentCache::key( *this, positions, threshold, force_axis_aligned );
+        if ( ExtentCache::instance().find(cacheKey, minMax) )
+        {
+            this->_extents.update( minMax );
+            return EXIT_SUCCESS;
+        }
+
+        // select inliers, batched
         std::vector<PidT> inliers;
-        inliers.reserve( cloud.size() );
-        const PidT stop_at = indices_arg ? indices_arg->size() : cloud.size();
-        for ( PidT i = 0; i != stop_at; ++i )
         {
-            const PidT pid = indices_arg ? (*indices_arg)[i] : i;
-            if ( this->getDistance( cloud[pid].template pos() ) < threshold )
-                inliers.push_back( pid );
+            std::vector<Scalar> distances;
+            this->getDistances( distances, positions );
+            inliers.reserve( positions.size() );
+            processing::kernels::selectInliers( inliers, distances.data(), distances.size(), Scalar(threshold) );
+            if ( indices_arg )
+                for ( size_t i = 0; i != inliers.size(); ++i )
+                    inliers[i] = (*indices_arg)[ inliers[i] ];
         }
 
         // check size
@@ -103,6 +116,7 @@ namespace rapter
         minMax[1] = on_line_cloud[ max_id ];
 
         this->_extents.update( minMax );
+        ExtentCache::instance().insert( cacheKey, minMax );
 
         return EXIT_SUCCESS;
     } //...getExtent()
@@ -2,6 +2,7 @@
 #define GO_PLANEPRIMITIVE_HPP
 
 #include "rapter/primitives/planePrimitive.h"
+#include "rapter/primitives/extentCache.h"
 
 // ________________________________________________________HPP_________________________________________________________
 
@@ -114,32 +115,45 @@ namespace rapter
 
 #ifdef RAPTER_USE_PCL
 
-        std::vector<LidT> inliers;
+        // batched: positions of the candidate points, their distances, then the ids of the ones within threshold
+        processing::kernels::PositionArrays<Scalar> positions;
+        std::vector<LidT> inliers; // ids into positions
         {
-            inliers.reserve( cloud.size() );
-            const PidT stop_at = indices_arg ? indices_arg->size() : cloud.size();
-            for ( PidT i = 0; i != stop_at; ++i )
-            {
-                const PidT pid = indices_arg ? (*indices_arg)[i] : i;
-                if ( this->getDistance( cloud[pid].template pos() ) < threshold )
-                    inliers.push_back( pid );
-            }
+            processing::kernels::gatherPositions( positions, cloud, indices_arg );
+        }
+
+        // same plane over the same points: reuse the extent from an earlier iteration
+        const ExtentCache::KeyT cacheKey = ExtentCache::key( *this, positions, threshold, force_axis_aligned );
+        if ( ExtentCache::instance().find(cacheKey, minMax) )
+        {
+            this->_extents.update( minMax );
+            return EXIT_SUCCESS;
+        }
 
-            //std::cout << "[" << __func__ << "]: " << "indices.size(): " << stop_at << " / " << cloud.size() << std::endl;
+        {
+            std::vector<Scalar> distances;
+            this->getDistances( distances, positions );
+            inliers.reserve( positions.size() );
+            processing::kernels::selectInliers( inliers, distances.data(), distances.size(), Scalar(threshold) );
         }
 
         // check size
         if ( !inliers.size() ) return EXIT_FAILURE;
 
         // project cloud
+        processing::kernels::PositionArrays<Scalar> projected;
+        processing::kernels::selectPositions( projected, positions, inliers );
+        processing::kernels::projectOntoPlane( projected, projected, Position(this->pos()), Position(this->dir()) );
+
         _PointContainerT on_plane_cloud;
         //on_plane_cloud.reserve( inliers.size() );
         on_plane_cloud.resize( inliers.size() );
 #       pragma omp parallel for num_threads(4)
         for ( UPidT pid_id = 0; pid_id < inliers.size(); ++pid_id )
         {
-            on_plane_cloud[pid_id] = _PointPrimitiveT( this->projectPoint(cloud[ inliers[pid_id] ].template pos()),
-                                                                          cloud[ inliers[pid_id] ].template dir()
+            const PidT pid = indices_arg ? (*indices_arg)[ inliers[pid_id] ] : inliers[pid_id];
+            on_plane_cloud[pid_id] = _PointPrimitiveT( Position(projected.x[pid_id], projected.y[pid_id], projected.z[pid_id]),
+                                                       cloud[ pid ].template dir()
                                                      );
         }
 
@@ -242,6 +256,7 @@ namespace rapter
         }
 
         this->_extents.update( minMax );
+        ExtentCache::instance().insert( cacheKey, minMax );
 
         return EXIT_SUCCESS;
 #           else
@@ -3,11 +3,58 @@
 
 #include <string>
 #include <map>
+#include <limits>
+#include <algorithm> // fill, copy
 #include "rapter/primitives/taggable.h"
 #include "rapter/simpleTypes.h"
 
 namespace rapter
 {
+    template <typename _Scalar>
+    const int32_t Taggable<_Scalar>::IN_OVERFLOW = std::numeric_limits<int32_t>::min();
+
+    template <typename _Scalar>
+    inline Taggable<_Scalar>::Taggable()
+        : _scalarSlot( TAG_UNSET )
+        , _charSlot  ( TAG_UNSET )
+    {
+        std::fill( _longSlots, _longSlots + LONG_SLOTS, int32_t(TAG_UNSET) );
+    }
+
+    template <typename _Scalar>
+    inline Taggable<_Scalar>::Taggable( Taggable<_Scalar> const& other )
+    {
+        copyTagsFrom( other );
+    }
+
+    template <typename _Scalar>
+    inline Taggable<_Scalar>&
+    Taggable<_Scalar>::operator=( Taggable<_Scalar> const& other )
+    {
+        if ( this != &other )
+            copyTagsFrom( other );
+        return *this;
+    }
+
+    template <typename _Scalar>
+    inline int
+    Taggable<_Scalar>::longSlot( rapter::GidT const key )
+    {
+        if ( (key >= 0) && (key < DIRECT_LONG_SLOTS) )
+            return key;
+        if ( (key >= USER_ID1) && (key <= USER_ID5) )
+            return DIRECT_LONG_SLOTS + key - USER_ID1;
+        return -1;
+    }
+
+    template <typename _Scalar>
+    inline typename Taggable<_Scalar>::Overflow&
+    Taggable<_Scalar>::overflow()
+    {
+        if ( !_overflow )
+            _overflow.reset( new Overflow() );
+        return *_overflow;
+    }
     /*! \brief              Stores long tag for int key. Mostly used by the enum typedefs.
       * \param[in] key      Key to store \p value at.
       * \param[in] value    Value to store.
@@ -17,7 +64,16 @@ namespace rapter
     inline Taggable<_Scalar>&
     Taggable<_Scalar>::setTag( int key, long value )
     {
-        _longValuedTags[key] = value;
+        const int slot = longSlot( key );
+        if ( slot < 0 )
+            overflow()._longValuedTags[key] = value;
+        else if ( (value > std::numeric_limits<int32_t>::min()) && (value <= std::numeric_limits<int32_t>::max()) )
+            _longSlots[slot] = static_cast<int32_t>( value );
+        else
+        {
+            _longSlots[slot] = IN_OVERFLOW;
+            overflow()._longValuedTags[key] = value;
+        }
         return *this;
     }
 
@@ -30,8 +86,7 @@ namespace rapter
     inline Taggable<_Scalar>&
     Taggable<_Scalar>::setTag( int key, int value )
     {
-        _longValuedTags[key] = value;
-        return *this;
+        return setTag( key, static_cast<long>(value) );
     }
 
     /*! \brief              Stores size_t valued tag for int key.
@@ -43,8 +98,7 @@ namespace rapter
     inline Taggable<_Scalar>&
     Taggable<_Scalar>::setTag( int key, std::size_t value )
     {
-        _longValuedTags[key] = value;
-        return *this;
+        return setTag( key, static_cast<long>(value) );
     }
 
     /*! \brief              Stores tag for int key.
@@ -56,7 +110,8 @@ namespace rapter
     inline Taggable<_Scalar>&
     Taggable<_Scalar>::setTag( char key, char value )
     {
-        _charValuedTags[key] = value;
+        if ( key == CHAR_SLOT_KEY ) _charSlot = value;
+        else                        overflow()._charValuedTags[key] = value;
         return *this;
     }
 
@@ -69,7 +124,8 @@ namespace rapter
     inline Taggable<_Scalar>&
     Taggable<_Scalar>::setTag( _Scalar key, _Scalar value )
     {
-        _scalarValuedTags[key] = value;
+        if ( key == _Scalar(SCALAR_SLOT_KEY) )  _scalarSlot = value;
+        else                                    overflow()._scalarValuedTags[key] = value;
         return *this;
     }
 
@@ -83,9 +139,16 @@ namespace rapter
     inline rapter::GidT
     Taggable<_Scalar>::getTag( rapter::GidT key ) const
     {
-        typename std::map<rapter::GidT, rapter::GidT>::const_iterator it = _longValuedTags.find( key );
-        if ( it != _longValuedTags.end() )
-            return it->second; // _tags.at( key ); changed by Aron on 3/1/2015
+        const int slot = longSlot( key );
+        if ( (slot >= 0) && (_longSlots[slot] != IN_OVERFLOW) )
+            return _longSlots[slot];
+
+        if ( _overflow )
+        {
+            typename std::map<rapter::GidT, rapter::GidT>::const_iterator it = _overflow->_longValuedTags.find( key );
+            if ( it != _overflow->_longValuedTags.end() )
+                return it->second; // _tags.at( key ); changed by Aron on 3/1/2015
+        }
 
         return TAG_UNSET;
     }
@@ -101,9 +164,15 @@ namespace rapter
     inline char
     Taggable<_Scalar>::getTag( char key ) const
     {
-        typename std::map<char,char>::const_iterator it = _charValuedTags.find( key );
-        if ( it != _charValuedTags.end() )
-            return it->second;
+        if ( key == CHAR_SLOT_KEY )
+            return _charSlot;
+
+        if ( _overflow )
+        {
+            typename std::map<char,char>::const_iterator it = _overflow->_charValuedTags.find( key );
+            if ( it != _overflow->_charValuedTags.end() )
+                return it->second;
+        }
 
         return TAG_UNSET;
     }
@@ -116,9 +185,15 @@ namespace rapter
     inline _Scalar
     Taggable<_Scalar>::getTag( _Scalar key ) const
     {
-        typename std::map<_Scalar,_Scalar>::const_iterator it = _scalarValuedTags.find( key );
-        if ( it != _scalarValuedTags.end() )
-            return it->second; // _tags.at( key ); changed by Aron on 3/1/2015
+        if ( key == _Scalar(SCALAR_SLOT_KEY) )
+            return _scalarSlot;
+
+        if ( _overflow )
+        {
+            typename std::map<_Scalar,_Scalar>::const_iterator it = _overflow->_scalarValuedTags.find( key );
+            if ( it != _overflow->_scalarValuedTags.end() )
+                return it->second; // _tags.at( key ); changed by Aron on 3/1/2015
+        }
 
         return TAG_UNSET;
     }
@@ -127,9 +202,10 @@ namespace rapter
     inline int
     Taggable<_Scalar>::copyTagsFrom( Taggable<_Scalar> const& other )
     {
-        _longValuedTags    = other._longValuedTags;
-        _scalarValuedTags  = other._scalarValuedTags;
-        _charValuedTags    = other._charValuedTags;
+        std::copy( other._longSlots, other._longSlots + LONG_SLOTS, _longSlots );
+        _scalarSlot        = other._scalarSlot;
+        _charSlot          = other._charSlot;
+        _overflow.reset( other._overflow ? new Overflow(*other._overflow) : NULL );
         //_intValuedTags     = other._intValuedTags;
         //_str_tags          = other._str_tags;
 
@@ -8,6 +8,7 @@
 #include "rapter/optimization/energyFunctors.h"   // pointToFiniteLineDistanceFunctor
 #include "rapter/primitives/primitive.h"          // inherit
 #include "rapter/processing/util.hpp"             // getPopulationOf()
+#include "rapter/processing/distanceKernels.hpp"  // lineDistances()
 
 #ifdef RAPTER_USE_PCL
 #   include "pcl/point_cloud.h"
@@ -188,6 +189,29 @@ namespace rapter
                 return MyPointFiniteLineDistanceFunctor::eval( extrema, *this, pnt );
             }
 
+            //! \brief                  Batch #getDistance() of all points in \p positions, see \ref processing::kernels.
+            //! \param[out] distances   Distance of each point.
+            //! \param[in]  positions   Points to calculate distances from.
+            inline void
+            getDistances( std::vector<Scalar> & distances, processing::kernels::PositionArrays<Scalar> const& positions ) const
+            {
+                distances.resize( positions.size() );
+                processing::kernels::lineDistances( distances.data(), positions.x.data(), positions.y.data(), positions.z.data(), positions.size()
+                                                  , Position(this->pos()), Position(this->dir()) );
+            }
+
+            //! \brief                  Batch #getFiniteDistance() of all points in \p positions.
+            //! \param[out] distances   Distance of each point.
+            //! \param[in]  extrema     Extrema of this primitive.
+            //! \param[in]  positions   Points to calculate distances from.
+            inline void
+            getFiniteDistances( std::vector<Scalar> & distances, ExtremaT const& extrema, processing::kernels::PositionArrays<Scalar> const& positions ) const
+            {
+                distances.resize( positions.size() );
+                processing::kernels::finiteLineDistances( distances.data(), positions.x.data(), positions.y.data(), positions.z.data(), positions.size()
+                                                        , extrema, Position(this->pos()), Position(this->normal()) );
+            }
+
             /*! \brief                          Calculates the length of the line based on the points in \p cloud, masked by \p indices and the distance from point to line \p threshold.
              *
              *                                  The method calculates the inliers and selects the most far away point from #pos() in both directions.
@@ -5,6 +5,7 @@
 #include "rapter/optimization/energyFunctors.h"
 #include "rapter/primitives/primitive.h"
 #include "rapter/processing/util.hpp" // pca, getPopulationOf()
+#include "rapter/processing/distanceKernels.hpp" // planeDistances()
 
 #ifdef RAPTER_USE_PCL
 #   include "pcl/ModelCoefficients.h"
@@ -122,6 +123,30 @@ namespace rapter
             Scalar
             getFiniteDistance( ExtentsT const& extrema, Position const& pnt ) const;
 
+            /*! \brief                  Batch #getDistance() of all points in \p positions, see \ref processing::kernels.
+             *  \param[out] distances   Signed distance of each point.
+             *  \param[in]  positions   Points to calculate distances from.
+             */
+            inline void
+            getDistances( std::vector<Scalar> & distances, processing::kernels::PositionArrays<Scalar> const& positions ) const
+            {
+                distances.resize( positions.size() );
+                processing::kernels::planeDistances( distances.data(), positions.x.data(), positions.y.data(), positions.z.data(), positions.size()
+                                                   , Position(this->pos()), Position(this->dir()) );
+            }
+
+            /*! \brief                  Batch #getFiniteDistance() of all points in \p positions, the frame of \p extrema is only set up once.
+             *  \param[out] distances   Distance of each point.
+             *  \param[in]  extrema     Extrema of this primitive.
+             *  \param[in]  positions   Points to calculate distances from.
+             */
+            inline void
+            getFiniteDistances( std::vector<Scalar> & distances, ExtentsT const& extrema, processing::kernels::PositionArrays<Scalar> const& positions ) const
+            {
+                distances.resize( positions.size() );
+                processing::kernels::finitePlaneDistances( distances.data(), positions.x.data(), positions.y.data(), positions.z.data(), positions.size(), extrema );
+            }
+
             int to4Coeffs( std::vector<Scalar> &coeffs ) const;
 
             Eigen::Matrix<Scalar,3,1>
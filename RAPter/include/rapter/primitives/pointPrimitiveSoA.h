@@ -0,0 +1,164 @@
+#ifndef __RAPTER_POINTPRIMITIVESOA_H__
+#define __RAPTER_POINTPRIMITIVESOA_H__
+
+#include <vector>
+#include "Eigen/Dense"
+#include "rapter/simpleTypes.h"                 // GidT
+#include "rapter/primitives/pointPrimitive.h"
+
+namespace rapter
+{
+    /*! \brief Structure-of-arrays point container. Positions, orientations and GIDs live in separate contiguous arrays,
+     *         so scans, that only read one of them (populations, inlier tests, covariances) don't stride over whole \ref PointPrimitive -s.
+     *
+     *         Indexing returns a lightweight reference implementing the pos(), dir() and getTag() concept of \ref PointPrimitive,
+     *         so the templated algorithms in \ref rapter::processing and \ref PlanePrimitive::getExtent compile against either layout.
+     *         value_type is \ref PointPrimitive, for TAGS and for algorithms that construct points to store.
+     *         Only the GID tag is stored, the other tags read as unset, and setting them is ignored.
+     */
+    class PointPrimitiveSoA
+    {
+        public:
+            typedef PointPrimitive                 value_type;
+            typedef PointPrimitive                 PrimitiveT;
+            typedef PointPrimitive::Scalar         Scalar;
+            typedef Eigen::Matrix<Scalar,3,1>      Position;
+            typedef std::vector<Scalar>            ScalarArrayT;
+            typedef std::vector<GidT>              GidArrayT;
+
+            //! \brief Read-only view of point \p pid.
+            class ConstRef
+            {
+                public:
+                    typedef PointPrimitive::TAGS TAGS;
+                    typedef PointPrimitive::Scalar Scalar;
+
+                    inline ConstRef( PointPrimitiveSoA const* owner, size_t const pid ) : _owner( owner ), _pid( pid ) {}
+
+                    inline Position pos() const { return Position( _owner->_x [_pid], _owner->_y [_pid], _owner->_z [_pid] ); }
+                    inline Position dir() const { return Position( _owner->_nx[_pid], _owner->_ny[_pid], _owner->_nz[_pid] ); }
+
+                    //! \return The GID for TAGS::GID, TAG_UNSET for all other keys.
+                    inline GidT getTag( GidT const key ) const { return key == TAGS::GID ? _owner->_gid[_pid] : GidT(PointPrimitive::LONG_VALUES::UNSET); }
+                    inline bool gidUnset() const { return _owner->_gid[_pid] == PointPrimitive::LONG_VALUES::UNSET; }
+
+                    //! \brief Copies the point out to the array-of-structures layout.
+                    inline operator PointPrimitive() const
+                    {
+                        PointPrimitive point;
+                        point.coeffs() << pos(), dir();
+                        point.setTag( TAGS::GID, _owner->_gid[_pid] );
+                        return point;
+                    }
+
+                protected:
+                    PointPrimitiveSoA const* _owner;
+                    size_t                   _pid;
+            }; //...class ConstRef
+
+            //! \brief Writable view of point \p pid.
+            class Ref : public ConstRef
+            {
+                public:
+                    inline Ref( PointPrimitiveSoA * owner, size_t const pid ) : ConstRef( owner, pid ) {}
+
+                    //! \brief Stores position, orientation and GID of \p point.
+                    inline Ref& operator=( PointPrimitive const& point )
+                    {
+                        mutableOwner()->set( this->_pid, point );
+                        return *this;
+                    }
+
+                    inline Ref& operator=( Ref const& other ) { return *this = static_cast<PointPrimitive>(other); }
+
+                    //! \brief Stores \p value, if \p key is TAGS::GID.
+                    inline Ref& setTag( GidT const key, GidT const value )
+                    {
+                        if ( key == ConstRef::TAGS::GID )
+                            mutableOwner()->_gid[ this->_pid ] = value;
+                        return *this;
+                    }
+
+                protected:
+                    inline PointPrimitiveSoA* mutableOwner() const { return const_cast<PointPrimitiveSoA*>( this->_owner ); }
+            }; //...class Ref
+
+            // ____________________CONSTRUCTORS____________________
+            PointPrimitiveSoA() {}
+
+            //! \brief Converts from the array-of-structures layout. Concept: \ref PointPrimitiveVector.
+            template <class _PointContainerT>
+            explicit PointPrimitiveSoA( _PointContainerT const& points )
+            {
+                this->resize( points.size() );
+                for ( size_t pid = 0; pid != points.size(); ++pid )
+                    this->set( pid, points[pid] );
+            }
+
+            //! \brief Converts back to the array-of-structures layout. Concept: \ref PointPrimitiveVector.
+            template <class _PointContainerT>
+            inline void toAoS( _PointContainerT & points ) const
+            {
+                points.clear();
+                points.reserve( this->size() );
+                for ( size_t pid = 0; pid != this->size(); ++pid )
+                    points.push_back( (*this)[pid] );
+            }
+
+            // ____________________STL____________________
+            inline size_t   size    () const { return _gid.size(); }
+            inline bool     empty   () const { return _gid.empty(); }
+            inline ConstRef operator[]( size_t const pid ) const { return ConstRef( this, pid ); }
+            inline Ref      operator[]( size_t const pid )       { return Ref     ( this, pid ); }
+
+            inline void reserve( size_t const n )
+            {
+                _x .reserve( n ); _y .reserve( n ); _z .reserve( n );
+                _nx.reserve( n ); _ny.reserve( n ); _nz.reserve( n );
+                _gid.reserve( n );
+            }
+
+            //! \brief New points are at the origin, with zero orientation and unset GID.
+            inline void resize( size_t const n )
+            {
+                _x .resize( n, Scalar(0) ); _y .resize( n, Scalar(0) ); _z .resize( n, Scalar(0) );
+                _nx.resize( n, Scalar(0) ); _ny.resize( n, Scalar(0) ); _nz.resize( n, Scalar(0) );
+                _gid.resize( n, GidT(PointPrimitive::LONG_VALUES::UNSET) );
+            }
+
+            inline void clear() { this->resize( 0 ); }
+
+            inline void push_back( PointPrimitive const& point )
+            {
+                this->resize( this->size() + 1 );
+                this->set( this->size() - 1, point );
+            }
+
+            // ____________________ARRAYS____________________
+            inline ScalarArrayT const& x  () const { return _x;   }
+            inline ScalarArrayT const& y  () const { return _y;   }
+            inline ScalarArrayT const& z  () const { return _z;   }
+            inline ScalarArrayT const& nx () const { return _nx;  }
+            inline ScalarArrayT const& ny () const { return _ny;  }
+            inline ScalarArrayT const& nz () const { return _nz;  }
+            inline GidArrayT    const& gid() const { return _gid; }
+
+        protected:
+            //! \brief Stores point \p pid. Concept of \p point: \ref PointPrimitive, or a \ref ConstRef.
+            template <class _PointT>
+            inline void set( size_t const pid, _PointT const& point )
+            {
+                const Position pos = point.pos(), dir = point.dir();
+                _x [pid] = pos(0); _y [pid] = pos(1); _z [pid] = pos(2);
+                _nx[pid] = dir(0); _ny[pid] = dir(1); _nz[pid] = dir(2);
+                _gid[pid] = point.getTag( PointPrimitive::TAGS::GID );
+            }
+
+            ScalarArrayT _x, _y, _z;    //!< \brief Positions.
+            ScalarArrayT _nx, _ny, _nz; //!< \brief Orientations.
+            GidArrayT    _gid;          //!< \brief PointPrimitive::TAGS::GID of each point.
+    }; //...class PointPrimitiveSoA
+
+} //...ns rapter
+
+#endif // __RAPTER_POINTPRIMITIVESOA_H__
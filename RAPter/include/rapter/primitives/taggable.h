@@ -3,6 +3,8 @@
 
 #include <string>
 #include <map>
+#include <memory>  // unique_ptr
+#include <cstdint> // int32_t
 #include "rapter/simpleTypes.h"
 
 namespace rapter
@@ -11,6 +13,8 @@ namespace rapter
      *
      *             The types are hard-coded to speed up compilation,
      *             and because we don't know how many types we will need later.
+     *             The keys in use (GID, DIR_GID, STATUS, GEN_ANGLE, the point tags and USER_ID1..5) are stored in fixed slots,
+     *             other keys and values not fitting a slot go to maps allocated on first use.
      */
     template <typename _Scalar>
     class Taggable
@@ -94,11 +98,38 @@ namespace rapter
             int
             copyTagsFrom( Taggable const& other );
 
+            Taggable();
+            Taggable( Taggable const& other );
+            Taggable& operator=( Taggable const& other );
 
         protected:
-            std::map<rapter::GidT, rapter::GidT>         _longValuedTags;     //!< \brief Stores long,int and char values for int keys.
-            std::map<char,char>         _charValuedTags;
-            std::map<_Scalar,_Scalar>   _scalarValuedTags;   //!< \brief Stores values for int keys with value float/double.
+            enum SLOTS {
+                  DIRECT_LONG_SLOTS = 4                                                   //!< long keys 0..3 have a slot each: GID, DIR_GID of primitives, PID, GID, LID, LID0 of points
+                , LONG_SLOTS        = DIRECT_LONG_SLOTS + USER_ID5 - USER_ID1 + 1         //!< USER_ID1..5 follow the direct slots
+                , CHAR_SLOT_KEY     = 2                                                   //!< Primitive::TAGS::STATUS
+                , SCALAR_SLOT_KEY   = 3                                                   //!< Primitive::TAGS::GEN_ANGLE
+            };
+
+            //! \brief Marks a long slot, whose value did not fit 32 bits, and is stored in the overflow map.
+            static const int32_t IN_OVERFLOW;
+
+            //! \brief Tags without a slot.
+            struct Overflow
+            {
+                std::map<rapter::GidT, rapter::GidT>    _longValuedTags;     //!< \brief Stores long,int and char values for int keys.
+                std::map<char,char>                     _charValuedTags;
+                std::map<_Scalar,_Scalar>               _scalarValuedTags;   //!< \brief Stores values for int keys with value float/double.
+            };
+
+            //! \brief Slot index of long \p key, -1, if it has none.
+            static inline int longSlot( rapter::GidT const key );
+            //! \brief Allocates the overflow maps on first use.
+            inline Overflow& overflow();
+
+            int32_t                     _longSlots[LONG_SLOTS];   //!< \brief TAG_UNSET, or value, or IN_OVERFLOW.
+            _Scalar                     _scalarSlot;              //!< \brief GEN_ANGLE, TAG_UNSET by default.
+            char                        _charSlot;                //!< \brief STATUS, TAG_UNSET by default.
+            std::unique_ptr<Overflow>   _overflow;                //!< \brief NULL, until a tag without a slot is set.
             //std::map<std::string,int>   _str_tags;           //!< \brief Stores values for string keys.
     }; // ... cls Taggable
 } // ... ns rapter
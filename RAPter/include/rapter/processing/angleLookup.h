@@ -0,0 +1,193 @@
+#ifndef RAPTER_ANGLELOOKUP_H
+#define RAPTER_ANGLELOOKUP_H
+
+#include <cmath>
+#include <vector>
+#include <limits>
+#include <algorithm>                                // sort, unique
+#include "Eigen/Dense"
+#include "rapter/processing/distanceKernels.hpp"    // PositionArrays
+
+namespace rapter {
+namespace processing {
+
+/*! \brief Precomputed replacement for the angle and closest allowed angle search in \ref MyPrimitivePrimitiveAngleFunctor::eval().
+ *
+ *  The angle between two directions is read from their cosine, computed in double: \f$ acos(u) = \sqrt{1-u} \, g(u) \f$, with \f$ u = |cos| \f$,
+ *  where \f$ g \f$ is smooth on [0,1], so it is tabulated and interpolated linearly. Negative cosines use \f$ acos(-u) = \pi - acos(u) \f$.
+ *  The cosine range [-1,1] is cut into bins, each bin lists the ids of the allowed angles, that can be the closest one
+ *  to an angle within the bin, usually one or two, so only those get compared, instead of all of \p angles.
+ *  The result matches the exact path up to the interpolation error, see \ref maxInterpolationError() and \ref benchAngles.
+ *
+ *  \tparam _Scalar Concept: float.
+ */
+template <typename _Scalar>
+class AngleLookup
+{
+    public:
+        typedef _Scalar                     Scalar;
+        typedef std::vector<_Scalar>        AnglesT;
+        typedef Eigen::Matrix<_Scalar,3,1>  Position;
+
+        /*! \brief Builds the tables.
+         *  \param[in] angles   Allowed angles in radians, in the order \ref MyPrimitivePrimitiveAngleFunctor::eval() takes them, since ids index this.
+         *  \param[in] binCount Number of cosine bins. At 4096 the interpolation error is below 2e-9 rad,
+         *                      results agree with acos to within one float ulp (~2.4e-7 rad near pi).
+         */
+        explicit AngleLookup( AnglesT const& angles, int const binCount = 4096 )
+            : _angles( angles ), _binCount( std::max(binCount, 1) )
+        {
+            // g(u) = acos(u) / sqrt(1-u) at the bin borders of u in [0,1], its limit at u = 1 is sqrt(2)
+            _g.resize( _binCount + 1 );
+            for ( int k = 0; k != _binCount; ++k )
+            {
+                const double u = double(k) / _binCount;
+                _g[k] = std::acos( u ) / std::sqrt( 1. - u );
+            }
+            _g[ _binCount ] = std::sqrt( 2. );
+
+            // candidate ids of each cosine bin, padded, so that interpolation errors at the bin borders don't lose the closest one
+            const double pad = 1.e-6;
+            _offsets.resize( _binCount + 1 );
+            _offsets[0] = 0;
+            for ( int k = 0; k != _binCount; ++k )
+            {
+                const double c0 = -1. + 2. *  k      / _binCount;
+                const double c1 = -1. + 2. * (k + 1) / _binCount;
+                const double lo = std::acos( std::min(c1, 1.) ) - pad;
+                const double hi = std::acos( std::max(c0,-1.) ) + pad;
+
+                // closest to either end of the bin, or within it: an angle outside the bin can only be the closest to a point within the bin,
+                // if it is the closest to the bin's end on its side
+                std::vector<int> ids;
+                ids.push_back( closest(lo) );
+                ids.push_back( closest(hi) );
+                for ( size_t i = 0; i != _angles.size(); ++i )
+                    if ( (_angles[i] >= lo) && (_angles[i] <= hi) )
+                        ids.push_back( i );
+                std::sort( ids.begin(), ids.end() );
+                ids.erase( std::unique(ids.begin(), ids.end()), ids.end() );
+                if ( ids.size() && ids[0] < 0 ) ids.erase( ids.begin() ); // no angles at all
+
+                _ids.insert( _ids.end(), ids.begin(), ids.end() );
+                _offsets[k+1] = _ids.size();
+            }
+        } //...AngleLookup()
+
+        /*! \brief Same as \ref MyPrimitivePrimitiveAngleFunctor::eval(), but on two directions.
+         *  \param[out] closest_angle_id Index of the closest allowed angle, if not NULL.
+         *  \return The absolute difference of the angle of \p dir0 and \p dir1 to the closest allowed angle.
+         */
+        template <class _DerivedA, class _DerivedB>
+        inline Scalar eval( _DerivedA const& dir0, _DerivedB const& dir1, int * closest_angle_id = NULL ) const
+        {
+            return this->evalCosine( cosine(double(dir0(0)), double(dir0(1)), double(dir0(2)), double(dir1(0)), double(dir1(1)), double(dir1(2))), closest_angle_id );
+        }
+
+        /*! \brief Batched \ref eval(): \p dir0 against \p dirs.
+         *  \param[out] diffs            diffs[i] = eval( dir0, dirs[i] ).
+         *  \param[out] closest_angle_ids Ids of the closest allowed angles, if not NULL.
+         */
+        inline void evalBatch( std::vector<Scalar>                   & diffs
+                             , Position                         const& dir0
+                             , kernels::PositionArrays<Scalar>  const& dirs
+                             , std::vector<int>                      * closest_angle_ids = NULL ) const
+        {
+            const size_t n = dirs.size();
+            diffs.resize( n );
+            if ( closest_angle_ids )
+                closest_angle_ids->resize( n );
+
+            // cosines first, this loop vectorizes
+            const double ax = dir0(0), ay = dir0(1), az = dir0(2);
+            std::vector<double> cosines( n );
+            for ( size_t i = 0; i < n; ++i )
+                cosines[i] = cosine( ax, ay, az, double(dirs.x[i]), double(dirs.y[i]), double(dirs.z[i]) );
+
+            for ( size_t i = 0; i != n; ++i )
+                diffs[i] = this->evalCosine( cosines[i], closest_angle_ids ? &(*closest_angle_ids)[i] : NULL );
+        }
+
+        //! \brief \ref eval() from the cosine of the two directions.
+        inline Scalar evalCosine( double c, int * closest_angle_id = NULL ) const
+        {
+            // nan, or a zero direction: angle 0, like angleInRad()
+            if ( !(c >= -1.) ) c = (c != c) ? 1. : -1.;
+            if ( c > 1. )      c = 1.;
+
+            // angle, rounded to Scalar and normalized to 0..180 the same way as the exact path,
+            // so that antiparallel directions wrap around to 0
+            const double u     = std::abs( c );
+            const double t     = u * _binCount;
+            const int    k     = std::min( int(t), _binCount - 1 );
+            const double g     = _g[k] + (t - k) * (_g[k+1] - _g[k]);
+            const double angle = std::sqrt( 1. - u ) * g;
+            Scalar       theta = Scalar( c < 0. ? M_PI - angle : angle );
+
+            int bin = std::min( int((c + 1.) * 0.5 * _binCount), _binCount - 1 );
+            while ( theta > M_PI ) { theta -= M_PI; bin = _binCount - 1; }
+
+            // closest among the bin's candidates, the first one of equals, like the exact path
+            Scalar min_angle = std::numeric_limits<Scalar>::max();
+            for ( int j = _offsets[bin]; j != _offsets[bin+1]; ++j )
+            {
+                const Scalar diff = std::abs( _angles[_ids[j]] - theta );
+                if ( diff < min_angle )
+                {
+                    min_angle = diff;
+                    if ( closest_angle_id )
+                        *closest_angle_id = _ids[j];
+                }
+            }
+
+            return min_angle;
+        } //...evalCosine()
+
+        inline AnglesT const& getAngles  () const { return _angles; }
+        inline int            getBinCount() const { return _binCount; }
+
+        //! \brief Upper bound of the angle error from interpolating g, sampled at the bin centres.
+        inline double maxInterpolationError() const
+        {
+            double err = 0.;
+            for ( int k = 0; k != _binCount; ++k )
+            {
+                const double u = (k + 0.5) / _binCount;
+                err = std::max( err, std::abs(std::sqrt(1. - u) * 0.5 * (_g[k] + _g[k+1]) - std::acos(u)) );
+            }
+            return err;
+        }
+
+    protected:
+        //! \brief Cosine of the angle between a and b, 1 for zero vectors.
+        static inline double cosine( double ax, double ay, double az, double bx, double by, double bz )
+        {
+            const double norms = std::sqrt( (ax*ax + ay*ay + az*az) * (bx*bx + by*by + bz*bz) );
+            return norms > 0. ? (ax*bx + ay*by + az*bz) / norms : 1.;
+        }
+
+        //! \brief Id of the allowed angle closest to \p angle, first of equals, -1 if there are none.
+        inline int closest( double const angle ) const
+        {
+            int    id  = -1;
+            double min = std::numeric_limits<double>::max();
+            for ( size_t i = 0; i != _angles.size(); ++i )
+                if ( std::abs(_angles[i] - angle) < min )
+                {
+                    min = std::abs( _angles[i] - angle );
+                    id  = i;
+                }
+            return id;
+        }
+
+        AnglesT                     _angles;
+        int                         _binCount;
+        std::vector<double>         _g;         //!< \brief acos(u) / sqrt(1-u) at u = k / _binCount.
+        std::vector<int>            _offsets;   //!< \brief Candidates of cosine bin k are _ids[ _offsets[k] .. _offsets[k+1] ).
+        std::vector<int>            _ids;       //!< \brief Candidate angle ids of all bins.
+}; //...class AngleLookup
+
+} //...ns processing
+} //...ns rapter
+
+#endif // RAPTER_ANGLELOOKUP_H
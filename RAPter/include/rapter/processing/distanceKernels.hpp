@@ -0,0 +1,350 @@
+#ifndef RAPTER_DISTANCEKERNELS_HPP
+#define RAPTER_DISTANCEKERNELS_HPP
+
+#include <cmath>
+#include <vector>
+#include <algorithm>                                // min
+#if defined(__AVX__) || defined(__SSE2__)
+#   include <immintrin.h>
+#endif
+#include "Eigen/Dense"
+#include "rapter/simpleTypes.h"                     // LidT
+#include "rapter/primitives/pointPrimitiveSoA.h"    // gatherPositions()
+
+namespace rapter {
+namespace processing {
+
+/*! \brief Batch point-to-primitive kernels: distances of N points to one plane or line, inlier selection and projection.
+ *
+ *         Points are passed as separate x, y, z arrays (see \ref PositionArrays and \ref gatherPositions).
+ *         The float versions run 8 (AVX) or 4 (SSE) points at a time, depending on what the translation unit is compiled for
+ *         (see WITH_AVX2 in CMakeLists.txt), other scalar types and the remainders run the scalar loops.
+ *         Both paths evaluate the same expressions as the per-point getDistance(), getFiniteDistance() and projectPoint() functions.
+ */
+namespace kernels {
+
+    //! \brief Point positions as structure-of-arrays, the input of the kernels.
+    template <typename _Scalar>
+    struct PositionArrays
+    {
+        std::vector<_Scalar> x, y, z;
+
+        inline size_t size  () const { return x.size(); }
+        inline void   resize( size_t const n ) { x.resize( n ); y.resize( n ); z.resize( n ); }
+    };
+
+    /*! \brief Copies the positions of \p points, or of the ones listed in \p indices into \p positions.
+     *  \tparam _PointContainerT    Concept: std::vector< \ref rapter::PointPrimitive >.
+     *  \tparam _IndicesContainerT  Concept: std::vector<PidT>.
+     */
+    template <typename _Scalar, class _PointContainerT, class _IndicesContainerT> inline void
+    gatherPositions( PositionArrays<_Scalar> & positions, _PointContainerT const& points, _IndicesContainerT const* indices )
+    {
+        const size_t n = indices ? indices->size() : points.size();
+        positions.resize( n );
+        for ( size_t i = 0; i != n; ++i )
+        {
+            const Eigen::Matrix<_Scalar,3,1> pos = points[ indices ? (*indices)[i] : i ].pos();
+            positions.x[i] = pos(0); positions.y[i] = pos(1); positions.z[i] = pos(2);
+        }
+    }
+
+    //! \brief Copies straight from the arrays of a \ref PointPrimitiveSoA.
+    template <typename _Scalar, class _IndicesContainerT> inline void
+    gatherPositions( PositionArrays<_Scalar> & positions, PointPrimitiveSoA const& points, _IndicesContainerT const* indices )
+    {
+        if ( !indices )
+        {
+            positions.x.assign( points.x().begin(), points.x().end() );
+            positions.y.assign( points.y().begin(), points.y().end() );
+            positions.z.assign( points.z().begin(), points.z().end() );
+            return;
+        }
+
+        positions.resize( indices->size() );
+        for ( size_t i = 0; i != indices->size(); ++i )
+        {
+            const size_t pid = (*indices)[i];
+            positions.x[i] = points.x()[pid]; positions.y[i] = points.y()[pid]; positions.z[i] = points.z()[pid];
+        }
+    }
+
+    //! \brief Copies the entries listed in \p ids of \p in to \p out.
+    template <typename _Scalar, class _IdsContainerT> inline void
+    selectPositions( PositionArrays<_Scalar> & out, PositionArrays<_Scalar> const& in, _IdsContainerT const& ids )
+    {
+        out.resize( ids.size() );
+        for ( size_t i = 0; i != ids.size(); ++i )
+        {
+            out.x[i] = in.x[ ids[i] ]; out.y[i] = in.y[ ids[i] ]; out.z[i] = in.z[ ids[i] ];
+        }
+    }
+
+    namespace simd
+    {
+        // Thin wrappers, so that each kernel is written once for both instruction sets.
+#if defined(__AVX__)
+        typedef __m256 Vec;
+        enum { WIDTH = 8 };
+        inline Vec  load  ( float const* p )            { return _mm256_loadu_ps( p ); }
+        inline void store ( float* p, Vec a )           { _mm256_storeu_ps( p, a ); }
+        inline Vec  set1  ( float a )                   { return _mm256_set1_ps( a ); }
+        inline Vec  add   ( Vec a, Vec b )              { return _mm256_add_ps( a, b ); }
+        inline Vec  sub   ( Vec a, Vec b )              { return _mm256_sub_ps( a, b ); }
+        inline Vec  mul   ( Vec a, Vec b )              { return _mm256_mul_ps( a, b ); }
+        inline Vec  max   ( Vec a, Vec b )              { return _mm256_max_ps( a, b ); }
+        inline Vec  min   ( Vec a, Vec b )              { return _mm256_min_ps( a, b ); }
+        inline Vec  sqrt  ( Vec a )                     { return _mm256_sqrt_ps( a ); }
+        inline Vec  abs   ( Vec a )                     { return _mm256_andnot_ps( _mm256_set1_ps(-0.f), a ); }
+        inline Vec  lt    ( Vec a, Vec b )              { return _mm256_cmp_ps( a, b, _CMP_LT_OQ ); }
+        inline Vec  le    ( Vec a, Vec b )              { return _mm256_cmp_ps( a, b, _CMP_LE_OQ ); }
+        inline Vec  both  ( Vec a, Vec b )              { return _mm256_and_ps( a, b ); }
+        inline Vec  select( Vec mask, Vec a, Vec b )    { return _mm256_blendv_ps( b, a, mask ); }
+        inline int  bits  ( Vec mask )                  { return _mm256_movemask_ps( mask ); }
+#elif defined(__SSE2__)
+        typedef __m128 Vec;
+        enum { WIDTH = 4 };
+        inline Vec  load  ( float const* p )            { return _mm_loadu_ps( p ); }
+        inline void store ( float* p, Vec a )           { _mm_storeu_ps( p, a ); }
+        inline Vec  set1  ( float a )                   { return _mm_set1_ps( a ); }
+        inline Vec  add   ( Vec a, Vec b )              { return _mm_add_ps( a, b ); }
+        inline Vec  sub   ( Vec a, Vec b )              { return _mm_sub_ps( a, b ); }
+        inline Vec  mul   ( Vec a, Vec b )              { return _mm_mul_ps( a, b ); }
+        inline Vec  max   ( Vec a, Vec b )              { return _mm_max_ps( a, b ); }
+        inline Vec  min   ( Vec a, Vec b )              { return _mm_min_ps( a, b ); }
+        inline Vec  sqrt  ( Vec a )                     { return _mm_sqrt_ps( a ); }
+        inline Vec  abs   ( Vec a )                     { return _mm_andnot_ps( _mm_set1_ps(-0.f), a ); }
+        inline Vec  lt    ( Vec a, Vec b )              { return _mm_cmplt_ps( a, b ); }
+        inline Vec  le    ( Vec a, Vec b )              { return _mm_cmple_ps( a, b ); }
+        inline Vec  both  ( Vec a, Vec b )              { return _mm_and_ps( a, b ); }
+        inline Vec  select( Vec mask, Vec a, Vec b )    { return _mm_or_ps( _mm_and_ps(mask, a), _mm_andnot_ps(mask, b) ); }
+        inline int  bits  ( Vec mask )                  { return _mm_movemask_ps( mask ); }
+#endif
+        //! \brief The vectorized kernels below return the number of points they processed, these generic ones process none.
+        template <typename _Scalar> inline size_t planeDistances      ( _Scalar*, _Scalar const*, _Scalar const*, _Scalar const*, size_t, _Scalar const* ) { return 0; }
+        template <typename _Scalar> inline size_t lineDistances       ( _Scalar*, _Scalar const*, _Scalar const*, _Scalar const*, size_t, _Scalar const* ) { return 0; }
+        template <typename _Scalar> inline size_t finitePlaneDistances( _Scalar*, _Scalar const*, _Scalar const*, _Scalar const*, size_t, _Scalar const* ) { return 0; }
+        template <typename _Scalar> inline size_t finiteLineDistances ( _Scalar*, _Scalar const*, _Scalar const*, _Scalar const*, size_t, _Scalar const* ) { return 0; }
+
+#if defined(__AVX__) || defined(__SSE2__)
+        //! \param[in] c {px,py,pz,nx,ny,nz}
+        inline size_t planeDistances( float* d, float const* x, float const* y, float const* z, size_t const n, float const* c )
+        {
+            const Vec px = set1(c[0]), py = set1(c[1]), pz = set1(c[2]), nx = set1(c[3]), ny = set1(c[4]), nz = set1(c[5]);
+            size_t i = 0;
+            for ( ; i + WIDTH <= n; i += WIDTH )
+                store( d + i, add(add(mul(sub(load(x+i), px), nx), mul(sub(load(y+i), py), ny)), mul(sub(load(z+i), pz), nz)) );
+            return i;
+        }
+
+        //! \param[in] c {px,py,pz,dx,dy,dz}
+        inline size_t lineDistances( float* d, float const* x, float const* y, float const* z, size_t const n, float const* c )
+        {
+            const Vec px = set1(c[0]), py = set1(c[1]), pz = set1(c[2]), dx = set1(c[3]), dy = set1(c[4]), dz = set1(c[5]);
+            size_t i = 0;
+            for ( ; i + WIDTH <= n; i += WIDTH )
+            {
+                const Vec vx = sub(px, load(x+i)), vy = sub(py, load(y+i)), vz = sub(pz, load(z+i));
+                const Vec cx = sub(mul(vy, dz), mul(vz, dy)),
+                          cy = sub(mul(vz, dx), mul(vx, dz)),
+                          cz = sub(mul(vx, dy), mul(vy, dx));
+                store( d + i, sqrt(add(add(mul(cx, cx), mul(cy, cy)), mul(cz, cz))) );
+            }
+            return i;
+        }
+
+        //! \param[in] c {cx,cy,cz, f0x,f0y,f0z, f1x,f1y,f1z, f2x,f2y,f2z, h0,h1}
+        inline size_t finitePlaneDistances( float* d, float const* x, float const* y, float const* z, size_t const n, float const* c )
+        {
+            const Vec cx  = set1(c[ 0]), cy  = set1(c[ 1]), cz  = set1(c[ 2]),
+                      f0x = set1(c[ 3]), f0y = set1(c[ 4]), f0z = set1(c[ 5]),
+                      f1x = set1(c[ 6]), f1y = set1(c[ 7]), f1z = set1(c[ 8]),
+                      f2x = set1(c[ 9]), f2y = set1(c[10]), f2z = set1(c[11]),
+                      h0  = set1(c[12]), h1  = set1(c[13]), zero = set1(0.f);
+            size_t i = 0;
+            for ( ; i + WIDTH <= n; i += WIDTH )
+            {
+                const Vec lx = sub(load(x+i), cx), ly = sub(load(y+i), cy), lz = sub(load(z+i), cz);
+                const Vec e0 = max( sub(abs(add(add(mul(lx, f0x), mul(ly, f0y)), mul(lz, f0z))), h0), zero ),
+                          e1 = max( sub(abs(add(add(mul(lx, f1x), mul(ly, f1y)), mul(lz, f1z))), h1), zero ),
+                          e2 =          abs(add(add(mul(lx, f2x), mul(ly, f2y)), mul(lz, f2z)));
+                store( d + i, sqrt(add(add(mul(e0, e0), mul(e1, e1)), mul(e2, e2))) );
+            }
+            return i;
+        }
+
+        //! \param[in] c {ax,ay,az, bx,by,bz, ux,uy,uz, length, px,py,pz, nx,ny,nz}
+        inline size_t finiteLineDistances( float* d, float const* x, float const* y, float const* z, size_t const n, float const* c )
+        {
+            const Vec ax = set1(c[ 0]), ay = set1(c[ 1]), az = set1(c[ 2]),
+                      bx = set1(c[ 3]), by = set1(c[ 4]), bz = set1(c[ 5]),
+                      ux = set1(c[ 6]), uy = set1(c[ 7]), uz = set1(c[ 8]), length = set1(c[9]),
+                      px = set1(c[10]), py = set1(c[11]), pz = set1(c[12]),
+                      nx = set1(c[13]), ny = set1(c[14]), nz = set1(c[15]), zero = set1(0.f);
+            size_t i = 0;
+            for ( ; i + WIDTH <= n; i += WIDTH )
+            {
+                const Vec qx = load(x+i), qy = load(y+i), qz = load(z+i);
+                const Vec qax = sub(qx, ax), qay = sub(qy, ay), qaz = sub(qz, az);
+                const Vec qbx = sub(qx, bx), qby = sub(qy, by), qbz = sub(qz, bz);
+                const Vec dq     = add(add(mul(ux, qax), mul(uy, qay)), mul(uz, qaz));
+                const Vec inside = both( le(zero, dq), le(dq, length) );
+                const Vec orth   = abs(add(add(mul(nx, sub(qx, px)), mul(ny, sub(qy, py))), mul(nz, sub(qz, pz))));
+                const Vec ends   = min( sqrt(add(add(mul(qax, qax), mul(qay, qay)), mul(qaz, qaz))),
+                                        sqrt(add(add(mul(qbx, qbx), mul(qby, qby)), mul(qbz, qbz))) );
+                store( d + i, select(inside, orth, ends) );
+            }
+            return i;
+        }
+
+        //! \brief Appends the ids of the \p n entries of \p d below \p threshold to \p ids.
+        template <class _IdsContainerT>
+        inline size_t selectBelow( _IdsContainerT & ids, float const* d, size_t const n, float const threshold )
+        {
+            const Vec t = set1( threshold );
+            size_t i = 0;
+            for ( ; i + WIDTH <= n; i += WIDTH )
+            {
+                int mask = bits( lt(load(d+i), t) );
+                for ( int k = 0; mask; ++k, mask >>= 1 )
+                    if ( mask & 1 )
+                        ids.push_back( i + k );
+            }
+            return i;
+        }
+#endif // __AVX__ || __SSE2__
+        template <typename _Scalar, class _IdsContainerT>
+        inline size_t selectBelow( _IdsContainerT &, _Scalar const*, size_t, _Scalar ) { return 0; }
+    } //...ns simd
+
+    /*! \brief Signed distances of points to the plane through \p pos with unit normal \p normal, as PlanePrimitive::getDistance().
+     *  \param[out] d   n distances.
+     */
+    template <typename _Scalar> inline void
+    planeDistances( _Scalar* d, _Scalar const* x, _Scalar const* y, _Scalar const* z, size_t const n
+                  , Eigen::Matrix<_Scalar,3,1> const& pos, Eigen::Matrix<_Scalar,3,1> const& normal )
+    {
+        const _Scalar c[6] = { pos(0), pos(1), pos(2), normal(0), normal(1), normal(2) };
+        for ( size_t i = simd::planeDistances(d, x, y, z, n, c); i < n; ++i )
+            d[i] = (x[i] - c[0]) * c[3] + (y[i] - c[1]) * c[4] + (z[i] - c[2]) * c[5];
+    }
+
+    /*! \brief Distances of points to the infinite line through \p pos with unit direction \p dir, as LinePrimitive::getDistance().
+     *  \param[out] d   n distances.
+     */
+    template <typename _Scalar> inline void
+    lineDistances( _Scalar* d, _Scalar const* x, _Scalar const* y, _Scalar const* z, size_t const n
+                 , Eigen::Matrix<_Scalar,3,1> const& pos, Eigen::Matrix<_Scalar,3,1> const& dir )
+    {
+        const _Scalar c[6] = { pos(0), pos(1), pos(2), dir(0), dir(1), dir(2) };
+        for ( size_t i = simd::lineDistances(d, x, y, z, n, c); i < n; ++i )
+        {
+            const _Scalar vx = c[0] - x[i], vy = c[1] - y[i], vz = c[2] - z[i];
+            const _Scalar cx = vy * c[5] - vz * c[4],
+                          cy = vz * c[3] - vx * c[5],
+                          cz = vx * c[4] - vy * c[3];
+            d[i] = std::sqrt( cx * cx + cy * cy + cz * cz );
+        }
+    }
+
+    /*! \brief Distances of points to the rectangle spanned by the four \p extrema of a plane, as MyPointFinitePlaneDistanceFunctor.
+     *         The frame of the rectangle is set up once, instead of once per point.
+     *  \tparam _ExtremaT   Concept: std::vector< Eigen::Matrix<_Scalar,3,1> >, ordered as PlanePrimitive::getExtent() outputs them.
+     *  \param[out] d       n distances.
+     */
+    template <typename _Scalar, class _ExtremaT> inline void
+    finitePlaneDistances( _Scalar* d, _Scalar const* x, _Scalar const* y, _Scalar const* z, size_t const n, _ExtremaT const& extrema )
+    {
+        typedef Eigen::Matrix<_Scalar,3,1> Position;
+
+        Position center( Position::Zero() );
+        for ( size_t e = 0; e != extrema.size(); ++e )
+            center += extrema[e];
+        center /= _Scalar( extrema.size() );
+
+        const Position f0 = (extrema[1] - extrema[0]).normalized(),
+                       f1 = (extrema[2] - extrema[1]).normalized(),
+                       f2 = f0.cross( f1 ).normalized();
+        const _Scalar c[14] = { center(0), center(1), center(2)
+                              , f0(0), f0(1), f0(2), f1(0), f1(1), f1(2), f2(0), f2(1), f2(2)
+                              , (extrema[1] - extrema[0]).norm() / _Scalar(2.), (extrema[2] - extrema[1]).norm() / _Scalar(2.) };
+
+        for ( size_t i = simd::finitePlaneDistances(d, x, y, z, n, c); i < n; ++i )
+        {
+            const _Scalar lx = x[i] - c[0], ly = y[i] - c[1], lz = z[i] - c[2];
+            const _Scalar e0 = std::max( std::abs(lx * c[3] + ly * c[ 4] + lz * c[ 5]) - c[12], _Scalar(0) ),
+                          e1 = std::max( std::abs(lx * c[6] + ly * c[ 7] + lz * c[ 8]) - c[13], _Scalar(0) ),
+                          e2 =           std::abs(lx * c[9] + ly * c[10] + lz * c[11]);
+            d[i] = std::sqrt( e0 * e0 + e1 * e1 + e2 * e2 );
+        }
+    }
+
+    /*! \brief Distances of points to the segment between the two \p extrema of a line, as MyPointFiniteLineDistanceFunctor.
+     *  \param[in]  pos     Point on the line.
+     *  \param[in]  normal  Normal of the line, LinePrimitive::normal().
+     *  \param[out] d       n distances.
+     */
+    template <typename _Scalar, class _ExtremaT> inline void
+    finiteLineDistances( _Scalar* d, _Scalar const* x, _Scalar const* y, _Scalar const* z, size_t const n, _ExtremaT const& extrema
+                       , Eigen::Matrix<_Scalar,3,1> const& pos, Eigen::Matrix<_Scalar,3,1> const& normal )
+    {
+        typedef Eigen::Matrix<_Scalar,3,1> Position;
+
+        const Position a = extrema[0], b = extrema[1], u = (b - a).normalized();
+        const _Scalar c[16] = { a(0), a(1), a(2), b(0), b(1), b(2), u(0), u(1), u(2), (b - a).norm()
+                              , pos(0), pos(1), pos(2), normal(0), normal(1), normal(2) };
+
+        for ( size_t i = simd::finiteLineDistances(d, x, y, z, n, c); i < n; ++i )
+        {
+            const Position q( x[i], y[i], z[i] );
+            const _Scalar  dq = u.dot( q - a );
+            d[i] = (dq >= _Scalar(0.) && dq <= c[9]) ? std::abs( normal.dot(q - pos) )
+                                                     : std::min( (q - a).norm(), (q - b).norm() );
+        }
+    }
+
+    /*! \brief Projects points onto the plane through \p pos with unit normal \p normal, as PlanePrimitive::projectPoint(). \p out may be \p in.
+     */
+    template <typename _Scalar> inline void
+    projectOntoPlane( PositionArrays<_Scalar> & out, PositionArrays<_Scalar> const& in
+                    , Eigen::Matrix<_Scalar,3,1> const& pos, Eigen::Matrix<_Scalar,3,1> const& normal )
+    {
+        const size_t n = in.size();
+        std::vector<_Scalar> d( n );
+        planeDistances( d.data(), in.x.data(), in.y.data(), in.z.data(), n, pos, normal );
+
+        out.resize( n );
+        for ( size_t i = 0; i < n; ++i )
+        {
+            out.x[i] = in.x[i] - d[i] * normal(0);
+            out.y[i] = in.y[i] - d[i] * normal(1);
+            out.z[i] = in.z[i] - d[i] * normal(2);
+        }
+    }
+
+    /*! \brief Inlier mask: mask[i] = d[i] < threshold. Compares as the getExtent() functions do, so signed plane distances on the back side pass.
+     */
+    template <typename _Scalar> inline void
+    inlierMask( std::vector<unsigned char> & mask, _Scalar const* d, size_t const n, _Scalar const threshold )
+    {
+        mask.resize( n );
+        for ( size_t i = 0; i < n; ++i )
+            mask[i] = d[i] < threshold;
+    }
+
+    /*! \brief Appends the ids of the entries of \p d below \p threshold to \p ids, in ascending order.
+     *  \tparam _IdsContainerT Concept: std::vector<LidT>.
+     */
+    template <typename _Scalar, class _IdsContainerT> inline void
+    selectInliers( _IdsContainerT & ids, _Scalar const* d, size_t const n, _Scalar const threshold )
+    {
+        for ( size_t i = simd::selectBelow(ids, d, n, threshold); i < n; ++i )
+            if ( d[i] < threshold )
+                ids.push_back( i );
+    }
+
+} //...ns kernels
+} //...ns processing
+} //...ns rapter
+
+#endif // RAPTER_DISTANCEKERNELS_HPP
@@ -0,0 +1,158 @@
+#ifndef RAPTER_LOCALFIT_HPP
+#define RAPTER_LOCALFIT_HPP
+
+#include <cmath>
+#include <vector>
+#include <limits>
+#include <algorithm>                                  // min, max, fill
+#include "Eigen/Dense"
+#include "Eigen/Eigenvalues"                        // SelfAdjointEigenSolver::computeDirect
+#include "rapter/simpleTypes.h"                     // LidT
+#include "rapter/processing/distanceKernels.hpp"    // PositionArrays
+
+namespace rapter {
+namespace processing {
+
+/*! \brief Local line and plane fits to point neighbourhoods, the orientation stage of \ref Segmentation::fitLocal.
+ *
+ *         Computes the same fit as smartgeometry::geometry::fitLinearPrimitive: centroid, covariance weighted by the distance to the previous fit,
+ *         largest (line) or smallest (plane) eigenvector. The neighbourhood is passed as a \ref kernels::PositionArrays block, so that the
+ *         weight and covariance loops vectorise, and the 3x3 eigen problem is solved in closed form instead of iteratively.
+ */
+namespace localfit {
+
+    /*! \brief Closed form eigen decomposition of a symmetric 3x3 matrix, in double precision.
+     *  \param[out] values  Eigenvalues, ascending.
+     *  \param[out] vectors Unit eigenvectors in the columns, in the order of \p values.
+     */
+    inline void eigenSymmetric3( Eigen::Vector3d & values, Eigen::Matrix3d & vectors, Eigen::Matrix3d const& matrix )
+    {
+        Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> solver;
+        solver.computeDirect( matrix );
+        values  = solver.eigenvalues();
+        vectors = solver.eigenvectors();
+    }
+
+    //! \brief Output of \ref fitNeighbourhood.
+    template <typename _Scalar>
+    struct Fit
+    {
+        Eigen::Matrix<_Scalar,3,1> centroid;
+        Eigen::Matrix<_Scalar,3,1> dir;         //!< \brief Line direction, or plane normal.
+        _Scalar                    variation;   //!< \brief Eigenvalue not explained by the fit over their sum, lower is better (surface or line variation).
+    };
+
+    /*! \brief Fits a line (\p Rows == 6) or a plane (\p Rows == 4) to \p block, and refits \p refit times with weights (1 - (d/scale)^2)^2 of the distance d to the previous fit.
+     *  \param[out] fit      Centroid, direction and variation.
+     *  \param[in]  block    Neighbourhood positions.
+     *  \param[in]  scale    Distance at which weights become 0.
+     *  \param[in]  refit    Refit count, 2 in \ref Segmentation::fitLocal.
+     *  \param[in]  weights  Scratch space, resized to the block.
+     *  \param[in]  count    Fits the first \p count points of \p block only, i.e. a smaller radius of a distance sorted neighbourhood. All, if negative.
+     *  \return              EXIT_FAILURE, if less than two points are fit.
+     */
+    template <int Rows, typename _Scalar>
+    inline int fitNeighbourhood( Fit<_Scalar>                            & fit
+                               , kernels::PositionArrays<_Scalar>   const& block
+                               , _Scalar                            const  scale
+                               , int                                const  refit
+                               , std::vector<_Scalar>                    & weights
+                               , LidT                               const  count = -1 )
+    {
+        const LidT N = (count < 0) ? LidT(block.size()) : std::min( count, LidT(block.size()) );
+        if ( N < 2 )
+            return EXIT_FAILURE;
+
+        _Scalar const* x = block.x.data();
+        _Scalar const* y = block.y.data();
+        _Scalar const* z = block.z.data();
+
+        // unweighted centroid, as computeCentroid
+        double cx = 0., cy = 0., cz = 0.;
+        for ( LidT i = 0; i < N; ++i ) { cx += x[i]; cy += y[i]; cz += z[i]; }
+        const _Scalar mx = cx / N, my = cy / N, mz = cz / N;
+        fit.centroid << mx, my, mz;
+
+        weights.resize( N );
+        _Scalar* w = weights.data();
+        Eigen::Vector3d values;
+        Eigen::Matrix3d vectors;
+        for ( int iteration = 0; iteration <= refit; ++iteration )
+        {
+            // weights from the distance to the previous fit
+            if ( !iteration )
+                std::fill( weights.begin(), weights.begin() + N, _Scalar(1) );
+            else
+            {
+                const _Scalar dx = fit.dir(0), dy = fit.dir(1), dz = fit.dir(2), invScale = _Scalar(1) / scale;
+                if ( Rows == 4 )
+                {
+                    // signed, as pointPrimitiveDistance<float,4>
+                    const _Scalar d0 = -(dx * mx + dy * my + dz * mz);
+#                   pragma omp simd
+                    for ( LidT i = 0; i < N; ++i )
+                    {
+                        const _Scalar dist = dx * x[i] + dy * y[i] + dz * z[i] + d0;
+                        const _Scalar t    = dist * invScale;
+                        w[i] = dist < scale ? (t * t - _Scalar(1)) * (t * t - _Scalar(1)) : _Scalar(0);
+                    }
+                }
+                else
+                {
+#                   pragma omp simd
+                    for ( LidT i = 0; i < N; ++i )
+                    {
+                        // |(centroid - p) x dir|
+                        const _Scalar px = mx - x[i], py = my - y[i], pz = mz - z[i];
+                        const _Scalar qx = py * dz - pz * dy, qy = pz * dx - px * dz, qz = px * dy - py * dx;
+                        const _Scalar dist = std::sqrt( qx * qx + qy * qy + qz * qz );
+                        const _Scalar t    = dist * invScale;
+                        w[i] = dist < scale ? (t * t - _Scalar(1)) * (t * t - _Scalar(1)) : _Scalar(0);
+                    }
+                }
+            }
+
+            // weighted covariance around the centroid
+            _Scalar sw = 0, sxx = 0, sxy = 0, sxz = 0, syy = 0, syz = 0, szz = 0;
+#           pragma omp simd reduction(+:sw,sxx,sxy,sxz,syy,syz,szz)
+            for ( LidT i = 0; i < N; ++i )
+            {
+                const _Scalar px = x[i] - mx, py = y[i] - my, pz = z[i] - mz;
+                sw  += w[i];
+                sxx += w[i] * px * px; sxy += w[i] * px * py; sxz += w[i] * px * pz;
+                syy += w[i] * py * py; syz += w[i] * py * pz; szz += w[i] * pz * pz;
+            }
+            Eigen::Matrix3d cov;
+            cov << sxx, sxy, sxz,
+                   sxy, syy, syz,
+                   sxz, syz, szz;
+            if ( sw > std::numeric_limits<float>::epsilon() )
+                cov /= sw;
+
+            eigenSymmetric3( values, vectors, cov );
+            fit.dir = vectors.col( Rows == 4 ? 0 : 2 ).normalized().template cast<_Scalar>();
+        }
+
+        const double sum = values.sum();
+        fit.variation = sum > 0. ? _Scalar( (Rows == 4 ? values(0) : values(0) + values(1)) / sum ) : _Scalar(0);
+
+        return EXIT_SUCCESS;
+    } //...fitNeighbourhood()
+
+    /*! \brief Radii of a multi-scale orientation, \p count radii around \p scale a factor of sqrt(2) apart, ascending.
+     *  \param[in] count Number of radii, 1 is \p scale only.
+     */
+    template <typename _Scalar>
+    inline std::vector<_Scalar> scaleRadii( _Scalar const scale, int const count )
+    {
+        std::vector<_Scalar> radii;
+        for ( int k = 0; k < std::max(1, count); ++k )
+            radii.push_back( scale * std::pow(_Scalar(2), (k - (std::max(1, count) - 1) / _Scalar(2)) / _Scalar(2)) );
+        return radii;
+    }
+
+} //...ns localfit
+} //...ns processing
+} //...ns rapter
+
+#endif // RAPTER_LOCALFIT_HPP
@@ -0,0 +1,321 @@
+#ifndef RAPTER_NEIGHBOURHOODGRAPH_HPP
+#define RAPTER_NEIGHBOURHOODGRAPH_HPP
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <algorithm>                            // upper_bound
+#include <cstring>                              // memcmp
+#include <stdint.h>
+
+#include "omp.h"
+#include "boost/shared_ptr.hpp"
+#include "boost/filesystem.hpp"
+#include "boost/interprocess/file_mapping.hpp"
+#include "boost/interprocess/mapped_region.hpp"
+
+#include "rapter/simpleTypes.h"                 // PidT
+#include "rapter/util/impl/pclUtil.hpp"         // buildANN
+
+namespace rapter
+{
+    namespace processing
+    {
+        /*! \brief Point neighbourhoods of a cloud in compressed sparse row layout, computed once and shared by segment, generate and formulate.
+         *
+         *  Every point stores all neighbours closer than \ref getRadius(), sorted by distance, starting with itself.
+         *  If a point has less than \ref getK() neighbours in the radius, its \ref getK() nearest neighbours are stored instead,
+         *  so that "radius search, or K nearest if too few" queries can be answered for any radius up to \ref getRadius().
+         *
+         *  The graph is written next to the cloud (\ref getPath()) and memory mapped by later steps.
+         *  It is identified by a hash of the point positions, so re-oriented clouds (same positions, new normals) keep their graph.
+         */
+        class NeighbourhoodGraph
+        {
+            public:
+                typedef uint64_t    HashT;
+                typedef uint64_t    OffsetT;
+                typedef int32_t     NeighIdT;
+                typedef float       SqrDistT;
+
+                NeighbourhoodGraph()
+                    : _hash(0), _size(0), _nnz(0), _radius(0.f), _K(0)
+                    , _offsets(NULL), _neighIds(NULL), _sqrDists(NULL) {}
+
+                //! \brief Graph file next to the cloud, e.g. "cloud.ply" -> "cloud.ply.neigh".
+                static inline std::string getPath( std::string const& cloud_path ) { return cloud_path + ".neigh"; }
+
+                /*! \brief FNV-1a hash of the point positions, used to invalidate stored graphs.
+                 *  \tparam _PointContainerT Concept: std::vector< \ref rapter::PointPrimitive >.
+                 */
+                template <class _PointContainerT>
+                static inline HashT hashPoints( _PointContainerT const& points )
+                {
+                    HashT hash( 14695981039346656037ull );
+                    for ( size_t pid = 0; pid != points.size(); ++pid )
+                    {
+                        for ( int d = 0; d != 3; ++d )
+                        {
+                            const float coord = points[pid].template pos()(d);
+                            unsigned char const* bytes = reinterpret_cast<unsigned char const*>( &coord );
+                            for ( size_t b = 0; b != sizeof(float); ++b )
+                            {
+                                hash ^= bytes[b];
+                                hash *= 1099511628211ull;
+                            }
+                        }
+                    }
+                    return hash;
+                } //...hashPoints()
+
+                /*! \brief Builds the graph with a kd-tree query per point, in parallel.
+                 *  \param[in] points Concept: std::vector< \ref rapter::PointPrimitive >.
+                 *  \param[in] radius Neighbours closer than radius are stored.
+                 *  \param[in] K      Number of nearest neighbours stored, if the radius contains less.
+                 */
+                template <class _PointContainerT>
+                inline int build( _PointContainerT const& points, float const radius, int const K )
+                {
+                    pclutil::PclSearchTreePtrT tree = pclutil::buildANN( points );
+
+                    const long N = points.size();
+                    std::vector< std::vector<int  > > neighs   ( N );
+                    std::vector< std::vector<float> > sqr_dists( N );
+#                   pragma omp parallel for schedule(dynamic,1024)
+                    for ( long pid = 0; pid < N; ++pid )
+                    {
+                        pclutil::PclSearchPointT pnt;
+                        pnt.getVector3fMap() = points[pid].template pos();
+                        int found = tree->radiusSearch( pnt, radius, neighs[pid], sqr_dists[pid], /* all: */ 0 );
+                        if ( found < K )
+                            tree->nearestKSearch( pnt, K, neighs[pid], sqr_dists[pid] );
+                    }
+
+                    // flatten
+                    _offsetsStore.resize( N + 1 );
+                    _offsetsStore[0] = 0;
+                    for ( long pid = 0; pid != N; ++pid )
+                        _offsetsStore[pid+1] = _offsetsStore[pid] + neighs[pid].size();
+
+                    _neighIdsStore.resize( _offsetsStore[N] );
+                    _sqrDistsStore.resize( _offsetsStore[N] );
+#                   pragma omp parallel for
+                    for ( long pid = 0; pid < N; ++pid )
+                    {
+                        std::copy( neighs   [pid].begin(), neighs   [pid].end(), _neighIdsStore.begin() + _offsetsStore[pid] );
+                        std::copy( sqr_dists[pid].begin(), sqr_dists[pid].end(), _sqrDistsStore.begin() + _offsetsStore[pid] );
+                    }
+
+                    _region.reset();
+                    _hash     = hashPoints( points );
+                    _size     = N;
+                    _nnz      = _offsetsStore[N];
+                    _radius   = radius;
+                    _K        = K;
+                    _offsets  = _offsetsStore.data();
+                    _neighIds = _neighIdsStore.data();
+                    _sqrDists = _sqrDistsStore.data();
+
+                    return EXIT_SUCCESS;
+                } //...build()
+
+                /*! \brief Maps a stored graph, or builds and stores a new one, if it's missing, belongs to a different cloud, or is too small.
+                 *  \param[in] path   Graph file path, usually \ref getPath() of the cloud.
+                 *  \param[in] points The cloud the graph has to belong to.
+                 *  \param[in] radius Largest radius that will be queried.
+                 *  \param[in] K      Nearest neighbour count that will be queried.
+                 */
+                template <class _PointContainerT>
+                inline int getOrBuild( std::string const& path, _PointContainerT const& points, float const radius, int const K, bool const verbose = false )
+                {
+                    float buildRadius = radius;
+                    int   buildK      = K;
+                    if ( boost::filesystem::exists(path) && (EXIT_SUCCESS == this->map(path)) )
+                    {
+                        if ( (_hash == hashPoints(points)) && (_size == static_cast<OffsetT>(points.size())) )
+                        {
+                            if ( this->covers(radius,K) )
+                            {
+                                if ( verbose ) std::cout << "[" << __func__ << "]: " << "mapped neighbourhood graph " << path << ", " << _nnz << " edges" << std::endl;
+                                return EXIT_SUCCESS;
+                            }
+
+                            // keep the larger radius, so that alternating steps don't keep rebuilding it
+                            buildRadius = std::max( radius, _radius );
+                            buildK      = std::max( K     , _K      );
+                        }
+                        std::cout << "[" << __func__ << "]: " << "neighbourhood graph " << path << " is outdated, rebuilding" << std::endl;
+                        this->release();
+                    }
+
+                    int err = this->build( points, buildRadius, buildK );
+                    if ( EXIT_SUCCESS == err )
+                        err = this->write( path );
+                    if ( verbose ) std::cout << "[" << __func__ << "]: " << "built neighbourhood graph " << path << ", " << _nnz << " edges" << std::endl;
+
+                    return err;
+                } //...getOrBuild()
+
+                //! \brief Writes the graph in the layout \ref map() expects.
+                inline int write( std::string const& path ) const
+                {
+                    std::ofstream f( path.c_str(), std::ios::binary | std::ios::trunc );
+                    if ( !f.is_open() )
+                    {
+                        std::cerr << "[" << __func__ << "]: " << "could not open " << path << std::endl;
+                        return EXIT_FAILURE;
+                    }
+
+                    Header header;
+                    std::memcpy( header.magic, Magic(), 4 );
+                    header.version = Version;
+                    header.hash    = _hash;
+                    header.size    = _size;
+                    header.nnz     = _nnz;
+                    header.radius  = _radius;
+                    header.K       = _K;
+
+                    f.write( reinterpret_cast<char const*>(&header)   , sizeof(Header) );
+                    f.write( reinterpret_cast<char const*>(_offsets)  , sizeof(OffsetT ) * (_size + 1) );
+                    f.write( reinterpret_cast<char const*>(_neighIds) , sizeof(NeighIdT) * _nnz );
+                    f.write( reinterpret_cast<char const*>(_sqrDists) , sizeof(SqrDistT) * _nnz );
+
+                    return f.good() ? EXIT_SUCCESS : EXIT_FAILURE;
+                } //...write()
+
+                //! \brief Memory maps a graph written by \ref write(), the arrays are not copied.
+                inline int map( std::string const& path )
+                {
+                    this->release();
+                    try
+                    {
+                        boost::interprocess::file_mapping mapping( path.c_str(), boost::interprocess::read_only );
+                        _region.reset( new boost::interprocess::mapped_region(mapping, boost::interprocess::read_only) );
+                    }
+                    catch ( boost::interprocess::interprocess_exception const& e )
+                    {
+                        std::cerr << "[" << __func__ << "]: " << "could not map " << path << ": " << e.what() << std::endl;
+                        return EXIT_FAILURE;
+                    }
+
+                    char const* data = static_cast<char const*>( _region->get_address() );
+                    Header const* header = reinterpret_cast<Header const*>( data );
+                    if (    (_region->get_size() < sizeof(Header))
+                         || std::memcmp(header->magic, Magic(), 4)
+                         || (header->version != Version) )
+                    {
+                        std::cerr << "[" << __func__ << "]: " << path << " is not a neighbourhood graph" << std::endl;
+                        this->release();
+                        return EXIT_FAILURE;
+                    }
+
+                    const size_t expectedSize = sizeof(Header) + sizeof(OffsetT) * (header->size + 1) + (sizeof(NeighIdT) + sizeof(SqrDistT)) * header->nnz;
+                    if ( _region->get_size() < expectedSize )
+                    {
+                        std::cerr << "[" << __func__ << "]: " << path << " is truncated" << std::endl;
+                        this->release();
+                        return EXIT_FAILURE;
+                    }
+
+                    _hash     = header->hash;
+                    _size     = header->size;
+                    _nnz      = header->nnz;
+                    _radius   = header->radius;
+                    _K        = header->K;
+                    _offsets  = reinterpret_cast<OffsetT  const*>( data + sizeof(Header) );
+                    _neighIds = reinterpret_cast<NeighIdT const*>( data + sizeof(Header) + sizeof(OffsetT) * (_size+1) );
+                    _sqrDists = reinterpret_cast<SqrDistT const*>( data + sizeof(Header) + sizeof(OffsetT) * (_size+1) + sizeof(NeighIdT) * _nnz );
+
+                    return EXIT_SUCCESS;
+                } //...map()
+
+                //! \brief True, if radius and K queries can be answered from the graph.
+                inline bool covers( float const radius, int const K ) const { return _offsets && (radius <= _radius) && (K <= _K); }
+
+                inline OffsetT         size    ()               const { return _size; }
+                inline OffsetT         getNnz  ()               const { return _nnz; }
+                inline float           getRadius()              const { return _radius; }
+                inline int             getK    ()               const { return _K; }
+                inline OffsetT         degree  ( PidT const pid ) const { return _offsets[pid+1] - _offsets[pid]; }
+                inline NeighIdT const* neighs  ( PidT const pid ) const { return _neighIds + _offsets[pid]; }
+                inline SqrDistT const* sqrDists( PidT const pid ) const { return _sqrDists + _offsets[pid]; }
+
+                //! \brief Number of neighbours of \p pid closer than \p radius (inclusive), they are the first ones in \ref neighs().
+                inline OffsetT countWithin( PidT const pid, float const radius ) const
+                {
+                    return std::upper_bound( sqrDists(pid), sqrDists(pid) + degree(pid), radius * radius ) - sqrDists(pid);
+                }
+
+                /*! \brief Mimics pcl's radiusSearch( pnt, radius, neighs, sqr_dists, max_nn ) for radii up to \ref getRadius().
+                 *  \param[in] max_nn 0 for all neighbours.
+                 */
+                inline int radiusSearch( PidT const pid, float const radius, std::vector<int> &neighs, std::vector<float> &sqr_dists, unsigned const max_nn = 0 ) const
+                {
+                    OffsetT count = countWithin( pid, radius );
+                    if ( max_nn && (count > max_nn) )
+                        count = max_nn;
+                    neighs   .assign( this->neighs(pid)  , this->neighs(pid)   + count );
+                    sqr_dists.assign( this->sqrDists(pid), this->sqrDists(pid) + count );
+                    return count;
+                } //...radiusSearch()
+
+                //! \brief Mimics pcl's nearestKSearch( pnt, K, neighs, sqr_dists ) for K up to \ref getK().
+                inline int nearestKSearch( PidT const pid, unsigned const K, std::vector<int> &neighs, std::vector<float> &sqr_dists ) const
+                {
+                    const OffsetT count = std::min( static_cast<OffsetT>(K), degree(pid) );
+                    neighs   .assign( this->neighs(pid)  , this->neighs(pid)   + count );
+                    sqr_dists.assign( this->sqrDists(pid), this->sqrDists(pid) + count );
+                    return count;
+                } //...nearestKSearch()
+
+            protected:
+                static const uint32_t Version = 1;
+                static inline char const* Magic() { return "RNGH"; }
+
+                //! \brief 40 bytes, so that the offsets following it stay 8 byte aligned.
+                struct Header
+                {
+                    char     magic[4];
+                    uint32_t version;
+                    uint64_t hash;
+                    uint64_t size;
+                    uint64_t nnz;
+                    float    radius;
+                    int32_t  K;
+                };
+
+                inline void release()
+                {
+                    _region.reset();
+                    _offsets = NULL; _neighIds = NULL; _sqrDists = NULL;
+                    _hash = _size = _nnz = 0;
+                    _radius = 0.f; _K = 0;
+                }
+
+                HashT                   _hash;
+                OffsetT                 _size;
+                OffsetT                 _nnz;
+                float                   _radius;
+                int                     _K;
+
+                // views, pointing either to the stores below, or to the mapped region
+                OffsetT         const*  _offsets;
+                NeighIdT        const*  _neighIds;
+                SqrDistT        const*  _sqrDists;
+
+                std::vector<OffsetT >   _offsetsStore;
+                std::vector<NeighIdT>   _neighIdsStore;
+                std::vector<SqrDistT>   _sqrDistsStore;
+                boost::shared_ptr<boost::interprocess::mapped_region> _region;
+
+            private:
+                // the views would dangle
+                NeighbourhoodGraph( NeighbourhoodGraph const& );
+                NeighbourhoodGraph& operator=( NeighbourhoodGraph const& );
+        }; //...class NeighbourhoodGraph
+
+    } //...ns processing
+} //...ns rapter
+
+#endif // RAPTER_NEIGHBOURHOODGRAPH_HPP
@@ -0,0 +1,304 @@
+#ifndef RAPTER_POPULATIONINDEX_HPP
+#define RAPTER_POPULATIONINDEX_HPP
+
+#include <vector>
+#include <limits>
+#include <iostream>
+#include <algorithm>                            // upper_bound, lower_bound, copy_backward, sort, unique
+
+#include "omp.h"
+
+#include "rapter/simpleTypes.h"                 // GidT, PidT, LidT
+
+namespace rapter
+{
+    namespace processing
+    {
+        /*! \brief Point ids of every GID in compressed sparse row layout, the population of a GID is a contiguous, ascending range of point ids.
+         *
+         *  Built once by a parallel counting sort on GID, so that looking up a GID's population is O(1), instead of a scan over all points.
+         *  Dense GIDs (patch ids) get a slot for every GID between the smallest and the largest one. Sparse GIDs, whose range exceeds twice the point count
+         *  (GID = point id, GID offsets of tiles), get a slot per distinct GID only, and are looked up by binary search, so memory stays linear in the points.
+         *  \ref retag moves a point to another GID in place, a range that outgrows its slot is moved to the end of the id array.
+         */
+        class PopulationIndex
+        {
+            public:
+                PopulationIndex() : _minGid( 0 ), _sparse( false ), _size( 0 ) {}
+
+                /*! \brief Counting sort of the point ids on their GID, in parallel.
+                 *  \tparam _PointContainerT Concept: std::vector< \ref rapter::PointPrimitive >.
+                 *  \param[in] threads       Thread count, omp_get_max_threads(), if not positive.
+                 */
+                template <class _PointContainerT>
+                inline int build( _PointContainerT const& points, int threads = 0 )
+                {
+                    typedef typename _PointContainerT::value_type _PointPrimitiveT;
+
+                    _begins.clear(); _ends.clear(); _capacities.clear(); _pids.clear(); _slotGids.clear();
+                    _minGid = 0;
+                    _sparse = false;
+                    _size   = points.size();
+                    if ( !_size )
+                        return EXIT_SUCCESS;
+
+                    if ( threads <= 0 )    threads = omp_get_max_threads();
+                    if ( _size < 65536 )   threads = 1;
+                    const LidT N = _size;
+
+                    // GID range
+                    GidT minGid = std::numeric_limits<GidT>::max(), maxGid = std::numeric_limits<GidT>::lowest();
+#                   pragma omp parallel for num_threads(threads) reduction(min:minGid) reduction(max:maxGid)
+                    for ( LidT pid = 0; pid < N; ++pid )
+                    {
+                        const GidT gid = points[pid].getTag( _PointPrimitiveT::TAGS::GID );
+                        if ( gid < minGid ) minGid = gid;
+                        if ( gid > maxGid ) maxGid = gid;
+                    }
+                    _minGid = minGid;
+
+                    // sparse: a slot per distinct GID
+                    _sparse = (maxGid - minGid) >= GidT(2) * N + 1024;
+                    if ( _sparse )
+                    {
+                        _slotGids.resize( N );
+#                       pragma omp parallel for num_threads(threads)
+                        for ( LidT pid = 0; pid < N; ++pid )
+                            _slotGids[pid] = points[pid].getTag( _PointPrimitiveT::TAGS::GID );
+                        std::sort( _slotGids.begin(), _slotGids.end() );
+                        _slotGids.erase( std::unique(_slotGids.begin(), _slotGids.end()), _slotGids.end() );
+                        std::vector<GidT>( _slotGids ).swap( _slotGids );
+                    }
+                    const LidT slotCount = _sparse ? LidT(_slotGids.size()) : LidT(maxGid - minGid + 1);
+                    _begins    .resize( slotCount + 1 );
+                    _pids      .resize( N );
+
+                    // each thread counts, then scatters its contiguous chunk of points, chunks and slots in order keep the ranges ascending,
+                    // fewer threads, if their counters would outnumber the points
+                    threads = std::max( 1, std::min(threads, int(N / slotCount)) );
+                    std::vector< std::vector<LidT> > offsets( threads, std::vector<LidT>(slotCount, 0) );
+#                   pragma omp parallel num_threads(threads)
+                    {
+                        const int  t     = omp_get_thread_num();
+                        const int  T     = omp_get_num_threads();
+                        const LidT start = N * t / T, stop = N * (t + 1) / T;
+                        std::vector<LidT>& offset = offsets[t];
+
+                        for ( LidT pid = start; pid < stop; ++pid )
+                            ++offset[ slot(points[pid].getTag(_PointPrimitiveT::TAGS::GID)) ];
+
+#                       pragma omp barrier
+#                       pragma omp single
+                        {
+                            LidT sum = 0;
+                            for ( LidT slot = 0; slot != slotCount; ++slot )
+                            {
+                                _begins[slot] = sum;
+                                for ( size_t thread = 0; thread != offsets.size(); ++thread )
+                                {
+                                    const LidT count = offsets[thread][slot];
+                                    offsets[thread][slot] = sum;
+                                    sum += count;
+                                }
+                            }
+                            _begins[slotCount] = sum;
+                        } //...single
+
+                        for ( LidT pid = start; pid < stop; ++pid )
+                            _pids[ offset[slot(points[pid].getTag(_PointPrimitiveT::TAGS::GID))]++ ] = pid;
+                    } //...omp parallel
+
+                    _ends      .assign( _begins.begin() + 1, _begins.end() );
+                    _capacities = _ends;
+                    _begins    .pop_back();
+
+                    return EXIT_SUCCESS;
+                } //...build()
+
+                //! \brief Point count.
+                inline size_t      size          ()               const { return _size; }
+                //! \brief Smallest GID with a slot, meaningless, if there are no points.
+                inline GidT        getMinGid     ()               const { return _minGid; }
+                //! \brief Largest GID with a slot.
+                inline GidT        getMaxGid     ()               const { return _begins.empty() ? _minGid - 1 : slotGid( _begins.size() - 1 ); }
+                //! \brief True, if the slots are per distinct GID, instead of per GID in [\ref getMinGid, \ref getMaxGid].
+                inline bool        isSparse      ()               const { return _sparse; }
+                //! \brief Number of slots.
+                inline size_t      getSlotCount  ()               const { return _begins.size(); }
+                //! \brief Entries of the id array, the room of the ranges and abandoned ranges included, drops when \ref retag compacts.
+                inline size_t      getCapacity   ()               const { return _pids.size(); }
+                //! \brief Number of points with GID \p gid.
+                inline LidT        getPopulationSize( GidT gid )  const { const LidT s = slot(gid); return s < 0 ? 0 : _ends[s] - _begins[s]; }
+                //! \brief First point id of \p gid's population, ids ascend until \ref end().
+                inline PidT const* begin         ( GidT gid )     const { const LidT s = slot(gid); return s < 0 ? NULL : _pids.data() + _begins[s]; }
+                //! \brief One after the last point id of \p gid's population.
+                inline PidT const* end           ( GidT gid )     const { const LidT s = slot(gid); return s < 0 ? NULL : _pids.data() + _ends[s]; }
+
+                /*! \brief Appends the point ids of \p gid to \p population, like \ref getPopulationOf, without a scan over the points.
+                 *  \tparam _PidContainerT Concept: std::vector<PidT>.
+                 *  \return                Number of points with \p gid.
+                 */
+                template <class _PidContainerT>
+                inline LidT getPopulationOf( _PidContainerT & population, GidT const gid ) const
+                {
+                    const LidT s = slot( gid );
+                    if ( s < 0 )
+                        return 0;
+                    population.insert( population.end(), _pids.begin() + _begins[s], _pids.begin() + _ends[s] );
+                    return _ends[s] - _begins[s];
+                } //...getPopulationOf()
+
+                /*! \brief Appends every non-empty population to \p populations, one map insertion per GID.
+                 *  \tparam _GidPidContainerMap Concept: std::map< GidT, std::vector<PidT> >, or std::map< GidT, std::set<PidT> >.
+                 */
+                template <class _GidPidContainerMap>
+                inline int getPopulations( _GidPidContainerMap & populations ) const
+                {
+                    for ( LidT s = 0; s != static_cast<LidT>(_begins.size()); ++s )
+                    {
+                        if ( _ends[s] == _begins[s] )
+                            continue;
+
+                        typename _GidPidContainerMap::mapped_type& population = populations[ slotGid(s) ];
+                        for ( LidT i = _begins[s]; i != _ends[s]; ++i )
+                            population.insert( population.end(), _pids[i] );
+                    }
+                    return EXIT_SUCCESS;
+                } //...getPopulations()
+
+                /*! \brief Moves point \p pid from \p oldGid's population to \p newGid's, to follow points[pid].setTag( GID, newGid ).
+                 *         Linear in the two population sizes, amortized.
+                 *  \return EXIT_FAILURE, if \p pid is not in \p oldGid's population.
+                 */
+                inline int retag( PidT const pid, GidT const oldGid, GidT const newGid )
+                {
+                    if ( oldGid == newGid )
+                        return EXIT_SUCCESS;
+
+                    // remove
+                    const LidT from = slot( oldGid );
+                    PidT* fromEnd = from < 0 ? NULL : _pids.data() + _ends[from];
+                    PidT* it      = from < 0 ? NULL : std::lower_bound( _pids.data() + _begins[from], fromEnd, pid );
+                    if ( !it || (it == fromEnd) || (*it != pid) )
+                    {
+                        std::cerr << "[" << __func__ << "]: " << "point " << pid << " is not in population " << oldGid << std::endl;
+                        return EXIT_FAILURE;
+                    }
+                    std::copy( it + 1, fromEnd, it );
+                    --_ends[ from ];
+
+                    // insert, move the range to the back with twice the room, if it is full
+                    addSlot( newGid );
+                    const LidT to = slot( newGid );
+                    if ( _ends[to] == _capacities[to] )
+                    {
+                        const LidT count    = _ends[to] - _begins[to];
+                        const LidT newBegin = _pids.size();
+                        _pids.resize( newBegin + std::max(LidT(4), 2 * count) );
+                        std::copy( _pids.begin() + _begins[to], _pids.begin() + _ends[to], _pids.begin() + newBegin );
+                        _begins    [to] = newBegin;
+                        _ends      [to] = newBegin + count;
+                        _capacities[to] = _pids.size();
+                    }
+                    PidT* toEnd = _pids.data() + _ends[to];
+                    PidT* pos   = std::upper_bound( _pids.data() + _begins[to], toEnd, pid );
+                    std::copy_backward( pos, toEnd, toEnd + 1 );
+                    *pos = pid;
+                    ++_ends[ to ];
+
+                    // abandoned ranges outnumber the points
+                    if ( _pids.size() > 2 * _size + 1024 )
+                        compact();
+
+                    return EXIT_SUCCESS;
+                } //...retag()
+
+            protected:
+                //! \brief Slot of \p gid, -1, if it has none.
+                inline LidT slot( GidT const gid ) const
+                {
+                    if ( _sparse )
+                    {
+                        std::vector<GidT>::const_iterator it = std::lower_bound( _slotGids.begin(), _slotGids.end(), gid );
+                        return ( (it != _slotGids.end()) && (*it == gid) ) ? LidT(it - _slotGids.begin()) : LidT(-1);
+                    }
+                    return (gid < _minGid || gid - _minGid >= static_cast<GidT>(_begins.size())) ? LidT(-1) : LidT(gid - _minGid);
+                }
+
+                //! \brief GID of slot \p s.
+                inline GidT slotGid( LidT const s ) const { return _sparse ? _slotGids[s] : _minGid + GidT(s); }
+
+                //! \brief Adds empty slots, until \p gid has one. Dense slots turn sparse, if the range would outgrow twice the point count.
+                inline void addSlot( GidT const gid )
+                {
+                    const LidT back = _pids.size();
+                    if ( !_sparse && !_begins.empty() && (std::max(gid, getMaxGid()) - std::min(gid, _minGid) >= GidT(2) * GidT(_size) + 1024) )
+                    {
+                        _slotGids.resize( _begins.size() );
+                        for ( size_t s = 0; s != _slotGids.size(); ++s )
+                            _slotGids[s] = _minGid + GidT(s);
+                        _sparse = true;
+                    }
+
+                    if ( _sparse )
+                    {
+                        std::vector<GidT>::iterator it = std::lower_bound( _slotGids.begin(), _slotGids.end(), gid );
+                        if ( (it != _slotGids.end()) && (*it == gid) )
+                            return;
+                        const LidT s = it - _slotGids.begin();
+                        _slotGids  .insert( it, gid );
+                        _begins    .insert( _begins    .begin() + s, back );
+                        _ends      .insert( _ends      .begin() + s, back );
+                        _capacities.insert( _capacities.begin() + s, back );
+                        _minGid = _slotGids.front();
+                    }
+                    else if ( _begins.empty() )
+                    {
+                        _minGid = gid;
+                        _begins.assign( 1, back ); _ends.assign( 1, back ); _capacities.assign( 1, back );
+                    }
+                    else if ( gid < _minGid )
+                    {
+                        const LidT count = _minGid - gid;
+                        _begins    .insert( _begins    .begin(), count, back );
+                        _ends      .insert( _ends      .begin(), count, back );
+                        _capacities.insert( _capacities.begin(), count, back );
+                        _minGid = gid;
+                    }
+                    else if ( gid - _minGid >= static_cast<GidT>(_begins.size()) )
+                    {
+                        const LidT count = gid - _minGid + 1;
+                        _begins    .resize( count, back );
+                        _ends      .resize( count, back );
+                        _capacities.resize( count, back );
+                    }
+                } //...addSlot()
+
+                //! \brief Copies the ranges next to each other, without room.
+                inline void compact()
+                {
+                    std::vector<PidT> pids;
+                    pids.reserve( _size );
+                    for ( size_t s = 0; s != _begins.size(); ++s )
+                    {
+                        const LidT begin = pids.size();
+                        pids.insert( pids.end(), _pids.begin() + _begins[s], _pids.begin() + _ends[s] );
+                        _begins[s] = begin;
+                        _ends  [s] = _capacities[s] = pids.size();
+                    }
+                    _pids.swap( pids );
+                } //...compact()
+
+                GidT                _minGid;        //!< \brief GID of the first slot.
+                bool                _sparse;        //!< \brief Slots per distinct GID in \ref _slotGids, instead of per GID in a range.
+                std::vector<GidT>   _slotGids;      //!< \brief Sparse only, GID of every slot, ascending.
+                std::vector<LidT>   _begins;        //!< \brief Per slot, first entry of the population in \ref _pids.
+                std::vector<LidT>   _ends;          //!< \brief Per slot, one after the last entry of the population in \ref _pids.
+                std::vector<LidT>   _capacities;    //!< \brief Per slot, one after the last entry the population may grow into.
+                std::vector<PidT>   _pids;          //!< \brief Point ids, grouped by GID.
+                size_t              _size;          //!< \brief Point count.
+        }; //...class PopulationIndex
+    } //...ns processing
+} //...ns rapter
+
+#endif // RAPTER_POPULATIONINDEX_HPP
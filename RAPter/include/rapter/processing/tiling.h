@@ -0,0 +1,101 @@
+#ifndef RAPTER_TILING_H
+#define RAPTER_TILING_H
+
+#include <cmath>            // floor, ceil
+#include <vector>
+#include <limits>
+#include <algorithm>        // min, max
+#include "Eigen/Dense"
+
+namespace rapter
+{
+    namespace processing
+    {
+        /*! \brief Regular grid of cubic tiles over a bounding box, used by \ref TiledPipeline to process clouds piece by piece.
+         *
+         *  Every position belongs to exactly one tile's core (its owner), and to the margin of every tile, whose core grown by the overlap contains it.
+         *  Tiles are numbered x fastest, then y, then z. An axis shorter than the tile size gets a single tile, so flat scans get a 2D grid.
+         *
+         *  \tparam _Scalar Concept: float.
+         */
+        template <typename _Scalar>
+        class Tiling
+        {
+            public:
+                typedef _Scalar                     Scalar;
+                typedef Eigen::Matrix<_Scalar,3,1>  Position;
+
+                Tiling() : _min( Position::Zero() ), _tileSize( 1 ), _overlap( 0 ), _counts( Eigen::Vector3i::Ones() ) {}
+
+                /*! \param[in] min, max  Bounding box of the cloud.
+                 *  \param[in] tileSize  Edge length of the tile cores.
+                 *  \param[in] overlap   Tiles read points this far outside their core.
+                 */
+                Tiling( Position const& min, Position const& max, _Scalar const tileSize, _Scalar const overlap )
+                    : _min( min ), _tileSize( tileSize ), _overlap( overlap )
+                {
+                    for ( int d = 0; d != 3; ++d )
+                        _counts(d) = std::max( 1, int(std::ceil((max(d) - min(d)) / tileSize)) );
+                }
+
+                inline int                    size     () const { return _counts.prod(); }
+                inline Eigen::Vector3i const& getCounts() const { return _counts; }
+                inline _Scalar                getOverlap() const { return _overlap; }
+
+                inline int      id    ( Eigen::Vector3i const& cell ) const { return (cell(2) * _counts(1) + cell(1)) * _counts(0) + cell(0); }
+                inline Eigen::Vector3i cell( int const tile ) const { return Eigen::Vector3i( tile % _counts(0), (tile / _counts(0)) % _counts(1), tile / (_counts(0) * _counts(1)) ); }
+
+                //! \brief Grid cell of \p pos, clamped to the grid, so that points on the far faces of the bounding box have an owner too.
+                inline Eigen::Vector3i cellOf( Position const& pos ) const
+                {
+                    Eigen::Vector3i cell;
+                    for ( int d = 0; d != 3; ++d )
+                        cell(d) = std::min( _counts(d) - 1, std::max(0, int(std::floor((pos(d) - _min(d)) / _tileSize))) );
+                    return cell;
+                }
+
+                //! \brief The tile, whose core contains \p pos.
+                inline int owner( Position const& pos ) const { return this->id( this->cellOf(pos) ); }
+
+                //! \brief Lists the tiles, whose core grown by the overlap contains \p pos, the owner included.
+                inline void tilesOf( std::vector<int> &tiles, Position const& pos ) const
+                {
+                    tiles.clear();
+                    Eigen::Vector3i lo, hi;
+                    for ( int d = 0; d != 3; ++d )
+                    {
+                        lo(d) = std::min( _counts(d) - 1, std::max(0, int(std::floor((pos(d) - _overlap - _min(d)) / _tileSize))) );
+                        hi(d) = std::min( _counts(d) - 1, std::max(0, int(std::floor((pos(d) + _overlap - _min(d)) / _tileSize))) );
+                    }
+                    for ( int z = lo(2); z <= hi(2); ++z )
+                        for ( int y = lo(1); y <= hi(1); ++y )
+                            for ( int x = lo(0); x <= hi(0); ++x )
+                                tiles.push_back( this->id(Eigen::Vector3i(x,y,z)) );
+                }
+
+                /*! \brief Distance of \p pos to the closest face of \p tile's core, that is shared with another tile.
+                 *         Faces on the bounding box are ignored, infinite for a single tile.
+                 */
+                inline _Scalar distanceToSeam( int const tile, Position const& pos ) const
+                {
+                    const Eigen::Vector3i c = this->cell( tile );
+                    _Scalar dist = std::numeric_limits<_Scalar>::max();
+                    for ( int d = 0; d != 3; ++d )
+                    {
+                        const _Scalar lo = _min(d) + c(d) * _tileSize;
+                        if ( c(d) > 0 )              dist = std::min( dist, std::abs(pos(d) - lo) );
+                        if ( c(d) + 1 < _counts(d) ) dist = std::min( dist, std::abs(lo + _tileSize - pos(d)) );
+                    }
+                    return dist;
+                }
+
+            protected:
+                Position        _min;
+                _Scalar         _tileSize;
+                _Scalar         _overlap;
+                Eigen::Vector3i _counts;    //!< \brief Number of tiles along each axis.
+        }; //...class Tiling
+    } //...ns processing
+} //...ns rapter
+
+#endif // RAPTER_TILING_H
@@ -8,6 +8,7 @@
 #include "Eigen/Dense"
 #include "rapter/util/containers.hpp" // add()
 #include "rapter/simpleTypes.h"      // GidT
+#include "rapter/processing/populationIndex.hpp" // PopulationIndex
 #include "pcl/search/kdtree.h"
 #include "rapter/simpleTypes.h"
 
@@ -51,19 +52,15 @@ namespace rapter {
         *   \param[out] populations Contains an int value for each GID that occurred in points. The value is the count, how many points had this GID.
         *   \param[in]  points      The points containing gids retrievable by \code points[pid].getTag( _PointPrimitiveT::TAGS::GID ) \endcode.
         *   \return                 EXIT_SUCCESS
+        *   \sa \ref PopulationIndex, to keep the populations around, and look them up without a map.
         */
         template <class _GidIntSetMap, class _PointContainerT > inline int
         getPopulations( _GidIntSetMap & populations, _PointContainerT const& points )
         {
-            typedef typename _PointContainerT::value_type _PointPrimitiveT;
-
-            for ( size_t pid = 0; pid != points.size(); ++pid )
-            {
-                const GidT gid = points[pid].getTag( _PointPrimitiveT::TAGS::GID );
-                containers::add( populations, gid, static_cast<PidT>(pid) );
-            }
-
-            return EXIT_SUCCESS;
+            // counting sort instead of a map lookup per point
+            PopulationIndex index;
+            index.build( points );
+            return index.getPopulations( populations );
         } //...getPopulations
 
         /*! \brief Calculate the number of points that are assigned to the GID (group id).
@@ -74,6 +71,7 @@ namespace rapter {
          *  \param[in]  gid         The group id to look for.
          *  \param[in]  points      The points containing gids retrievable by \code points[pid].getTag( _PointPrimitiveT::TAGS::GID ) \endcode.
          *  \return                 Number of points assigned to \p gid.
+         *  \note                   Scans all points, use \ref PopulationIndex::getPopulationOf for repeated lookups.
          */
         template <class _PidContainerT, class _PointContainerT > inline int
         getPopulationOf( _PidContainerT & population, GidT const gid, _PointContainerT const& points )
@@ -7,6 +7,7 @@
 #include "rapter/primitives/linePrimitive.h"
 #include "rapter/primitives/planePrimitive.h"
 #include "rapter/primitives/pointPrimitive.h"
+#include "rapter/primitives/pointPrimitiveSoA.h"
 #include "rapter/optimization/energyFunctors.h"
 #include "rapter/util/containers.hpp"
 
@@ -17,6 +18,7 @@ namespace rapter
     typedef __Scalar Scalar;
     //typedef PrimitiveVectorT< PointPrimitiveT > PointContainerT;
     typedef PointPrimitiveVector PointContainerT;
+    typedef PointPrimitiveSoA    PointContainerSoAT; //!< \brief Structure-of-arrays layout of PointContainerT, for scans.
 
     namespace _2d
     {
@@ -0,0 +1,53 @@
+#ifndef RAPTER_BENCH_H
+#define RAPTER_BENCH_H
+
+#include <chrono>
+#include <vector>
+#include <limits>
+#include <cmath>        // abs, isinf
+#include <algorithm>    // max
+#include <cstdlib>      // rand
+
+namespace rapter
+{
+    //! \brief Helpers shared by the --bench-* entry points in src/bench*.cpp.
+    namespace bench
+    {
+        typedef std::chrono::system_clock ClockT;
+
+        //! \brief Uniform random in [-1,1].
+        template <typename _Scalar>
+        inline _Scalar unitRand() { return _Scalar(2) * _Scalar(rand()) / _Scalar(RAND_MAX) - _Scalar(1); }
+
+        //! \brief Uniform random in [0,1].
+        inline double uniformRand() { return double(rand()) / double(RAND_MAX); }
+
+        //! \brief Start time for \ref secondsSince.
+        inline ClockT::time_point now() { return ClockT::now(); }
+
+        //! \brief Wall clock seconds elapsed since \p start.
+        inline double secondsSince( ClockT::time_point const& start ) { return std::chrono::duration<double>( ClockT::now() - start ).count(); }
+
+        //! \brief Difference of \p b to \p a, relative to max(1,|a|), max(), if only one of them is infinite.
+        inline double relDiff( double const a, double const b )
+        {
+            if ( a == b )                           return 0.;
+            if ( std::isinf(a) || std::isinf(b) )   return std::numeric_limits<double>::max();
+            return std::abs( a - b ) / std::max( 1., std::abs(a) );
+        }
+
+        //! \brief Largest absolute difference of the entries of \p a and \p b, infinite, if they differ in size.
+        template <typename _Scalar>
+        inline _Scalar maxAbsDiff( std::vector<_Scalar> const& a, std::vector<_Scalar> const& b )
+        {
+            if ( a.size() != b.size() )
+                return std::numeric_limits<_Scalar>::infinity();
+            _Scalar diff( 0 );
+            for ( size_t i = 0; i != a.size(); ++i )
+                diff = std::max( diff, _Scalar(std::abs(a[i] - b[i])) );
+            return diff;
+        }
+    } //...ns bench
+} //...ns rapter
+
+#endif // RAPTER_BENCH_H
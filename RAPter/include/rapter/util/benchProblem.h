@@ -0,0 +1,112 @@
+#ifndef RAPTER_BENCHPROBLEM_H
+#define RAPTER_BENCHPROBLEM_H
+
+#include <iostream>
+#include <vector>
+#include <algorithm>                                    // min
+#include <cstdio>                                       // sprintf
+#include <cstdlib>                                      // rand
+
+#include "qcqpcpp/optProblem.h"                         // OptProblem
+#include "rapter/util/parse.h"                          // rapter::console
+#include "rapter/util/bench.h"                          // uniformRand
+
+namespace rapter
+{
+    namespace bench
+    {
+        typedef qcqpcpp::OptProblem<double> BenchProblemT;
+
+        //! \brief Size and shape of \ref randomProblem, parsed from the same options by every bench that uses it.
+        struct RandomProblemParams
+        {
+            int  n           = 200000;  //!< \brief Variables.
+            int  perVar      = 4;       //!< \brief Random Qo entries per variable, besides the diagonal one.
+            int  m           = 50000;   //!< \brief Linear constraints.
+            int  perRow      = 8;       //!< \brief Variables per linear constraint.
+            int  quad        = 16;      //!< \brief Constraints, from the first one, that get quadratic entries.
+            int  perQuad     = 64;      //!< \brief Quadratic entries per quadratic constraint.
+            //! \brief Cycle variables and constraints through every bound type with random bounds, instead of variables in [0,1] and constraints >= 1.
+            bool allBounds   = false;
+            //! \brief Cycle variables through binary, integer and continuous, instead of binary only.
+            bool allVarTypes = false;
+
+            //! \brief Reads -n, --per-var, -m, --per-row, --quad and --per-quad.
+            inline void parse( int argc, char** argv )
+            {
+                rapter::console::parse_argument( argc, argv, "-n"        , n );
+                rapter::console::parse_argument( argc, argv, "--per-var" , perVar );
+                rapter::console::parse_argument( argc, argv, "-m"        , m );
+                rapter::console::parse_argument( argc, argv, "--per-row" , perRow );
+                rapter::console::parse_argument( argc, argv, "--quad"    , quad );
+                rapter::console::parse_argument( argc, argv, "--per-quad", perQuad );
+            }
+
+            //! \brief The options of \ref parse, with their values, for a usage line.
+            inline void printUsage( std::ostream & os ) const
+            {
+                os << "[-n " << n << "] [--per-var " << perVar << "] [-m " << m << "] [--per-row " << perRow
+                   << "] [--quad " << quad << "] [--per-quad " << perQuad << "]";
+            }
+        };
+
+        /*! \brief Builds a random problem shaped by \p params: variables with a linear, a diagonal and \p params.perVar random Qo entries each,
+         *         constraints over \p params.perRow variables, the first \p params.quad of them with quadratic entries, an objective bias,
+         *         variable names and a binary starting point.
+         *  \note  Qo entries are added after all variables, OptProblem drops entries of variables it does not have yet.
+         */
+        inline void randomProblem( BenchProblemT & problem, RandomProblemParams const& params )
+        {
+            const BenchProblemT::BOUND    bounds[] = { BenchProblemT::BOUND::RANGE, BenchProblemT::BOUND::GREATER_EQ, BenchProblemT::BOUND::LESS_EQ, BenchProblemT::BOUND::EQUAL, BenchProblemT::BOUND::FREE };
+            const BenchProblemT::VAR_TYPE types [] = { BenchProblemT::VAR_TYPE::BINARY, BenchProblemT::VAR_TYPE::INTEGER, BenchProblemT::VAR_TYPE::CONTINUOUS };
+            const int n = params.n, m = params.m;
+
+            for ( int j = 0; j != n; ++j )
+            {
+                char name[32];
+                sprintf( name, "var_%d", j );
+                const double lower = params.allBounds ? double(rand() % 100) / 8.         : 0.;
+                const double upper = params.allBounds ? lower + double(rand() % 100) / 8. : 1.;
+                problem.addVariable( params.allBounds   ? bounds[j % 5] : BenchProblemT::BOUND::RANGE, lower, upper
+                                   , params.allVarTypes ? types [j % 3] : BenchProblemT::VAR_TYPE::BINARY, BenchProblemT::LINEARITY::LINEAR, name );
+            }
+            for ( int j = 0; j != n; ++j )
+            {
+                problem.addLinObjective( j, uniformRand() - .5 );
+                problem.addQObjective( j, j, uniformRand() );
+                for ( int k = 0; k != params.perVar; ++k )
+                    problem.addQObjective( j, rand() % n, uniformRand() - .5 );
+            }
+            problem.setObjectiveBias( 3.25 );
+
+            std::vector< Eigen::Triplet<double> > entries;
+            for ( int i = 0; i != m; ++i )
+            {
+                if ( params.allBounds )
+                {
+                    const BenchProblemT::BOUND bound = bounds[i % 5];
+                    const double               upper = 1. + double(rand() % 8);
+                    problem.addConstraint( bound, -1., (bound == BenchProblemT::BOUND::EQUAL) ? -1. : upper );
+                }
+                else
+                    problem.addConstraint( BenchProblemT::BOUND::GREATER_EQ, 1., problem.getINF() );
+                for ( int k = 0; k != params.perRow; ++k )
+                    entries.push_back( Eigen::Triplet<double>(i, rand() % n, uniformRand()) );
+            }
+            BenchProblemT::SparseMatrix A( m, n );
+            A.setFromTriplets( entries.begin(), entries.end() );
+            problem.addLinConstraints( A );
+
+            for ( int i = 0; i != std::min(params.quad, m); ++i )
+                for ( int k = 0; k != params.perQuad; ++k )
+                    problem.addQConstraint( i, rand() % n, rand() % n, uniformRand() - .5 );
+
+            BenchProblemT::VectorX x0( n );
+            for ( int j = 0; j != n; ++j )
+                x0( j ) = rand() % 2;
+            problem.setStartingPointDense( x0 );
+        } //...randomProblem()
+    } //...ns bench
+} //...ns rapter
+
+#endif // RAPTER_BENCHPROBLEM_H
@@ -0,0 +1,131 @@
+#include <iostream>
+#include <vector>
+#include <cstdlib>                                      // srand
+
+#include "rapter/typedefs.h"                            // _3d::PrimitiveT
+#include "rapter/util/parse.h"                          // rapter::console
+#include "rapter/util/bench.h"                          // unitRand, secondsSince
+#include "rapter/optimization/energyFunctors.h"         // MyPrimitivePrimitiveAngleFunctor
+#include "rapter/processing/angleLookup.h"
+#include "rapter/primitives/impl/planePrimitive.hpp"    // PlanePrimitive( pos, dir )
+
+namespace rapter
+{
+    namespace bench
+    {
+        //! \brief {0, gen, 2*gen, ...} below 180 degrees, in radians.
+        inline std::vector<Scalar> anglesFromGenerator( Scalar const genDeg )
+        {
+            std::vector<Scalar> angles;
+            for ( Scalar angle = 0; angle < M_PI; angle += genDeg * Scalar(M_PI / 180.) )
+                angles.push_back( angle );
+            return angles;
+        }
+
+        /*! \brief Directions to sweep: random ones, zero, parallel and antiparallel ones,
+         *         and ones at, and just off each allowed angle from \p dir0.
+         */
+        inline void sweepDirections( std::vector<_3d::PrimitiveT> & prims, Eigen::Matrix<Scalar,3,1> const& dir0, std::vector<Scalar> const& angles, int const n )
+        {
+            typedef Eigen::Matrix<Scalar,3,1> Position;
+
+            prims.clear();
+            prims.push_back( _3d::PrimitiveT(Position::Zero(), Position::Zero()) );
+            prims.push_back( _3d::PrimitiveT(Position::Zero(),  dir0) );
+            prims.push_back( _3d::PrimitiveT(Position::Zero(), -dir0) );
+
+            const Position axis = dir0.unitOrthogonal();
+            const Scalar   offsets[] = { 0., 1.e-7, -1.e-7, 1.e-4, -1.e-4, 1.e-2, -1.e-2 };
+            for ( size_t i = 0; i != angles.size(); ++i )
+                for ( size_t o = 0; o != sizeof(offsets) / sizeof(Scalar); ++o )
+                    prims.push_back( _3d::PrimitiveT(Position::Zero(), Eigen::AngleAxis<Scalar>(angles[i] + offsets[o], axis) * dir0) );
+
+            while ( prims.size() < size_t(n) )
+                prims.push_back( _3d::PrimitiveT(Position::Zero(), Position(unitRand<Scalar>(), unitRand<Scalar>(), unitRand<Scalar>())) );
+        }
+    } //...ns bench
+} //...ns rapter
+
+/*! \brief Checks \ref rapter::processing::AngleLookup against \ref rapter::MyPrimitivePrimitiveAngleFunctor::eval() over a sweep of directions
+ *         and angle generators, and times both.
+ *  \return EXIT_FAILURE, if a difference exceeds the tolerance, or the closest angle ids differ other than between equally close angles.
+ */
+int benchAngles( int argc, char** argv )
+{
+    using rapter::Scalar;
+    typedef rapter::_3d::PrimitiveT         PrimitiveT;
+    typedef Eigen::Matrix<Scalar,3,1>       Position;
+
+    int     n         = 200000;
+    int     bins      = 4096;
+    Scalar  tolerance = 1.e-6;
+    rapter::console::parse_argument( argc, argv, "-n"    , n );
+    rapter::console::parse_argument( argc, argv, "--bins", bins );
+    rapter::console::parse_argument( argc, argv, "--tol" , tolerance );
+    std::cout << "[" << __func__ << "]: " << "Usage: --bench-angles [-n " << n << "] [--bins " << bins << "] [--tol " << tolerance << "]" << std::endl;
+
+    srand( 0 );
+    const Scalar gens[] = { 90., 60., 45., 30., 15., 5., 1. };
+    bool ok = true;
+    std::cout << "gen_deg,angles,pairs,max_diff,id_mismatches,exact_sec,lookup_sec,batch_sec" << std::endl;
+    for ( size_t g = 0; g != sizeof(gens) / sizeof(Scalar); ++g )
+    {
+        const std::vector<Scalar> angles = rapter::bench::anglesFromGenerator( gens[g] );
+        const rapter::processing::AngleLookup<Scalar> lookup( angles, bins );
+
+        const PrimitiveT prim0( Position::Zero(), Position(rapter::bench::unitRand<Scalar>(), rapter::bench::unitRand<Scalar>(), rapter::bench::unitRand<Scalar>()).normalized() );
+        std::vector<PrimitiveT> prims;
+        rapter::bench::sweepDirections( prims, prim0.dir(), angles, n );
+
+        // exact
+        std::vector<Scalar> exact( prims.size() );
+        std::vector<int>    exactIds( prims.size() );
+        rapter::bench::ClockT::time_point start = rapter::bench::now();
+        for ( size_t i = 0; i != prims.size(); ++i )
+            exact[i] = rapter::MyPrimitivePrimitiveAngleFunctor::eval( prim0, prims[i], angles, &exactIds[i] );
+        const double exactTime = rapter::bench::secondsSince( start );
+
+        // lookup, one by one
+        std::vector<Scalar> fast( prims.size() );
+        std::vector<int>    fastIds( prims.size() );
+        start = rapter::bench::now();
+        for ( size_t i = 0; i != prims.size(); ++i )
+            fast[i] = rapter::MyPrimitivePrimitiveAngleFunctor::eval( prim0, prims[i], lookup, &fastIds[i] );
+        const double lookupTime = rapter::bench::secondsSince( start );
+
+        // lookup, batched
+        rapter::processing::kernels::PositionArrays<Scalar> dirs;
+        dirs.resize( prims.size() );
+        for ( size_t i = 0; i != prims.size(); ++i )
+        {
+            const Position dir = prims[i].dir();
+            dirs.x[i] = dir(0); dirs.y[i] = dir(1); dirs.z[i] = dir(2);
+        }
+        std::vector<Scalar> batch;
+        std::vector<int>    batchIds;
+        start = rapter::bench::now();
+        rapter::MyPrimitivePrimitiveAngleFunctor::evalBatch( batch, prim0, dirs, lookup, &batchIds );
+        const double batchTime = rapter::bench::secondsSince( start );
+
+        const Scalar maxDiff    = std::max( rapter::bench::maxAbsDiff(exact, fast), rapter::bench::maxAbsDiff(exact, batch) );
+        int          mismatches = 0;
+        for ( size_t i = 0; i != prims.size(); ++i )
+        {
+            // a different id is only fine, if the two angles are equally close
+            if ( (fastIds[i] != exactIds[i] || batchIds[i] != exactIds[i])
+                 && (std::abs(fast[i] - exact[i]) > tolerance || std::abs(batch[i] - exact[i]) > tolerance
+                     || std::abs(std::abs(angles[fastIds[i]] - angles[exactIds[i]]) - Scalar(2.) * exact[i]) > tolerance) )
+                ++mismatches;
+        }
+        ok &= (maxDiff <= tolerance) && !mismatches;
+
+        std::cout << gens[g] << "," << angles.size() << "," << prims.size() << "," << maxDiff << "," << mismatches << ","
+                  << exactTime << "," << lookupTime << "," << batchTime << std::endl;
+    }
+
+    const rapter::processing::AngleLookup<Scalar> lookup( rapter::bench::anglesFromGenerator(1.), bins );
+    std::cout << "[" << __func__ << "]: " << "interpolation error bound at " << bins << " bins: " << lookup.maxInterpolationError()
+              << ", " << (ok ? "all within " : "NOT within ") << tolerance << std::endl;
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+} //...benchAngles()
@@ -0,0 +1,104 @@
+#include <iostream>
+#include <vector>
+#include <cstdlib>                                      // srand
+
+#include "qcqpcpp/optProblem.h"                         // OptProblem
+#include "rapter/util/parse.h"                          // rapter::console
+#include "rapter/util/bench.h"                          // uniformRand, secondsSince, maxAbsDiff
+#include "rapter/util/benchProblem.h"                   // randomProblem
+
+namespace rapter
+{
+    namespace bench
+    {
+        //! \brief Copies the values of \p mx in row-major order to \p values, as the solver callbacks did before the patterns were precomputed.
+        inline void copyValues( std::vector<double> & values, qcqpcpp::OptProblem<double>::SparseMatrix const& mx )
+        {
+            values.resize( mx.nonZeros() );
+            size_t entry_id = 0;
+            for ( int row = 0; row != mx.outerSize(); ++row )
+                for ( qcqpcpp::OptProblem<double>::SparseMatrix::InnerIterator it(mx,row); it; ++it, ++entry_id )
+                    values[ entry_id ] = it.value();
+        }
+    } //...ns bench
+} //...ns rapter
+
+/*! \brief Times the Jacobian and Hessian callbacks of the Bonmin interface: assembling sparse matrices per call (getJacobian, getHessian),
+ *         against filling values into the precomputed sparsity patterns (fillJacobian, fillHessian), and checks that both give the same values.
+ *  \return EXIT_FAILURE, if patterns or values differ.
+ */
+int benchHessian( int argc, char** argv )
+{
+    typedef qcqpcpp::OptProblem<double> OptProblemT;
+
+    rapter::bench::RandomProblemParams params; // binary variables, constraints >= 1, as a selection problem
+    int    iters   = 20;
+    double tol     = 1.e-9;
+    params.parse( argc, argv );
+    rapter::console::parse_argument( argc, argv, "--iters"   , iters );
+    std::cout << "[" << __func__ << "]: " << "Usage: --bench-hessian ";
+    params.printUsage( std::cout );
+    std::cout << " [--iters " << iters << "]" << std::endl;
+
+    srand( 0 );
+    const int n = params.n, m = params.m;
+    OptProblemT problem;
+    rapter::bench::randomProblem( problem, params );
+
+    rapter::bench::ClockT::time_point start = rapter::bench::now();
+    problem.precalcJacobianSparsity();
+    problem.precalcHessianCoeffs();
+    const double precalcTime = rapter::bench::secondsSince( start );
+
+    OptProblemT::VectorX x( n ), lambdas( m );
+    for ( int j = 0; j != n; ++j ) x(j)       = rapter::bench::uniformRand();
+    for ( int i = 0; i != m; ++i ) lambdas(i) = rapter::bench::uniformRand();
+    const double objFactor = .5;
+
+    // per call assembly
+    std::vector<double> jacOld, hessOld;
+    OptProblemT::SparseMatrix jacobian, hessian;
+    start = rapter::bench::now();
+    for ( int it = 0; it != iters; ++it )
+    {
+        jacobian = problem.getJacobian( x );
+        rapter::bench::copyValues( jacOld, jacobian );
+        hessian  = problem.getHessian( objFactor, lambdas );
+        rapter::bench::copyValues( hessOld, hessian );
+    }
+    const double oldTime = rapter::bench::secondsSince( start );
+
+    // in place
+    std::vector<double> jacNew( problem.getJacobianNonZeros() ), hessNew( problem.getHessianNonZeros() );
+    start = rapter::bench::now();
+    for ( int it = 0; it != iters; ++it )
+    {
+        problem.fillJacobian( jacNew.data(), x.data() );
+        problem.fillHessian ( hessNew.data(), objFactor, lambdas.data() );
+    }
+    const double newTime = rapter::bench::secondsSince( start );
+
+    // compare patterns and values
+    bool ok = (jacOld.size() == jacNew.size()) && (hessOld.size() == hessNew.size());
+    double maxDiff = 0.;
+    if ( ok )
+    {
+        size_t entry_id = 0;
+        for ( int row = 0; row != jacobian.outerSize(); ++row )
+            for ( OptProblemT::SparseMatrix::InnerIterator it(jacobian,row); it; ++it, ++entry_id )
+                ok &= (problem.getJacobianRows()[entry_id] == it.row()) && (problem.getJacobianCols()[entry_id] == it.col());
+        entry_id = 0;
+        for ( int row = 0; row != hessian.outerSize(); ++row )
+            for ( OptProblemT::SparseMatrix::InnerIterator it(hessian,row); it; ++it, ++entry_id )
+                ok &= (problem.getHessianRows()[entry_id] == it.row()) && (problem.getHessianCols()[entry_id] == it.col());
+        maxDiff = std::max( rapter::bench::maxAbsDiff(jacOld, jacNew), rapter::bench::maxAbsDiff(hessOld, hessNew) );
+        ok &= maxDiff <= tol;
+    }
+
+    std::cout << "vars,constraints,jac_nnz,hess_nnz,precalc_sec,assemble_callbacks_per_sec,fill_callbacks_per_sec,max_diff" << std::endl;
+    std::cout << n << "," << m << "," << jacNew.size() << "," << hessNew.size() << "," << precalcTime << ","
+              << iters / oldTime << "," << iters / newTime << "," << maxDiff << std::endl;
+    std::cout << "[" << __func__ << "]: " << (ok ? "patterns and values match" : "patterns or values DIFFER") << std::endl;
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+} //...benchHessian()
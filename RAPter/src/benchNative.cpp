@@ -0,0 +1,207 @@
+#include <iostream>
+#include <vector>
+#include <map>
+#include <limits>
+#include <cmath>                                        // abs
+#include <algorithm>                                    // min, max
+#include <cstdlib>                                      // srand, rand
+
+#include "qcqpcpp/localSearchOptProblem.h"              // LocalSearchOpt
+#include "rapter/util/parse.h"                          // rapter::console
+#include "rapter/util/bench.h"                          // secondsSince
+
+namespace rapter
+{
+    namespace bench
+    {
+        typedef qcqpcpp::OptProblem<double> NativeProblemT;
+
+        /*! \brief Builds a problem shaped as \ref ProblemSetup::formulate2 formulates it: \p patches patches with 1..\p maxCands candidates each,
+         *         every candidate has one of \p dirs directions. Candidates carry data costs, directions complexity costs and pairwise costs to each other,
+         *         every patch selects a candidate (sum >= 1), and a selected candidate needs its direction (-sum x_c + sum x_c * x_d >= 0).
+         */
+        inline void randomSelectionProblem( NativeProblemT & problem, int const patches, int const maxCands, int const dirs )
+        {
+            std::vector< std::vector<int> > patchVars( patches );
+            std::map< int, std::vector<int> > dirVars;  // dir -> candidate vars
+            for ( int patch = 0; patch != patches; ++patch )
+            {
+                const int cands = 1 + rand() % maxCands;
+                for ( int c = 0; c != cands; ++c )
+                {
+                    const int var = problem.addVariable( NativeProblemT::BOUND::RANGE, 0., 1., NativeProblemT::VAR_TYPE::INTEGER );
+                    problem.addLinObjective( var, double(rand() % 1000) / 10. );
+                    patchVars[patch].push_back( var );
+                    dirVars[ rand() % dirs ].push_back( var );
+                }
+            }
+
+            std::vector<int> dirIds;
+            for ( auto it = dirVars.begin(); it != dirVars.end(); ++it )
+            {
+                dirIds.push_back( problem.addVariable(NativeProblemT::BOUND::RANGE, 0., 1., NativeProblemT::VAR_TYPE::BINARY) );
+                problem.addLinObjective( dirIds.back(), double(rand() % 200) / 10. );
+            }
+
+            // direction pairwise costs, both ways, as formulate2
+            for ( size_t i = 0; i < dirIds.size(); ++i )
+                for ( size_t j = i + 1; j < dirIds.size(); ++j )
+                    if ( rand() % 4 )
+                    {
+                        const double score = double(rand() % 100) / 10.;
+                        problem.addQObjective( dirIds[i], dirIds[j], score + score );
+                    }
+
+            // patch constraints
+            for ( int patch = 0; patch != patches; ++patch )
+            {
+                NativeProblemT::SparseMatrix coeffs( 1, problem.getVarCount() );
+                for ( size_t k = 0; k != patchVars[patch].size(); ++k )
+                    coeffs.insert( 0, patchVars[patch][k] ) = 1.;
+                problem.addConstraint( NativeProblemT::BOUND::GREATER_EQ, 1., problem.getINF(), &coeffs );
+            }
+
+            // direction constraints
+            int dir = 0;
+            for ( auto it = dirVars.begin(); it != dirVars.end(); ++it, ++dir )
+            {
+                const int constraintId = problem.getConstraintCount();
+                NativeProblemT::SparseMatrix coeffs( 1, problem.getVarCount() );
+                for ( size_t k = 0; k != it->second.size(); ++k )
+                    coeffs.insert( 0, it->second[k] ) = -1.;
+                problem.addConstraint( NativeProblemT::BOUND::GREATER_EQ, 0., problem.getINF(), &coeffs );
+                for ( size_t k = 0; k != it->second.size(); ++k )
+                    problem.addQConstraint( constraintId, it->second[k], dirIds[dir], 1. );
+            }
+        } //...randomSelectionProblem()
+
+        /*! \brief Objective (x' * Qo * x + qo' * x, from the entry lists) and feasibility of the binary point \p x.
+         *  \return True, if \p x satisfies all constraints.
+         */
+        inline bool evalBinary( double & objective, NativeProblemT const& problem, std::vector<double> const& x, double const tol = 1e-6 )
+        {
+            typedef NativeProblemT::SparseEntries SparseEntries;
+
+            objective = problem.getObjectiveBias();
+            for ( size_t j = 0; j != problem.getLinObjectives().size(); ++j )
+                objective += problem.getLinObjectives()[j] * x[j];
+            SparseEntries const& Qo = problem.getQuadraticObjectives();
+            for ( SparseEntries::const_iterator it = Qo.begin(); it != Qo.end(); ++it )
+                objective += it->value() * x[it->row()] * x[it->col()];
+
+            std::vector<double> c( problem.getConstraintCount(), 0. );
+            SparseEntries const& A = problem.getLinConstraints();
+            for ( SparseEntries::const_iterator it = A.begin(); it != A.end(); ++it )
+                c[ it->row() ] += it->value() * x[ it->col() ];
+            for ( size_t i = 0; i != c.size(); ++i )
+            {
+                if ( i < problem.getQuadraticConstraints().size() )
+                {
+                    SparseEntries const& Qi = problem.getQuadraticConstraints( i );
+                    for ( SparseEntries::const_iterator it = Qi.begin(); it != Qi.end(); ++it )
+                        c[i] += it->value() * x[it->row()] * x[it->col()];
+                }
+
+                const NativeProblemT::BOUND bound = problem.getConstraintBoundType( i );
+                const bool hasLower = (bound == NativeProblemT::BOUND::GREATER_EQ) || (bound == NativeProblemT::BOUND::RANGE) || (bound == NativeProblemT::BOUND::EQUAL);
+                const bool hasUpper = (bound == NativeProblemT::BOUND::LESS_EQ   ) || (bound == NativeProblemT::BOUND::RANGE) || (bound == NativeProblemT::BOUND::EQUAL);
+                if ( (hasLower && (c[i] < problem.getConstraintLowerBound(i) - tol)) || (hasUpper && (c[i] > problem.getConstraintUpperBound(i) + tol)) )
+                    return false;
+            }
+
+            return true;
+        } //...evalBinary()
+
+        /*! \brief Optimum of the binary problem \p problem by enumerating all 2^n points.
+         *  \return False, if no point is feasible.
+         */
+        inline bool bruteForce( double & optimum, NativeProblemT const& problem )
+        {
+            const size_t n = problem.getVarCount();
+            std::vector<double> x( n, 0. );
+            double objective;
+            optimum = std::numeric_limits<double>::max();
+            for ( unsigned long code = 0; code != (1ul << n); ++code )
+            {
+                for ( size_t j = 0; j != n; ++j )
+                    x[j] = double( (code >> j) & 1ul );
+                if ( evalBinary(objective, problem, x) && (objective < optimum) )
+                    optimum = objective;
+            }
+            return optimum != std::numeric_limits<double>::max();
+        } //...bruteForce()
+    } //...ns bench
+} //...ns rapter
+
+/*! \brief Checks qcqpcpp::LocalSearchOpt (--solver native) on small formulate2 shaped problems against their brute force optima.
+ *         The solver is a heuristic, more problems or larger ones may need more --restarts, the pipeline gives it 8 per attempt.
+ *  \return EXIT_FAILURE, if the native solver's output is infeasible, or worse than the optimum, on any of the problems.
+ */
+int benchNative( int argc, char** argv )
+{
+    using rapter::bench::NativeProblemT;
+
+    int    problems = 40;
+    int    patches  = 6;
+    int    cands    = 3;
+    int    dirs     = 6;
+    int    restarts = 8;
+    double tol      = 1.e-6;
+    rapter::console::parse_argument( argc, argv, "--problems", problems );
+    rapter::console::parse_argument( argc, argv, "--patches" , patches );
+    rapter::console::parse_argument( argc, argv, "--cands"   , cands );
+    rapter::console::parse_argument( argc, argv, "--dirs"    , dirs );
+    rapter::console::parse_argument( argc, argv, "--restarts", restarts );
+    std::cout << "[" << __func__ << "]: " << "Usage: --bench-native [--problems " << problems << "] [--patches " << patches << "] [--cands " << cands
+              << "\t max per patch] [--dirs " << dirs << "] [--restarts " << restarts << "]" << std::endl;
+    if ( patches * cands + dirs > 24 )
+    {
+        std::cerr << "[" << __func__ << "]: " << "patches * cands + dirs has to be at most 24 to enumerate the problems" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    srand( 0 );
+    int    mismatches = 0;
+    size_t maxVars    = 0;
+    double bruteTime = 0., nativeTime = 0.;
+    for ( int problem_id = 0; problem_id != problems; ++problem_id )
+    {
+        NativeProblemT problem;
+        rapter::bench::randomSelectionProblem( problem, 1 + rand() % patches, cands, dirs );
+        maxVars = std::max( maxVars, problem.getVarCount() );
+
+        rapter::bench::ClockT::time_point start = rapter::bench::now();
+        double optimum;
+        if ( !rapter::bench::bruteForce(optimum, problem) )
+            continue; // formulate2 problems are always feasible, this one is too
+        bruteTime += rapter::bench::secondsSince( start );
+
+        qcqpcpp::LocalSearchOpt<double> native;
+        static_cast<NativeProblemT&>( native ) = problem;
+        native.setRestarts( restarts );
+        native.setSeed    ( problem_id );
+        std::vector<double> x;
+        start = rapter::bench::now();
+        int err = native.update();
+        if ( EXIT_SUCCESS == err )
+            err = native.optimize( &x, NativeProblemT::OBJ_SENSE::MINIMIZE );
+        nativeTime += rapter::bench::secondsSince( start );
+
+        double objective = std::numeric_limits<double>::max();
+        const bool ok = (native.getOkCode() == err) && (x.size() == problem.getVarCount())
+                        && rapter::bench::evalBinary( objective, problem, x )
+                        && (objective <= optimum + tol * std::max(1., std::abs(optimum)));
+        if ( !ok )
+        {
+            ++mismatches;
+            std::cerr << "[" << __func__ << "]: " << "problem " << problem_id << " (" << problem.getVarCount() << " vars): native E = " << objective
+                      << ", optimum " << optimum << std::endl;
+        }
+    }
+
+    std::cout << "problems,max_vars,brute_force_sec,native_sec,mismatches" << std::endl;
+    std::cout << problems << "," << maxVars << "," << bruteTime << "," << nativeTime << "," << mismatches << std::endl;
+    std::cout << "[" << __func__ << "]: " << (mismatches ? "native solver MISSED optima" : "native solver found every optimum") << std::endl;
+
+    return mismatches ? EXIT_FAILURE : EXIT_SUCCESS;
+} //...benchNative()
@@ -0,0 +1,195 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <limits>
+#include <algorithm>                                    // std::reverse
+#include <cstring>                                      // memcpy
+#include <cstdio>                                       // fopen
+#include <cstdlib>                                      // srand
+
+#include "omp.h"
+#include "boost/filesystem.hpp"
+
+#include "rapter/typedefs.h"                            // PointContainerT, PointPrimitiveT
+#include "rapter/util/parse.h"                          // rapter::console
+#include "rapter/util/bench.h"                          // unitRand, secondsSince
+#include "rapter/io/io.h"                               // PlyReader, readPoints
+
+namespace rapter
+{
+    namespace bench
+    {
+        /*! \brief Writes \p points as a PLY file of \p format, with a "red" vertex property and a face element around the vertices,
+         *         that the reader has to skip.
+         */
+        inline int writePly( std::string const& path, PointContainerT const& points, int const format )
+        {
+            FILE* f = fopen( path.c_str(), "wb" );
+            if ( !f ) { std::cerr << "[" << __func__ << "]: " << "could not open " << path << std::endl; return EXIT_FAILURE; }
+
+            const char* formats[] = { "ascii", "binary_little_endian", "binary_big_endian" };
+            fprintf( f, "ply\nformat %s 1.0\nelement vertex %lu\nproperty float x\nproperty float y\nproperty float z\nproperty uchar red\n"
+                        "property float nx\nproperty float ny\nproperty float nz\nelement face 1\nproperty list uchar int vertex_indices\nend_header\n"
+                   , formats[format], (unsigned long)points.size() );
+
+            const uint16_t probe = 1;
+            const bool     swap  = (format == io::PlyReader::BINARY_BIG_ENDIAN) == (*reinterpret_cast<char const*>(&probe) == 1);
+            for ( size_t pid = 0; pid != points.size(); ++pid )
+            {
+                float values[6];
+                for ( int d = 0; d != 3; ++d )
+                {
+                    values[ d     ] = points[pid].pos()(d);
+                    values[ d + 3 ] = points[pid].dir()(d);
+                }
+
+                if ( format == io::PlyReader::ASCII )
+                {
+                    fprintf( f, "%.9g %.9g %.9g 255 %.9g %.9g %.9g\n", values[0], values[1], values[2], values[3], values[4], values[5] );
+                    continue;
+                }
+
+                const unsigned char red = 255;
+                for ( int d = 0; d != 6; ++d )
+                {
+                    if ( d == 3 )
+                        fwrite( &red, 1, 1, f );
+                    char bytes[4];
+                    std::memcpy( bytes, values + d, 4 );
+                    if ( swap )
+                        std::reverse( bytes, bytes + 4 );
+                    fwrite( bytes, 1, 4, f );
+                }
+            }
+            // a face, that is not read
+            if ( format == io::PlyReader::ASCII )
+                fprintf( f, "3 0 1 2\n" );
+            else
+            {
+                const unsigned char n = 3;
+                const int32_t       ids[3] = { 0, 1, 2 };
+                fwrite( &n, 1, 1, f );
+                fwrite( ids, 4, 3, f );
+            }
+
+            fclose( f );
+            return EXIT_SUCCESS;
+        } //...writePly()
+
+        //! \brief Largest coordinate difference between \p a and \p b, infinite, if they differ in size or tags.
+        inline Scalar maxDifference( PointContainerT const& a, PointContainerT const& b )
+        {
+            if ( a.size() != b.size() )
+                return std::numeric_limits<Scalar>::infinity();
+            Scalar diff( 0 );
+            for ( size_t pid = 0; pid != a.size(); ++pid )
+            {
+                if ( b[pid].getTag(PointPrimitiveT::TAGS::PID) != PidT(pid) )
+                    return std::numeric_limits<Scalar>::infinity();
+                diff = std::max( diff, (a[pid].pos() - b[pid].pos()).cwiseAbs().maxCoeff() );
+                diff = std::max( diff, (a[pid].dir() - b[pid].dir()).cwiseAbs().maxCoeff() );
+            }
+            return diff;
+        }
+    } //...ns bench
+} //...ns rapter
+
+/*! \brief Writes a random cloud as ASCII, and little and big endian binary PLY, and reads each back with \ref rapter::io::PlyReader
+ *         single and multi threaded, and with PCL's loader, that \ref rapter::io::readPoints used before. Reports throughput and checks the points read.
+ *         With --cloud, times reading that file instead.
+ *  \return EXIT_FAILURE, if a file is not read back exactly.
+ */
+int benchPly( int argc, char** argv )
+{
+    using rapter::Scalar;
+    using rapter::PointContainerT;
+    using rapter::PointPrimitiveT;
+    typedef Eigen::Matrix<Scalar,3,1> Position;
+
+    long        n         = 2000000;
+    int         threads   = omp_get_max_threads();
+    std::string dir       = ".";
+    std::string cloudPath = "";
+    rapter::console::parse_argument( argc, argv, "-n"       , n );
+    rapter::console::parse_argument( argc, argv, "--threads", threads );
+    rapter::console::parse_argument( argc, argv, "--dir"    , dir );
+    rapter::console::parse_argument( argc, argv, "--cloud"  , cloudPath );
+    const bool withPcl = rapter::console::find_switch( argc, argv, "--pcl" );
+    const bool keep    = rapter::console::find_switch( argc, argv, "--keep" );
+    std::cout << "[" << __func__ << "]: " << "Usage: --bench-ply [-n " << n << "] [--threads " << threads << "] [--dir " << dir << "]"
+              << " [--cloud in.ply] [--pcl, also time PCL's loader] [--keep, keep the written files]" << std::endl;
+
+    std::vector<std::string> paths;
+    PointContainerT          reference;
+    if ( cloudPath.empty() )
+    {
+        srand( 0 );
+        reference.reserve( n );
+        for ( long pid = 0; pid != n; ++pid )
+        {
+            reference.push_back( PointPrimitiveT(Position(rapter::bench::unitRand<Scalar>(), rapter::bench::unitRand<Scalar>(), rapter::bench::unitRand<Scalar>()) * Scalar(100.),
+                                                 Position(rapter::bench::unitRand<Scalar>(), rapter::bench::unitRand<Scalar>(), rapter::bench::unitRand<Scalar>()).normalized()) );
+            reference.back().setTag( PointPrimitiveT::TAGS::PID, pid );
+        }
+
+        const char* names[] = { "bench_ascii.ply", "bench_binary_le.ply", "bench_binary_be.ply" };
+        for ( int format = 0; format != 3; ++format )
+        {
+            paths.push_back( dir + "/" + names[format] );
+            if ( EXIT_SUCCESS != rapter::bench::writePly(paths.back(), reference, format) )
+                return EXIT_FAILURE;
+        }
+    }
+    else
+        paths.push_back( cloudPath );
+
+    bool ok = true;
+    std::cout << "file,points,MB,reader,threads,sec,MB_per_sec,max_diff" << std::endl;
+    for ( size_t f = 0; f != paths.size(); ++f )
+    {
+        const double mb = boost::filesystem::file_size( paths[f] ) / 1048576.;
+        const int threadCounts[] = { 1, threads };
+        for ( int t = 0; t != (threads > 1 ? 2 : 1); ++t )
+        {
+            PointContainerT points;
+            const rapter::bench::ClockT::time_point start = rapter::bench::now();
+            rapter::io::PlyReader reader( threadCounts[t] );
+            int err = reader.open( paths[f] );
+            if ( EXIT_SUCCESS == err )
+                err = reader.read<PointPrimitiveT>( points );
+            const double readTime = rapter::bench::secondsSince( start );
+
+            const Scalar diff = reference.empty() ? Scalar(0) : rapter::bench::maxDifference( reference, points );
+            ok &= (EXIT_SUCCESS == err) && (diff <= Scalar(1.e-5));
+            std::cout << paths[f] << "," << points.size() << "," << mb << ",PlyReader," << threadCounts[t] << "," << readTime << ","
+                      << mb / readTime << "," << diff << std::endl;
+        }
+
+        if ( withPcl )
+        {
+            // what io::readPoints did before: PCL cloud, then a copy to the point container
+            PointContainerT points;
+            const rapter::bench::ClockT::time_point start = rapter::bench::now();
+            rapter::PclCloudPtrT cloud( new rapter::PclCloudT() );
+            pcl::io::loadPLYFile( paths[f], *cloud );
+            points.reserve( cloud->size() );
+            for ( size_t pid = 0; pid != cloud->size(); ++pid )
+            {
+                points.push_back( PointPrimitiveT(cloud->at(pid).getVector3fMap().cast<Scalar>(), cloud->at(pid).getNormalVector3fMap().cast<Scalar>()) );
+                points.back().setTag( PointPrimitiveT::TAGS::PID, pid );
+            }
+            const double readTime = rapter::bench::secondsSince( start );
+
+            const Scalar diff = reference.empty() ? Scalar(0) : rapter::bench::maxDifference( reference, points );
+            std::cout << paths[f] << "," << points.size() << "," << mb << ",pcl,1," << readTime << ","
+                      << mb / readTime << "," << diff << std::endl;
+        }
+    }
+
+    if ( cloudPath.empty() && !keep )
+        for ( size_t f = 0; f != paths.size(); ++f )
+            boost::filesystem::remove( paths[f] );
+
+    std::cout << "[" << __func__ << "]: " << (ok ? "all files read back" : "some files NOT read back") << std::endl;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+} //...benchPly()
@@ -0,0 +1,149 @@
+#include <iostream>
+#include <vector>
+#include <map>
+#include <string>
+#include <cstdlib>                                      // srand, rand
+#include <algorithm>                                    // equal
+
+#include "rapter/simpleTypes.h"                         // GidT, PidT
+#include "rapter/processing/populationIndex.hpp"        // PopulationIndex
+#include "rapter/util/parse.h"                          // rapter::console
+#include "rapter/util/bench.h"                          // secondsSince
+
+namespace rapter
+{
+    namespace bench
+    {
+        //! \brief The GID tag of a point, all \ref processing::PopulationIndex reads.
+        struct GidPoint
+        {
+            struct TAGS { enum { GID = 0 }; };
+            inline GidT getTag( int const /*key*/ ) const { return gid; }
+            inline void setTag( int const /*key*/, GidT const value ) { gid = value; }
+            GidT gid;
+        };
+
+        typedef std::map< GidT, std::vector<PidT> > PopulationMapT;
+
+        //! \brief Populations by a map insertion per point, as getPopulations did before the index.
+        inline void mapPopulations( PopulationMapT & populations, std::vector<GidPoint> const& points )
+        {
+            for ( size_t pid = 0; pid != points.size(); ++pid )
+                populations[ points[pid].getTag(GidPoint::TAGS::GID) ].push_back( pid );
+        }
+
+        //! \brief True, if \p index has exactly the populations of \p reference, in the same order.
+        inline bool samePopulations( processing::PopulationIndex const& index, PopulationMapT const& reference )
+        {
+            size_t count = 0;
+            for ( PopulationMapT::const_iterator it = reference.begin(); it != reference.end(); ++it )
+            {
+                if ( index.getPopulationSize(it->first) != static_cast<LidT>(it->second.size()) )
+                    return false;
+                if ( !std::equal(it->second.begin(), it->second.end(), index.begin(it->first)) )
+                    return false;
+                count += it->second.size();
+            }
+
+            PopulationMapT populations;
+            index.getPopulations( populations );
+            return (count == index.size()) && (populations == reference);
+        }
+
+        /*! \brief Builds the index of \p points, compares it against the map and prints a csv line.
+         *  \return False, if the populations differ.
+         */
+        inline bool runCase( std::string const& name, std::vector<GidPoint> const& points, processing::PopulationIndex & index )
+        {
+            ClockT::time_point start = now();
+            PopulationMapT reference;
+            mapPopulations( reference, points );
+            const double mapTime = secondsSince( start );
+
+            start = now();
+            index.build( points );
+            const double indexTime = secondsSince( start );
+
+            const bool ok = samePopulations( index, reference );
+            std::cout << name << "," << points.size() << "," << reference.size() << "," << index.isSparse() << "," << index.getSlotCount() << ","
+                      << mapTime << "," << indexTime << ",-,-," << (ok ? "ok" : "DIFFERS") << std::endl;
+            return ok;
+        }
+    } //...ns bench
+} //...ns rapter
+
+/*! \brief Checks and times \ref processing::PopulationIndex against populations in a map, on dense GIDs (patch ids), on sparse GIDs
+ *         (GID = point id, and tile offsets), and after random retags, enough of them to compact the id array.
+ *  \return EXIT_FAILURE, if any populations differ, if sparse GIDs get more slots than points, or if the retags did not compact.
+ */
+int benchPopulationIndex( int argc, char** argv )
+{
+    using rapter::bench::GidPoint;
+    using rapter::GidT;
+    using rapter::PidT;
+
+    long n      = 2000000;
+    int  gids   = 30000;
+    int  retags = 200000;
+    rapter::console::parse_argument( argc, argv, "-n"      , n );
+    rapter::console::parse_argument( argc, argv, "--gids"  , gids );
+    rapter::console::parse_argument( argc, argv, "--retags", retags );
+    std::cout << "[" << __func__ << "]: " << "Usage: --bench-population-index [-n " << n << "] [--gids " << gids << "] [--retags " << retags << "]" << std::endl;
+
+    srand( 0 );
+    bool ok = true;
+    rapter::processing::PopulationIndex index;
+    std::vector<GidPoint> points( n );
+    std::cout << "case,points,gids,sparse,slots,map_sec,index_sec,retags,compactions,check" << std::endl;
+
+    // sparse: every point its own patch, as before segmentation
+    for ( long pid = 0; pid != n; ++pid )
+        points[pid].setTag( GidPoint::TAGS::GID, pid );
+    ok &= rapter::bench::runCase( "gid_is_pid", points, index );
+    ok &= index.getSlotCount() <= size_t(n);
+
+    // sparse: patch ids of 16 tiles with large offsets
+    for ( long pid = 0; pid != n; ++pid )
+        points[pid].setTag( GidPoint::TAGS::GID, (GidT(pid % 16) << 40) + GidT(rand() % gids) );
+    ok &= rapter::bench::runCase( "tile_offsets", points, index );
+    ok &= index.isSparse() && (index.getSlotCount() <= size_t(n));
+
+    // dense: patch ids
+    for ( long pid = 0; pid != n; ++pid )
+        points[pid].setTag( GidPoint::TAGS::GID, rand() % gids );
+    ok &= rapter::bench::runCase( "dense", points, index );
+
+    // retags, some to new GIDs far away, check compaction and the populations
+    {
+        int    compactions = 0;
+        size_t capacity    = index.getCapacity();
+        const rapter::bench::ClockT::time_point start = rapter::bench::now();
+        for ( int r = 0; (r != retags) && n; ++r )
+        {
+            const PidT pid    = (PidT(rand()) * RAND_MAX + rand()) % n;
+            const GidT oldGid = points[pid].getTag( GidPoint::TAGS::GID );
+            const GidT newGid = (r % 1000) ? GidT(rand() % gids) : (GidT(1) << 32) + r;
+            ok &= EXIT_SUCCESS == index.retag( pid, oldGid, newGid );
+            points[pid].setTag( GidPoint::TAGS::GID, newGid );
+
+            compactions += index.getCapacity() < capacity;
+            capacity     = index.getCapacity();
+        }
+        const double retagTime = rapter::bench::secondsSince( start );
+
+        rapter::bench::PopulationMapT reference;
+        rapter::bench::mapPopulations( reference, points );
+        const bool same = rapter::bench::samePopulations( index, reference );
+        std::cout << "retag," << n << "," << reference.size() << "," << index.isSparse() << "," << index.getSlotCount() << ",-," << retagTime << ","
+                  << retags << "," << compactions << "," << (same ? "ok" : "DIFFERS") << std::endl;
+        ok &= same;
+        if ( !compactions )
+        {
+            std::cerr << "[" << __func__ << "]: " << "the retags did not compact the id array, raise --retags" << std::endl;
+            ok = false;
+        }
+    }
+
+    std::cout << "[" << __func__ << "]: " << (ok ? "populations match" : "populations DIFFER, or the index outgrew the points") << std::endl;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+} //...benchPopulationIndex()
@@ -0,0 +1,414 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <limits>
+#include <cmath>                                        // abs
+#include <algorithm>                                    // min, max
+#include <cstdlib>                                      // srand, strtod, strtoul
+#include <fstream>
+#include <sstream>
+
+#include "boost/filesystem.hpp"
+
+#include "qcqpcpp/optProblem.h"                         // OptProblem
+#include "rapter/util/parse.h"                          // rapter::console
+#include "rapter/util/bench.h"                          // unitRand, secondsSince, relDiff
+#include "rapter/util/benchProblem.h"                   // randomProblem
+
+namespace rapter
+{
+    namespace bench
+    {
+        typedef BenchProblemT IoProblemT;
+
+        //! \brief Largest difference of any bound, coefficient or starting point entry, max(), if types, counts or names differ.
+        inline double problemDiff( IoProblemT const& a, IoProblemT const& b, bool const checkNames )
+        {
+            const double different = std::numeric_limits<double>::max();
+            if ( (a.getVarCount() != b.getVarCount()) || (a.getConstraintCount() != b.getConstraintCount()) || (a.getQuadraticConstraints().size() != b.getQuadraticConstraints().size()) )
+                return different;
+
+            double diff = std::abs( a.getObjectiveBias() - b.getObjectiveBias() );
+            for ( size_t j = 0; j != a.getVarCount(); ++j )
+            {
+                if ( (a.getVarType(j) != b.getVarType(j)) || (a.getVarBoundType(j) != b.getVarBoundType(j)) || (checkNames && (a.getVarName(j) != b.getVarName(j))) )
+                    return different;
+                diff = std::max( diff, std::abs(a.getVarLowerBound(j) - b.getVarLowerBound(j)) );
+                diff = std::max( diff, std::abs(a.getVarUpperBound(j) - b.getVarUpperBound(j)) );
+                diff = std::max( diff, std::abs(a.getLinObjectives()[j] - b.getLinObjectives()[j]) );
+            }
+            for ( size_t i = 0; i != a.getConstraintCount(); ++i )
+            {
+                if ( a.getConstraintBoundType(i) != b.getConstraintBoundType(i) )
+                    return different;
+                diff = std::max( diff, std::abs(a.getConstraintLowerBound(i) - b.getConstraintLowerBound(i)) );
+                diff = std::max( diff, std::abs(a.getConstraintUpperBound(i) - b.getConstraintUpperBound(i)) );
+            }
+
+            IoProblemT::SparseMatrix mx = a.getQuadraticObjectivesMatrix() - b.getQuadraticObjectivesMatrix();
+            diff = std::max( diff, mx.coeffs().size() ? mx.coeffs().cwiseAbs().maxCoeff() : 0. );
+            mx = a.getLinConstraintsMatrix() - b.getLinConstraintsMatrix();
+            diff = std::max( diff, mx.coeffs().size() ? mx.coeffs().cwiseAbs().maxCoeff() : 0. );
+            for ( size_t i = 0; i != a.getQuadraticConstraints().size(); ++i )
+            {
+                mx = a.getQuadraticConstraintsMatrix(i) - b.getQuadraticConstraintsMatrix(i);
+                diff = std::max( diff, mx.coeffs().size() ? mx.coeffs().cwiseAbs().maxCoeff() : 0. );
+            }
+            if ( a.getStartingPoint().rows() != b.getStartingPoint().rows() )
+                return different;
+            if ( a.getStartingPoint().rows() )
+                diff = std::max( diff, (a.getStartingPoint() - b.getStartingPoint()).cwiseAbs().maxCoeff() );
+
+            return diff;
+        } //...problemDiff()
+
+        //! \brief Objective and constraint values of a problem at a point, and the constraint bounds, +-inf if unbounded.
+        struct ProblemValues
+        {
+            double              objective;
+            std::vector<double> rows, lower, upper;
+
+            inline void reset( size_t const m )
+            {
+                objective = 0.;
+                rows .assign( m, std::numeric_limits<double>::quiet_NaN() );
+                lower.assign( m, -std::numeric_limits<double>::infinity() );
+                upper.assign( m,  std::numeric_limits<double>::infinity() );
+            }
+        };
+
+        //! \brief Values of \p problem at \p x from its entry lists, as the solvers evaluate them (bias + q'x + x'Qo x, A x + x'Qi x).
+        inline void problemValues( ProblemValues & values, IoProblemT const& problem, std::vector<double> const& x )
+        {
+            typedef IoProblemT::SparseEntries SparseEntries;
+
+            values.reset( problem.getConstraintCount() );
+            values.objective = problem.getObjectiveBias();
+            for ( size_t j = 0; j != problem.getLinObjectives().size(); ++j )
+                values.objective += problem.getLinObjectives()[j] * x[j];
+            SparseEntries const& Qo = problem.getQuadraticObjectives();
+            for ( SparseEntries::const_iterator it = Qo.begin(); it != Qo.end(); ++it )
+                values.objective += it->value() * x[it->row()] * x[it->col()];
+
+            std::fill( values.rows.begin(), values.rows.end(), 0. );
+            SparseEntries const& A = problem.getLinConstraints();
+            for ( SparseEntries::const_iterator it = A.begin(); it != A.end(); ++it )
+                values.rows[ it->row() ] += it->value() * x[ it->col() ];
+            for ( size_t i = 0; i != problem.getQuadraticConstraints().size(); ++i )
+            {
+                SparseEntries const& Qi = problem.getQuadraticConstraints( i );
+                for ( SparseEntries::const_iterator it = Qi.begin(); it != Qi.end(); ++it )
+                    values.rows[i] += it->value() * x[it->row()] * x[it->col()];
+            }
+
+            for ( size_t i = 0; i != problem.getConstraintCount(); ++i )
+                switch ( problem.getConstraintBoundType(i) )
+                {
+                    case IoProblemT::BOUND::GREATER_EQ: values.lower[i] = problem.getConstraintLowerBound(i); break;
+                    case IoProblemT::BOUND::LESS_EQ:    values.upper[i] = problem.getConstraintUpperBound(i); break;
+                    case IoProblemT::BOUND::EQUAL:      values.lower[i] = values.upper[i] = problem.getConstraintLowerBound(i); break;
+                    case IoProblemT::BOUND::RANGE:      values.lower[i] = problem.getConstraintLowerBound(i);
+                                                        values.upper[i] = problem.getConstraintUpperBound(i); break;
+                    default: break;
+                }
+        } //...problemValues()
+
+        //! \brief Index of the variable or row \p name ("x<j>", "c<i>"), as the MPS and LP exports name them. \return False, if the index is not in [0,n).
+        inline bool exportedIndex( size_t & j, std::string const& name, size_t const n )
+        {
+            if ( name.size() < 2 || (name[0] != 'x' && name[0] != 'c') )
+                return false;
+            j = std::strtoul( name.c_str() + 1, NULL, 10 );
+            return j < n;
+        }
+
+        /*! \brief Values at \p x of the MPS file \p path, as a reader sees it: the obj row and 1/2 x'Qx of QUADOBJ (lower triangle) minus its rhs,
+         *         and the rows from COLUMNS and QCMATRIX, with the bounds from ROWS, RHS and RANGES.
+         *  \return False, if the file can not be read, or names unknown variables or rows.
+         */
+        inline bool mpsValues( ProblemValues & values, std::string const& path, std::vector<double> const& x, size_t const m )
+        {
+            std::ifstream f( path );
+            if ( !f.is_open() )
+                return false;
+
+            values.reset( m );
+            std::fill( values.rows.begin(), values.rows.end(), 0. );
+            std::vector<char>   types ( m, 'N' );
+            std::vector<double> rhs   ( m, 0. ), ranges( m, 0. );
+            std::string line, section, a, b;
+            size_t qcRow = 0, i, j, k;
+            double value;
+            while ( std::getline(f, line) )
+            {
+                if ( line.empty() )
+                    continue;
+                std::istringstream tokens( line );
+                if ( line[0] != ' ' )
+                {
+                    tokens >> section;
+                    if ( (section == "QCMATRIX") && (!(tokens >> a) || !exportedIndex(qcRow, a, m)) )
+                        return false;
+                    continue;
+                }
+
+                if ( section == "ROWS" )
+                {
+                    char type;
+                    tokens >> type >> a;
+                    if ( a == "obj" ) continue;
+                    if ( !exportedIndex(i, a, m) ) return false;
+                    types[i] = type;
+                }
+                else if ( section == "COLUMNS" )
+                {
+                    tokens >> a >> b;
+                    if ( b == "'MARKER'" ) continue;
+                    if ( !(tokens >> value) || !exportedIndex(j, a, x.size()) ) return false;
+                    if ( b == "obj" )                       values.objective += value * x[j];
+                    else if ( exportedIndex(i, b, m) )      values.rows[i]   += value * x[j];
+                    else                                    return false;
+                }
+                else if ( (section == "RHS") || (section == "RANGES") )
+                {
+                    if ( !(tokens >> a >> b >> value) ) return false;
+                    if ( b == "obj" )                       values.objective -= value;
+                    else if ( !exportedIndex(i, b, m) )     return false;
+                    else                                    (section == "RHS" ? rhs : ranges)[i] = value;
+                }
+                else if ( (section == "QUADOBJ") || (section == "QCMATRIX") )
+                {
+                    if ( !(tokens >> a >> b >> value) || !exportedIndex(j, a, x.size()) || !exportedIndex(k, b, x.size()) ) return false;
+                    if ( section == "QCMATRIX" )            values.rows[qcRow] += value * x[j] * x[k];
+                    else if ( j == k )                      values.objective   += .5 * value * x[j] * x[k];
+                    else                                    values.objective   += value * x[j] * x[k];
+                }
+            }
+
+            for ( i = 0; i != m; ++i )
+                switch ( types[i] )
+                {
+                    case 'G': values.lower[i] = rhs[i]; if ( ranges[i] != 0. ) values.upper[i] = rhs[i] + std::abs(ranges[i]); break;
+                    case 'L': values.upper[i] = rhs[i]; if ( ranges[i] != 0. ) values.lower[i] = rhs[i] - std::abs(ranges[i]); break;
+                    case 'E': values.lower[i] = values.upper[i] = rhs[i];
+                              if ( ranges[i] > 0. ) values.upper[i] += ranges[i];
+                              if ( ranges[i] < 0. ) values.lower[i] += ranges[i];
+                              break;
+                    default: break;
+                }
+
+            return true;
+        } //...mpsValues()
+
+        /*! \brief Value at \p x of the LP expression \p tokens[pos...], up to a comparison or the end: signed terms "c x", "c x ^ 2", "c x * y" or "c",
+         *         and bracketed quadratic parts, "[ ... ] / 2" in the objective. Leaves \p pos at the comparison.
+         *  \return False, if a term names an unknown variable, or a bracket is not closed.
+         */
+        inline bool lpExpression( double & value, std::vector<std::string> const& tokens, size_t & pos, std::vector<double> const& x )
+        {
+            double sign = 1., bracket = 0.;
+            bool   inBracket = false;
+            size_t j, k;
+            for ( value = 0.; pos < tokens.size(); ++pos )
+            {
+                std::string const& token = tokens[pos];
+                if      ( token == "+" ) sign = 1.;
+                else if ( token == "-" ) sign = -1.;
+                else if ( token == "[" ) { inBracket = true; bracket = 0.; }
+                else if ( token == "]" )
+                {
+                    if ( (pos + 2 < tokens.size()) && (tokens[pos+1] == "/") )
+                    {
+                        bracket /= std::strtod( tokens[pos+2].c_str(), NULL );
+                        pos += 2;
+                    }
+                    value     += bracket;
+                    inBracket  = false;
+                }
+                else if ( (token == ">=") || (token == "<=") || (token == "=") )
+                    break;
+                else
+                {
+                    double term = sign * std::strtod( token.c_str(), NULL );
+                    sign = 1.;
+                    if ( (pos + 1 < tokens.size()) && (tokens[pos+1][0] == 'x') )
+                    {
+                        if ( !exportedIndex(j, tokens[++pos], x.size()) ) return false;
+                        term *= x[j];
+                        if ( (pos + 2 < tokens.size()) && (tokens[pos+1] == "^") )
+                        {
+                            term *= x[j];
+                            pos += 2;
+                        }
+                        else if ( (pos + 2 < tokens.size()) && (tokens[pos+1] == "*") )
+                        {
+                            if ( !exportedIndex(k, tokens[pos+2], x.size()) ) return false;
+                            term *= x[k];
+                            pos += 2;
+                        }
+                    }
+                    (inBracket ? bracket : value) += term;
+                }
+            }
+            return !inBracket;
+        } //...lpExpression()
+
+        /*! \brief Values at \p x of the LP file \p path: the "obj" statement, and every "c<i>", "c<i>_lo" or "c<i>_up" statement with its bound.
+         *         Rows without a statement (free constraints) stay NaN and unbounded.
+         *  \return False, if the file can not be read, or a statement does not parse.
+         */
+        inline bool lpValues( ProblemValues & values, std::string const& path, std::vector<double> const& x, size_t const m )
+        {
+            std::ifstream f( path );
+            if ( !f.is_open() )
+                return false;
+
+            // statements with their continuation lines, in Minimize and Subject To
+            std::vector< std::vector<std::string> > statements;
+            std::string line, token, section;
+            while ( std::getline(f, line) )
+            {
+                if ( line.empty() || (line[0] == '\\') )
+                    continue;
+                if ( line[0] != ' ' )
+                {
+                    section = line;
+                    continue;
+                }
+                if ( (section != "Minimize") && (section != "Subject To") )
+                    continue;
+
+                std::istringstream tokens( line );
+                tokens >> token;
+                if ( token[token.size()-1] == ':' )
+                    statements.push_back( std::vector<std::string>() );
+                if ( statements.empty() )
+                    return false;
+                do statements.back().push_back( token ); while ( tokens >> token );
+            }
+
+            values.reset( m );
+            bool hasObjective = false;
+            for ( size_t s = 0; s != statements.size(); ++s )
+            {
+                std::vector<std::string> const& tokens = statements[s];
+                const std::string name = tokens[0].substr( 0, tokens[0].size() - 1 );
+                size_t pos = 1, i;
+                double value;
+                if ( !lpExpression(value, tokens, pos, x) )
+                    return false;
+
+                if ( name == "obj" )
+                {
+                    values.objective = value;
+                    hasObjective     = true;
+                    continue;
+                }
+                if ( !exportedIndex(i, name.substr(0, name.find('_')), m) || (pos + 2 != tokens.size()) )
+                    return false;
+
+                const double bound = std::strtod( tokens[pos+1].c_str(), NULL );
+                values.rows[i] = value;
+                if ( tokens[pos] != "<=" ) values.lower[i] = bound;
+                if ( tokens[pos] != ">=" ) values.upper[i] = bound;
+            }
+
+            return hasObjective;
+        } //...lpValues()
+
+        //! \brief Largest difference, relative to max(1,|value|), of the objective, row values and bounds, max(), if bounds differ in being infinite.
+        inline double valuesDiff( ProblemValues const& a, ProblemValues const& b )
+        {
+            const double different = std::numeric_limits<double>::max();
+            if ( (a.rows.size() != b.rows.size()) || (a.lower.size() != b.lower.size()) || (a.upper.size() != b.upper.size()) )
+                return different;
+
+            double diff = relDiff( a.objective, b.objective );
+            for ( size_t i = 0; i != a.rows.size(); ++i )
+            {
+                if ( !std::isnan(a.rows[i]) && !std::isnan(b.rows[i]) )
+                    diff = std::max( diff, relDiff(a.rows[i], b.rows[i]) );
+                diff = std::max( diff, relDiff(a.lower[i], b.lower[i]) );
+                diff = std::max( diff, relDiff(a.upper[i], b.upper[i]) );
+            }
+            return diff;
+        } //...valuesDiff()
+    } //...ns bench
+} //...ns rapter
+
+/*! \brief Times writing and reading a problem as csv files (OptProblem::write, read) against the binary container (writeBinary, readBinary),
+ *         checks that the binary round trip is exact, and times the MPS and LP exports. The exports are read back, and their objective,
+ *         constraint values and bounds at a random point compared against the problem's entry lists.
+ *  \return EXIT_FAILURE, if the binary round trip changes the problem, or the MPS or LP export evaluates differently.
+ */
+int benchProblemIo( int argc, char** argv )
+{
+    using rapter::bench::IoProblemT;
+
+    rapter::bench::RandomProblemParams params;
+    params.allBounds   = true;
+    params.allVarTypes = true;
+    std::string dir     = "./bench_problem_io";
+    double      tol     = 1.e-9;
+    params.parse( argc, argv );
+    rapter::console::parse_argument( argc, argv, "--dir"     , dir );
+    rapter::console::parse_argument( argc, argv, "--tol"     , tol );
+    std::cout << "[" << __func__ << "]: " << "Usage: --bench-problem-io ";
+    params.printUsage( std::cout );
+    std::cout << " [--dir " << dir << "] [--tol " << tol << "\t relative, of the exports' values]" << std::endl;
+
+    srand( 0 );
+    const int n = params.n, m = params.m;
+    IoProblemT problem;
+    rapter::bench::randomProblem( problem, params );
+    boost::filesystem::create_directories( dir + "/csv" );
+
+    rapter::bench::ClockT::time_point start = rapter::bench::now();
+    problem.write( dir + "/csv" );
+    const double csvWrite = rapter::bench::secondsSince( start );
+
+    IoProblemT csvProblem;
+    start = rapter::bench::now();
+    csvProblem.read( dir + "/csv" );
+    const double csvRead = rapter::bench::secondsSince( start );
+
+    start = rapter::bench::now();
+    int err = problem.writeBinary( dir + "/" + problem.getBinaryName() );
+    const double binWrite = rapter::bench::secondsSince( start );
+
+    IoProblemT binProblem;
+    start = rapter::bench::now();
+    err += binProblem.read( dir + "/" + problem.getBinaryName() );
+    const double binRead = rapter::bench::secondsSince( start );
+
+    start = rapter::bench::now();
+    err += problem.writeMps( dir + "/" + problem.getMpsName() );
+    const double mpsWrite = rapter::bench::secondsSince( start );
+
+    start = rapter::bench::now();
+    err += problem.writeLp( dir + "/" + problem.getLpName() );
+    const double lpWrite = rapter::bench::secondsSince( start );
+
+    // exports evaluated at a random point
+    std::vector<double> x( n );
+    for ( int j = 0; j != n; ++j )
+        x[j] = rapter::bench::unitRand<double>();
+    rapter::bench::ProblemValues reference, mpsValues, lpValues;
+    rapter::bench::problemValues( reference, problem, x );
+    const double different = std::numeric_limits<double>::max();
+    const double mpsDiff   = rapter::bench::mpsValues( mpsValues, dir + "/" + problem.getMpsName(), x, m ) ? rapter::bench::valuesDiff( reference, mpsValues ) : different;
+    const double lpDiff    = rapter::bench::lpValues ( lpValues , dir + "/" + problem.getLpName() , x, m ) ? rapter::bench::valuesDiff( reference, lpValues  ) : different;
+
+    const double binDiff = rapter::bench::problemDiff( problem, binProblem, true  );
+    const double csvDiff = rapter::bench::problemDiff( problem, csvProblem, false );
+    const bool   binOk   = (EXIT_SUCCESS == err) && (binDiff == 0.);
+    const bool   exOk    = (mpsDiff < tol) && (lpDiff < tol);
+
+    std::cout << "vars,constraints,csv_write_sec,csv_read_sec,bin_write_sec,bin_read_sec,mps_write_sec,lp_write_sec,csv_max_diff,bin_max_diff,mps_max_diff,lp_max_diff" << std::endl;
+    std::cout << n << "," << m << "," << csvWrite << "," << csvRead << "," << binWrite << "," << binRead << ","
+              << mpsWrite << "," << lpWrite << "," << csvDiff << "," << binDiff << "," << mpsDiff << "," << lpDiff << std::endl;
+    std::cout << "[" << __func__ << "]: " << (binOk ? "binary round trip is exact" : "binary round trip DIFFERS") << ", "
+              << (exOk ? "MPS and LP exports evaluate as the problem" : "MPS or LP export evaluates DIFFERENTLY") << std::endl;
+
+    return (binOk && exOk) ? EXIT_SUCCESS : EXIT_FAILURE;
+} //...benchProblemIo()
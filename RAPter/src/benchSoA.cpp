@@ -0,0 +1,101 @@
+#include <iostream>
+#include <vector>
+#include <cstdlib>                                      // srand
+
+#include "rapter/typedefs.h"                            // PointContainerT, PointContainerSoAT, _3d::PrimitiveT
+#include "rapter/util/parse.h"                          // rapter::console
+#include "rapter/util/bench.h"                          // unitRand, secondsSince
+#include "rapter/processing/util.hpp"                   // getPopulations
+#include "rapter/primitives/impl/planePrimitive.hpp"    // getExtent
+
+namespace rapter
+{
+    namespace bench
+    {
+        /*! \brief Samples \p n noisy points from \p patchCount random planes, and assigns them to their plane by GID.
+         *  \param[out] points      Point cloud output, GID tags set.
+         *  \param[out] planes      One plane per GID.
+         *  \param[in]  interleave  Assign point pid to plane pid % patchCount, instead of consecutive blocks of points to each plane.
+         */
+        inline void samplePlanes( PointContainerT & points, std::vector<_3d::PrimitiveT> & planes, long const n, int const patchCount, Scalar const scale, bool const interleave )
+        {
+            typedef Eigen::Matrix<Scalar,3,1> Position;
+
+            planes.clear();
+            for ( int gid = 0; gid != patchCount; ++gid )
+            {
+                const Position normal = Position( unitRand<Scalar>(), unitRand<Scalar>(), unitRand<Scalar>() ).normalized();
+                planes.push_back( _3d::PrimitiveT(Position(unitRand<Scalar>(), unitRand<Scalar>(), unitRand<Scalar>()), normal) );
+            }
+
+            points.clear();
+            points.reserve( n );
+            for ( long pid = 0; pid != n; ++pid )
+            {
+                const GidT gid = interleave ? pid % patchCount : pid * patchCount / n;
+                _3d::PrimitiveT const& plane = planes[ gid ];
+                const Position u = plane.dir().unitOrthogonal(), v = plane.dir().cross( u );
+                const Position pos = plane.pos() + u * unitRand<Scalar>() * Scalar(0.2) + v * unitRand<Scalar>() * Scalar(0.2) + plane.dir() * unitRand<Scalar>() * scale * Scalar(0.1);
+                points.push_back( PointPrimitiveT(pos, plane.dir()) );
+                points.back().setTag( PointPrimitiveT::TAGS::GID, gid );
+            }
+        }
+
+        //! \brief Times populations, and the extent of each plane over its population in \p points.
+        template <class _PointContainerT>
+        inline void runLayout( std::string const& name, _PointContainerT const& points, std::vector<_3d::PrimitiveT> const& planes, Scalar const scale )
+        {
+            typedef std::map<GidT, std::vector<PidT> > PopulationsT;
+
+            ClockT::time_point start = now();
+            PopulationsT populations;
+            processing::getPopulations( populations, points );
+            const double populationsTime = secondsSince( start );
+
+            start = now();
+            Scalar checksum( 0 );
+            for ( PopulationsT::const_iterator it = populations.begin(); it != populations.end(); ++it )
+            {
+                _3d::PrimitiveT plane = planes[ it->first ]; // copy, to not reuse cached extents
+                _3d::PrimitiveT::ExtentsT extrema;
+                if ( EXIT_SUCCESS == plane.getExtent<PointPrimitiveT>( extrema, points, scale, &(it->second), /* force_axis_aligned: */ true ) )
+                    for ( size_t d = 0; d != extrema.size(); ++d )
+                        checksum += extrema[d].sum();
+            }
+            const double extentsTime = secondsSince( start );
+
+            std::cout << name << "," << points.size() << "," << populations.size() << ","
+                      << populationsTime << "," << extentsTime << "," << checksum << std::endl;
+        }
+    } //...ns bench
+} //...ns rapter
+
+//! \brief Populations and plane extents over the array-of-structures PointContainerT, and the structure-of-arrays PointContainerSoAT.
+int benchSoA( int argc, char** argv )
+{
+    long                 n          = 10000000;
+    int                  patchCount = 1000;
+    rapter::Scalar       scale      = 0.05;
+    rapter::console::parse_argument( argc, argv, "-n"       , n );
+    rapter::console::parse_argument( argc, argv, "--patches", patchCount );
+    rapter::console::parse_argument( argc, argv, "--scale"  , scale );
+    const bool interleave = rapter::console::find_switch( argc, argv, "--interleave" );
+    std::cout << "[" << __func__ << "]: " << "Usage: --bench-soa [-n " << n << "] [--patches " << patchCount << "] [--scale " << scale << "] [--interleave]" << std::endl;
+
+    srand( 0 );
+    rapter::PointContainerT points;
+    std::vector<rapter::_3d::PrimitiveT> planes;
+    rapter::bench::samplePlanes( points, planes, n, patchCount, scale, interleave );
+
+    const rapter::bench::ClockT::time_point start = rapter::bench::now();
+    rapter::PointContainerSoAT soaPoints( points );
+    const double convertTime = rapter::bench::secondsSince( start );
+    std::cout << "[" << __func__ << "]: " << "conversion took " << convertTime << " s, "
+              << "bytes/point: " << sizeof(rapter::PointPrimitiveT) << " vs. " << 6 * sizeof(rapter::Scalar) + sizeof(rapter::GidT) << std::endl;
+
+    std::cout << "layout,points,patches,populations_sec,extents_sec,checksum" << std::endl;
+    rapter::bench::runLayout( "aos", points   , planes, scale );
+    rapter::bench::runLayout( "soa", soaPoints, planes, scale );
+
+    return EXIT_SUCCESS;
+} //...benchSoA()
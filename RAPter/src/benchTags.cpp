@@ -0,0 +1,81 @@
+#include <iostream>
+#include <fstream>
+#include <map>
+#include <vector>
+#include <unistd.h>                                     // sysconf
+
+#include "rapter/typedefs.h"                            // PointPrimitiveT
+#include "rapter/util/parse.h"                          // rapter::console
+#include "rapter/util/bench.h"                          // secondsSince
+#include "rapter/primitives/impl/taggable.hpp"
+
+namespace rapter
+{
+    namespace bench
+    {
+        //! \brief The std::map storage Taggable used before the fixed slots, for comparison.
+        struct MapTags
+        {
+            inline void  setTag( GidT key, GidT value ) { _longValuedTags[key] = value; }
+            inline GidT  getTag( GidT key ) const
+            {
+                std::map<GidT,GidT>::const_iterator it = _longValuedTags.find( key );
+                return ( it != _longValuedTags.end() ) ? it->second : GidT( Taggable<Scalar>::TAG_UNSET );
+            }
+
+            std::map<GidT,GidT>     _longValuedTags;
+            std::map<char,char>     _charValuedTags;
+            std::map<Scalar,Scalar> _scalarValuedTags;
+        };
+
+        //! \brief Resident set size in bytes, from /proc/self/statm.
+        inline long residentBytes()
+        {
+            long pages = 0, resident = 0;
+            std::ifstream statm( "/proc/self/statm" );
+            statm >> pages >> resident;
+            return resident * sysconf( _SC_PAGESIZE );
+        }
+
+        //! \brief Tags \p n points with their GID, and reads them back \p passes times.
+        template <class _TaggableT>
+        inline void run( std::string const& name, long const n, int const passes )
+        {
+            const GidT key = PointPrimitiveT::TAGS::GID;
+
+            const long before = residentBytes();
+            std::vector<_TaggableT> points( n );
+            for ( long i = 0; i != n; ++i )
+                points[i].setTag( key, GidT(i % 100000) );
+            const long after  = residentBytes();
+
+            GidT sum = 0;
+            const ClockT::time_point start = now();
+            for ( int pass = 0; pass != passes; ++pass )
+                for ( long i = 0; i != n; ++i )
+                    sum += points[i].getTag( key );
+            const double elapsed = secondsSince( start );
+
+            std::cout << name << "," << sizeof(_TaggableT) << "," << double(after - before) / n << ","
+                      << double(n) * passes / elapsed << "," << sum << std::endl;
+        }
+    } //...ns bench
+} //...ns rapter
+
+//! \brief Bytes per point and GID lookups per second of point tags, fixed slots against the previous std::map storage.
+int benchTags( int argc, char** argv )
+{
+    long n      = 20000000;
+    int  passes = 10;
+    rapter::console::parse_argument( argc, argv, "-n"      , n );
+    rapter::console::parse_argument( argc, argv, "--passes", passes );
+    std::cout << "[" << __func__ << "]: " << "Usage: --bench-tags [-n " << n << "] [--passes " << passes << "]" << std::endl;
+
+    // contiguous storage first, its memory is given back to the system, the map nodes' might not be
+    std::cout << "storage,sizeof,bytes_per_point,lookups_per_sec,checksum" << std::endl;
+    rapter::bench::run< rapter::Taggable<rapter::Scalar> >( "slots", n, passes );
+    rapter::bench::run< rapter::bench::MapTags          >( "map"  , n, passes );
+    std::cout << "sizeof(PointPrimitive): " << sizeof(rapter::PointPrimitiveT) << std::endl;
+
+    return EXIT_SUCCESS;
+} //...benchTags()
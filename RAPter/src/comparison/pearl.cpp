@@ -88,6 +88,7 @@ int pearlCli( int argc, char **argv )
         pcl::console::parse_argument( argc, argv, "--unary", params.lambdas(0) );
         pcl::console::parse_argument( argc, argv, "--int-mult", params.int_mult );
         pcl::console::parse_argument( argc, argv, "--cmp"  , params.beta );
+        pcl::console::parse_argument( argc, argv, "--data-radius", params.data_radius );
         valid_input &= pcl::console::parse_argument( argc, argv, "--pw"  , params.lambdas(2) ) >= 0;
 
         if (     !valid_input
@@ -103,6 +104,7 @@ int pearlCli( int argc, char **argv )
                       << "\t --cmp " << params.beta << "\n"
                       << "\t --unary " << params.lambdas(0) << "\n"
                       << "\t --int-mult " << params.int_mult << "\n"
+                      << "\t --data-radius " << params.data_radius << "\t sparse datacosts, labels farther from a point are left out, 0: dense\n"
                       << "\n\t Example: ../pearl --scale 0.03 --cloud cloud.ply -p patches.csv --pw 1000 --cmp 1000 --int-mult 1000\n"
                       << "\n";
 
@@ -0,0 +1,111 @@
+#include "boost/filesystem.hpp"
+#include "pcl/console/parse.h"
+
+#include "rapter/typedefs.h"                            // _2d::PrimitiveT, _3d::PrimitiveT
+#include "rapter/util/parse.h"                          // find_switch
+#include "rapter/io/io.h"                               // readPrimitives, savePrimitives, BinaryColumns
+#include "rapter/primitives/impl/planePrimitive.hpp"
+
+namespace rapter
+{
+    //! \brief Converts primitives, associations or points between CSV/PLY and \ref io::BinaryColumns, see \ref convert.
+    template <class _PrimitiveT, class _PrimitiveContainerT>
+    inline int convertFile( std::string const& in_path, std::string const& out_path, std::string type )
+    {
+        typedef typename _PrimitiveContainerT::value_type InnerPrimitiveContainerT;
+
+        // deduce type from the binary header, or the file name
+        if ( type.empty() )
+        {
+            io::BinaryColumns file;
+            if ( io::BinaryColumns::isBinary(in_path) && (EXIT_SUCCESS == file.map(in_path)) )
+                type = (file.kind() == io::BinaryColumns::PRIMITIVES  ) ? "prims"
+                     : (file.kind() == io::BinaryColumns::ASSOCIATIONS) ? "assoc"
+                                                                        : "points";
+            else if ( boost::filesystem::path(in_path).extension().string() == ".ply" )
+                type = "points";
+            else if ( boost::filesystem::path(in_path).filename().string().find("points_") == 0 )
+                type = "assoc";
+            else
+                type = "prims";
+        }
+
+        int err = EXIT_SUCCESS;
+        if ( type == "prims" )
+        {
+            _PrimitiveContainerT prims;
+            err = io::readPrimitives<_PrimitiveT, InnerPrimitiveContainerT>( prims, in_path );
+            if ( EXIT_SUCCESS == err )
+                err = io::savePrimitives<_PrimitiveT, typename InnerPrimitiveContainerT::const_iterator>( prims, out_path, /* verbose: */ true );
+        }
+        else if ( type == "assoc" )
+        {
+            std::vector<std::pair<PidT,LidT> > points_primitives;
+            err = io::readAssociations( points_primitives, in_path, NULL );
+
+            // writeAssociations takes points
+            PointContainerT points;
+            points.reserve( points_primitives.size() );
+            for ( size_t pid = 0; (EXIT_SUCCESS == err) && (pid != points_primitives.size()); ++pid )
+            {
+                points.push_back( PointPrimitiveT() );
+                points.back().setTag( PointPrimitiveT::TAGS::PID, pid );
+                points.back().setTag( PointPrimitiveT::TAGS::GID, points_primitives[pid].first );
+            }
+            if ( EXIT_SUCCESS == err )
+                err = io::writeAssociations<PointPrimitiveT>( points, out_path );
+        }
+        else if ( type == "points" )
+        {
+            PointContainerT points;
+            err = io::readPoints<PointPrimitiveT>( points, in_path );
+            if ( EXIT_SUCCESS == err )
+                err = io::writePoints<PointPrimitiveT>( points, out_path );
+        }
+        else
+        {
+            std::cerr << "[" << __func__ << "]: " << "unknown --type " << type << std::endl;
+            err = EXIT_FAILURE;
+        }
+
+        if ( EXIT_SUCCESS == err )
+            std::cout << "[" << __func__ << "]: " << "converted " << type << " " << in_path << " -> " << out_path << std::endl;
+        return err;
+    } //...convertFile()
+} //...ns rapter
+
+/*! \brief Converts between CSV/PLY and the binary container. The output format is decided by \ref rapter::io::useBinary (".rbin" or --binary),
+ *         the input format is recognized by its magic bytes.
+ */
+int convert( int argc, char** argv )
+{
+    std::string in_path, out_path, type;
+    bool valid_input = true;
+    if ( pcl::console::parse_argument(argc, argv, "--in", in_path) < 0 || !boost::filesystem::exists(in_path) )
+    {
+        std::cerr << "[" << __func__ << "]: " << "--in does not exist: " << in_path << std::endl;
+        valid_input = false;
+    }
+    if ( pcl::console::parse_argument(argc, argv, "--out", out_path) < 0 )
+    {
+        std::cerr << "[" << __func__ << "]: " << "--out is compulsory" << std::endl;
+        valid_input = false;
+    }
+    pcl::console::parse_argument( argc, argv, "--type", type );
+
+    if ( !valid_input || rapter::console::find_switch(argc,argv,"--help") || rapter::console::find_switch(argc,argv,"-h") )
+    {
+        std::cout << "[" << __func__ << "]: " << "Usage:\t " << argv[0] << " --convert[3D]\n"
+                  << "\t --in " << in_path << "\t CSV, PLY or binary, binary is recognized by its magic bytes\n"
+                  << "\t --out " << out_path << "\t binary, if ends in .rbin or --binary is given, CSV/PLY otherwise\n"
+                  << "\t [--type prims|assoc|points]\t deduced from binary header or file name, if omitted\n"
+                  << "\t [--binary]\n"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if ( rapter::console::find_switch(argc,argv,"--convert3D") )
+        return rapter::convertFile< rapter::_3d::PrimitiveT, rapter::_3d::PrimitiveContainerT >( in_path, out_path, type );
+    else
+        return rapter::convertFile< rapter::_2d::PrimitiveT, rapter::_2d::PrimitiveContainerT >( in_path, out_path, type );
+} //...convert()
@@ -1,6 +1,8 @@
 #include <iostream>
 
 #include "rapter/util/parse.h"
+#include "rapter/io/binaryIo.hpp"   // binaryOutput
+#include "rapter/primitives/extentCache.h"
 
 int subsample ( int argc, char** argv ); // subsample.cpp
 int segment   ( int argc, char** argv ); // segment.cpp
@@ -14,6 +16,16 @@ int merge     ( int argc, char** argv ); // merge.cpp
 //int datafit   ( int argc, char** argv ); // datafit.cpp
 //int reassign  ( int argc, char** argv );
 int represent ( int argc, char** argv ); // represent.cpp
+int convert   ( int argc, char** argv ); // convert.cpp
+int pipeline  ( int argc, char** argv ); // pipeline.cpp
+int benchTags ( int argc, char** argv ); // benchTags.cpp
+int benchSoA  ( int argc, char** argv ); // benchSoA.cpp
+int benchAngles( int argc, char** argv ); // benchAngles.cpp
+int benchPly   ( int argc, char** argv ); // benchPly.cpp
+int benchHessian( int argc, char** argv ); // benchHessian.cpp
+int benchProblemIo( int argc, char** argv ); // benchProblemIo.cpp
+int benchNative ( int argc, char** argv ); // benchNative.cpp
+int benchPopulationIndex( int argc, char** argv ); // benchPopulationIndex.cpp
 
 int main( int argc, char *argv[] )
 {
@@ -34,13 +46,31 @@ int main( int argc, char *argv[] )
                   << "\t--merge3D\n"
                   << "\t--datafit\n"
                   << "\t--corresp\n"
-                  << "\t--represent[3D]"
+                  << "\t--represent[3D]\n"
+                  << "\t--convert[3D]\n"
+                  << "\t--pipeline[3D]\t generate, formulate, solve and merge iterations in one process\n"
+                  << "\t--bench-tags\t point tag memory and lookup rate\n"
+                  << "\t--bench-soa\t populations and extents, point structs against point arrays\n"
+                  << "\t--bench-angles\t checks and times the allowed angle lookup against the exact search\n"
+                  << "\t--bench-ply\t checks and times the PLY reader on ASCII and binary files\n"
+                  << "\t--bench-hessian\t checks and times the solver's Jacobian and Hessian callbacks\n"
+                  << "\t--bench-problem-io\t checks and times the binary problem container against the csv files, and the MPS and LP exports\n"
+                  << "\t--bench-native\t checks the native solver against brute force optima of small selection problems\n"
+                  << "\t--bench-population-index\t checks and times the population index against a map, on dense and sparse GIDs and after retags\n"
+                  << "\t[--binary]\t write primitives and associations in the binary format\n"
+                  << "\t[--extent-cache]\t keep primitive extents in \"<primitives>.extents\" between invocations"
                   //<< "\t--show\n"
                   << std::endl;
 
         return EXIT_SUCCESS;
     }
-    else if ( rapter::console::find_switch(argc,argv,"--segment") || rapter::console::find_switch(argc,argv,"--segment3D") )
+
+    // readers recognize the binary format by themselves, this only changes what is written
+    rapter::io::binaryOutput() = rapter::console::find_switch( argc, argv, "--binary" );
+    // extents are cached in-process either way, this reads and writes them next to the primitives files
+    rapter::ExtentCache::instance().setPersistent( rapter::console::find_switch(argc, argv, "--extent-cache") );
+
+    if ( rapter::console::find_switch(argc,argv,"--segment") || rapter::console::find_switch(argc,argv,"--segment3D") )
     {
        return segment( argc, argv );
     }
@@ -99,6 +129,46 @@ int main( int argc, char *argv[] )
     {
         return represent( argc, argv );
     }
+    else if ( rapter::console::find_switch(argc,argv,"--convert") || rapter::console::find_switch(argc,argv,"--convert3D") )
+    {
+        return convert( argc, argv );
+    }
+    else if ( rapter::console::find_switch(argc,argv,"--pipeline") || rapter::console::find_switch(argc,argv,"--pipeline3D") )
+    {
+        return pipeline( argc, argv );
+    }
+    else if ( rapter::console::find_switch(argc,argv,"--bench-tags") )
+    {
+        return benchTags( argc, argv );
+    }
+    else if ( rapter::console::find_switch(argc,argv,"--bench-soa") )
+    {
+        return benchSoA( argc, argv );
+    }
+    else if ( rapter::console::find_switch(argc,argv,"--bench-angles") )
+    {
+        return benchAngles( argc, argv );
+    }
+    else if ( rapter::console::find_switch(argc,argv,"--bench-ply") )
+    {
+        return benchPly( argc, argv );
+    }
+    else if ( rapter::console::find_switch(argc,argv,"--bench-hessian") )
+    {
+        return benchHessian( argc, argv );
+    }
+    else if ( rapter::console::find_switch(argc,argv,"--bench-problem-io") )
+    {
+        return benchProblemIo( argc, argv );
+    }
+    else if ( rapter::console::find_switch(argc,argv,"--bench-native") )
+    {
+        return benchNative( argc, argv );
+    }
+    else if ( rapter::console::find_switch(argc,argv,"--bench-population-index") )
+    {
+        return benchPopulationIndex( argc, argv );
+    }
 //    else if ( rapter::console::find_switch(argc,argv,"--corresp") || rapter::console::find_switch(argc,argv,"--corresp3D") )
 //    {
 //        return corresp( argc, argv );
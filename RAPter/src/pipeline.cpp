@@ -0,0 +1,27 @@
+#include "rapter/typedefs.h"                            // _2d, _3d namespaces
+#include "rapter/util/parse.h"                          // rapter::console
+
+#include "rapter/optimization/pipeline.h"               // Pipeline::runCli
+#include "rapter/primitives/impl/planePrimitive.hpp"
+
+int pipeline( int argc, char** argv )
+{
+    if ( rapter::console::find_switch(argc,argv,"--pipeline3D") )
+    {
+        return rapter::Pipeline::runCli< rapter::_3d::PrimitiveContainerT
+                                       , rapter::PointContainerT
+                                       , rapter::_3d::PrimitiveT
+                                       , rapter::PointPrimitiveT
+                                       , rapter::_3d::MyFinitePlaneToFinitePlaneCompatFunctor
+                                       >( argc, argv );
+    }
+    else
+    {
+        return rapter::Pipeline::runCli< rapter::_2d::PrimitiveContainerT
+                                       , rapter::PointContainerT
+                                       , rapter::_2d::PrimitiveT
+                                       , rapter::PointPrimitiveT
+                                       , rapter::_2d::MyFiniteLineToFiniteLineCompatFunctor
+                                       >( argc, argv );
+    } //...if find_switch
+} //...pipeline()
@@ -32,7 +32,9 @@ namespace rapter
                               ( rapter::PointContainerT       &points
                               , rapter::Scalar          const  scale
                               , int                  const  nn_K
-                              , int                  const  verbose );
+                              , int                  const  verbose
+                              , processing::NeighbourhoodGraph const* neighGraph
+                              , int                  const  scaleCount );
 
     template int
     Segmentation::orientPoints< rapter::PointPrimitiveT
@@ -43,7 +45,9 @@ namespace rapter
                               ( rapter::PointContainerT       &points
                               , rapter::Scalar          const  scale
                               , int                  const  nn_K
-                              , int                  const  verbose );
+                              , int                  const  verbose
+                              , processing::NeighbourhoodGraph const* neighGraph
+                              , int                  const  scaleCount );
 
 
     template int
@@ -61,6 +65,7 @@ namespace rapter
             , int                                      const  nn_K
             , int                                      const  verbose
             , size_t                                   const  patchPopLimit
+            , processing::NeighbourhoodGraph           const* neighGraph
             );
 
     template int
@@ -78,6 +83,7 @@ namespace rapter
                           , int                                      const  nn_K
                           , int                                      const  verbose
                           , size_t                                   const  patchPopLimit
+                          , processing::NeighbourhoodGraph           const* neighGraph
                           );
 
     namespace segm_templinst
@@ -108,6 +114,7 @@ namespace rapter
                               , GidT                        const  gid_tag_name              //= _PointT::GID
                               , int                         const  nn_K
                               , bool                        const  verbose
+                              , processing::NeighbourhoodGraph const* neighGraph
                               );
     template int
     Segmentation::regionGrow  < rapter::_3d::PrimitiveT
@@ -124,6 +131,7 @@ namespace rapter
                               , GidT                        const  gid_tag_name              //= _PointT::GID
                               , int                         const  nn_K
                               , bool                        const  verbose
+                              , processing::NeighbourhoodGraph const* neighGraph
                               );
 
     template int
@@ -135,6 +143,8 @@ namespace rapter
                             , bool                 const  soft_radius
                             , std::vector<PidT>         * mapping
                             , int                  const  verbose
+                            , processing::NeighbourhoodGraph const* neighGraph
+                            , int                  const  scaleCount
                             );
 
     template int
@@ -146,6 +156,8 @@ namespace rapter
                             , bool                 const  soft_radius
                             , std::vector<PidT>         * mapping
                             , int                  const  verbose
+                            , processing::NeighbourhoodGraph const* neighGraph
+                            , int                  const  scaleCount
                             );
 
     template int